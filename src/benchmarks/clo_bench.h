@@ -25,8 +25,6 @@
 
 #include <cl_ops.h>
 
-cl_int clo_bench_compare(CloType type, cl_uchar* a, cl_uchar* b);
-
 void clo_bench_rand(GRand* rng, CloType type, void* location);
 
 #endif
@@ -50,10 +50,10 @@ static unsigned int maxint = 0;
 /* Valid command line options. */
 static GOptionEntry entries[] = {
 	{"rng",          'r', 0, G_OPTION_ARG_STRING, &rng,
-		"Random number generator: " CLO_RNG_IMPLS " (default is " CLO_RNG_BENCHMARK_DEFAULT ")",
+		"Random number generator: " CLO_RNG_IMPLS " (default is " CLO_RNG_BENCHMARK_DEFAULT "). The _soa suffix selects the structure-of-arrays state layout, compare with the default layout to evaluate it.",
 		"RNG"},
 	{"output",       'o', 0, G_OPTION_ARG_STRING, &output,
-		"Output: file-tsv, file-dh, stdout-bin, stdout-uint (default: " CLO_RNG_BENCHMARK_OUTPUT ")",
+		"Output: file-tsv, file-dh, file-dh-bin, stdout-bin, stdout-uint (default: " CLO_RNG_BENCHMARK_OUTPUT "). The file-dh-bin and stdout-bin outputs write raw 32-bit words, which can be read by dieharder (-g 201) or PractRand.",
 		"OUTPUT"},
 	{"globalsize",   'g', 0, G_OPTION_ARG_INT,    &gws,
 		"Global work size (default is " G_STRINGIFY(CLO_RNG_BENCHMARK_GWS) ")",
@@ -82,6 +82,87 @@ static GOptionEntry entries[] = {
 	{ NULL, 0, 0, 0, NULL, NULL, NULL }
 };
 
+/* Message which tells the writer thread to stop. */
+#define CLO_RNG_BENCHMARK_WRITER_STOP GINT_TO_POINTER(-1)
+
+/**
+ * Output writer, which formats and writes generated numbers in a
+ * separate thread. Host buffers are exchanged with the main thread
+ * through two queues: buffers ready to be written are pushed into the
+ * `full` queue, and buffers already written are pushed back into the
+ * `free` queue. Buffers are identified by their index plus one.
+ * */
+struct clo_rng_bench_writer {
+
+	/** Output stream. */
+	FILE* output_pointer;
+
+	/** Write raw words? */
+	gboolean output_raw;
+
+	/** Field separator (formatted output only). */
+	const char* output_sep_field;
+
+	/** Line separator (formatted output only). */
+	const char* output_sep_line;
+
+	/** Host buffers. */
+	cl_uint* result_host[2];
+
+	/** Number of values in each host buffer. */
+	size_t numel;
+
+	/** Buffers ready to be written. */
+	GAsyncQueue* full;
+
+	/** Buffers ready to be filled. */
+	GAsyncQueue* free;
+
+	/** Was there a write error? */
+	gboolean write_error;
+
+};
+
+/**
+ * Writer thread function.
+ *
+ * @param[in] data A ::clo_rng_bench_writer object.
+ * @return Always `NULL`.
+ * */
+static gpointer clo_rng_bench_write(gpointer data) {
+
+	struct clo_rng_bench_writer* writer = data;
+	gpointer msg;
+
+	while ((msg = g_async_queue_pop(writer->full))
+			!= CLO_RNG_BENCHMARK_WRITER_STOP) {
+
+		cl_uint* result_host = writer->result_host[GPOINTER_TO_INT(msg) - 1];
+
+		/* Write data to output. */
+		if (writer->output_raw) {
+			fwrite(result_host, sizeof(cl_uint), writer->numel,
+				writer->output_pointer);
+		} else {
+			for (size_t i = 0; i < writer->numel; i++) {
+				fprintf(writer->output_pointer, "%u%s", result_host[i],
+					writer->output_sep_field);
+			}
+			fprintf(writer->output_pointer, "%s",
+				writer->output_sep_line);
+		}
+
+		/* Keep track of write errors. */
+		if (ferror(writer->output_pointer))
+			writer->write_error = TRUE;
+
+		/* Buffer can be filled again. */
+		g_async_queue_push(writer->free, msg);
+	}
+
+	return NULL;
+}
+
 /**
  * Main program.
  *
@@ -99,11 +180,11 @@ int main(int argc, char **argv) {
 	GOptionContext *context = NULL;
 
 	/* Test data structures. */
-	cl_uint *result_host = NULL;
+	cl_uint *result_host[2] = { NULL, NULL };
 	FILE *output_pointer = NULL;
 	char *output_buffer = NULL;
 	gboolean output_raw;
-	const char *output_sep_field, *output_sep_line;
+	const char *output_sep_field = NULL, *output_sep_line = NULL;
 	gchar *output_filename = NULL;
 	gchar* compiler_opts = NULL;
 	gchar* src = NULL;
@@ -113,9 +194,19 @@ int main(int argc, char **argv) {
 	CCLDevice* dev = NULL;
 	CCLProgram* prg = NULL;
 	CCLQueue* queue = NULL;
+	CCLQueue* queue_comm = NULL;
 	CCLKernel* test_rng = NULL;
 	CCLBuffer* seeds_dev = NULL;
-	CCLBuffer* result_dev = NULL;
+	CCLBuffer* result_dev[2] = { NULL, NULL };
+	CCLEvent* read_evt[2] = { NULL, NULL };
+	CCLEventWaitList ewl = NULL;
+
+	/* Output writer and respective thread. */
+	struct clo_rng_bench_writer writer = { 0 };
+	GThread* writer_thread = NULL;
+
+	/* Current and previous buffers. */
+	gint buf, buf_prev = -1;
 
 	/* Error management object. */
 	GError *err = NULL;
@@ -123,6 +214,13 @@ int main(int argc, char **argv) {
 	/* How long will it take? */
 	GTimer* timer = NULL;
 
+	/* Profiler, for measuring generation throughput. */
+	CCLProf* prof = NULL;
+	const CCLProfAgg* prof_agg;
+
+	/* Event wrapper. */
+	CCLEvent* evt;
+
 	CloRng* rng_ocl = NULL;
 
 	CloRngSeedType seed_type;
@@ -140,11 +238,11 @@ int main(int argc, char **argv) {
 	if (gid_hash == NULL) {
 		seed_type = CLO_RNG_SEED_HOST_MT;
 	} else {
-		seed_type = CLO_RNG_SEED_DEV_GID;
+		seed_type = CLO_RNG_SEED_DEV_GID_FUSED;
 	}
 
 	g_if_err_create_goto(err, CLO_ERROR,
-		g_strcmp0(output, "file-tsv") && g_strcmp0(output, "file-dh") && g_strcmp0(output, "stdout-bin") && g_strcmp0(output, "stdout-uint"),
+		g_strcmp0(output, "file-tsv") && g_strcmp0(output, "file-dh") && g_strcmp0(output, "file-dh-bin") && g_strcmp0(output, "stdout-bin") && g_strcmp0(output, "stdout-uint"),
 		CLO_ERROR_ARGS, error_handler,
 		"Unknown output '%s'.", output);
 	g_if_err_create_goto(err, CLO_ERROR,
@@ -168,8 +266,15 @@ int main(int argc, char **argv) {
 		maxint ? " -D CLO_RNG_BENCHMARK_MAXINT" : "",
 		NULL);
 
-	/* Create command queue. */
-	queue = ccl_queue_new(ctx, dev, 0, &err);
+	/* Create command queue. Generation throughput is only profiled
+	 * for a finite number of runs. */
+	queue = ccl_queue_new(ctx, dev,
+		runs ? CL_QUEUE_PROFILING_ENABLE : 0, &err);
+	g_if_err_goto(err, error_handler);
+
+	/* Create command queue for reading generated numbers, so that reads
+	 * overlap the generation of the next block. */
+	queue_comm = ccl_queue_new(ctx, dev, 0, &err);
 	g_if_err_goto(err, error_handler);
 
 	/* Create RNG object. */
@@ -191,13 +296,23 @@ int main(int argc, char **argv) {
 	ccl_program_build(prg, compiler_opts, &err);
 	g_if_err_goto(err, error_handler);
 
-	/* Create host results buffer */
-	result_host = g_slice_alloc(sizeof(cl_uint) * gws);
+	/* Initialize GID-based seeds with the benchmark program. */
+	if (seed_type == CLO_RNG_SEED_DEV_GID_FUSED) {
+		clo_rng_init_seeds(rng_ocl, prg, queue, &err);
+		g_if_err_goto(err, error_handler);
+	}
 
-	/* Create device results buffer. */
-	result_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
-		gws * sizeof(cl_int), NULL, &err);
-	g_if_err_goto(err, error_handler);
+	/* Create host and device results buffers, two of each, so that
+	 * the device can generate numbers into one while the other is
+	 * being written. */
+	for (guint i = 0; i < 2; i++) {
+
+		result_host[i] = g_slice_alloc(sizeof(cl_uint) * gws);
+
+		result_dev[i] = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+			gws * sizeof(cl_uint), NULL, &err);
+		g_if_err_goto(err, error_handler);
+	}
 
 	/* Setup options depending whether the generated random numbers are
 	 * to be output to stdout or to a file. */
@@ -223,7 +338,13 @@ int main(int argc, char **argv) {
 
 	} else if (g_str_has_prefix(output, "file")) {
 		/* Generated random numbers are to be output to file. */
-		if (!g_strcmp0(output, "file-dh")) {
+		if (!g_strcmp0(output, "file-dh-bin")) {
+			output_filename = g_strconcat(
+				CLO_RNG_BENCHMARK_FILE_PREFIX, "_", rng, "_",
+				gid_hash ? "gid_" : "host_",
+				gid_hash ? gid_hash : "mt",
+				".dh.bin", NULL);
+		} else if (!g_strcmp0(output, "file-dh")) {
 			output_filename = g_strconcat(
 				CLO_RNG_BENCHMARK_FILE_PREFIX, "_", rng, "_",
 				gid_hash ? "gid_" : "host_",
@@ -244,7 +365,7 @@ int main(int argc, char **argv) {
 		}
 
 		/* Open file. */
-		output_pointer = fopen(output_filename, "w");
+		output_pointer = fopen(output_filename, "wb");
 		g_if_err_create_goto(err, CLO_ERROR, output_pointer == NULL,
 			CLO_ERROR_OPENFILE, error_handler,
 			"Unable to create output file '%s'.", output_filename);
@@ -259,8 +380,9 @@ int main(int argc, char **argv) {
 			CLO_ERROR_STREAM_WRITE, error_handler,
 			"Unable to set output file buffer.");
 
-		/* Output type is uint, not raw. */
-		output_raw = FALSE;
+		/* Output type is raw for binary dieharder files, uint
+		 * otherwise. */
+		output_raw = !g_strcmp0(output, "file-dh-bin");
 
 		/* Write initial data if file is to written in dieharder format. */
 		if (!g_strcmp0(output, "file-dh")) {
@@ -293,41 +415,95 @@ int main(int argc, char **argv) {
 	test_rng = ccl_program_get_kernel(prg, "clo_rng_bench", &err);
 	g_if_err_goto(err, error_handler);
 
-	/*  Set test kernel arguments. */
+	/*  Set test kernel arguments (results buffer is set in each run). */
 	cl_uint value = maxint ? maxint : bits;
-	ccl_kernel_set_args(test_rng, seeds_dev, result_dev,
-		ccl_arg_priv(value, cl_uint), NULL);
+	ccl_kernel_set_arg(test_rng, 0, seeds_dev);
+	ccl_kernel_set_arg(test_rng, 2, ccl_arg_priv(value, cl_uint));
+
+	/* Setup output writer and start writer thread. Both buffers are
+	 * initially free. */
+	writer.output_pointer = output_pointer;
+	writer.output_raw = output_raw;
+	writer.output_sep_field = output_sep_field;
+	writer.output_sep_line = output_sep_line;
+	writer.result_host[0] = result_host[0];
+	writer.result_host[1] = result_host[1];
+	writer.numel = gws;
+	writer.full = g_async_queue_new();
+	writer.free = g_async_queue_new();
+	g_async_queue_push(writer.free, GINT_TO_POINTER(1));
+	g_async_queue_push(writer.free, GINT_TO_POINTER(2));
+	writer_thread = g_thread_new("writer", clo_rng_bench_write, &writer);
 
 	/* Test! */
 	for (guint i = 0; (i != runs) || (runs == 0); i++) {
 
+		/* Get a free buffer, waiting for the writer if required. */
+		buf = GPOINTER_TO_INT(g_async_queue_pop(writer.free)) - 1;
+
 		/* Run kernel. */
-		ccl_kernel_enqueue_ndrange(
+		ccl_kernel_set_arg(test_rng, 1, result_dev[buf]);
+		evt = ccl_kernel_enqueue_ndrange(
 			test_rng, queue, 1, NULL, &gws, &lws, NULL, &err);
 		g_if_err_goto(err, error_handler);
+		ccl_event_set_name(evt, "RNG");
 
-		/* Read data. */
-		ccl_buffer_enqueue_read(result_dev, queue, CL_TRUE, 0,
-			gws * sizeof(cl_uint), result_host, NULL, &err);
+		/* Submit the kernel, since the read waits for it in another
+		 * queue. */
+		ccl_queue_flush(queue, &err);
 		g_if_err_goto(err, error_handler);
 
-		/* Write data to output. */
-		if (output_raw) {
-			fwrite(result_host, sizeof(cl_uint), gws, output_pointer);
-		} else {
-			for (unsigned int i = 0; i < gws; i++) {
-				fprintf(output_pointer, "%u%s", result_host[i],
-					output_sep_field);
-			}
-			fprintf(output_pointer, "%s", output_sep_line);
+		/* Read data in the transfer queue once the kernel is done,
+		 * without waiting, while the next block is generated. */
+		read_evt[buf] = ccl_buffer_enqueue_read(result_dev[buf],
+			queue_comm, CL_FALSE, 0, gws * sizeof(cl_uint),
+			result_host[buf], ccl_ewl(&ewl, evt, NULL), &err);
+		g_if_err_goto(err, error_handler);
+		ccl_queue_flush(queue_comm, &err);
+		g_if_err_goto(err, error_handler);
+
+		/* Meanwhile, hand the previous buffer to the writer as soon as
+		 * it has been read. */
+		if (buf_prev >= 0) {
+			ccl_event_wait(ccl_ewl(&ewl, read_evt[buf_prev], NULL), &err);
+			g_if_err_goto(err, error_handler);
+			g_async_queue_push(writer.full, GINT_TO_POINTER(buf_prev + 1));
 		}
+		buf_prev = buf;
 	}
 
+	/* Hand the last buffer to the writer. */
+	ccl_event_wait(ccl_ewl(&ewl, read_evt[buf_prev], NULL), &err);
+	g_if_err_goto(err, error_handler);
+	g_async_queue_push(writer.full, GINT_TO_POINTER(buf_prev + 1));
+
+	/* Wait for the writer to finish. */
+	g_async_queue_push(writer.full, CLO_RNG_BENCHMARK_WRITER_STOP);
+	g_thread_join(writer_thread);
+	writer_thread = NULL;
+
 	/* Stop timming. */
 	g_timer_stop(timer);
 
+	/* Check if there were write errors. */
+	g_if_err_create_goto(err, CLO_ERROR, writer.write_error,
+		CLO_ERROR_STREAM_WRITE, error_handler,
+		"Unable to write generated numbers to output.");
+
 	/* Print timming. */
 	g_print("     Finished, ellapsed time: %lfs\n", g_timer_elapsed(timer, NULL));
+
+	/* Print generation throughput, i.e. kernel time only. */
+	if (runs) {
+		prof = ccl_prof_new();
+		ccl_prof_add_queue(prof, "RNG", queue);
+		ccl_prof_calc(prof, &err);
+		g_if_err_goto(err, error_handler);
+		prof_agg = ccl_prof_get_agg(prof, "RNG");
+		g_print("     Generation throughput: %lf Mnumbers/s (%lf GB/s)\n",
+			(gws * runs * 1e3) / prof_agg->absolute_time,
+			(gws * runs * sizeof(cl_uint)) / (double) prof_agg->absolute_time);
+	}
 	g_print("     Done...\n");
 
 	/* If we get here, everything went Ok. */
@@ -345,6 +521,18 @@ error_handler:
 
 cleanup:
 
+	/* Make sure no reads are pending before releasing host buffers. */
+	if (queue) ccl_queue_finish(queue, NULL);
+	if (queue_comm) ccl_queue_finish(queue_comm, NULL);
+
+	/* Stop writer thread, if still running. */
+	if (writer_thread) {
+		g_async_queue_push(writer.full, CLO_RNG_BENCHMARK_WRITER_STOP);
+		g_thread_join(writer_thread);
+	}
+	if (writer.full) g_async_queue_unref(writer.full);
+	if (writer.free) g_async_queue_unref(writer.free);
+
 	/* Free CLI options context. */
 	if (context) g_option_context_free(context);
 
@@ -369,6 +557,9 @@ cleanup:
 	/* Free timer. */
 	if (timer) g_timer_destroy(timer);
 
+	/* Free profiler. */
+	if (prof) ccl_prof_destroy(prof);
+
 	/* Close file. */
 	if (output_pointer) fclose(output_pointer);
 
@@ -380,13 +571,17 @@ cleanup:
 
 	/* Destroy cf4ocl wrappers. */
 	if (seeds_dev) ccl_buffer_destroy(seeds_dev);
-	if (result_dev) ccl_buffer_destroy(result_dev);
+	for (guint i = 0; i < 2; i++)
+		if (result_dev[i]) ccl_buffer_destroy(result_dev[i]);
 	if (queue) ccl_queue_destroy(queue);
+	if (queue_comm) ccl_queue_destroy(queue_comm);
 	if (prg) ccl_program_destroy(prg);
 	if (ctx) ccl_context_destroy(ctx);
 
 	/* Free host resources */
-	if (result_host) g_slice_free1(sizeof(cl_uint) * gws, result_host);
+	for (guint i = 0; i < 2; i++)
+		if (result_host[i])
+			g_slice_free1(sizeof(cl_uint) * gws, result_host[i]);
 
 	/* Bye bye. */
 	return status;
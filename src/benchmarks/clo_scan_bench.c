@@ -31,6 +31,10 @@
 #define CLO_SCAN_BENCHMARK_ALGORITHM "blelloch"
 #define CLO_SCAN_BENCHMARK_ALG_OPTS ""
 
+/* Maximum number of scanners (e.g. local memory layouts) compared in
+ * the same benchmark. */
+#define CLO_SCAN_BENCHMARK_MAX_SCANNERS 2
+
 /** A description of the program. */
 #define CLO_SCAN_DESCRIPTION "Test CL_Ops scan implementations"
 
@@ -83,7 +87,7 @@ static GOptionEntry entries[] = {
 	{"alg-opts",     'p', 0, G_OPTION_ARG_STRING, &alg_options,
 		"Algorithm options",                 "STRING"},
 	{"no-check",     'u', 0, G_OPTION_ARG_NONE,   &no_check,
-		"Don't check scan with serial version",
+		"Don't check scan with host version",
 		NULL},
 	{"out",          'o', 0, G_OPTION_ARG_STRING, &out,
 		"File where to output scan benchmarks (default is no file output)",
@@ -111,6 +115,7 @@ int main(int argc, char **argv) {
 	/* Test data structures. */
 	gchar* host_data = NULL;
 	gchar* host_data_scanned = NULL;
+	gchar* host_data_expected = NULL;
 	size_t bytes, bytes_sum;
 	CloType clotype_elem;
 	CloType clotype_sum;
@@ -118,8 +123,13 @@ int main(int argc, char **argv) {
 	gdouble total_time;
 	FILE *outfile = NULL;
 
-	/* Scanner object. */
-	CloScan* scanner = NULL;
+	/* Scanner objects, one per compared configuration. */
+	CloScan* scanners[CLO_SCAN_BENCHMARK_MAX_SCANNERS] = { NULL, NULL };
+	const char* scanner_descs[CLO_SCAN_BENCHMARK_MAX_SCANNERS] =
+		{ "", "" };
+	guint num_scanners = 1;
+	gboolean inclusive;
+	gchar* alg_options_padded = NULL;
 
 	/* cf4ocl wrappers. */
 	CCLQueue* cq_exec = NULL;
@@ -136,8 +146,8 @@ int main(int argc, char **argv) {
 	/* Error management object. */
 	GError *err = NULL;
 
-	/* Scan benchmarks. */
-	gdouble** benchmarks = NULL;
+	/* Scan benchmarks, per scanner, number of elements and run. */
+	gdouble*** benchmarks = NULL;
 
 	/* Parse command line options. */
 	context = g_option_context_new (" - " CLO_SCAN_DESCRIPTION);
@@ -155,6 +165,9 @@ int main(int argc, char **argv) {
 	if (algorithm == NULL) algorithm = g_strdup(CLO_SCAN_BENCHMARK_ALGORITHM);
 	if (alg_options == NULL) alg_options = g_strdup(CLO_SCAN_BENCHMARK_ALG_OPTS);
 
+	/* Check if scan is inclusive, in order to verify it. */
+	inclusive = (strstr(alg_options, "inclusive=1") != NULL);
+
 	/* Determine size in bytes of each element to sort. */
 	bytes = clo_type_sizeof(clotype_elem);
 	bytes_sum = clo_type_sizeof(clotype_sum);
@@ -169,10 +182,26 @@ int main(int argc, char **argv) {
 	g_if_err_goto(err, error_handler);
 
 	/* Get scan object. */
-	scanner = clo_scan_new(algorithm, alg_options, ctx, clotype_elem,
-		clotype_sum, compiler_opts, &err);
+	scanners[0] = clo_scan_new(algorithm, alg_options, ctx, clotype_elem,
+		clotype_sum, NULL, NULL, NULL, compiler_opts, &err);
 	g_if_err_goto(err, error_handler);
 
+	/* If a blelloch scan was requested without specifying a local
+	 * memory layout, benchmark both the unpadded and padded layouts. */
+	if ((g_strcmp0(algorithm, "blelloch") == 0)
+			&& (strstr(alg_options, "padded") == NULL)) {
+		alg_options_padded = (strlen(alg_options) > 0)
+			? g_strconcat(alg_options, ",padded=1", NULL)
+			: g_strdup("padded=1");
+		scanners[1] = clo_scan_new(algorithm, alg_options_padded, ctx,
+			clotype_elem, clotype_sum, NULL, NULL, NULL, compiler_opts,
+			&err);
+		g_if_err_goto(err, error_handler);
+		scanner_descs[0] = " (unpadded)";
+		scanner_descs[1] = " (padded)";
+		num_scanners = 2;
+	}
+
 	/* Create command queues. */
 	cq_exec = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err);
 	g_if_err_goto(err, error_handler);
@@ -191,9 +220,12 @@ int main(int argc, char **argv) {
 	printf("     Compiler Options: %s\n", compiler_opts);
 
 	/* Create benchmarks table. */
-	benchmarks = g_new(gdouble*, num_doub);
-	for (unsigned int i = 0; i < num_doub; i++)
-		benchmarks[i] = g_new0(gdouble, runs);
+	benchmarks = g_new0(gdouble**, num_scanners);
+	for (unsigned int s = 0; s < num_scanners; s++) {
+		benchmarks[s] = g_new0(gdouble*, num_doub);
+		for (unsigned int i = 0; i < num_doub; i++)
+			benchmarks[s][i] = g_new0(gdouble, runs);
+	}
 
 	/* Determine maximum buffer size. */
 	max_buffer_size = bytes * init_elems * (1 << num_doub);
@@ -202,6 +234,7 @@ int main(int argc, char **argv) {
 	/* Create host buffers */
 	host_data = g_new0(gchar, max_buffer_size);
 	host_data_scanned = g_new0(gchar, max_buffer_size_sum);
+	host_data_expected = g_new0(gchar, max_buffer_size_sum);
 
 	/* Start with the inital number of elements. */
 	unsigned int num_elems = init_elems;
@@ -209,74 +242,64 @@ int main(int argc, char **argv) {
 	/* Perform test. */
 	for (unsigned int N = 1; N <= num_doub; N++) {
 
-		const gchar* scan_ok;
+		for (unsigned int s = 0; s < num_scanners; s++) {
 
-		for (unsigned int r = 0; r < runs; r++) {
+			const gchar* scan_ok;
 
-			g_debug("|===== Num. elems: %d (run %d): =====|", num_elems, r);
+			for (unsigned int r = 0; r < runs; r++) {
 
-			/* Initialize host buffer. */
-			for (unsigned int i = 0;  i < num_elems; i++) {
-				/* Get a random 64-bit value by default, but keep it small... */
-				gulong value = (gulong) (g_rand_double(rng_host) * 128);
-				/* But just use the specified bits. */
-				memcpy(host_data + bytes * i, &value, bytes);
-			}
+				g_debug("|===== Num. elems: %d (run %d): =====|", num_elems, r);
 
-			/* Perform scan. */
-			clo_scan_with_host_data(scanner, cq_exec, cq_comm,
-				host_data, host_data_scanned, num_elems, lws, &err);
-			g_if_err_goto(err, error_handler);
-
-			/* Perform profiling. */
-			prof = ccl_prof_new();
-			ccl_prof_add_queue(prof, "q_exec", cq_exec);
-			ccl_prof_calc(prof, &err);
-			g_if_err_goto(err, error_handler);
-
-			/* Save time to benchmarks. */
-			benchmarks[N - 1][r] =  ccl_prof_get_duration(prof);
-			ccl_prof_destroy(prof);
-
-			/* Wait on host thread for data transfer queue to finish... */
-			ccl_queue_finish(cq_comm, &err);
-			g_if_err_goto(err, error_handler);
-
-			/* Check if scan was well performed. */
-			if (no_check) {
-				scan_ok = "[Unverified]";
-			} else {
-				g_debug("== CHECK ==");
-				g_debug("%10s %10s %10s", "Host", "Serial", "Dev");
-				scan_ok = "";
-				gulong value_dev = 0, value_host = 0;
-				for (unsigned int i = 0; i < num_elems; i++) {
-					/* Perform a CPU scan. */
-					value_host = (i == 0) ? 0 : value_host + CLO_SCAN_HOST_GET(host_data, i - 1, bytes);
-					/* Check for overflow. */
-					if (value_host > CLO_SCAN_MAXU(bytes_sum)) {
-						scan_ok = "[Overflow]";
-						break;
-					}
-					/* Get device value. */
-					memcpy(&value_dev, host_data_scanned + bytes_sum * i, bytes_sum);
-					/* Compare. */
-					if (value_dev != value_host) {
-						scan_ok = "[Scan did not work]";
-						break;
-					}
-					g_debug("%10lu %10lu %10lu", CLO_SCAN_HOST_GET(host_data, i, bytes), value_host, value_dev);
+				/* Initialize host buffer. */
+				for (unsigned int i = 0;  i < num_elems; i++) {
+					/* Get a random 64-bit value by default, but keep it small... */
+					gulong value = (gulong) (g_rand_double(rng_host) * 128);
+					/* But just use the specified bits. */
+					memcpy(host_data + bytes * i, &value, bytes);
+				}
 
+				/* Perform scan. */
+				clo_scan_with_host_data(scanners[s], cq_exec, cq_comm,
+					host_data, host_data_scanned, num_elems, lws, &err);
+				g_if_err_goto(err, error_handler);
+
+				/* Perform profiling. */
+				prof = ccl_prof_new();
+				ccl_prof_add_queue(prof, "q_exec", cq_exec);
+				ccl_prof_calc(prof, &err);
+				g_if_err_goto(err, error_handler);
+
+				/* Save time to benchmarks. */
+				benchmarks[s][N - 1][r] =  ccl_prof_get_duration(prof);
+				ccl_prof_destroy(prof);
+
+				/* Wait on host thread for data transfer queue to finish... */
+				ccl_queue_finish(cq_comm, &err);
+				g_if_err_goto(err, error_handler);
+
+				/* Check if scan was well performed, by comparing with
+				 * the host scan. */
+				if (no_check) {
+					scan_ok = "[Unverified]";
+				} else {
+					clo_scan_host_sum(clotype_elem, clotype_sum, host_data,
+						host_data_expected, num_elems, inclusive, &err);
+					g_if_err_goto(err, error_handler);
+					scan_ok = (memcmp(host_data_scanned, host_data_expected,
+							bytes_sum * num_elems) == 0)
+						? "" : "[Scan did not work]";
 				}
 			}
-		}
 
-		/* Print info. */
-		total_time = 0;
-		for (unsigned int i = 0;  i < runs; i++)
-			total_time += benchmarks[N - 1][i];
-		printf("       - %10d : %f MValues/s %s\n", num_elems, (1e-6 * num_elems * runs) / (total_time * 1e-9), scan_ok);
+			/* Print info. */
+			total_time = 0;
+			for (unsigned int i = 0;  i < runs; i++)
+				total_time += benchmarks[s][N - 1][i];
+			printf("       - %10d : %f MValues/s %s%s\n", num_elems, (1e-6 * num_elems * runs) / (total_time * 1e-9), scan_ok, scanner_descs[s]);
+
+		}
 
+		/* Next number of elements. */
 		num_elems *= 2;
 
 	}
@@ -286,8 +309,10 @@ int main(int argc, char **argv) {
 		outfile = fopen(out, "w");
 		for (unsigned int i = 0; i < num_doub; i++) {
 			fprintf(outfile, "%d", i);
-			for (unsigned int j = 0; j < runs; j++) {
-				fprintf(outfile, "\t%lf", benchmarks[i][j]);
+			for (unsigned int s = 0; s < num_scanners; s++) {
+				for (unsigned int j = 0; j < runs; j++) {
+					fprintf(outfile, "\t%lf", benchmarks[s][i][j]);
+				}
 			}
 			fprintf(outfile, "\n");
 		}
@@ -308,8 +333,9 @@ error_handler:
 
 cleanup:
 
-	/* Destroy scanner object. */
-	if (scanner) clo_scan_destroy(scanner);
+	/* Destroy scanner objects. */
+	for (unsigned int s = 0; s < CLO_SCAN_BENCHMARK_MAX_SCANNERS; s++)
+		if (scanners[s]) clo_scan_destroy(scanners[s]);
 
 	/* Release OpenCL wrappers. */
 	if (cq_exec) ccl_queue_destroy(cq_exec);
@@ -319,6 +345,7 @@ cleanup:
 	/* Free host resources */
 	g_free(host_data);
 	g_free(host_data_scanned);
+	g_free(host_data_expected);
 
 	/* Free command line options. */
 	if (context) g_option_context_free(context);
@@ -326,11 +353,16 @@ cleanup:
 	if (out) g_free(out);
 	if (algorithm) g_free(algorithm);
 	if (alg_options) g_free(alg_options);
+	if (alg_options_padded) g_free(alg_options_padded);
 
 	/* Free benchmarks. */
 	if (benchmarks) {
-		for (unsigned int i = 0; i < num_doub; i++)
-			if (benchmarks[i]) g_free(benchmarks[i]);
+		for (unsigned int s = 0; s < num_scanners; s++) {
+			if (!benchmarks[s]) continue;
+			for (unsigned int i = 0; i < num_doub; i++)
+				if (benchmarks[s][i]) g_free(benchmarks[s][i]);
+			g_free(benchmarks[s]);
+		}
 		g_free(benchmarks);
 	}
 
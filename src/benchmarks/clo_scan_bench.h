@@ -25,19 +25,5 @@
 
 #include "clo_bench.h"
 
-#define CLO_SCAN_HOST_GET(host_data, i, bytes) \
-	((unsigned long) \
-	(bytes == 1) ? ((unsigned char*) host_data)[i] : \
-	((bytes == 2) ? ((unsigned short*) host_data)[i] : \
-	((bytes == 4) ? ((unsigned int*) host_data)[i] : \
-	((unsigned long*) host_data)[i])))
-
-#define CLO_SCAN_MAXU(bytes) \
-	((unsigned long) \
-	(bytes == 1) ? 0xFF : \
-	((bytes == 2) ? G_MAXUSHORT : \
-	((bytes == 4) ? G_MAXUINT : \
-	(G_MAXULONG))))
-
 #endif
 
@@ -79,6 +79,50 @@ static GOptionEntry entries[] = {
 	{ NULL, 0, 0, 0, NULL, NULL, NULL }
 };
 
+/**
+ * Check if two arrays of scalar elements have the same keys, i.e. if
+ * the elements compare as equal, which is not the same as having the
+ * same bits: for example, -0.0 and +0.0 are sorted as equal keys, so
+ * they can appear in any order.
+ *
+ * @param[in] type Type of elements.
+ * @param[in] a First array.
+ * @param[in] b Second array.
+ * @param[in] numel Number of elements in each array.
+ * @return `TRUE` if the arrays have the same keys, `FALSE` otherwise.
+ * */
+static gboolean clo_sort_bench_same_keys(CloType type, const void* a,
+	const void* b, size_t numel) {
+
+	for (size_t i = 0; i < numel; ++i) {
+		switch (type) {
+			case CLO_HALF:
+				/* Half values are stored as their bits, which differ
+				 * only in the sign for both zeros. */
+				if ((((const cl_half*) a)[i] != ((const cl_half*) b)[i])
+					&& ((((const cl_half*) a)[i] & 0x7FFF) != 0
+						|| (((const cl_half*) b)[i] & 0x7FFF) != 0))
+					return FALSE;
+				break;
+			case CLO_FLOAT:
+				if (((const cl_float*) a)[i] != ((const cl_float*) b)[i])
+					return FALSE;
+				break;
+			case CLO_DOUBLE:
+				if (((const cl_double*) a)[i]
+					!= ((const cl_double*) b)[i])
+					return FALSE;
+				break;
+			default:
+				if (memcmp((const char*) a + i * clo_type_sizeof(type),
+					(const char*) b + i * clo_type_sizeof(type),
+					clo_type_sizeof(type)) != 0)
+					return FALSE;
+		}
+	}
+	return TRUE;
+}
+
 /**
  * Main program.
  *
@@ -99,6 +143,7 @@ int main(int argc, char **argv)
 
 	/* Test data structures. */
 	cl_uchar* host_data = NULL;
+	cl_uchar* host_expected = NULL;
 	size_t bytes;
 	cl_ulong total_time;
 	FILE *outfile = NULL;
@@ -175,8 +220,9 @@ int main(int argc, char **argv)
 	printf("     Number of runs: %d\n", runs);
 	printf("     Compiler Options: %s\n", compiler_opts);
 
-	/* Create host buffer. */
+	/* Create host buffers. */
 	host_data = g_slice_alloc(bytes * (1 << maxpo2));
+	host_expected = g_slice_alloc(bytes * (1 << maxpo2));
 
 	/* Perform test. */
 	for (unsigned int N = 4; N <= maxpo2; N++) {
@@ -191,6 +237,7 @@ int main(int argc, char **argv)
 				clo_bench_rand(
 					rng_host, clotype_elem, host_data + bytes * i);
 			}
+			memcpy(host_expected, host_data, bytes * num_elems);
 
 			/* Perform sort. */
 			clo_sort_with_host_data(sorter, cq_exec, cq_comm,
@@ -207,23 +254,17 @@ int main(int argc, char **argv)
 			benchmarks[N - 1][r] = ccl_prof_get_duration(prof);
 			ccl_prof_destroy(prof);
 
-			/* Check if sorting was well performed. */
-			sorted_ok = TRUE;
 			/* Wait on host thread for data transfer queue to finish... */
 			ccl_queue_finish(cq_comm, &err);
 			g_if_err_goto(err, error_handler);
-			/* Start check. */
-			for (unsigned int i = 0;  i < num_elems - 1; i++) {
-
-				/* Perform comparison. */
-				if (clo_bench_compare(clotype_elem, host_data + bytes*i,
-						host_data + bytes*(i + 1)) > 0) {
-
-					sorted_ok = FALSE;
-					break;
-				}
 
-			}
+			/* Check if sorting was well performed, by comparing keys
+			 * with the host sort. */
+			clo_sort_host_radix(
+				clotype_elem, host_expected, num_elems, &err);
+			g_if_err_goto(err, error_handler);
+			sorted_ok = sorted_ok && clo_sort_bench_same_keys(
+				clotype_elem, host_data, host_expected, num_elems);
 		}
 
 		/* Print info. */
@@ -281,6 +322,8 @@ cleanup:
 
 	/* Free host resources */
 	if (host_data) g_slice_free1(bytes * (1 << maxpo2), host_data);
+	if (host_expected)
+		g_slice_free1(bytes * (1 << maxpo2), host_expected);
 
 	/* Free benchmarks. */
 	if (benchmarks) {
@@ -32,6 +32,7 @@ extern "C" {
 
 /* Common header. */
 #include <cl_ops/clo_common.h>
+#include <cl_ops/clo_batch.h>
 
 /* RNG header. */
 #include <cl_ops/clo_rng.h>
@@ -42,10 +43,20 @@ extern "C" {
 #include <cl_ops/clo_sort_sbitonic.h>
 #include <cl_ops/clo_sort_gselect.h>
 #include <cl_ops/clo_sort_satradix.h>
+#include <cl_ops/clo_sort_samplesort.h>
+#include <cl_ops/clo_sort_host.h>
 
 /* Scan headers. */
 #include <cl_ops/clo_scan_abstract.h>
 #include <cl_ops/clo_scan_blelloch.h>
+#include <cl_ops/clo_scan_rblock.h>
+#include <cl_ops/clo_scan_host.h>
+
+/* Histogram header. */
+#include <cl_ops/clo_histogram.h>
+
+/* Group-by header. */
+#include <cl_ops/clo_group_by.h>
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,502 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Recorded command batches implementation.
+ *
+ * @author Nuno Fachada
+ */
+
+#include "cl_ops/clo_batch.h"
+#include "common/_g_err_macros.h"
+
+/**
+ * @internal
+ * Type of recorded command.
+ * */
+typedef enum {
+	/** Set kernel argument. */
+	CLO_BATCH_CMD_ARG,
+	/** Execute kernel. */
+	CLO_BATCH_CMD_NDRANGE,
+	/** Copy buffer. */
+	CLO_BATCH_CMD_COPY
+} clo_batch_cmd_type;
+
+/**
+ * @internal
+ * A recorded command.
+ * */
+typedef struct {
+
+	/** Command type. */
+	clo_batch_cmd_type type;
+
+	/** Kernel (argument and kernel execution commands). */
+	CCLKernel* krnl;
+
+	/** Queue (kernel execution and copy commands). */
+	CCLQueue* cq;
+
+	/** Buffer argument or source buffer of copy, kept referenced. */
+	CCLBuffer* src;
+
+	/** Destination buffer of copy, kept referenced. */
+	CCLBuffer* dst;
+
+	/** Argument index or number of work dimensions. */
+	cl_uint idx;
+
+	/** Argument size or number of bytes to copy. */
+	size_t size;
+
+	/** Argument value (NULL for local memory arguments). */
+	void* value;
+
+	/** Global worksize or source/destination offsets of copy. */
+	size_t gws[3];
+
+	/** Local worksize. */
+	size_t lws[3];
+
+	/** Was a local worksize given? */
+	gboolean has_lws;
+
+	/** Command name, used for profiling events. */
+	const char* name;
+
+	/** Does a following command depend on the event of this one? */
+	gboolean signal;
+
+	/** Does this command wait on the previous command event? */
+	gboolean wait;
+
+} clo_batch_cmd;
+
+/**
+ * @addtogroup CLO_BATCH
+ * @{
+ */
+
+/**
+ * Command batch class.
+ * */
+struct clo_batch {
+
+	/** @private Recorded commands. */
+	GArray* cmds;
+
+	/** @private Create (and name) events on replay? */
+	cl_bool prof;
+
+	/** @private Index of last recorded enqueue command, or -1. */
+	gint last_enqueue;
+
+};
+
+/**
+ * @internal
+ * Record a new command in the batch and return it.
+ * */
+static clo_batch_cmd* clo_batch_add(CloBatch* batch,
+	clo_batch_cmd_type type) {
+
+	clo_batch_cmd cmd = { .type = type };
+
+	g_array_append_val(batch->cmds, cmd);
+	return &g_array_index(batch->cmds, clo_batch_cmd,
+		batch->cmds->len - 1);
+}
+
+/**
+ * @internal
+ * Record a new enqueue command in the batch, keeping track of
+ * dependencies between commands in different queues, and return it.
+ * */
+static clo_batch_cmd* clo_batch_add_enqueue(CloBatch* batch,
+	clo_batch_cmd_type type, CCLQueue* cq) {
+
+	clo_batch_cmd* cmd = clo_batch_add(batch, type);
+	clo_batch_cmd* prev;
+
+	/* If previous enqueue command was in a different queue, this
+	 * command must wait for it. */
+	if (batch->last_enqueue >= 0) {
+		prev = &g_array_index(batch->cmds, clo_batch_cmd,
+			batch->last_enqueue);
+		if (prev->cq != cq) {
+			prev->signal = TRUE;
+			cmd->wait = TRUE;
+		}
+	}
+
+	ccl_queue_ref(cq);
+	cmd->cq = cq;
+	batch->last_enqueue = (gint) batch->cmds->len - 1;
+
+	return cmd;
+}
+
+/**
+ * Create a new command batch.
+ *
+ * @public @memberof clo_batch
+ *
+ * @param[in] prof If `CL_TRUE`, events will be created and named when
+ * the batch is replayed, so that it can be profiled; otherwise no
+ * events are created for commands which don't have dependencies in
+ * other queues.
+ * @return A new command batch.
+ * */
+CloBatch* clo_batch_new(cl_bool prof) {
+
+	CloBatch* batch = g_slice_new0(CloBatch);
+
+	batch->cmds = g_array_new(FALSE, FALSE, sizeof(clo_batch_cmd));
+	batch->prof = prof;
+	batch->last_enqueue = -1;
+
+	return batch;
+}
+
+/**
+ * Destroy a command batch.
+ *
+ * @public @memberof clo_batch
+ *
+ * @param[in] batch Command batch to destroy. If `NULL`, this function
+ * does nothing.
+ * */
+void clo_batch_destroy(CloBatch* batch) {
+
+	if (batch == NULL) return;
+
+	/* Release recorded commands. */
+	for (guint i = 0; i < batch->cmds->len; ++i) {
+		clo_batch_cmd* cmd =
+			&g_array_index(batch->cmds, clo_batch_cmd, i);
+		if (cmd->krnl) ccl_kernel_destroy(cmd->krnl);
+		if (cmd->cq) ccl_queue_destroy(cmd->cq);
+		if (cmd->src) ccl_buffer_destroy(cmd->src);
+		if (cmd->dst) ccl_buffer_destroy(cmd->dst);
+		g_free(cmd->value);
+	}
+	g_array_free(batch->cmds, TRUE);
+
+	g_slice_free(CloBatch, batch);
+}
+
+/**
+ * Set a kernel argument, recording it in the batch if the batch is not
+ * `NULL`.
+ *
+ * @public @memberof clo_batch
+ *
+ * @param[in] batch Command batch or `NULL`.
+ * @param[in] krnl Kernel wrapper.
+ * @param[in] idx Argument index.
+ * @param[in] size Argument size in bytes.
+ * @param[in] value Argument value, or `NULL` if this is a local memory
+ * argument.
+ * */
+void clo_batch_set_arg(CloBatch* batch, CCLKernel* krnl, cl_uint idx,
+	size_t size, void* value) {
+
+	ccl_kernel_set_arg(krnl, idx, ccl_arg_full(value, size));
+
+	if (batch != NULL) {
+		clo_batch_cmd* cmd = clo_batch_add(batch, CLO_BATCH_CMD_ARG);
+		ccl_kernel_ref(krnl);
+		cmd->krnl = krnl;
+		cmd->idx = idx;
+		cmd->size = size;
+		cmd->value = (value != NULL) ? g_memdup(value, size) : NULL;
+	}
+}
+
+/**
+ * Set a buffer kernel argument, recording it in the batch if the batch
+ * is not `NULL`. The batch keeps a reference to the buffer.
+ *
+ * @public @memberof clo_batch
+ *
+ * @param[in] batch Command batch or `NULL`.
+ * @param[in] krnl Kernel wrapper.
+ * @param[in] idx Argument index.
+ * @param[in] buf Buffer wrapper.
+ * */
+void clo_batch_set_buffer(CloBatch* batch, CCLKernel* krnl,
+	cl_uint idx, CCLBuffer* buf) {
+
+	ccl_kernel_set_arg(krnl, idx, buf);
+
+	if (batch != NULL) {
+		cl_mem mem = ccl_memobj_unwrap(buf);
+		clo_batch_cmd* cmd = clo_batch_add(batch, CLO_BATCH_CMD_ARG);
+		ccl_kernel_ref(krnl);
+		ccl_buffer_ref(buf);
+		cmd->krnl = krnl;
+		cmd->src = buf;
+		cmd->idx = idx;
+		cmd->size = sizeof(cl_mem);
+		cmd->value = g_memdup(&mem, sizeof(cl_mem));
+	}
+}
+
+/**
+ * Enqueue a kernel execution, recording it in the batch if the batch is
+ * not `NULL`.
+ *
+ * @public @memberof clo_batch
+ *
+ * @param[in] batch Command batch or `NULL`.
+ * @param[in] krnl Kernel wrapper.
+ * @param[in] cq Command queue wrapper.
+ * @param[in] work_dim Number of work dimensions (up to 3).
+ * @param[in] gws Global worksize.
+ * @param[in] lws Local worksize (can be `NULL`).
+ * @param[in,out] ewl Event wait list (only used now, it is not recorded
+ * in the batch).
+ * @param[in] name Event name, must be a static string.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper associated with the kernel execution or `NULL`
+ * if an error occurs.
+ * */
+CCLEvent* clo_batch_enqueue_ndrange(CloBatch* batch, CCLKernel* krnl,
+	CCLQueue* cq, cl_uint work_dim, const size_t* gws, const size_t* lws,
+	CCLEventWaitList* ewl, const char* name, GError** err) {
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Make sure work dimensions are within limits. */
+	g_return_val_if_fail(work_dim >= 1 && work_dim <= 3, NULL);
+
+	CCLEvent* evt;
+
+	evt = ccl_kernel_enqueue_ndrange(
+		krnl, cq, work_dim, NULL, gws, lws, ewl, err);
+	if (evt == NULL) return NULL;
+	ccl_event_set_name(evt, name);
+
+	if (batch != NULL) {
+		clo_batch_cmd* cmd = clo_batch_add_enqueue(
+			batch, CLO_BATCH_CMD_NDRANGE, cq);
+		ccl_kernel_ref(krnl);
+		cmd->krnl = krnl;
+		cmd->idx = work_dim;
+		for (cl_uint i = 0; i < work_dim; ++i) {
+			cmd->gws[i] = gws[i];
+			cmd->lws[i] = (lws != NULL) ? lws[i] : 0;
+		}
+		cmd->has_lws = (lws != NULL);
+		cmd->name = name;
+	}
+
+	return evt;
+}
+
+/**
+ * Enqueue a buffer copy, recording it in the batch if the batch is not
+ * `NULL`. The batch keeps references to both buffers.
+ *
+ * @public @memberof clo_batch
+ *
+ * @param[in] batch Command batch or `NULL`.
+ * @param[in] src Source buffer wrapper.
+ * @param[in] dst Destination buffer wrapper.
+ * @param[in] cq Command queue wrapper.
+ * @param[in] src_offset Offset in source buffer.
+ * @param[in] dst_offset Offset in destination buffer.
+ * @param[in] size Number of bytes to copy.
+ * @param[in,out] ewl Event wait list (only used now, it is not recorded
+ * in the batch).
+ * @param[in] name Event name, must be a static string.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper associated with the copy or `NULL` if an error
+ * occurs.
+ * */
+CCLEvent* clo_batch_enqueue_copy(CloBatch* batch, CCLBuffer* src,
+	CCLBuffer* dst, CCLQueue* cq, size_t src_offset, size_t dst_offset,
+	size_t size, CCLEventWaitList* ewl, const char* name, GError** err) {
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	CCLEvent* evt;
+
+	evt = ccl_buffer_enqueue_copy(
+		src, dst, cq, src_offset, dst_offset, size, ewl, err);
+	if (evt == NULL) return NULL;
+	ccl_event_set_name(evt, name);
+
+	if (batch != NULL) {
+		clo_batch_cmd* cmd = clo_batch_add_enqueue(
+			batch, CLO_BATCH_CMD_COPY, cq);
+		ccl_buffer_ref(src);
+		ccl_buffer_ref(dst);
+		cmd->src = src;
+		cmd->dst = dst;
+		cmd->gws[0] = src_offset;
+		cmd->gws[1] = dst_offset;
+		cmd->size = size;
+		cmd->name = name;
+	}
+
+	return evt;
+}
+
+/**
+ * Replay the commands recorded in a batch. Commands are issued
+ * directly to OpenCL, without going through the _cf4ocl_ argument and
+ * event handling machinery. Events are only created for commands on
+ * which commands in other queues depend, or for all commands if the
+ * batch was created with profiling enabled; in the latter case the
+ * events are associated with the respective queue wrappers and named,
+ * so they can be profiled with _cf4ocl_'s profiler.
+ *
+ * @public @memberof clo_batch
+ *
+ * @param[in] batch Command batch to replay.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if batch was successfully replayed, `CL_FALSE`
+ * otherwise.
+ * */
+cl_bool clo_batch_replay(CloBatch* batch, GError** err) {
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+	/* Make sure batch is not NULL. */
+	g_return_val_if_fail(batch != NULL, CL_FALSE);
+
+	/* Function return status. */
+	cl_bool status;
+
+	/* OpenCL status. */
+	cl_int ocl_status = CL_SUCCESS;
+
+	/* Event of previous command, if one was required. */
+	cl_event prev_evt = NULL;
+
+	for (guint i = 0; i < batch->cmds->len; ++i) {
+
+		clo_batch_cmd* cmd =
+			&g_array_index(batch->cmds, clo_batch_cmd, i);
+
+		/* Event for current command, if required. */
+		cl_event evt = NULL;
+		gboolean need_evt = batch->prof || cmd->signal;
+
+		/* Wait on previous command if required. */
+		cl_uint num_wait = (cmd->wait && prev_evt != NULL) ? 1 : 0;
+
+		switch (cmd->type) {
+
+			case CLO_BATCH_CMD_ARG:
+				ocl_status = clSetKernelArg(ccl_kernel_unwrap(cmd->krnl),
+					cmd->idx, cmd->size, cmd->value);
+				g_if_err_create_goto(*err, CLO_ERROR,
+					ocl_status != CL_SUCCESS, CLO_ERROR_LIBRARY,
+					error_handler,
+					"Unable to set kernel argument %d in batch (%s).",
+					cmd->idx, ccl_err(ocl_status));
+				continue;
+
+			case CLO_BATCH_CMD_NDRANGE:
+				ocl_status = clEnqueueNDRangeKernel(
+					ccl_queue_unwrap(cmd->cq),
+					ccl_kernel_unwrap(cmd->krnl), cmd->idx, NULL,
+					cmd->gws, cmd->has_lws ? cmd->lws : NULL,
+					num_wait, num_wait ? &prev_evt : NULL,
+					need_evt ? &evt : NULL);
+				break;
+
+			case CLO_BATCH_CMD_COPY:
+				ocl_status = clEnqueueCopyBuffer(
+					ccl_queue_unwrap(cmd->cq),
+					ccl_memobj_unwrap(cmd->src),
+					ccl_memobj_unwrap(cmd->dst),
+					cmd->gws[0], cmd->gws[1], cmd->size,
+					num_wait, num_wait ? &prev_evt : NULL,
+					need_evt ? &evt : NULL);
+				break;
+
+			default:
+				g_assert_not_reached();
+		}
+
+		g_if_err_create_goto(*err, CLO_ERROR,
+			ocl_status != CL_SUCCESS, CLO_ERROR_LIBRARY,
+			error_handler, "Unable to enqueue '%s' in batch (%s).",
+			cmd->name, ccl_err(ocl_status));
+
+		/* Release event of previous command, unless it belongs to a
+		 * queue wrapper. */
+		if ((prev_evt != NULL) && (!batch->prof))
+			clReleaseEvent(prev_evt);
+		prev_evt = evt;
+
+		/* If profiling, hand event over to the queue wrapper. */
+		if (batch->prof)
+			ccl_event_set_name(
+				ccl_queue_produce_event(cmd->cq, evt), cmd->name);
+
+	}
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	status = CL_TRUE;
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	status = CL_FALSE;
+
+finish:
+
+	/* Release last event, unless it belongs to a queue wrapper. */
+	if ((prev_evt != NULL) && (!batch->prof)) clReleaseEvent(prev_evt);
+
+	/* Return status. */
+	return status;
+}
+
+/**
+ * Get the number of commands (argument settings, kernel executions
+ * and buffer copies) recorded in a batch.
+ *
+ * @public @memberof clo_batch
+ *
+ * @param[in] batch Command batch.
+ * @return Number of recorded commands.
+ * */
+cl_uint clo_batch_get_num_commands(CloBatch* batch) {
+
+	/* Make sure batch is not NULL. */
+	g_return_val_if_fail(batch != NULL, 0);
+
+	return batch->cmds->len;
+}
+
+/** @} */
@@ -0,0 +1,109 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Recorded command batches, which capture a sequence of kernel
+ * argument settings, kernel executions and buffer copies so that it
+ * can later be replayed with minimal host overhead.
+ *
+ * @author Nuno Fachada
+ */
+
+#ifndef _CLO_BATCH_H_
+#define _CLO_BATCH_H_
+
+#include "cl_ops/clo_common.h"
+
+/**
+ * @defgroup CLO_BATCH Command batches
+ *
+ * Record-and-replay of OpenCL command sequences. Algorithm
+ * implementations use the `clo_batch_set_*()` and
+ * `clo_batch_enqueue_*()` functions instead of the respective
+ * _cf4ocl_ functions; if a batch is given, the commands are also
+ * recorded in it. When the batch is replayed, the recorded commands
+ * are issued directly to OpenCL, and events are only created if
+ * profiling was requested when the batch was created.
+ *
+ * @{
+ */
+
+/**
+ * Set a private kernel argument and record it in the batch (if not
+ * `NULL`).
+ *
+ * @param[in] batch Batch object or `NULL`.
+ * @param[in] krnl Kernel wrapper.
+ * @param[in] idx Argument index.
+ * @param[in] value Argument value (must be an lvalue).
+ * @param[in] type Argument type.
+ * */
+#define clo_batch_set_arg_priv(batch, krnl, idx, value, type) \
+	clo_batch_set_arg((batch), (krnl), (idx), sizeof(type), &(value))
+
+/**
+ * Set a local memory kernel argument and record it in the batch (if not
+ * `NULL`).
+ *
+ * @param[in] batch Batch object or `NULL`.
+ * @param[in] krnl Kernel wrapper.
+ * @param[in] idx Argument index.
+ * @param[in] count Number of elements of the given type.
+ * @param[in] type Type of the elements.
+ * */
+#define clo_batch_set_arg_local(batch, krnl, idx, count, type) \
+	clo_batch_set_arg((batch), (krnl), (idx), (count) * sizeof(type), NULL)
+
+/** @} */
+
+/* Create a new command batch. */
+CloBatch* clo_batch_new(cl_bool prof);
+
+/* Destroy a command batch. */
+void clo_batch_destroy(CloBatch* batch);
+
+/* Set a kernel argument, recording it in the batch if the batch is not
+ * NULL. */
+void clo_batch_set_arg(CloBatch* batch, CCLKernel* krnl, cl_uint idx,
+	size_t size, void* value);
+
+/* Set a buffer kernel argument, recording it in the batch if the batch
+ * is not NULL. */
+void clo_batch_set_buffer(CloBatch* batch, CCLKernel* krnl,
+	cl_uint idx, CCLBuffer* buf);
+
+/* Enqueue a kernel execution, recording it in the batch if the batch is
+ * not NULL. */
+CCLEvent* clo_batch_enqueue_ndrange(CloBatch* batch, CCLKernel* krnl,
+	CCLQueue* cq, cl_uint work_dim, const size_t* gws, const size_t* lws,
+	CCLEventWaitList* ewl, const char* name, GError** err);
+
+/* Enqueue a buffer copy, recording it in the batch if the batch is not
+ * NULL. */
+CCLEvent* clo_batch_enqueue_copy(CloBatch* batch, CCLBuffer* src,
+	CCLBuffer* dst, CCLQueue* cq, size_t src_offset, size_t dst_offset,
+	size_t size, CCLEventWaitList* ewl, const char* name, GError** err);
+
+/* Replay the commands recorded in a batch. */
+cl_bool clo_batch_replay(CloBatch* batch, GError** err);
+
+/* Get the number of commands recorded in a batch. */
+cl_uint clo_batch_get_num_commands(CloBatch* batch);
+
+#endif
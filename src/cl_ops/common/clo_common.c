@@ -23,9 +23,16 @@
  */
 
 #include "cl_ops/clo_common.h"
+#include "common/_g_err_macros.h"
 
-/* Check if given type is a known type. */
-#define CLO_IS_TYPE(type) (type >= CLO_CHAR) && (type <= CLO_DOUBLE)
+/* Check if given type is a known built-in type. */
+#define CLO_IS_BUILTIN_TYPE(type) \
+	(((type) >= CLO_CHAR) && ((type) <= CLO_DOUBLE2))
+
+/* Check if given type is a registered record type. */
+#define CLO_IS_RECORD_TYPE(type) \
+	(((type) >= CLO_RECORD) && (clo_records != NULL) \
+	&& ((guint) ((type) - CLO_RECORD) < clo_records->len))
 
 /**
  * @addtogroup CLO_TYPES
@@ -47,26 +54,96 @@ struct clo_type_info {
 	 * Type size in bytes.
 	 * @private
 	 * */
-	const size_t size;
+	size_t size;
+
+	/**
+	 * Type alignment in bytes.
+	 * @private
+	 * */
+	size_t align;
+
+	/**
+	 * OpenCL definition of the type (`NULL` for built-in types).
+	 * @private
+	 * */
+	char* def;
 };
 
-/* Relation between OpenCL type names and sizes in bytes. */
+/* Relation between OpenCL type names, sizes and alignments in bytes. */
 static const CloTypeInfo clo_types[] = {
 
-	{"char",   1}, /* CCL_CHAR   = 0 */
-	{"uchar",  1}, /* CCL_UCHAR  = 1 */
-	{"short",  2}, /* CCL_SHORT  = 2 */
-	{"ushort", 2}, /* CCL_USHORT = 3 */
-	{"int",    4}, /* CCL_INT    = 4 */
-	{"uint",   4}, /* CCL_UINT   = 5 */
-	{"long",   8}, /* CCL_LONG   = 6 */
-	{"ulong",  8}, /* CCL_ULONG  = 7 */
-	{"half",   2}, /* CCL_HALF   = 8 */
-	{"float",  4}, /* CCL_FLOAT  = 9 */
-	{"double", 8}, /* CCL_DOUBLE = 10 */
-	{NULL,     0}
+	{"char",     1,  1, NULL}, /* CLO_CHAR    = 0  */
+	{"uchar",    1,  1, NULL}, /* CLO_UCHAR   = 1  */
+	{"short",    2,  2, NULL}, /* CLO_SHORT   = 2  */
+	{"ushort",   2,  2, NULL}, /* CLO_USHORT  = 3  */
+	{"int",      4,  4, NULL}, /* CLO_INT     = 4  */
+	{"uint",     4,  4, NULL}, /* CLO_UINT    = 5  */
+	{"long",     8,  8, NULL}, /* CLO_LONG    = 6  */
+	{"ulong",    8,  8, NULL}, /* CLO_ULONG   = 7  */
+	{"half",     2,  2, NULL}, /* CLO_HALF    = 8  */
+	{"float",    4,  4, NULL}, /* CLO_FLOAT   = 9  */
+	{"double",   8,  8, NULL}, /* CLO_DOUBLE  = 10 */
+	{"int2",     8,  8, NULL}, /* CLO_INT2    = 11 */
+	{"int4",    16, 16, NULL}, /* CLO_INT4    = 12 */
+	{"uint2",    8,  8, NULL}, /* CLO_UINT2   = 13 */
+	{"uint4",   16, 16, NULL}, /* CLO_UINT4   = 14 */
+	{"long2",   16, 16, NULL}, /* CLO_LONG2   = 15 */
+	{"ulong2",  16, 16, NULL}, /* CLO_ULONG2  = 16 */
+	{"float2",   8,  8, NULL}, /* CLO_FLOAT2  = 17 */
+	{"float4",  16, 16, NULL}, /* CLO_FLOAT4  = 18 */
+	{"double2", 16, 16, NULL}, /* CLO_DOUBLE2 = 19 */
+	{NULL,       0,  0, NULL}
 };
 
+/* Registered record types, in registration order. */
+static GPtrArray* clo_records = NULL;
+
+/* Lock protecting the registered record types. */
+G_LOCK_DEFINE_STATIC(clo_records);
+
+/* Get information about a known type (built-in or record). */
+static const CloTypeInfo* clo_type_get_info(CloType type) {
+
+	/* Type information. */
+	const CloTypeInfo* info = NULL;
+
+	if (CLO_IS_BUILTIN_TYPE(type)) {
+		info = &clo_types[type];
+	} else {
+		G_LOCK(clo_records);
+		if (CLO_IS_RECORD_TYPE(type))
+			info = g_ptr_array_index(clo_records, type - CLO_RECORD);
+		G_UNLOCK(clo_records);
+	}
+
+	return info;
+}
+
+/* Find a type constant given a type name, or return -1 if the type is
+ * not known. Must be called while holding the record types lock. */
+static CloType clo_type_find(const char* name) {
+
+	/* Cycle through known built-in types. */
+	for (guint i = 0; clo_types[i].name != NULL; ++i)
+		/* Check if current type name is the same as given name. */
+		if (g_strcmp0(name, clo_types[i].name) == 0)
+			/* If so, return respective type constant. */
+			return i;
+
+	/* Cycle through registered record types. */
+	for (guint i = 0; (clo_records != NULL) && (i < clo_records->len);
+		++i) {
+		/* Check if current record name is the same as given name. */
+		CloTypeInfo* info = g_ptr_array_index(clo_records, i);
+		if (g_strcmp0(name, info->name) == 0)
+			/* If so, return respective type constant. */
+			return CLO_RECORD + i;
+	}
+
+	/* Type not found. */
+	return -1;
+}
+
 /**
  * Return OpenCL type name.
  *
@@ -75,11 +152,14 @@ static const CloTypeInfo clo_types[] = {
  * */
 const char* clo_type_get_name(CloType type) {
 
+	/* Get type information. */
+	const CloTypeInfo* info = clo_type_get_info(type);
+
 	/* Check if type is valid. */
-	g_return_val_if_fail(CLO_IS_TYPE(type), NULL);
+	g_return_val_if_fail(info != NULL, NULL);
 
 	/* Return type name. */
-	return clo_types[type].name;
+	return info->name;
 }
 
 /**
@@ -90,11 +170,166 @@ const char* clo_type_get_name(CloType type) {
  * */
 size_t clo_type_sizeof(CloType type) {
 
+	/* Get type information. */
+	const CloTypeInfo* info = clo_type_get_info(type);
+
 	/* Check if type is valid. */
-	g_return_val_if_fail(CLO_IS_TYPE(type), 0);
+	g_return_val_if_fail(info != NULL, 0);
 
 	/* Return type size in bytes. */
-	return clo_types[type].size;
+	return info->size;
+}
+
+/**
+ * Return OpenCL type alignment in bytes.
+ *
+ * @param[in] type Type constant.
+ * @return The alignment of the OpenCL type in bytes.
+ * */
+size_t clo_type_alignof(CloType type) {
+
+	/* Get type information. */
+	const CloTypeInfo* info = clo_type_get_info(type);
+
+	/* Check if type is valid. */
+	g_return_val_if_fail(info != NULL, 0);
+
+	/* Return type alignment in bytes. */
+	return info->align;
+}
+
+/**
+ * Return the OpenCL source code which defines the given type. Programs
+ * which use record types must include this definition before using
+ * the type.
+ *
+ * @param[in] type Type constant.
+ * @return The OpenCL definition of the type, or `NULL` if the type is
+ * a built-in OpenCL type and thus requires no definition.
+ * */
+const char* clo_type_get_def(CloType type) {
+
+	/* Get type information. */
+	const CloTypeInfo* info = clo_type_get_info(type);
+
+	/* Check if type is valid. */
+	g_return_val_if_fail(info != NULL, NULL);
+
+	/* Return type definition. */
+	return info->def;
+}
+
+/**
+ * Register a user-defined record (struct) type. The type is defined in
+ * OpenCL as a struct with the given members and alignment, so that
+ * records can be moved by kernels with wide (vector) loads and stores.
+ * Registered record types are valid until the program terminates.
+ * Registering a record with the name, members, size and alignment of
+ * an existing record returns the existing type constant.
+ *
+ * For example, a 32-byte particle record with a 16-byte alignment:
+ *
+ * @code{.c}
+ * CloType particle = clo_type_new_record("particle",
+ *     "float4 pos; float2 vel; uint id; uint flags;", 32, 16, &err);
+ * @endcode
+ *
+ * @param[in] name Name of the record type, which must be a valid
+ * OpenCL identifier.
+ * @param[in] members OpenCL declaration of the struct members.
+ * @param[in] size Size of the record in bytes, which must be the same
+ * in host and device.
+ * @param[in] align Alignment of the record in bytes, a power of 2 which
+ * divides `size`.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A type constant for the new record type or -1 if an error
+ * occurs.
+ * */
+CloType clo_type_new_record(const char* name, const char* members,
+	size_t size, size_t align, GError** err) {
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, -1);
+	/* Make sure name and members are not NULL. */
+	g_return_val_if_fail(name != NULL, -1);
+	g_return_val_if_fail(members != NULL, -1);
+
+	/* Type constant to return. */
+	CloType type = -1;
+	/* Type definition. */
+	char* def = NULL;
+	/* Information about new record type. */
+	CloTypeInfo* info;
+
+	/* Check record size and alignment. */
+	g_if_err_create_goto(*err, CLO_ERROR,
+		(size == 0) || (align == 0) || (!CLO_IS_PO2(align))
+			|| (size % align != 0),
+		CLO_ERROR_ARGS, error_handler,
+		"Invalid size (%u) or alignment (%u) for record type '%s'.",
+		(unsigned int) size, (unsigned int) align, name);
+
+	/* Build OpenCL type definition. */
+	def = g_strdup_printf(
+		"typedef struct __attribute__ ((aligned (%u))) { %s } %s;\n",
+		(unsigned int) align, members, name);
+
+	G_LOCK(clo_records);
+
+	if (clo_records == NULL) clo_records = g_ptr_array_new();
+
+	/* Check if a type with the same name already exists. */
+	type = clo_type_find(name);
+
+	if ((int) type < 0) {
+
+		/* Name not taken, register new record. */
+		info = g_slice_new(CloTypeInfo);
+		info->name = g_strdup(name);
+		info->size = size;
+		info->align = align;
+		info->def = def;
+		def = NULL;
+		type = CLO_RECORD + clo_records->len;
+		g_ptr_array_add(clo_records, info);
+
+	} else if (CLO_IS_RECORD_TYPE(type)) {
+
+		/* Name taken by a record, which must be the same record. */
+		info = g_ptr_array_index(clo_records, type - CLO_RECORD);
+		if ((info->size != size) || (info->align != align)
+				|| (g_strcmp0(def, info->def) != 0))
+			type = -1;
+
+	} else {
+
+		/* Name taken by a built-in type. */
+		type = -1;
+	}
+
+	G_UNLOCK(clo_records);
+
+	g_if_err_create_goto(*err, CLO_ERROR, (int) type < 0,
+		CLO_ERROR_ARGS, error_handler,
+		"A different type named '%s' already exists.", name);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	type = -1;
+
+finish:
+
+	/* Free stuff. */
+	g_free(def);
+
+	/* Return type constant. */
+	return type;
 }
 
 /**
@@ -107,12 +342,16 @@ size_t clo_type_sizeof(CloType type) {
  * */
 CloType clo_type_by_name(const char* name, GError** err) {
 
-	/* Cycle through known types. */
-	for (guint i = 0; clo_types[i].name != NULL; ++i)
-		/* Check if current type name is the same as given name. */
-		if (g_strcmp0(name, clo_types[i].name) == 0)
-			/* If so, return respective type constant. */
-			return i;
+	/* Type constant to return. */
+	CloType type;
+
+	/* Search known types. */
+	G_LOCK(clo_records);
+	type = clo_type_find(name);
+	G_UNLOCK(clo_records);
+
+	/* Return type constant if type was found. */
+	if ((int) type >= 0) return type;
 
 	/* If we get here, it means that the type is unknown, and an error
 	 * should be thrown. */
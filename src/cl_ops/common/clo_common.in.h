@@ -103,7 +103,10 @@ enum clo_error_codes {
  */
 
 /**
- * Enumeration of OpenCL types.
+ * Enumeration of OpenCL types. Besides the scalar and vector OpenCL
+ * types listed here, user-defined record types can be registered with
+ * clo_type_new_record(), which returns type constants starting at
+ * ::CLO_RECORD.
  * */
 typedef enum {
 	CLO_CHAR = 0,
@@ -116,9 +119,29 @@ typedef enum {
 	CLO_ULONG = 7,
 	CLO_HALF = 8,
 	CLO_FLOAT = 9,
-	CLO_DOUBLE = 10
+	CLO_DOUBLE = 10,
+	CLO_INT2 = 11,
+	CLO_INT4 = 12,
+	CLO_UINT2 = 13,
+	CLO_UINT4 = 14,
+	CLO_LONG2 = 15,
+	CLO_ULONG2 = 16,
+	CLO_FLOAT2 = 17,
+	CLO_FLOAT4 = 18,
+	CLO_DOUBLE2 = 19,
+	/** First type constant of user-defined record types. */
+	CLO_RECORD = 32
 } CloType;
 
+/**
+ * Yields true if `type` is a scalar type, i.e. neither a vector nor a
+ * record type.
+ *
+ * @param[in] type Type constant.
+ * */
+#define CLO_TYPE_IS_SCALAR(type) \
+	(((type) >= CLO_CHAR) && ((type) <= CLO_DOUBLE))
+
 /**
  * Information about an OpenCL type.
  * */
@@ -135,12 +158,31 @@ typedef struct clo_scan CloScan;
 /* RNG class. */
 typedef struct clo_rng CloRng;
 
+/* Histogram class. */
+typedef struct clo_histogram CloHistogram;
+
+/* Group-by class. */
+typedef struct clo_group_by CloGroupBy;
+
+/* Command batch class. */
+typedef struct clo_batch CloBatch;
+
 /* Return OpenCL type name. */
 const char* clo_type_get_name(CloType type);
 
 /* Return OpenCL type size in bytes. */
 size_t clo_type_sizeof(CloType type);
 
+/* Return OpenCL type alignment in bytes. */
+size_t clo_type_alignof(CloType type);
+
+/* Return the OpenCL source code which defines the given type. */
+const char* clo_type_get_def(CloType type);
+
+/* Register a user-defined record (struct) type. */
+CloType clo_type_new_record(const char* name, const char* members,
+	size_t size, size_t align, GError** err);
+
 /* Return an OpenCL type constant given a type name. */
 CloType clo_type_by_name(const char* name, GError** err);
 
@@ -0,0 +1,689 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Group-by (unique, run-length encode and reduce-by-key) class
+ * implementation.
+ * */
+
+#include "cl_ops/clo_group_by.h"
+#include "common/_g_err_macros.h"
+
+/**
+ * @addtogroup CLO_GROUP_BY
+ * @{
+ */
+
+/**
+ * Group-by class.
+ * */
+struct clo_group_by {
+
+	/** @private Context wrapper. */
+	CCLContext* ctx;
+
+	/** @private Program wrapper. */
+	CCLProgram* prg;
+
+	/** @private Type of keys. */
+	CloType key_type;
+
+	/** @private Type of values, if reduce-by-key is available. */
+	CloType val_type;
+
+	/** @private Is reduce-by-key available? */
+	cl_bool has_vals;
+
+	/** @private Pair type for run-length encoding. */
+	CloType rle_pair_type;
+
+	/** @private Pair type for reduce-by-key. */
+	CloType pair_type;
+
+	/** @private Operator which reduces values. */
+	gchar* op;
+
+	/** @private Identity of the operator which reduces values. */
+	gchar* identity;
+
+	/** @private Scan algorithm. */
+	gchar* scan_type;
+
+	/** @private Compiler options, also used for the scanners. */
+	gchar* compiler_opts;
+
+	/** @private Scanner for unique, created on first use. */
+	CloScan* scan_heads;
+
+	/** @private Scanner for run-length encoding, created on first
+	 * use. */
+	CloScan* scan_rle;
+
+	/** @private Scanner for reduce-by-key, created on first use. */
+	CloScan* scan_pairs;
+
+};
+
+/**
+ * @internal
+ * Register the pair type of run heads and values of the given type.
+ * */
+static CloType clo_group_by_pair_new(CloType val_type, GError** err) {
+
+	/* Pair name and members. */
+	gchar* name = g_strdup_printf(
+		"clo_group_by_pair_%s", clo_type_get_name(val_type));
+	gchar* members = g_strdup_printf(
+		"uint n; %s v;", clo_type_get_name(val_type));
+
+	/* The value follows the run heads, and both are padded to the
+	 * alignment of the pair. */
+	size_t align = MAX(sizeof(cl_uint), clo_type_alignof(val_type));
+	size_t size = align
+		+ CLO_DIV_CEIL(clo_type_sizeof(val_type), align) * align;
+
+	/* Register pair type. */
+	CloType pair_type = clo_type_new_record(
+		name, members, size, align, err);
+
+	/* Free stuff. */
+	g_free(name);
+	g_free(members);
+
+	/* Return pair type. */
+	return pair_type;
+
+}
+
+/**
+ * @internal
+ * Create a scanner which performs a segmented inclusive scan of pairs
+ * of run heads and values. The scan operator and its identity call
+ * helper functions, which are passed to the scanner as its prelude.
+ * */
+static CloScan* clo_group_by_pair_scanner(CloGroupBy* grp,
+	CloType pair_type, CloType val_type, const char* op,
+	const char* identity, GError** err) {
+
+	/* Type names. */
+	const char* pn = clo_type_get_name(pair_type);
+	const char* vn = clo_type_get_name(val_type);
+
+	/* Helper functions of the segmented operator and its identity. */
+	gchar* seg_funcs = g_strdup_printf(
+		"%s clo_group_by_combine(%s pa, %s pb) {\n"
+		"\t%s r;\n\t%s a = pa.v;\n\t%s b = pb.v;\n"
+		"\tr.n = pa.n + pb.n;\n"
+		"\tif (pb.n > 0) r.v = b; else r.v = %s;\n"
+		"\treturn r;\n}\n"
+		"%s clo_group_by_identity() {\n"
+		"\t%s r;\n\tr.n = 0;\n\tr.v = %s;\n"
+		"\treturn r;\n}",
+		pn, pn, pn, pn, vn, vn, op, pn, pn, identity);
+
+	/* Create scanner. */
+	CloScan* scanner = clo_scan_new(grp->scan_type, "inclusive=1",
+		grp->ctx, pair_type, pair_type, "clo_group_by_combine((a), (b))",
+		"clo_group_by_identity()", seg_funcs, grp->compiler_opts, err);
+
+	/* Free stuff. */
+	g_free(seg_funcs);
+
+	/* Return scanner. */
+	return scanner;
+
+}
+
+/**
+ * @internal
+ * Perform the three group-by passes: initialize the elements to scan
+ * from the keys (and values), scan them in place and scatter the
+ * results, writing the number of runs.
+ * */
+static CCLEvent* clo_group_by_run(CloGroupBy* grp, CloScan* scanner,
+	size_t elem_size, const char* kname_init, const char* kname_scatter,
+	CCLQueue* cq_exec, CCLQueue* cq_comm, CCLBuffer* keys_in,
+	CCLBuffer* vals_in, CCLBuffer* out1, CCLBuffer* out2,
+	CCLBuffer* count, size_t numel, size_t lws_max, GError** err) {
+
+	/* OpenCL object wrappers. */
+	CCLDevice* dev = NULL;
+	CCLKernel* krnl_init = NULL;
+	CCLKernel* krnl_scat = NULL;
+	CCLBuffer* tmp = NULL;
+	CCLEvent* evt = NULL;
+
+	/* Internal error reporting object. */
+	GError* err_internal = NULL;
+
+	/* Worksizes. */
+	size_t lws, realws, gws;
+
+	/* Number of elements and kernel argument index. */
+	cl_uint numel_cl = numel;
+	cl_uint arg = 0;
+
+	/* If data transfer queue is NULL, use exec queue for data
+	 * transfers. */
+	if (cq_comm == NULL) cq_comm = cq_exec;
+
+	/* Get device where group-by will be performed. */
+	dev = ccl_queue_get_device(cq_exec, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Get kernel wrappers. */
+	krnl_init = ccl_program_get_kernel(
+		grp->prg, kname_init, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	krnl_scat = ccl_program_get_kernel(
+		grp->prg, kname_scatter, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Determine worksizes, with one work-item per key. */
+	lws = lws_max;
+	realws = MAX(numel, 1);
+	ccl_kernel_suggest_worksizes(NULL, dev, 1, &realws, NULL, &lws,
+		&err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	gws = CLO_GWS_MULT(realws, lws);
+
+	/* Create temporary buffer with elements to scan. */
+	tmp = ccl_buffer_new(grp->ctx, CL_MEM_READ_WRITE,
+		realws * elem_size, NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	if (numel > 0) {
+
+		/* Initialize elements to scan. */
+		ccl_kernel_set_arg(krnl_init, arg++, keys_in);
+		if (vals_in != NULL) ccl_kernel_set_arg(krnl_init, arg++, vals_in);
+		ccl_kernel_set_arg(krnl_init, arg++, tmp);
+		ccl_kernel_set_arg(
+			krnl_init, arg++, ccl_arg_priv(numel_cl, cl_uint));
+		evt = ccl_kernel_enqueue_ndrange(krnl_init, cq_exec, 1, NULL,
+			&gws, &lws, NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "group_by_init");
+
+		/* Number runs (and reduce them), in place. */
+		clo_scan_with_device_data(scanner, cq_exec, cq_comm, tmp, tmp,
+			numel, lws_max, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	}
+
+	/* Scatter results and write number of runs. */
+	arg = 0;
+	ccl_kernel_set_arg(krnl_scat, arg++, keys_in);
+	ccl_kernel_set_arg(krnl_scat, arg++, tmp);
+	ccl_kernel_set_arg(krnl_scat, arg++, out1);
+	if (out2 != NULL) ccl_kernel_set_arg(krnl_scat, arg++, out2);
+	ccl_kernel_set_arg(krnl_scat, arg++, count);
+	ccl_kernel_set_arg(krnl_scat, arg++, ccl_arg_priv(numel_cl, cl_uint));
+	evt = ccl_kernel_enqueue_ndrange(krnl_scat, cq_exec, 1, NULL,
+		&gws, &lws, NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	ccl_event_set_name(evt, "group_by_scatter");
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	evt = NULL;
+
+finish:
+
+	/* Release temporary buffer. */
+	if (tmp) ccl_buffer_destroy(tmp);
+
+	/* Return event. */
+	return evt;
+
+}
+
+/**
+ * Create a new group-by object.
+ *
+ * @public @memberof clo_group_by
+ *
+ * @param[in] ctx OpenCL context wrapper.
+ * @param[in] key_type Type of keys.
+ * @param[in] val_type Type of values to reduce with clo_reduce_by_key(),
+ * which cannot be a record type. If NULL, clo_reduce_by_key() is not
+ * available.
+ * @param[in] equal One-liner OpenCL C code string which checks if two
+ * keys, a and b, are equal, yielding a boolean; e.g.
+ * `all((a) == (b))` for vector keys. If NULL, this defaults to
+ * `((a) == (b))`.
+ * @param[in] op One-liner OpenCL C code string which combines two
+ * values, a and b, with an associative operator, where `a` precedes
+ * `b`; e.g. `max((a), (b))` yields the maximum of each run. If NULL,
+ * this defaults to `((a) + (b))`.
+ * @param[in] identity One-liner OpenCL C code string with the identity
+ * element of `op`. If NULL, this defaults to `0`.
+ * @param[in] options Group-by options: `scan=<type>` selects the scan
+ * algorithm (::CLO_GROUP_BY_SCAN_DEFAULT by default). Can be `NULL`.
+ * @param[in] compiler_opts OpenCL Compiler options.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new group-by object or `NULL` if an error occurs.
+ * */
+CloGroupBy* clo_group_by_new(CCLContext* ctx, CloType key_type,
+	CloType* val_type, const char* equal, const char* op,
+	const char* identity, const char* options,
+	const char* compiler_opts, GError** err) {
+
+	/* Make sure context is not NULL. */
+	g_return_val_if_fail(ctx != NULL, NULL);
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Group-by object. */
+	CloGroupBy* grp = NULL;
+
+	/* Internal error management object. */
+	GError *err_internal = NULL;
+
+	/* Tokenized options. */
+	gchar** opts = NULL;
+	gchar** opt = NULL;
+
+	/* Number of tokens. */
+	int num_toks;
+
+	/* Group-by macros builder. */
+	GString* ocl_macros = NULL;
+
+	/* Final compiler options. */
+	gchar* compiler_opts_final = NULL;
+
+	/* Complete source (macros + group-by source). */
+	const char* src_full[2];
+
+	/* Allocate memory for group-by object. */
+	grp = g_slice_new0(CloGroupBy);
+
+	/* Keep data in group-by object. */
+	ccl_context_ref(ctx);
+	grp->ctx = ctx;
+	grp->key_type = key_type;
+	grp->op = g_strdup(op != NULL ? op : "((a) + (b))");
+	grp->identity = g_strdup(identity != NULL ? identity : "0");
+	grp->scan_type = g_strdup(CLO_GROUP_BY_SCAN_DEFAULT);
+	grp->compiler_opts = g_strdup(
+		compiler_opts != NULL ? compiler_opts : "");
+
+	/* Check options. */
+	if (options) {
+		opts = g_strsplit_set(options, ",", -1);
+		for (guint i = 0; opts[i] != NULL; i++) {
+
+			/* Ignore empty tokens. */
+			if (opts[i][0] == '\0') continue;
+
+			/* Parse current option, get key and value. */
+			opt = g_strsplit_set(opts[i], "=", 2);
+
+			/* Count number of tokens. */
+			for (num_toks = 0; opt[num_toks] != NULL; num_toks++);
+
+			/* If number of tokens is not 2 (key and value), throw error. */
+			g_if_err_create_goto(*err, CLO_ERROR, num_toks != 2,
+				CLO_ERROR_ARGS, error_handler,
+				"Invalid group-by option '%s'.", opts[i]);
+
+			/* Check key/value option. */
+			if (g_strcmp0("scan", opt[0]) == 0) {
+				/* Scan algorithm. */
+				g_free(grp->scan_type);
+				grp->scan_type = g_strdup(opt[1]);
+			} else {
+				g_if_err_create_goto(*err, CLO_ERROR, TRUE,
+					CLO_ERROR_ARGS, error_handler,
+					"Invalid group-by option key '%s'.", opt[0]);
+			}
+
+			/* Free token. */
+			g_strfreev(opt);
+			opt = NULL;
+
+		}
+	}
+
+	/* Register pair type for run-length encoding. */
+	grp->rle_pair_type = clo_group_by_pair_new(CLO_UINT, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Register pair type for reduce-by-key, if required. Pairs of
+	 * records are not possible, since only the definition of the pair
+	 * is included in the scan source. */
+	if (val_type != NULL) {
+		g_if_err_create_goto(*err, CLO_ERROR,
+			clo_type_get_def(*val_type) != NULL,
+			CLO_ERROR_ARGS, error_handler,
+			"Record types are not supported as group-by values.");
+		grp->val_type = *val_type;
+		grp->has_vals = CL_TRUE;
+		grp->pair_type = clo_group_by_pair_new(
+			grp->val_type, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+	}
+
+	/* Build group-by macros, which define the record types and the
+	 * key equality macro. */
+	ocl_macros = g_string_new("");
+	if (clo_type_get_def(key_type))
+		g_string_append(ocl_macros, clo_type_get_def(key_type));
+	g_string_append(ocl_macros, clo_type_get_def(grp->rle_pair_type));
+	if (grp->has_vals)
+		g_string_append(ocl_macros, clo_type_get_def(grp->pair_type));
+	g_string_append_printf(ocl_macros,
+		"#define CLO_GROUP_BY_EQUAL(a, b) %s\n",
+		equal != NULL ? equal : "((a) == (b))");
+
+	/* Determine final compiler options. */
+	if (grp->has_vals) {
+		compiler_opts_final = g_strdup_printf(
+			" -DCLO_GROUP_BY_KEY_TYPE=%s -DCLO_GROUP_BY_RLE_PAIR_TYPE=%s"
+			" -DCLO_GROUP_BY_VAL_TYPE=%s -DCLO_GROUP_BY_PAIR_TYPE=%s %s",
+			clo_type_get_name(key_type),
+			clo_type_get_name(grp->rle_pair_type),
+			clo_type_get_name(grp->val_type),
+			clo_type_get_name(grp->pair_type), grp->compiler_opts);
+	} else {
+		compiler_opts_final = g_strdup_printf(
+			" -DCLO_GROUP_BY_KEY_TYPE=%s -DCLO_GROUP_BY_RLE_PAIR_TYPE=%s"
+			" %s", clo_type_get_name(key_type),
+			clo_type_get_name(grp->rle_pair_type), grp->compiler_opts);
+	}
+
+	/* Create and build group-by program. */
+	src_full[0] = (const char*) ocl_macros->str;
+	src_full[1] = CLO_GROUP_BY_SRC;
+	grp->prg = ccl_program_new_from_sources(
+		ctx, 2, src_full, NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	ccl_program_build(grp->prg, compiler_opts_final, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+
+	if (grp) { clo_group_by_destroy(grp); grp = NULL; }
+
+finish:
+
+	/* Free stuff. */
+	if (compiler_opts_final) g_free(compiler_opts_final);
+	if (ocl_macros) g_string_free(ocl_macros, TRUE);
+	g_strfreev(opts);
+	g_strfreev(opt);
+
+	/* Return group-by object. */
+	return grp;
+
+}
+
+/**
+ * Destroy a group-by object.
+ *
+ * @public @memberof clo_group_by
+ *
+ * @param[in] grp Group-by object to destroy.
+ * */
+void clo_group_by_destroy(CloGroupBy* grp) {
+
+	/* Check group-by object is not NULL. */
+	g_return_if_fail(grp != NULL);
+
+	/* Destroy scanners. */
+	if (grp->scan_heads) clo_scan_destroy(grp->scan_heads);
+	if (grp->scan_rle) clo_scan_destroy(grp->scan_rle);
+	if (grp->scan_pairs) clo_scan_destroy(grp->scan_pairs);
+
+	/* Destroy program. */
+	if (grp->prg) ccl_program_destroy(grp->prg);
+
+	/* Unreference context. */
+	if (grp->ctx) ccl_context_unref(grp->ctx);
+
+	/* Free strings. */
+	g_free(grp->op);
+	g_free(grp->identity);
+	g_free(grp->scan_type);
+	g_free(grp->compiler_opts);
+
+	/* Free group-by object memory. */
+	g_slice_free(CloGroupBy, grp);
+
+}
+
+/**
+ * Get the unique keys of runs of equal keys, e.g. of sorted keys.
+ *
+ * @public @memberof clo_group_by
+ *
+ * @param[in] grp Group-by object.
+ * @param[in] cq_exec A valid command queue wrapper for kernel
+ * execution, cannot be `NULL`.
+ * @param[in] cq_comm A command queue wrapper for data transfers.
+ * If `NULL`, `cq_exec` will be used for data transfers.
+ * @param[in] keys_in Keys, with equal keys in consecutive positions.
+ * @param[out] keys_out Location where to place the unique keys, with
+ * space for `numel` keys.
+ * @param[out] count Device location where to place the number of
+ * unique keys, as a `cl_uint`.
+ * @param[in] numel Number of keys in `keys_in`.
+ * @param[in] lws_max Max. local worksize. If 0, the local worksize
+ * will be automatically determined.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return An event which must terminate before the operation is
+ * considered complete.
+ * */
+CCLEvent* clo_unique(CloGroupBy* grp, CCLQueue* cq_exec,
+	CCLQueue* cq_comm, CCLBuffer* keys_in, CCLBuffer* keys_out,
+	CCLBuffer* count, size_t numel, size_t lws_max, GError** err) {
+
+	/* Make sure group-by object is not NULL. */
+	g_return_val_if_fail(grp != NULL, NULL);
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Make sure cq_exec is not NULL. */
+	g_return_val_if_fail(cq_exec != NULL, NULL);
+
+	/* Create scanner on first use. */
+	if (grp->scan_heads == NULL) {
+		grp->scan_heads = clo_scan_new(grp->scan_type, "inclusive=1",
+			grp->ctx, CLO_UINT, CLO_UINT, NULL, NULL, NULL,
+			grp->compiler_opts, err);
+		if (grp->scan_heads == NULL) return NULL;
+	}
+
+	/* Perform unique. */
+	return clo_group_by_run(grp, grp->scan_heads, sizeof(cl_uint),
+		CLO_GROUP_BY_KNAME_HEADS, CLO_GROUP_BY_KNAME_UNIQUE, cq_exec,
+		cq_comm, keys_in, NULL, keys_out, NULL, count, numel, lws_max,
+		err);
+
+}
+
+/**
+ * Get the unique keys and the length of runs of equal keys, e.g. of
+ * sorted keys.
+ *
+ * @public @memberof clo_group_by
+ *
+ * @param[in] grp Group-by object.
+ * @param[in] cq_exec A valid command queue wrapper for kernel
+ * execution, cannot be `NULL`.
+ * @param[in] cq_comm A command queue wrapper for data transfers.
+ * If `NULL`, `cq_exec` will be used for data transfers.
+ * @param[in] keys_in Keys, with equal keys in consecutive positions.
+ * @param[out] keys_out Location where to place the unique keys, with
+ * space for `numel` keys.
+ * @param[out] lengths Location where to place the length of each run,
+ * as `cl_uint`, with space for `numel` lengths.
+ * @param[out] count Device location where to place the number of
+ * runs, as a `cl_uint`.
+ * @param[in] numel Number of keys in `keys_in`.
+ * @param[in] lws_max Max. local worksize. If 0, the local worksize
+ * will be automatically determined.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return An event which must terminate before the operation is
+ * considered complete.
+ * */
+CCLEvent* clo_run_length_encode(CloGroupBy* grp, CCLQueue* cq_exec,
+	CCLQueue* cq_comm, CCLBuffer* keys_in, CCLBuffer* keys_out,
+	CCLBuffer* lengths, CCLBuffer* count, size_t numel, size_t lws_max,
+	GError** err) {
+
+	/* Make sure group-by object is not NULL. */
+	g_return_val_if_fail(grp != NULL, NULL);
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Make sure cq_exec is not NULL. */
+	g_return_val_if_fail(cq_exec != NULL, NULL);
+
+	/* Create scanner on first use. */
+	if (grp->scan_rle == NULL) {
+		grp->scan_rle = clo_group_by_pair_scanner(grp,
+			grp->rle_pair_type, CLO_UINT, "((a) + (b))", "0", err);
+		if (grp->scan_rle == NULL) return NULL;
+	}
+
+	/* Perform run-length encoding. */
+	return clo_group_by_run(grp, grp->scan_rle,
+		clo_type_sizeof(grp->rle_pair_type),
+		CLO_GROUP_BY_KNAME_RLE_PAIRS, CLO_GROUP_BY_KNAME_RLE, cq_exec,
+		cq_comm, keys_in, NULL, keys_out, lengths, count, numel,
+		lws_max, err);
+
+}
+
+/**
+ * Get the unique keys and the reduction of the values of runs of equal
+ * keys, e.g. of sorted keys.
+ *
+ * @public @memberof clo_group_by
+ *
+ * @param[in] grp Group-by object, created with a value type.
+ * @param[in] cq_exec A valid command queue wrapper for kernel
+ * execution, cannot be `NULL`.
+ * @param[in] cq_comm A command queue wrapper for data transfers.
+ * If `NULL`, `cq_exec` will be used for data transfers.
+ * @param[in] keys_in Keys, with equal keys in consecutive positions.
+ * @param[in] vals_in Values associated with keys.
+ * @param[out] keys_out Location where to place the unique keys, with
+ * space for `numel` keys.
+ * @param[out] vals_out Location where to place the reduction of the
+ * values of each run, with space for `numel` values.
+ * @param[out] count Device location where to place the number of
+ * runs, as a `cl_uint`.
+ * @param[in] numel Number of keys in `keys_in`.
+ * @param[in] lws_max Max. local worksize. If 0, the local worksize
+ * will be automatically determined.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return An event which must terminate before the operation is
+ * considered complete.
+ * */
+CCLEvent* clo_reduce_by_key(CloGroupBy* grp, CCLQueue* cq_exec,
+	CCLQueue* cq_comm, CCLBuffer* keys_in, CCLBuffer* vals_in,
+	CCLBuffer* keys_out, CCLBuffer* vals_out, CCLBuffer* count,
+	size_t numel, size_t lws_max, GError** err) {
+
+	/* Make sure group-by object is not NULL. */
+	g_return_val_if_fail(grp != NULL, NULL);
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Make sure cq_exec is not NULL. */
+	g_return_val_if_fail(cq_exec != NULL, NULL);
+
+	/* Event to return. */
+	CCLEvent* evt = NULL;
+
+	/* Check that reduce-by-key is available. */
+	g_if_err_create_goto(*err, CLO_ERROR, !grp->has_vals,
+		CLO_ERROR_ARGS, error_handler,
+		"Reduce-by-key requires a group-by object with a value type.");
+
+	/* Create scanner on first use. */
+	if (grp->scan_pairs == NULL) {
+		grp->scan_pairs = clo_group_by_pair_scanner(grp,
+			grp->pair_type, grp->val_type, grp->op, grp->identity, err);
+		if (grp->scan_pairs == NULL) goto error_handler;
+	}
+
+	/* Perform reduce-by-key. */
+	evt = clo_group_by_run(grp, grp->scan_pairs,
+		clo_type_sizeof(grp->pair_type),
+		CLO_GROUP_BY_KNAME_PAIRS, CLO_GROUP_BY_KNAME_REDUCE, cq_exec,
+		cq_comm, keys_in, vals_in, keys_out, vals_out, count, numel,
+		lws_max, err);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	evt = NULL;
+
+finish:
+
+	/* Return event. */
+	return evt;
+
+}
+
+/**
+ * Get program wrapper associated with group-by object.
+ *
+ * @public @memberof clo_group_by
+ *
+ * @param[in] grp Group-by object.
+ * @return Program wrapper associated with group-by object.
+ * */
+CCLProgram* clo_group_by_get_program(CloGroupBy* grp) {
+
+	/* Make sure group-by object is not NULL. */
+	g_return_val_if_fail(grp != NULL, NULL);
+
+	/* Return program wrapper. */
+	return grp->prg;
+
+}
+
+/** @} */
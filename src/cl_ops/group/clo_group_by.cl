@@ -0,0 +1,235 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Group-by (unique, run-length encode and reduce-by-key)
+ * implementation.
+ *
+ * Runs are numbered by an inclusive scan of the run heads, so that the
+ * last element of each run knows the position of the run in the
+ * output. For run-length encoding and reduce-by-key, each element is a
+ * pair with the number of run heads (`n`) and a value (`v`), and the
+ * pairs are combined with a segmented operator:
+ *
+ *     (a.n + b.n, b.n > 0 ? b.v : op(a.v, b.v))
+ *
+ * These kernels expect the following constants and macros to be
+ * defined:
+ *
+ * * `CLO_GROUP_BY_KEY_TYPE` - Type of keys.
+ * * `CLO_GROUP_BY_EQUAL(a, b)` - Are keys `a` and `b` equal?
+ * * `CLO_GROUP_BY_RLE_PAIR_TYPE` - Pair of `uint` run heads and
+ * `uint` run length.
+ * * `CLO_GROUP_BY_VAL_TYPE` - Type of values (optional, only required
+ * by reduce-by-key).
+ * * `CLO_GROUP_BY_PAIR_TYPE` - Pair of `uint` run heads and value
+ * (only if `CLO_GROUP_BY_VAL_TYPE` is defined).
+ *
+ */
+
+/* Is the i^th key the first of a run? */
+#define CLO_GROUP_BY_IS_HEAD(keys, i) \
+	(((i) == 0) || !(CLO_GROUP_BY_EQUAL((keys)[(i) - 1], (keys)[i])))
+
+/* Is the i^th key the last of a run? */
+#define CLO_GROUP_BY_IS_TAIL(keys, i, numel) \
+	(((i) == (numel) - 1) || !(CLO_GROUP_BY_EQUAL((keys)[i], (keys)[(i) + 1])))
+
+/**
+ * Flags the first key of each run.
+ *
+ * @param keys Keys, with equal keys in consecutive positions.
+ * @param heads Run head flags, 1 for the first key of a run, 0
+ * otherwise.
+ * @param numel Number of keys.
+ */
+__kernel void groupHeads(
+			__global CLO_GROUP_BY_KEY_TYPE *keys,
+			__global uint *heads,
+			uint numel)
+{
+
+	uint i = get_global_id(0);
+
+	if (i < numel)
+		heads[i] = CLO_GROUP_BY_IS_HEAD(keys, i) ? 1 : 0;
+
+}
+
+/**
+ * Scatters the unique keys, using the last key of each run, and
+ * writes the number of runs.
+ *
+ * @param keys Keys, with equal keys in consecutive positions.
+ * @param heads Inclusive scan of the run head flags.
+ * @param keys_out Unique keys.
+ * @param count Number of runs.
+ * @param numel Number of keys.
+ */
+__kernel void groupUnique(
+			__global CLO_GROUP_BY_KEY_TYPE *keys,
+			__global uint *heads,
+			__global CLO_GROUP_BY_KEY_TYPE *keys_out,
+			__global uint *count,
+			uint numel)
+{
+
+	uint i = get_global_id(0);
+
+	if (i < numel) {
+		if (CLO_GROUP_BY_IS_TAIL(keys, i, numel))
+			keys_out[heads[i] - 1] = keys[i];
+		if (i == numel - 1)
+			count[0] = heads[i];
+	} else if ((i == 0) && (numel == 0)) {
+		count[0] = 0;
+	}
+
+}
+
+/**
+ * Initializes the run-length encoding pairs, with the run head flag
+ * and a unit length.
+ *
+ * @param keys Keys, with equal keys in consecutive positions.
+ * @param pairs Run-length encoding pairs.
+ * @param numel Number of keys.
+ */
+__kernel void groupRlePairs(
+			__global CLO_GROUP_BY_KEY_TYPE *keys,
+			__global CLO_GROUP_BY_RLE_PAIR_TYPE *pairs,
+			uint numel)
+{
+
+	uint i = get_global_id(0);
+	CLO_GROUP_BY_RLE_PAIR_TYPE p;
+
+	if (i < numel) {
+		p.n = CLO_GROUP_BY_IS_HEAD(keys, i) ? 1 : 0;
+		p.v = 1;
+		pairs[i] = p;
+	}
+
+}
+
+/**
+ * Scatters the unique keys and run lengths, using the last key of each
+ * run, and writes the number of runs.
+ *
+ * @param keys Keys, with equal keys in consecutive positions.
+ * @param pairs Segmented inclusive scan of the run-length encoding
+ * pairs.
+ * @param keys_out Unique keys.
+ * @param lengths Run lengths.
+ * @param count Number of runs.
+ * @param numel Number of keys.
+ */
+__kernel void groupRle(
+			__global CLO_GROUP_BY_KEY_TYPE *keys,
+			__global CLO_GROUP_BY_RLE_PAIR_TYPE *pairs,
+			__global CLO_GROUP_BY_KEY_TYPE *keys_out,
+			__global uint *lengths,
+			__global uint *count,
+			uint numel)
+{
+
+	uint i = get_global_id(0);
+	CLO_GROUP_BY_RLE_PAIR_TYPE p;
+
+	if (i < numel) {
+		if (CLO_GROUP_BY_IS_TAIL(keys, i, numel)) {
+			p = pairs[i];
+			keys_out[p.n - 1] = keys[i];
+			lengths[p.n - 1] = p.v;
+			if (i == numel - 1)
+				count[0] = p.n;
+		}
+	} else if ((i == 0) && (numel == 0)) {
+		count[0] = 0;
+	}
+
+}
+
+#ifdef CLO_GROUP_BY_VAL_TYPE
+
+/**
+ * Initializes the reduce-by-key pairs, with the run head flag and the
+ * respective value.
+ *
+ * @param keys Keys, with equal keys in consecutive positions.
+ * @param vals Values associated with keys.
+ * @param pairs Reduce-by-key pairs.
+ * @param numel Number of keys.
+ */
+__kernel void groupPairs(
+			__global CLO_GROUP_BY_KEY_TYPE *keys,
+			__global CLO_GROUP_BY_VAL_TYPE *vals,
+			__global CLO_GROUP_BY_PAIR_TYPE *pairs,
+			uint numel)
+{
+
+	uint i = get_global_id(0);
+	CLO_GROUP_BY_PAIR_TYPE p;
+
+	if (i < numel) {
+		p.n = CLO_GROUP_BY_IS_HEAD(keys, i) ? 1 : 0;
+		p.v = vals[i];
+		pairs[i] = p;
+	}
+
+}
+
+/**
+ * Scatters the unique keys and reduced values, using the last key of
+ * each run, and writes the number of runs.
+ *
+ * @param keys Keys, with equal keys in consecutive positions.
+ * @param pairs Segmented inclusive scan of the reduce-by-key pairs.
+ * @param keys_out Unique keys.
+ * @param vals_out Reduced values.
+ * @param count Number of runs.
+ * @param numel Number of keys.
+ */
+__kernel void groupReduce(
+			__global CLO_GROUP_BY_KEY_TYPE *keys,
+			__global CLO_GROUP_BY_PAIR_TYPE *pairs,
+			__global CLO_GROUP_BY_KEY_TYPE *keys_out,
+			__global CLO_GROUP_BY_VAL_TYPE *vals_out,
+			__global uint *count,
+			uint numel)
+{
+
+	uint i = get_global_id(0);
+	CLO_GROUP_BY_PAIR_TYPE p;
+
+	if (i < numel) {
+		if (CLO_GROUP_BY_IS_TAIL(keys, i, numel)) {
+			p = pairs[i];
+			keys_out[p.n - 1] = keys[i];
+			vals_out[p.n - 1] = p.v;
+			if (i == numel - 1)
+				count[0] = p.n;
+		}
+	} else if ((i == 0) && (numel == 0)) {
+		count[0] = 0;
+	}
+
+}
+
+#endif
@@ -0,0 +1,94 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Group-by (unique, run-length encode and reduce-by-key) class
+ * declarations.
+ * */
+
+#ifndef _CLO_GROUP_BY_H_
+#define _CLO_GROUP_BY_H_
+
+#include "cl_ops/clo_common.h"
+#include "cl_ops/clo_scan_abstract.h"
+
+/** The group-by kernels source. */
+#define CLO_GROUP_BY_SRC "@GROUP_BY_SRC@"
+
+/* Group-by kernel names. */
+#define CLO_GROUP_BY_KNAME_HEADS "groupHeads"
+#define CLO_GROUP_BY_KNAME_UNIQUE "groupUnique"
+#define CLO_GROUP_BY_KNAME_RLE_PAIRS "groupRlePairs"
+#define CLO_GROUP_BY_KNAME_RLE "groupRle"
+#define CLO_GROUP_BY_KNAME_PAIRS "groupPairs"
+#define CLO_GROUP_BY_KNAME_REDUCE "groupReduce"
+
+/* Scan algorithm used by default. */
+#define CLO_GROUP_BY_SCAN_DEFAULT "blelloch"
+
+/**
+ * @defgroup CLO_GROUP_BY Group-by
+ *
+ * This module groups runs of consecutive equal keys, as found in
+ * sorted data, yielding the unique keys, the length of each run
+ * (run-length encoding) or the reduction of the values associated with
+ * each run (reduce-by-key). Each operation performs three passes: a
+ * first kernel flags the first key of each run, an inclusive scan
+ * (performed with a ::CloScan object) numbers the runs, and a last
+ * kernel scatters the results and writes the number of runs to a
+ * device buffer, so that subsequent operations can stay on the
+ * device. For reduce-by-key and run-length encoding, the run number
+ * and the reduction are obtained by the same segmented scan.
+ *
+ * @{
+ */
+
+/** @} */
+
+/* Create a new group-by object. */
+CloGroupBy* clo_group_by_new(CCLContext* ctx, CloType key_type,
+	CloType* val_type, const char* equal, const char* op,
+	const char* identity, const char* options,
+	const char* compiler_opts, GError** err);
+
+/* Destroy a group-by object. */
+void clo_group_by_destroy(CloGroupBy* grp);
+
+/* Get the unique keys of runs of equal keys. */
+CCLEvent* clo_unique(CloGroupBy* grp, CCLQueue* cq_exec,
+	CCLQueue* cq_comm, CCLBuffer* keys_in, CCLBuffer* keys_out,
+	CCLBuffer* count, size_t numel, size_t lws_max, GError** err);
+
+/* Get the unique keys and the length of runs of equal keys. */
+CCLEvent* clo_run_length_encode(CloGroupBy* grp, CCLQueue* cq_exec,
+	CCLQueue* cq_comm, CCLBuffer* keys_in, CCLBuffer* keys_out,
+	CCLBuffer* lengths, CCLBuffer* count, size_t numel, size_t lws_max,
+	GError** err);
+
+/* Get the unique keys and the reduction of the values of runs of equal
+ * keys. */
+CCLEvent* clo_reduce_by_key(CloGroupBy* grp, CCLQueue* cq_exec,
+	CCLQueue* cq_comm, CCLBuffer* keys_in, CCLBuffer* vals_in,
+	CCLBuffer* keys_out, CCLBuffer* vals_out, CCLBuffer* count,
+	size_t numel, size_t lws_max, GError** err);
+
+/* Get program wrapper associated with group-by object. */
+CCLProgram* clo_group_by_get_program(CloGroupBy* grp);
+
+#endif
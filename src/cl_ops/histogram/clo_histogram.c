@@ -0,0 +1,759 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Histogram class implementation.
+ * */
+
+#include "cl_ops/clo_histogram.h"
+#include "common/_g_err_macros.h"
+#include <string.h>
+
+/**
+ * @addtogroup CLO_HISTOGRAM
+ * @{
+ */
+
+/**
+ * Histogram class.
+ * */
+struct clo_histogram {
+
+	/** @private Context wrapper. */
+	CCLContext* ctx;
+
+	/** @private Program wrapper. */
+	CCLProgram* prg;
+
+	/** @private Type of elements to bin. */
+	CloType elem_type;
+
+	/** @private Number of bins. */
+	cl_uint num_bins;
+
+	/** @private Path used to compute the histogram. */
+	CloHistogramPath path;
+
+	/** @private Sorter for the sort-based path, `NULL` otherwise. */
+	CloSort* sorter;
+
+};
+
+/**
+ * @internal
+ * Compute histogram using local memory sub-histograms.
+ * */
+static CCLEvent* clo_histogram_local(CloHistogram* hist,
+	CCLQueue* cq_exec, CCLBuffer* data_in, CCLBuffer* counts,
+	size_t numel, size_t lws_max, GError** err) {
+
+	/* OpenCL object wrappers. */
+	CCLDevice* dev = NULL;
+	CCLKernel* krnl_local = NULL;
+	CCLKernel* krnl_merge = NULL;
+	CCLBuffer* partial = NULL;
+	CCLEvent* evt = NULL;
+
+	/* Internal error reporting object. */
+	GError* err_internal = NULL;
+
+	/* Worksizes. */
+	size_t lws, realws, gws, gws_merge;
+
+	/* Number of elements and of sub-histograms. */
+	cl_uint numel_cl = numel;
+	cl_uint num_wgs;
+
+	/* Get device where histogram will be computed. */
+	dev = ccl_queue_get_device(cq_exec, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Get kernel wrappers. */
+	krnl_local = ccl_program_get_kernel(
+		hist->prg, CLO_HISTOGRAM_KNAME_LOCAL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	krnl_merge = ccl_program_get_kernel(
+		hist->prg, CLO_HISTOGRAM_KNAME_MERGE, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Determine worksizes. Each work-item bins several elements, so
+	 * that the number of sub-histograms to merge is bounded. */
+	lws = lws_max;
+	realws = MAX(numel, 1);
+	ccl_kernel_suggest_worksizes(krnl_local, dev, 1, &realws,
+		&gws, &lws, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	gws = MIN(gws, lws * CLO_HISTOGRAM_MAX_WGS);
+	num_wgs = gws / lws;
+	gws_merge = CLO_GWS_MULT(hist->num_bins, lws);
+
+	/* If there is more than one workgroup, sub-histograms are kept in
+	 * a temporary buffer, otherwise the single sub-histogram is the
+	 * final histogram. */
+	if (num_wgs > 1) {
+		partial = ccl_buffer_new(hist->ctx, CL_MEM_READ_WRITE,
+			num_wgs * hist->num_bins * sizeof(cl_uint), NULL,
+			&err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+	}
+
+	g_debug("Histogram (local): N: %d, GWS: %d, LWS: %d, WGs: %d",
+		(int) numel, (int) gws, (int) lws, (int) num_wgs);
+
+	/* Build sub-histograms. */
+	evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_local, cq_exec,
+		1, NULL, &gws, &lws, NULL, &err_internal,
+		data_in, partial != NULL ? partial : counts,
+		ccl_arg_local(hist->num_bins, cl_uint),
+		ccl_arg_priv(numel_cl, cl_uint), NULL);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	ccl_event_set_name(evt, "histogram_local");
+
+	/* Merge sub-histograms. */
+	if (partial != NULL) {
+		evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_merge,
+			cq_exec, 1, NULL, &gws_merge, &lws, NULL, &err_internal,
+			partial, counts, ccl_arg_priv(num_wgs, cl_uint), NULL);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "histogram_merge");
+	}
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	evt = NULL;
+
+finish:
+
+	/* Release temporary buffer. */
+	if (partial) ccl_buffer_destroy(partial);
+
+	/* Return event. */
+	return evt;
+
+}
+
+/**
+ * @internal
+ * Compute histogram by sorting the bins of the elements.
+ * */
+static CCLEvent* clo_histogram_sort(CloHistogram* hist,
+	CCLQueue* cq_exec, CCLQueue* cq_comm, CCLBuffer* data_in,
+	CCLBuffer* counts, size_t numel, size_t lws_max, GError** err) {
+
+	/* OpenCL object wrappers. */
+	CCLDevice* dev = NULL;
+	CCLKernel* krnl_bins = NULL;
+	CCLKernel* krnl_clear = NULL;
+	CCLKernel* krnl_runs = NULL;
+	CCLKernel* krnl_counts = NULL;
+	CCLBuffer* bins = NULL;
+	CCLBuffer* starts = NULL;
+	CCLEvent* evt = NULL;
+
+	/* Internal error reporting object. */
+	GError* err_internal = NULL;
+
+	/* Worksizes. */
+	size_t lws, realws, gws_elems, gws_bins;
+
+	/* Number of elements, and number of bins to sort, padded to a power
+	 * of two for sort algorithms which only sort powers of two. */
+	cl_uint numel_cl = numel;
+	cl_uint numel_pad = clo_nlpo2(MAX(numel_cl, 1));
+
+	/* Get device where histogram will be computed. */
+	dev = ccl_queue_get_device(cq_exec, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Get kernel wrappers. */
+	krnl_bins = ccl_program_get_kernel(
+		hist->prg, CLO_HISTOGRAM_KNAME_BINS, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	krnl_clear = ccl_program_get_kernel(
+		hist->prg, CLO_HISTOGRAM_KNAME_CLEAR, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	krnl_runs = ccl_program_get_kernel(
+		hist->prg, CLO_HISTOGRAM_KNAME_RUNS, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	krnl_counts = ccl_program_get_kernel(
+		hist->prg, CLO_HISTOGRAM_KNAME_COUNTS, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Determine worksizes, with one work-item per element or per bin. */
+	lws = lws_max;
+	realws = MAX(numel_pad, hist->num_bins);
+	ccl_kernel_suggest_worksizes(NULL, dev, 1, &realws, NULL, &lws,
+		&err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	gws_elems = CLO_GWS_MULT(numel_pad, lws);
+	gws_bins = CLO_GWS_MULT(hist->num_bins, lws);
+
+	/* Create temporary buffers. */
+	bins = ccl_buffer_new(hist->ctx, CL_MEM_READ_WRITE,
+		numel_pad * sizeof(cl_uint), NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	starts = ccl_buffer_new(hist->ctx, CL_MEM_READ_WRITE,
+		hist->num_bins * sizeof(cl_uint), NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	g_debug("Histogram (sort): N: %d, bins: %d, LWS: %d",
+		(int) numel, (int) hist->num_bins, (int) lws);
+
+	/* Clear histogram and run starts. */
+	evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_clear, cq_exec,
+		1, NULL, &gws_bins, &lws, NULL, &err_internal,
+		counts, starts, NULL);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	ccl_event_set_name(evt, "histogram_clear");
+
+	if (numel > 0) {
+
+		/* Get bin of each element. */
+		evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_bins,
+			cq_exec, 1, NULL, &gws_elems, &lws, NULL, &err_internal,
+			data_in, bins, ccl_arg_priv(numel_cl, cl_uint),
+			ccl_arg_priv(numel_pad, cl_uint), NULL);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "histogram_bins");
+
+		/* Sort bins in place, including padding, which is moved to the
+		 * end of the sorted bins and is thus not visited below. */
+		clo_sort_with_device_data(hist->sorter, cq_exec, cq_comm, bins,
+			NULL, numel_pad, lws_max, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+
+		/* Find run boundaries of each bin. */
+		evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_runs,
+			cq_exec, 1, NULL, &gws_elems, &lws, NULL, &err_internal,
+			bins, counts, starts, ccl_arg_priv(numel_cl, cl_uint), NULL);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "histogram_runs");
+
+		/* Get counts from run boundaries. */
+		evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_counts,
+			cq_exec, 1, NULL, &gws_bins, &lws, NULL, &err_internal,
+			counts, starts, NULL);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "histogram_counts");
+
+	}
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	evt = NULL;
+
+finish:
+
+	/* Release temporary buffers. */
+	if (bins) ccl_buffer_destroy(bins);
+	if (starts) ccl_buffer_destroy(starts);
+
+	/* Return event. */
+	return evt;
+
+}
+
+/**
+ * Create a new histogram object.
+ *
+ * @public @memberof clo_histogram
+ *
+ * @param[in] ctx OpenCL context wrapper.
+ * @param[in] elem_type Type of elements to bin, which can be an integer,
+ * floating-point, vector or record type.
+ * @param[in] num_bins Number of bins.
+ * @param[in] bin_get One-liner OpenCL C code string without side
+ * effects which obtains the bin, as an integer or floating-point value,
+ * of the element defined in the `x` variable; e.g. `((x) & 0xFF)` bins
+ * integers by their least significant byte, and `((x) * 64.0f)` bins
+ * floats in [0, 1) in 64 bins. Elements with negative (or NaN) bins, or
+ * with bins larger or equal to `num_bins`, are not counted; the bin is
+ * only converted to an unsigned integer once it is known to be in
+ * range. If NULL, this defaults to `(x)`.
+ * @param[in] options Histogram options, comma separated:
+ * `path=local|sort|auto` selects the local memory or the sort-based
+ * path (by default, `auto` selects the local memory path for up to
+ * ::CLO_HISTOGRAM_LOCAL_MAX_BINS bins, if they fit in the local memory
+ * of the first device in the context); `sort=<type>` selects the sort
+ * algorithm of the sort-based path (::CLO_HISTOGRAM_SORT_DEFAULT by
+ * default), which may be one which only sorts powers of two, since
+ * the sorted bins are padded accordingly. Can be `NULL`.
+ * @param[in] compiler_opts OpenCL Compiler options.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new histogram object or `NULL` if an error occurs.
+ * */
+CloHistogram* clo_histogram_new(CCLContext* ctx, CloType elem_type,
+	cl_uint num_bins, const char* bin_get, const char* options,
+	const char* compiler_opts, GError** err) {
+
+	/* Make sure context is not NULL. */
+	g_return_val_if_fail(ctx != NULL, NULL);
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Histogram object. */
+	CloHistogram* hist = NULL;
+
+	/* Internal error management object. */
+	GError *err_internal = NULL;
+
+	/* Device used to select the histogram path. */
+	CCLDevice* dev = NULL;
+
+	/* Tokenized options. */
+	gchar** opts = NULL;
+	gchar** opt = NULL;
+
+	/* Number of tokens. */
+	int num_toks;
+
+	/* Requested path, and is it automatically selected? */
+	CloHistogramPath path = CLO_HISTOGRAM_PATH_LOCAL;
+	cl_bool path_auto = CL_TRUE;
+
+	/* Sort algorithm of the sort-based path. */
+	const char* sort_type = CLO_HISTOGRAM_SORT_DEFAULT;
+
+	/* Type of sorted bins. */
+	CloType bin_type = CLO_UINT;
+
+	/* Local memory size of device. */
+	cl_ulong local_mem;
+
+	/* Histogram macros builder. */
+	GString* ocl_macros = NULL;
+
+	/* Final compiler options. */
+	gchar* compiler_opts_final = NULL;
+
+	/* Complete source (macros + histogram source). */
+	const char* src_full[2];
+
+	/* Check number of bins. */
+	g_if_err_create_goto(*err, CLO_ERROR, num_bins == 0,
+		CLO_ERROR_ARGS, error_handler,
+		"Histogram must have at least one bin.");
+
+	/* Check options. */
+	if (options) {
+		opts = g_strsplit_set(options, ",", -1);
+		for (guint i = 0; opts[i] != NULL; i++) {
+
+			/* Ignore empty tokens. */
+			if (opts[i][0] == '\0') continue;
+
+			/* Parse current option, get key and value. */
+			opt = g_strsplit_set(opts[i], "=", 2);
+
+			/* Count number of tokens. */
+			for (num_toks = 0; opt[num_toks] != NULL; num_toks++);
+
+			/* If number of tokens is not 2 (key and value), throw error. */
+			g_if_err_create_goto(*err, CLO_ERROR, num_toks != 2,
+				CLO_ERROR_ARGS, error_handler,
+				"Invalid histogram option '%s'.", opts[i]);
+
+			/* Check key/value option. */
+			if (g_strcmp0("path", opt[0]) == 0) {
+				/* Histogram path. */
+				if (g_strcmp0("local", opt[1]) == 0) {
+					path = CLO_HISTOGRAM_PATH_LOCAL;
+					path_auto = CL_FALSE;
+				} else if (g_strcmp0("sort", opt[1]) == 0) {
+					path = CLO_HISTOGRAM_PATH_SORT;
+					path_auto = CL_FALSE;
+				} else {
+					g_if_err_create_goto(*err, CLO_ERROR,
+						g_strcmp0("auto", opt[1]) != 0,
+						CLO_ERROR_ARGS, error_handler,
+						"The 'path' histogram option must be 'local', "\
+						"'sort' or 'auto'.");
+				}
+			} else if (g_strcmp0("sort", opt[0]) == 0) {
+				/* Sort algorithm (points into the tokenized options,
+				 * which are kept until the sorter is created). */
+				sort_type = opts[i] + strlen("sort=");
+			} else {
+				g_if_err_create_goto(*err, CLO_ERROR, TRUE,
+					CLO_ERROR_ARGS, error_handler,
+					"Invalid histogram option key '%s'.", opt[0]);
+			}
+
+			/* Free token. */
+			g_strfreev(opt);
+			opt = NULL;
+
+		}
+	}
+
+	/* Get local memory size of first device in context. */
+	dev = ccl_context_get_device(ctx, 0, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	local_mem = ccl_device_get_info_scalar(
+		dev, CL_DEVICE_LOCAL_MEM_SIZE, cl_ulong, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Select path if not explicitly requested, otherwise check that the
+	 * local memory path is possible. */
+	if (path_auto) {
+		path = ((num_bins <= CLO_HISTOGRAM_LOCAL_MAX_BINS)
+				&& (num_bins * sizeof(cl_uint) <= local_mem))
+			? CLO_HISTOGRAM_PATH_LOCAL : CLO_HISTOGRAM_PATH_SORT;
+	} else {
+		g_if_err_create_goto(*err, CLO_ERROR,
+			(path == CLO_HISTOGRAM_PATH_LOCAL)
+				&& (num_bins * sizeof(cl_uint) > local_mem),
+			CLO_ERROR_ARGS, error_handler,
+			"%d bins do not fit in local memory, use the sort-based "\
+			"histogram path.", (int) num_bins);
+	}
+
+	/* Allocate memory for histogram object. */
+	hist = g_slice_new0(CloHistogram);
+
+	/* Keep data in histogram object. */
+	ccl_context_ref(ctx);
+	hist->ctx = ctx;
+	hist->elem_type = elem_type;
+	hist->num_bins = num_bins;
+	hist->path = path;
+
+	/* Create sorter for the sort-based path. */
+	if (path == CLO_HISTOGRAM_PATH_SORT) {
+		hist->sorter = clo_sort_new(sort_type, NULL, ctx, &bin_type,
+			NULL, NULL, NULL, compiler_opts, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+	}
+
+	/* Build histogram macros, which define the record type, if any,
+	 * and the binning macro. */
+	ocl_macros = g_string_new("");
+	if (clo_type_get_def(elem_type))
+		g_string_append(ocl_macros, clo_type_get_def(elem_type));
+	g_string_append_printf(ocl_macros,
+		"#define CLO_HISTOGRAM_BIN_GET(x) %s\n",
+		bin_get != NULL ? bin_get : "(x)");
+
+	/* Determine final compiler options. */
+	compiler_opts_final = g_strdup_printf(
+		" -DCLO_HISTOGRAM_ELEM_TYPE=%s -DCLO_HISTOGRAM_NUM_BINS=%u %s",
+		clo_type_get_name(elem_type), num_bins,
+		compiler_opts != NULL ? compiler_opts : "");
+
+	/* Create and build histogram program. */
+	src_full[0] = (const char*) ocl_macros->str;
+	src_full[1] = CLO_HISTOGRAM_SRC;
+	hist->prg = ccl_program_new_from_sources(
+		ctx, 2, src_full, NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	ccl_program_build(hist->prg, compiler_opts_final, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+
+	if (hist) { clo_histogram_destroy(hist); hist = NULL; }
+
+finish:
+
+	/* Free stuff. */
+	if (compiler_opts_final) g_free(compiler_opts_final);
+	if (ocl_macros) g_string_free(ocl_macros, TRUE);
+	g_strfreev(opts);
+	g_strfreev(opt);
+
+	/* Return histogram object. */
+	return hist;
+
+}
+
+/**
+ * Destroy a histogram object.
+ *
+ * @public @memberof clo_histogram
+ *
+ * @param[in] hist Histogram object to destroy.
+ * */
+void clo_histogram_destroy(CloHistogram* hist) {
+
+	/* Check histogram object is not NULL. */
+	g_return_if_fail(hist != NULL);
+
+	/* Destroy sorter. */
+	if (hist->sorter) clo_sort_destroy(hist->sorter);
+
+	/* Destroy program. */
+	if (hist->prg) ccl_program_destroy(hist->prg);
+
+	/* Unreference context. */
+	if (hist->ctx) ccl_context_unref(hist->ctx);
+
+	/* Free histogram object memory. */
+	g_slice_free(CloHistogram, hist);
+
+}
+
+/**
+ * Compute histogram of device data.
+ *
+ * @public @memberof clo_histogram
+ *
+ * @param[in] hist Histogram object.
+ * @param[in] cq_exec A valid command queue wrapper for kernel
+ * execution, cannot be `NULL`.
+ * @param[in] cq_comm A command queue wrapper for data transfers.
+ * If `NULL`, `cq_exec` will be used for data transfers.
+ * @param[in] data_in Elements to bin.
+ * @param[out] counts Location where to place the histogram, with one
+ * `cl_uint` count per bin.
+ * @param[in] numel Number of elements in `data_in`.
+ * @param[in] lws_max Max. local worksize. If 0, the local worksize
+ * will be automatically determined.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return An event which must terminate before the histogram is
+ * considered complete.
+ * */
+CCLEvent* clo_histogram_with_device_data(CloHistogram* hist,
+	CCLQueue* cq_exec, CCLQueue* cq_comm, CCLBuffer* data_in,
+	CCLBuffer* counts, size_t numel, size_t lws_max, GError** err) {
+
+	/* Make sure histogram object is not NULL. */
+	g_return_val_if_fail(hist != NULL, NULL);
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Make sure cq_exec is not NULL. */
+	g_return_val_if_fail(cq_exec != NULL, NULL);
+
+	/* If data transfer queue is NULL, use exec queue for data
+	 * transfers. */
+	if (cq_comm == NULL) cq_comm = cq_exec;
+
+	/* Use selected path. */
+	return hist->path == CLO_HISTOGRAM_PATH_LOCAL
+		? clo_histogram_local(
+			hist, cq_exec, data_in, counts, numel, lws_max, err)
+		: clo_histogram_sort(
+			hist, cq_exec, cq_comm, data_in, counts, numel, lws_max, err);
+
+}
+
+/**
+ * Compute histogram of host data. Device buffers will be created and
+ * destroyed by this function.
+ *
+ * @public @memberof clo_histogram
+ *
+ * @param[in] hist Histogram object.
+ * @param[in] cq_exec Command queue wrapper for kernel execution. If
+ * `NULL` a queue will be created.
+ * @param[in] cq_comm A command queue wrapper for data transfers.
+ * If `NULL`, `cq_exec` will be used for data transfers.
+ * @param[in] data_in Elements to bin.
+ * @param[out] counts Location where to place the histogram, with
+ * space for one count per bin.
+ * @param[in] numel Number of elements in `data_in`.
+ * @param[in] lws_max Max. local worksize. If 0, the local worksize
+ * will be automatically determined.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if histogram was successfully computed,
+ * `CL_FALSE` otherwise.
+ * */
+cl_bool clo_histogram_with_host_data(CloHistogram* hist,
+	CCLQueue* cq_exec, CCLQueue* cq_comm, void* data_in,
+	cl_uint* counts, size_t numel, size_t lws_max, GError** err) {
+
+	/* Make sure histogram object is not NULL. */
+	g_return_val_if_fail(hist != NULL, CL_FALSE);
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+	/* Function return status. */
+	cl_bool status;
+
+	/* OpenCL wrapper objects. */
+	CCLBuffer* data_in_dev = NULL;
+	CCLBuffer* counts_dev = NULL;
+	CCLQueue* intern_queue = NULL;
+	CCLDevice* dev = NULL;
+	CCLEvent* evt = NULL;
+
+	/* Event wait list. */
+	CCLEventWaitList ewl = NULL;
+
+	/* Internal error object. */
+	GError* err_internal = NULL;
+
+	/* Determine data size. */
+	size_t data_size = numel * clo_type_sizeof(hist->elem_type);
+
+	/* If execution queue is NULL, create own queue using first device
+	 * in context. */
+	if (cq_exec == NULL) {
+		/* Get first device in context. */
+		dev = ccl_context_get_device(hist->ctx, 0, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		/* Create queue. */
+		intern_queue = ccl_queue_new(hist->ctx, dev, 0, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		cq_exec = intern_queue;
+	}
+
+	/* If data transfer queue is NULL, use exec queue for data
+	 * transfers. */
+	if (cq_comm == NULL) cq_comm = cq_exec;
+
+	/* Create device buffers. */
+	data_in_dev = ccl_buffer_new(hist->ctx, CL_MEM_READ_ONLY,
+		MAX(data_size, 1), NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	counts_dev = ccl_buffer_new(hist->ctx, CL_MEM_READ_WRITE,
+		hist->num_bins * sizeof(cl_uint), NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Transfer data to device. */
+	if (numel > 0) {
+		evt = ccl_buffer_enqueue_write(data_in_dev, cq_comm, CL_FALSE,
+			0, data_size, data_in, NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "write_histogram");
+
+		/* Explicitly wait for transfer (some OpenCL implementations
+		 * don't respect CL_TRUE in data transfers). */
+		ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+	}
+
+	/* Compute histogram with device data. */
+	evt = clo_histogram_with_device_data(hist, cq_exec, cq_comm,
+		data_in_dev, counts_dev, numel, lws_max, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Transfer histogram back to host. */
+	evt = ccl_buffer_enqueue_read(counts_dev, cq_comm, CL_FALSE, 0,
+		hist->num_bins * sizeof(cl_uint), counts,
+		ccl_ewl(&ewl, evt, NULL), &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	ccl_event_set_name(evt, "read_histogram");
+
+	/* Explicitly wait for transfer (some OpenCL implementations don't
+	 * respect CL_TRUE in data transfers). */
+	ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	status = CL_TRUE;
+	goto finish;
+
+error_handler:
+
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	status = CL_FALSE;
+
+finish:
+
+	/* Release temporary objects. */
+	if (data_in_dev) ccl_buffer_destroy(data_in_dev);
+	if (counts_dev) ccl_buffer_destroy(counts_dev);
+	if (intern_queue) ccl_queue_destroy(intern_queue);
+
+	/* Return function status. */
+	return status;
+
+}
+
+/**
+ * Get number of bins.
+ *
+ * @public @memberof clo_histogram
+ *
+ * @param[in] hist Histogram object.
+ * @return Number of bins.
+ * */
+cl_uint clo_histogram_get_num_bins(CloHistogram* hist) {
+
+	/* Make sure histogram object is not NULL. */
+	g_return_val_if_fail(hist != NULL, 0);
+
+	/* Return number of bins. */
+	return hist->num_bins;
+
+}
+
+/**
+ * Get path used to compute the histogram.
+ *
+ * @public @memberof clo_histogram
+ *
+ * @param[in] hist Histogram object.
+ * @return Path used to compute the histogram.
+ * */
+CloHistogramPath clo_histogram_get_path(CloHistogram* hist) {
+
+	/* Make sure histogram object is not NULL. */
+	g_return_val_if_fail(hist != NULL, CLO_HISTOGRAM_PATH_LOCAL);
+
+	/* Return path. */
+	return hist->path;
+
+}
+
+/**
+ * Get program wrapper associated with histogram object.
+ *
+ * @public @memberof clo_histogram
+ *
+ * @param[in] hist Histogram object.
+ * @return Program wrapper associated with histogram object.
+ * */
+CCLProgram* clo_histogram_get_program(CloHistogram* hist) {
+
+	/* Make sure histogram object is not NULL. */
+	g_return_val_if_fail(hist != NULL, NULL);
+
+	/* Return program wrapper. */
+	return hist->prg;
+
+}
+
+/** @} */
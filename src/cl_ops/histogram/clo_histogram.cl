@@ -0,0 +1,208 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Histogram implementation.
+ *
+ * These kernels expect the following constants and macros to be
+ * defined:
+ *
+ * * `CLO_HISTOGRAM_ELEM_TYPE` - Type of elements to bin.
+ * * `CLO_HISTOGRAM_NUM_BINS` - Number of bins.
+ * * `CLO_HISTOGRAM_BIN_GET(x)` - Obtains the bin of element `x`, as
+ * an integer or floating-point value without side effects. Elements
+ * with negative (or NaN) bins, or with bins larger or equal to
+ * `CLO_HISTOGRAM_NUM_BINS`, are not counted.
+ *
+ */
+
+/* Get bin of element, mapping elements which are not counted to
+ * UINT_MAX. The bin is range checked in its own type before being
+ * converted, since converting negative or out of range floating-point
+ * values to uint is undefined. */
+#define CLO_HISTOGRAM_BIN(x) \
+	(((CLO_HISTOGRAM_BIN_GET(x)) >= 0) \
+		&& ((CLO_HISTOGRAM_BIN_GET(x)) < CLO_HISTOGRAM_NUM_BINS) \
+	? (uint) (CLO_HISTOGRAM_BIN_GET(x)) : UINT_MAX)
+
+/**
+ * Builds one sub-histogram per workgroup in local memory. Each
+ * work-item bins elements with a stride of the global worksize.
+ *
+ * @param data_in Elements to bin.
+ * @param partial Sub-histograms, one per workgroup (or the final
+ * histogram if there is only one workgroup).
+ * @param lhist Local memory sub-histogram, with
+ * `CLO_HISTOGRAM_NUM_BINS` counters.
+ * @param numel Number of elements to bin.
+ */
+__kernel void histogramLocal(
+			__global CLO_HISTOGRAM_ELEM_TYPE *data_in,
+			__global uint *partial,
+			__local uint *lhist,
+			uint numel)
+{
+
+	uint lid = get_local_id(0);
+	uint lsize = get_local_size(0);
+	uint bin;
+
+	/* Clear local sub-histogram. */
+	for (uint b = lid; b < CLO_HISTOGRAM_NUM_BINS; b += lsize)
+		lhist[b] = 0;
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	/* Bin elements. */
+	for (uint i = get_global_id(0); i < numel; i += get_global_size(0)) {
+		bin = CLO_HISTOGRAM_BIN(data_in[i]);
+		if (bin != UINT_MAX) atomic_inc(&lhist[bin]);
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	/* Store sub-histogram of current workgroup. */
+	partial += get_group_id(0) * CLO_HISTOGRAM_NUM_BINS;
+	for (uint b = lid; b < CLO_HISTOGRAM_NUM_BINS; b += lsize)
+		partial[b] = lhist[b];
+
+}
+
+/**
+ * Merges the sub-histograms, with one work-item per bin.
+ *
+ * @param partial Sub-histograms, one per workgroup of the
+ * `histogramLocal` kernel.
+ * @param counts Final histogram.
+ * @param num_partial Number of sub-histograms.
+ */
+__kernel void histogramMerge(
+			__global uint *partial,
+			__global uint *counts,
+			uint num_partial)
+{
+
+	uint b = get_global_id(0);
+	uint sum = 0;
+
+	if (b < CLO_HISTOGRAM_NUM_BINS) {
+		for (uint g = 0; g < num_partial; g++)
+			sum += partial[g * CLO_HISTOGRAM_NUM_BINS + b];
+		counts[b] = sum;
+	}
+
+}
+
+/**
+ * Obtains the bin of each element, so that bins can be sorted.
+ * Elements which are not counted get bin `UINT_MAX`, so that they
+ * are moved to the end of the sorted bins. Bins are padded with
+ * `UINT_MAX` up to the given number of sorted bins, so that sort
+ * algorithms which only sort powers of two can be used.
+ *
+ * @param data_in Elements to bin.
+ * @param bins Bins of elements.
+ * @param numel Number of elements to bin.
+ * @param numel_pad Number of bins to sort, including padding.
+ */
+__kernel void histogramBins(
+			__global CLO_HISTOGRAM_ELEM_TYPE *data_in,
+			__global uint *bins,
+			uint numel,
+			uint numel_pad)
+{
+
+	uint i = get_global_id(0);
+
+	if (i < numel)
+		bins[i] = CLO_HISTOGRAM_BIN(data_in[i]);
+	else if (i < numel_pad)
+		bins[i] = UINT_MAX;
+
+}
+
+/**
+ * Clears the histogram and the run starts.
+ *
+ * @param counts Histogram.
+ * @param starts Start of run of each bin in the sorted bins.
+ */
+__kernel void histogramClear(
+			__global uint *counts,
+			__global uint *starts)
+{
+
+	uint b = get_global_id(0);
+
+	if (b < CLO_HISTOGRAM_NUM_BINS) {
+		counts[b] = 0;
+		starts[b] = 0;
+	}
+
+}
+
+/**
+ * Finds the boundaries of runs of equal bins in the sorted bins. The
+ * first element of a run stores its index in `starts`, and the last
+ * element of a run stores its index plus one in `counts`. Each
+ * location is thus written by a single work-item.
+ *
+ * @param bins Sorted bins.
+ * @param counts Run ends (exclusive) of each bin.
+ * @param starts Run starts of each bin.
+ * @param numel Number of sorted bins.
+ */
+__kernel void histogramRuns(
+			__global uint *bins,
+			__global uint *counts,
+			__global uint *starts,
+			uint numel)
+{
+
+	uint i = get_global_id(0);
+	uint bin;
+
+	if (i < numel) {
+		bin = bins[i];
+		if (bin != UINT_MAX) {
+			if ((i == 0) || (bins[i - 1] != bin))
+				starts[bin] = i;
+			if ((i == numel - 1) || (bins[i + 1] != bin))
+				counts[bin] = i + 1;
+		}
+	}
+
+}
+
+/**
+ * Obtains the histogram from the run boundaries of each bin. Empty
+ * bins have both boundaries at zero.
+ *
+ * @param counts Run ends of each bin, replaced by the histogram.
+ * @param starts Run starts of each bin.
+ */
+__kernel void histogramCounts(
+			__global uint *counts,
+			__global uint *starts)
+{
+
+	uint b = get_global_id(0);
+
+	if (b < CLO_HISTOGRAM_NUM_BINS)
+		counts[b] -= starts[b];
+
+}
@@ -0,0 +1,111 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Histogram class declarations.
+ * */
+
+#ifndef _CLO_HISTOGRAM_H_
+#define _CLO_HISTOGRAM_H_
+
+#include "cl_ops/clo_common.h"
+#include "cl_ops/clo_sort_abstract.h"
+
+/** The histogram kernels source. */
+#define CLO_HISTOGRAM_SRC "@HISTOGRAM_SRC@"
+
+/* Histogram kernel names. */
+#define CLO_HISTOGRAM_KNAME_LOCAL "histogramLocal"
+#define CLO_HISTOGRAM_KNAME_MERGE "histogramMerge"
+#define CLO_HISTOGRAM_KNAME_BINS "histogramBins"
+#define CLO_HISTOGRAM_KNAME_CLEAR "histogramClear"
+#define CLO_HISTOGRAM_KNAME_RUNS "histogramRuns"
+#define CLO_HISTOGRAM_KNAME_COUNTS "histogramCounts"
+
+/* Maximum number of bins for which the local memory path is
+ * automatically selected. */
+#define CLO_HISTOGRAM_LOCAL_MAX_BINS 4096
+
+/* Maximum number of workgroups (and thus of sub-histograms) in the
+ * local memory path. */
+#define CLO_HISTOGRAM_MAX_WGS 256
+
+/* Sort algorithm used by default in the sort-based path, which sorts
+ * any number of elements. */
+#define CLO_HISTOGRAM_SORT_DEFAULT "samplesort"
+
+/**
+ * @defgroup CLO_HISTOGRAM Histograms
+ *
+ * This module counts the number of elements which fall in each of a
+ * given number of bins. The bin of each element is obtained with a
+ * user-supplied binning macro. Two paths are available: for small
+ * bin counts, each workgroup builds a sub-histogram in local memory
+ * with atomic increments, and sub-histograms are merged in global
+ * memory; for huge bin counts, which do not fit in local memory, the
+ * bins of the elements are sorted and the counts are obtained from
+ * the boundaries of runs of equal bins.
+ *
+ * @{
+ */
+
+/**
+ * Histogram computation path.
+ * */
+typedef enum clo_histogram_path {
+
+	/** Local memory sub-histograms with atomics, plus a global
+	 * merge. */
+	CLO_HISTOGRAM_PATH_LOCAL = 0,
+
+	/** Sort bins and count runs of equal bins. */
+	CLO_HISTOGRAM_PATH_SORT = 1
+
+} CloHistogramPath;
+
+/** @} */
+
+/* Create a new histogram object. */
+CloHistogram* clo_histogram_new(CCLContext* ctx, CloType elem_type,
+	cl_uint num_bins, const char* bin_get, const char* options,
+	const char* compiler_opts, GError** err);
+
+/* Destroy a histogram object. */
+void clo_histogram_destroy(CloHistogram* hist);
+
+/* Compute histogram of device data. */
+CCLEvent* clo_histogram_with_device_data(CloHistogram* hist,
+	CCLQueue* cq_exec, CCLQueue* cq_comm, CCLBuffer* data_in,
+	CCLBuffer* counts, size_t numel, size_t lws_max, GError** err);
+
+/* Compute histogram of host data. */
+cl_bool clo_histogram_with_host_data(CloHistogram* hist,
+	CCLQueue* cq_exec, CCLQueue* cq_comm, void* data_in,
+	cl_uint* counts, size_t numel, size_t lws_max, GError** err);
+
+/* Get number of bins. */
+cl_uint clo_histogram_get_num_bins(CloHistogram* hist);
+
+/* Get path used to compute the histogram. */
+CloHistogramPath clo_histogram_get_path(CloHistogram* hist);
+
+/* Get program wrapper associated with histogram object. */
+CCLProgram* clo_histogram_get_program(CloHistogram* hist);
+
+#endif
@@ -52,80 +52,141 @@ struct clo_rng {
 	 * */
 	size_t size_in_device;
 
+	/**
+	 * Type of seed.
+	 * @private
+	 * */
+	CloRngSeedType seed_type;
+
+	/**
+	 * Size of each seed.
+	 * @private
+	 * */
+	size_t seed_size;
+
+	/**
+	 * Number of seeds per block in the seeds buffer.
+	 * @private
+	 * */
+	size_t block_size;
+
+	/**
+	 * Number of seeds.
+	 * @private
+	 * */
+	size_t seeds_count;
+
+	/**
+	 * Number of seeds already initialized in device, from the start
+	 * of the seeds buffer.
+	 * @private
+	 * */
+	size_t seeds_init;
+
+	/**
+	 * Number of seeds the device seeds buffer can hold.
+	 * @private
+	 * */
+	size_t capacity;
+
+	/**
+	 * Base seed.
+	 * @private
+	 * */
+	cl_ulong main_seed;
+
+	/**
+	 * Seed initialization program (::CLO_RNG_SEED_DEV_GID only).
+	 * @private
+	 * */
+	CCLProgram* prg_init;
+
+	/**
+	 * Host seed generator (::CLO_RNG_SEED_HOST_MT only).
+	 * @private
+	 * */
+	GRand* rng_host;
+
 };
 
+/**
+ * @internal
+ * Block size definition prepended to RNG sources with SoA layout.
+ * */
+#define CLO_RNG_SOA_DEFINE \
+	"#define CLO_RNG_SOA_BLOCK " G_STRINGIFY(CLO_RNG_SOA_BLOCK) "\n"
+
 /**
  * Information about the random number generation algorithms.
  * */
 const struct clo_rng_info clo_rng_infos[] = {
-	{"lcg", CLO_RNG_SRC_LCG, 8},
-	{"xorshift64", CLO_RNG_SRC_XORSHIFT64, 8},
-	{"xorshift128", CLO_RNG_SRC_XORSHIFT128, 16},
-	{"mwc64x", CLO_RNG_SRC_MWC64X, 8},
-	{"parkmiller", CLO_RNG_SRC_PARKMILLER, 4},
-	{"tauslcg", CLO_RNG_SRC_TAUSLCG, 16},
-	{NULL, NULL, 0}
+	{"lcg", CLO_RNG_SRC_LCG, 8, 1},
+	{"xorshift64", CLO_RNG_SRC_XORSHIFT64, 8, 1},
+	{"xorshift128", CLO_RNG_SRC_XORSHIFT128, 16, 1},
+	{"mwc64x", CLO_RNG_SRC_MWC64X, 8, 1},
+	{"parkmiller", CLO_RNG_SRC_PARKMILLER, 4, 1},
+	{"tauslcg", CLO_RNG_SRC_TAUSLCG, 16, 1},
+	{"xorshift128_soa", CLO_RNG_SOA_DEFINE CLO_RNG_SRC_SOA
+		CLO_RNG_SRC_XORSHIFT128, 16, CLO_RNG_SOA_BLOCK},
+	{"tauslcg_soa", CLO_RNG_SOA_DEFINE CLO_RNG_SRC_SOA
+		CLO_RNG_SRC_TAUSLCG, 16, CLO_RNG_SOA_BLOCK},
+	{NULL, NULL, 0, 0}
 };
 
 /**
  * @internal
- * Perform seed initialization in device.
+ * Get the effective seed hash macro code.
  *
- * @param[in] ctx Context wrapper object.
+ * @param[in] hash Seed hash macro code, may be `NULL` or empty.
+ * @return The effective seed hash macro code, defaulting to no hash.
+ * */
+static const char* clo_rng_hash_eff(const char* hash) {
+
+	return ((hash) && (*hash)) ? hash : "x";
+
+}
+
+/**
+ * @internal
+ * Perform initialization of seeds not yet initialized in device, using
+ * the `clo_rng_init` kernel of the given program.
+ *
+ * @param[in] rng RNG object.
+ * @param[in] prg Program containing the `clo_rng_init` kernel.
  * @param[in] cq Command-queue wrapper object.
- * @param[in] rng_src Source of the selected RNG.
- * @param[in] hash Seed hash macro code. If `NULL` defaults to no hash.
- * @param[in] seeds_count Number of seeds.
- * @param[in] seed_size Size of each seed.
- * @param[in] main_seed Base seed.
  * @param[out] err Return location for a GError, or `NULL` if error
  * reporting is to be ignored.
- * @return Buffer of in-device seeds.
+ * @return Event wrapper associated with the seeds initialization
+ * kernel, or `NULL` if no seeds required initialization or if an error
+ * occurred.
  * */
-static CCLBuffer* clo_rng_device_seed_init(CCLContext* ctx,
-	CCLQueue* cq, const char* rng_src, const char* hash,
-	size_t seeds_count, size_t seed_size, cl_ulong main_seed,
-	GError** err) {
+static CCLEvent* clo_rng_device_seed_init(CloRng* rng,
+	CCLProgram* prg, CCLQueue* cq, GError** err) {
 
-	/* Program wrapper object. */
-	CCLProgram* prg = NULL;
-	/* Buffer of in-device seeds. */
-	CCLBuffer* seeds = NULL;
+	/* Event wrapper. */
+	CCLEvent* evt = NULL;
 	/* Internal error handling object. */
 	GError* err_internal = NULL;
-	/* Effective seed hash macro code. */
-	const char* hash_eff;
-	/* Source code to prepend to init kernel. */
-	gchar* init_src = NULL;
-
-	/* Determine effective seed hash macro code. */
-	if ((hash) && (*hash))
-		hash_eff = hash;
-	else
-		hash_eff = "x";
-
-	/* Construct seeds init source code. */
-	init_src = g_strconcat("#define CLO_RNG_HASH(x) ", hash_eff, "\n",
-		rng_src, CLO_RNG_SRC_INIT, NULL);
-
-	/* Create in-device seeds buffer. */
-	seeds = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
-		seeds_count * seed_size, NULL, &err_internal);
-	g_if_err_propagate_goto(err, err_internal, error_handler);
-
-	/* Create seed initialization program. */
-	prg = ccl_program_new_from_source(ctx, init_src, &err_internal);
-	g_if_err_propagate_goto(err, err_internal, error_handler);
-
-	/* Build seed initialization program. */
-	ccl_program_build(prg, NULL, &err_internal);
+	/* Offset and number of seeds to initialize. */
+	size_t offset, count;
+
+	/* Only initialize seeds not yet initialized. */
+	if (rng->seeds_count <= rng->seeds_init) goto finish;
+	offset = rng->seeds_init;
+	count = rng->seeds_count - rng->seeds_init;
+
+	/* Enqueue seed initialization kernel. The global work offset keeps
+	 * the GID-based seeds the same as if they had all been initialized
+	 * at once. */
+	evt = ccl_program_enqueue_kernel(prg, "clo_rng_init", cq, 1,
+		&offset, &count, NULL, NULL, &err_internal,
+		ccl_arg_priv(rng->main_seed, cl_ulong), rng->seeds_device,
+		NULL);
 	g_if_err_propagate_goto(err, err_internal, error_handler);
+	ccl_event_set_name(evt, "CLO: init seeds");
 
-	/* Enqueue seed initialization kernel. */
-	ccl_program_enqueue_kernel(prg, "clo_rng_init", cq, 1, 0,
-		&seeds_count, NULL, NULL, &err_internal,
-		ccl_arg_priv(main_seed, cl_ulong), seeds, NULL);
-	g_if_err_propagate_goto(err, err_internal, error_handler);
+	/* Seeds are now initialized up to the current number of seeds. */
+	rng->seeds_init = rng->seeds_count;
 
 	/* If we got here, everything is OK. */
 	g_assert(err == NULL || *err == NULL);
@@ -135,46 +196,36 @@ error_handler:
 
 	/* If we got here there was an error, verify that it is so. */
 	g_assert(err == NULL || *err != NULL);
-
-	/* If an error occurred make sure the seeds buffer is destroyed and
-	 * set to NULL. */
-	if (seeds) ccl_buffer_destroy(seeds);
-	seeds = NULL;
+	evt = NULL;
 
 finish:
 
-	/* Free stuff. */
-	if (prg) ccl_program_destroy(prg);
-	if (init_src) g_free(init_src);
-
-	/* Return seeds buffer. */
-	return seeds;
+	/* Return event wrapper. */
+	return evt;
 
 }
 
 /**
  * @internal
- * Perform seed initialization in host, then transfer to device.
+ * Perform initialization of seeds not yet initialized in device, by
+ * generating them in host, then transferring them to device. The host
+ * Mersenne Twister stream is kept, so that seeds are the same as if
+ * they had all been initialized at once.
  *
- * @param[in] ctx Context wrapper object.
+ * @param[in] rng RNG object.
  * @param[in] cq Command-queue wrapper object.
- * @param[in] seeds_count Number of seeds.
- * @param[in] seed_size Size of each seed.
- * @param[in] main_seed Base seed.
  * @param[out] err Return location for a GError, or `NULL` if error
  * reporting is to be ignored.
- * @return Buffer of in-device seeds.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE`
+ * otherwise.
  * */
-static CCLBuffer* clo_rng_host_seed_init(CCLContext* ctx, CCLQueue* cq,
-	size_t seeds_count, size_t seed_size, cl_ulong main_seed,
+static cl_bool clo_rng_host_seed_init(CloRng* rng, CCLQueue* cq,
 	GError** err) {
 
-	/* In-device seeds buffer. */
-	CCLBuffer* seeds_dev;
-	/* Random number generator. */
-	GRand* rng_host = NULL;
+	/* Function return status. */
+	cl_bool status;
 	/* Size in bytes of seeds vector. */
-	size_t seeds_vec_size;
+	size_t seeds_vec_size = 0;
 	/* Host seeds vector. */
 	void* seeds_host = NULL;
 	/* Internal error handling object. */
@@ -182,54 +233,175 @@ static CCLBuffer* clo_rng_host_seed_init(CCLContext* ctx, CCLQueue* cq,
 	/* Event wrapper. */
 	CCLEvent* evt;
 
+	/* Only initialize seeds not yet initialized. */
+	if (rng->seeds_count <= rng->seeds_init) {
+		status = CL_TRUE;
+		goto finish;
+	}
+
 	/* Determine size in bytes of seeds vector. */
-	seeds_vec_size = seed_size * seeds_count;
+	seeds_vec_size =
+		rng->seed_size * (rng->seeds_count - rng->seeds_init);
 	/* Allocate memory for host seeds vector. */
 	seeds_host = g_slice_alloc(seeds_vec_size);
 
-	/* Create in-device seeds buffer. */
-	seeds_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, seeds_vec_size,
-		NULL, &err_internal);
-	g_if_err_propagate_goto(err, err_internal, error_handler);
-
-	/* Initialize generator. */
-	rng_host = g_rand_new_with_seed(main_seed);
-
 	/* Generate seeds. */
 	for (cl_uint i = 0; i < seeds_vec_size / sizeof(guint32); i++) {
-		guint32 rand_value = g_rand_int(rng_host);
+		guint32 rand_value = g_rand_int(rng->rng_host);
 		void* dest = ((unsigned char*) seeds_host) + i * sizeof(guint32);
 		g_memmove(dest, &rand_value, sizeof(guint32));
 	}
 
 	/* Copy seeds to device. */
-	evt = ccl_buffer_enqueue_write(seeds_dev, cq, CL_TRUE, 0,
-		seeds_vec_size, seeds_host, NULL, &err_internal);
+	evt = ccl_buffer_enqueue_write(rng->seeds_device, cq, CL_TRUE,
+		rng->seeds_init * rng->seed_size, seeds_vec_size, seeds_host,
+		NULL, &err_internal);
 	g_if_err_propagate_goto(err, err_internal, error_handler);
 	ccl_event_set_name(evt, "CLO: write seeds");
 
+	/* Seeds are now initialized up to the current number of seeds. */
+	rng->seeds_init = rng->seeds_count;
+
 	/* If we got here, everything is OK. */
 	g_assert(err == NULL || *err == NULL);
+	status = CL_TRUE;
 	goto finish;
 
 error_handler:
 
 	/* If we got here there was an error, verify that it is so. */
 	g_assert(err == NULL || *err != NULL);
-
-	/* If an error occurred make sure the seeds buffer is destroyed and
-	 * set to NULL. */
-	if (seeds_dev) ccl_buffer_destroy(seeds_dev);
-	seeds_dev = NULL;
+	status = CL_FALSE;
 
 finish:
 
 	/* Free stuff. */
 	if (seeds_host) g_slice_free1(seeds_vec_size, seeds_host);
-	if (rng_host) g_rand_free(rng_host);
 
-	/* Return seeds buffer. */
-	return seeds_dev;
+	/* Return status. */
+	return status;
+
+}
+
+/**
+ * @internal
+ * Reallocate the in-device seeds buffer so that it can hold the given
+ * number of seeds. Initialized seeds are kept.
+ *
+ * @param[in] rng RNG object.
+ * @param[in] capacity New capacity, in number of seeds.
+ * @param[in] cq Command-queue wrapper object.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE`
+ * otherwise.
+ * */
+static cl_bool clo_rng_realloc(CloRng* rng, size_t capacity,
+	CCLQueue* cq, GError** err) {
+
+	/* Function return status. */
+	cl_bool status;
+	/* Context wrapper. */
+	CCLContext* ctx;
+	/* New in-device seeds buffer. */
+	CCLBuffer* seeds_dev = NULL;
+	/* Internal error handling object. */
+	GError* err_internal = NULL;
+	/* Event wrapper. */
+	CCLEvent* evt;
+
+	/* Seeds of external seed types are managed by the client. */
+	g_if_err_create_goto(*err, CLO_ERROR,
+		(rng->seed_type == CLO_RNG_SEED_EXT_DEV)
+			|| (rng->seed_type == CLO_RNG_SEED_EXT_HOST),
+		CLO_ERROR_ARGS, error_handler,
+		"Seeds buffer of external seed types cannot be enlarged.");
+
+	/* Get context from command queue. */
+	ctx = ccl_queue_get_context(cq, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Create new in-device seeds buffer. */
+	seeds_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+		capacity * rng->seed_size, NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Copy initialized seeds to new buffer. */
+	if (rng->seeds_init > 0) {
+		evt = ccl_buffer_enqueue_copy(rng->seeds_device, seeds_dev, cq,
+			0, 0, rng->seeds_init * rng->seed_size, NULL,
+			&err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "CLO: copy seeds");
+	}
+
+	/* Replace old buffer with new one. */
+	ccl_buffer_destroy(rng->seeds_device);
+	rng->seeds_device = seeds_dev;
+	rng->capacity = capacity;
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	status = CL_TRUE;
+	goto finish;
+
+error_handler:
+
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	status = CL_FALSE;
+
+	/* Destroy new buffer, if created. */
+	if (seeds_dev) ccl_buffer_destroy(seeds_dev);
+
+finish:
+
+	/* Return status. */
+	return status;
+
+}
+
+/**
+ * @internal
+ * Initialize seeds not yet initialized in device, according to the
+ * seed type. Nothing is done for ::CLO_RNG_SEED_DEV_GID_FUSED, since
+ * the client program is required (see clo_rng_init_seeds()).
+ *
+ * @param[in] rng RNG object.
+ * @param[in] cq Command-queue wrapper object.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE`
+ * otherwise.
+ * */
+static cl_bool clo_rng_seed_init(CloRng* rng, CCLQueue* cq,
+	GError** err) {
+
+	/* Internal error handling object. */
+	GError* err_internal = NULL;
+
+	switch (rng->seed_type) {
+		case CLO_RNG_SEED_DEV_GID:
+			clo_rng_device_seed_init(
+				rng, rng->prg_init, cq, &err_internal);
+			break;
+		case CLO_RNG_SEED_HOST_MT:
+			clo_rng_host_seed_init(rng, cq, &err_internal);
+			break;
+		default:
+			break;
+	}
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	return CL_TRUE;
+
+error_handler:
+
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	return CL_FALSE;
 
 }
 
@@ -238,19 +410,30 @@ finish:
  *
  * @public @memberof clo_rng
  *
- * @param[in] type Type of RNG: lcg, xorshift64, xorshift128, mwc64x.
- * @param[in] seed_type Type of seed.
+ * @param[in] type Type of RNG: lcg, xorshift64, xorshift128, mwc64x,
+ * parkmiller, tauslcg. The `_soa` suffixed types (xorshift128_soa,
+ * tauslcg_soa) keep the same algorithm, but store states using a
+ * structure-of-arrays layout.
+ * @param[in] seed_type Type of seed. For the
+ * ::CLO_RNG_SEED_DEV_GID_FUSED seed type, the seeds buffer is created
+ * but left uninitialized; the client must build a program with the
+ * source returned by clo_rng_get_source() and then call
+ * clo_rng_init_seeds() before generating any random numbers.
  * @param[in] seeds Array of seeds. Must be `NULL` for
- * ::CLO_RNG_SEED_DEV_GID and ::CLO_RNG_SEED_HOST_MT seed types. For
+ * ::CLO_RNG_SEED_DEV_GID, ::CLO_RNG_SEED_DEV_GID_FUSED and
+ * ::CLO_RNG_SEED_HOST_MT seed types. For
  * the ::CLO_RNG_SEED_EXT_HOST seed type, it must be an array of a
  * minimum of `seeds_count` values of _seed size_ each. Finally, for
  * ::CLO_RNG_SEED_EXT_DEV seed types, the `seeds` parameter must be a
  * device buffer wrapper, `CCLBuffer*`, of size at least `seeds_count` *
  * _seed size_. _seed size_ is the seed size required by the selected
  * RNG `type`.
- * @param[in] seeds_count Number of seeds.
+ * @param[in] seeds_count Number of seeds. It is rounded up to a
+ * multiple of the block size of the selected RNG `type` (see
+ * clo_rng_info::block_size), which external seeds must account for.
  * @param[in] main_seed Base seed (ignored for external seed types).
- * @param[in] hash Hash for ::CLO_RNG_SEED_DEV_GID seed type.
+ * @param[in] hash Hash for ::CLO_RNG_SEED_DEV_GID and
+ * ::CLO_RNG_SEED_DEV_GID_FUSED seed types.
  * @param[in] ctx Context wrapper (not required for
  * ::CLO_RNG_SEED_EXT_DEV seed type).
  * @param[in] cq Command queue wrapper (not required for
@@ -269,123 +452,162 @@ CloRng* clo_rng_new(const char* type, CloRngSeedType seed_type,
 	/* The new RNG object. */
 	CloRng* rng = NULL;
 
-	/* Device seeds. */
-	CCLBuffer* dev_seeds = NULL;
+	/* Information about the selected RNG. */
+	const struct clo_rng_info* info = NULL;
 
 	/* Size of external dev. buffer (for CLO_RNG_SEED_EXT_DEV only). */
 	size_t ext_buf_size;
 
+	/* Seed initialization program source. */
+	gchar* init_src = NULL;
+
 	/* Internal error object. */
 	GError* err_internal = NULL;
 
-	/* Search in the list of known scan classes. */
+	/* Search in the list of known RNGs. */
 	for (guint i = 0; clo_rng_infos[i].name != NULL; ++i) {
 		if (g_strcmp0(type, clo_rng_infos[i].name) == 0) {
-			/* If found, return an new instance.*/
-
-			/* Deal with seeds. */
-			switch (seed_type) {
-				case CLO_RNG_SEED_DEV_GID:
-					/* Check that seeds parameter is NULL. */
-					g_if_err_create_goto(*err, CLO_ERROR,
-						seeds != NULL, CLO_ERROR_ARGS, error_handler,
-						"The DEV_GID seed type expects a NULL seeds "\
-						"parameter.");
-					/* Initialize seeds in device using GID. */
-					dev_seeds = clo_rng_device_seed_init(ctx, cq,
-						clo_rng_infos[i].src, hash, seeds_count,
-						clo_rng_infos[i].seed_size, main_seed,
-						&err_internal);
-					g_if_err_propagate_goto(err, err_internal,
-						error_handler);
-					/* Get out of switch. */
-					break;
-				case CLO_RNG_SEED_HOST_MT:
-					/* Check that seeds parameter is NULL. */
-					g_if_err_create_goto(*err, CLO_ERROR,
-						seeds != NULL, CLO_ERROR_ARGS, error_handler,
-						"The HOST_MT seed type expects a NULL seeds "\
-						"parameter.");
-					/* Initialize seeds in host and copy them to
-					 * device. */
-					dev_seeds = clo_rng_host_seed_init(ctx, cq,
-						seeds_count, clo_rng_infos[i].seed_size,
-						main_seed, &err_internal);
-					g_if_err_propagate_goto(err, err_internal,
-						error_handler);
-					/* Get out of switch. */
-					break;
-				case CLO_RNG_SEED_EXT_DEV:
-					/* Check that external device buffer has the
-					 * required size. */
-					ext_buf_size = ccl_memobj_get_info_scalar(
-						(CCLMemObj*) seeds, CL_MEM_SIZE, size_t,
-						&err_internal);
-					g_if_err_propagate_goto(err, err_internal,
-						error_handler);
-					g_if_err_create_goto(*err, CLO_ERROR,
-						ext_buf_size < seeds_count * clo_rng_infos[i].seed_size,
-						CLO_ERROR_ARGS, error_handler,
-						"The '%s' RNG type requires a buffer of at " \
-						"least %d bytes. The size of the proviced " \
-						"external device seeds buffer is only %d bytes.",
-						type, (int) (seeds_count * clo_rng_infos[i].seed_size),
-						(int) ext_buf_size);
-					/* Keep external device seeds as the RNG seeds.
-					 * Increase reference count, client will have to
-					 * destroy external buffer himself. */
-					ccl_buffer_ref((CCLBuffer*) seeds);
-					dev_seeds = (CCLBuffer*) seeds;
-					/* Get out of switch. */
-					break;
-				case CLO_RNG_SEED_EXT_HOST:
-					/* Check that seeds is not NULL. */
-					g_if_err_create_goto(*err, CLO_ERROR,
-						seeds == NULL, CLO_ERROR_ARGS, error_handler,
-						"The EXT_HOST seed type expects a non-NULL "\
-						"seeds parameter.");
-					/* Create device buffer and copy seeds to device. */
-					dev_seeds = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
-						seeds_count * clo_rng_infos[i].seed_size, NULL,
-						&err_internal);
-					g_if_err_propagate_goto(err, err_internal,
-						error_handler);
-					ccl_buffer_enqueue_write(dev_seeds , cq, CL_TRUE, 0,
-						seeds_count * clo_rng_infos[i].seed_size,
-						seeds, NULL, &err_internal);
-					g_if_err_propagate_goto(err, err_internal,
-						error_handler);
-					/* Get out of switch. */
-					break;
-				default:
-					/* An invalid seed type was specified, throw error. */
-					g_if_err_create_goto(*err, CLO_ERROR, TRUE,
-						CLO_ERROR_ARGS, error_handler,
-						"Unknown seed type.");
-			}
-
-			/* Allocate memory for RNG object. */
-			rng = g_slice_new0(CloRng);
-
-			/* Construct source code. */
-			rng->src = g_strconcat(CLO_RNG_SRC_WORKITEM,
-				clo_rng_infos[i].src, CLO_RNG_SRC_API, NULL);
-
-			/* Set seeds buffer. */
-			rng->seeds_device = dev_seeds;
-
-			/* Set seed buffer size in device. */
-			rng->size_in_device =
-				seeds_count * clo_rng_infos[i].seed_size;
-
+			info = &clo_rng_infos[i];
+			break;
 		}
 	}
 
 	/* If no implementation found, throw error. */
-	g_if_err_create_goto(*err, CLO_ERROR, rng == NULL,
+	g_if_err_create_goto(*err, CLO_ERROR, info == NULL,
 		CLO_ERROR_IMPL_NOT_FOUND, error_handler,
 		"The requested RNG implementation, '%s', was not found.", type);
 
+	/* Round number of seeds to the block size of the seeds layout. */
+	seeds_count = CLO_DIV_CEIL(seeds_count, info->block_size)
+		* info->block_size;
+
+	/* Allocate memory for RNG object. */
+	rng = g_slice_new0(CloRng);
+
+	/* Keep seed information, required for resizing and for seeds
+	 * initialization in client program. */
+	rng->seed_type = seed_type;
+	rng->seed_size = info->seed_size;
+	rng->block_size = info->block_size;
+	rng->seeds_count = seeds_count;
+	rng->capacity = seeds_count;
+	rng->main_seed = main_seed;
+
+	/* Set seed buffer size in device. */
+	rng->size_in_device = seeds_count * info->seed_size;
+
+	/* Deal with seeds. */
+	switch (seed_type) {
+		case CLO_RNG_SEED_DEV_GID:
+			/* Check that seeds parameter is NULL. */
+			g_if_err_create_goto(*err, CLO_ERROR,
+				seeds != NULL, CLO_ERROR_ARGS, error_handler,
+				"The DEV_GID seed type expects a NULL seeds "\
+				"parameter.");
+			/* Construct and build seeds init program, kept for
+			 * initializing new seeds when resizing. */
+			init_src = g_strconcat("#define CLO_RNG_HASH(x) ",
+				clo_rng_hash_eff(hash), "\n", info->src,
+				CLO_RNG_SRC_INIT, NULL);
+			rng->prg_init = ccl_program_new_from_source(
+				ctx, init_src, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+			ccl_program_build(rng->prg_init, NULL, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+			/* Seeds will be initialized in device using GID. */
+			rng->seeds_device = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+				rng->size_in_device, NULL, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+			/* Get out of switch. */
+			break;
+		case CLO_RNG_SEED_DEV_GID_FUSED:
+			/* Check that seeds parameter is NULL. */
+			g_if_err_create_goto(*err, CLO_ERROR,
+				seeds != NULL, CLO_ERROR_ARGS, error_handler,
+				"The DEV_GID_FUSED seed type expects a NULL "\
+				"seeds parameter.");
+			/* Only create seeds buffer, initialization kernel
+			 * will be run from the client program. */
+			rng->seeds_device = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+				rng->size_in_device, NULL, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+			/* Get out of switch. */
+			break;
+		case CLO_RNG_SEED_HOST_MT:
+			/* Check that seeds parameter is NULL. */
+			g_if_err_create_goto(*err, CLO_ERROR,
+				seeds != NULL, CLO_ERROR_ARGS, error_handler,
+				"The HOST_MT seed type expects a NULL seeds "\
+				"parameter.");
+			/* Seeds will be initialized in host and copied to
+			 * device. Host generator is kept for initializing new
+			 * seeds when resizing. */
+			rng->rng_host = g_rand_new_with_seed(main_seed);
+			rng->seeds_device = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+				rng->size_in_device, NULL, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+			/* Get out of switch. */
+			break;
+		case CLO_RNG_SEED_EXT_DEV:
+			/* Check that external device buffer has the
+			 * required size. */
+			ext_buf_size = ccl_memobj_get_info_scalar(
+				(CCLMemObj*) seeds, CL_MEM_SIZE, size_t,
+				&err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+			g_if_err_create_goto(*err, CLO_ERROR,
+				ext_buf_size < rng->size_in_device,
+				CLO_ERROR_ARGS, error_handler,
+				"The '%s' RNG type requires a buffer of at " \
+				"least %d bytes. The size of the proviced " \
+				"external device seeds buffer is only %d bytes.",
+				type, (int) rng->size_in_device, (int) ext_buf_size);
+			/* Keep external device seeds as the RNG seeds.
+			 * Increase reference count, client will have to
+			 * destroy external buffer himself. */
+			ccl_buffer_ref((CCLBuffer*) seeds);
+			rng->seeds_device = (CCLBuffer*) seeds;
+			rng->seeds_init = seeds_count;
+			/* Get out of switch. */
+			break;
+		case CLO_RNG_SEED_EXT_HOST:
+			/* Check that seeds is not NULL. */
+			g_if_err_create_goto(*err, CLO_ERROR,
+				seeds == NULL, CLO_ERROR_ARGS, error_handler,
+				"The EXT_HOST seed type expects a non-NULL "\
+				"seeds parameter.");
+			/* Create device buffer and copy seeds to device. */
+			rng->seeds_device = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+				rng->size_in_device, NULL, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+			ccl_buffer_enqueue_write(rng->seeds_device, cq, CL_TRUE, 0,
+				rng->size_in_device, seeds, NULL, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+			rng->seeds_init = seeds_count;
+			/* Get out of switch. */
+			break;
+		default:
+			/* An invalid seed type was specified, throw error. */
+			g_if_err_create_goto(*err, CLO_ERROR, TRUE,
+				CLO_ERROR_ARGS, error_handler,
+				"Unknown seed type.");
+	}
+
+	/* Initialize seeds. */
+	clo_rng_seed_init(rng, cq, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Construct source code. If seeds are to be initialized from the
+	 * client program, append the hash and the initialization kernel. */
+	if (seed_type == CLO_RNG_SEED_DEV_GID_FUSED) {
+		rng->src = g_strconcat("#define CLO_RNG_HASH(x) ",
+			clo_rng_hash_eff(hash), "\n", CLO_RNG_SRC_WORKITEM,
+			info->src, CLO_RNG_SRC_API, CLO_RNG_SRC_INIT, NULL);
+	} else {
+		rng->src = g_strconcat(CLO_RNG_SRC_WORKITEM,
+			info->src, CLO_RNG_SRC_API, NULL);
+	}
+
 	/* If we got here, everything is OK. */
 	g_assert(err == NULL || *err == NULL);
 	goto finish;
@@ -395,11 +617,15 @@ error_handler:
 	/* If we got here there was an error, verify that it is so. */
 	g_assert(err == NULL || *err != NULL);
 
-	/* If a buffer was created, destroy it. */
-	if (dev_seeds != NULL) ccl_buffer_destroy(dev_seeds);
+	/* If a RNG object was created, destroy it. */
+	if (rng != NULL) clo_rng_destroy(rng);
+	rng = NULL;
 
 finish:
 
+	/* Free seeds init program source. */
+	if (init_src) g_free(init_src);
+
 	/* Return RNG object. */
 	return rng;
 }
@@ -417,10 +643,16 @@ void clo_rng_destroy(CloRng* rng) {
 	g_return_if_fail(rng != NULL);
 
 	/* Destroy in-device seeds buffer. */
-	ccl_buffer_destroy(rng->seeds_device);
+	if (rng->seeds_device) ccl_buffer_destroy(rng->seeds_device);
+
+	/* Destroy seed initialization program. */
+	if (rng->prg_init) ccl_program_destroy(rng->prg_init);
+
+	/* Destroy host seed generator. */
+	if (rng->rng_host) g_rand_free(rng->rng_host);
 
 	/* Destroy source code string. */
-	g_free(rng->src);
+	if (rng->src) g_free(rng->src);
 
 	/* Destroy rng object. */
 	g_slice_free(CloRng, rng);
@@ -446,7 +678,9 @@ const char* clo_rng_get_source(CloRng* rng) {
 }
 
 /**
- * Get in-device seeds. Only for non-external seed types.
+ * Get in-device seeds. Only for non-external seed types. The returned
+ * buffer may change after calls to clo_rng_resize() or
+ * clo_rng_reserve().
  *
  * @public @memberof clo_rng
  *
@@ -480,4 +714,195 @@ size_t clo_rng_get_size(CloRng* rng) {
 
 }
 
+/**
+ * Get number of seeds the device seeds buffer can hold without being
+ * reallocated.
+ *
+ * @public @memberof clo_rng
+ *
+ * @param[in] rng RNG object.
+ * @return Capacity of device seeds buffer, in number of seeds.
+ * */
+size_t clo_rng_get_capacity(CloRng* rng) {
+
+	/* Make sure rng object is not NULL. */
+	g_return_val_if_fail(rng != NULL, 0);
+
+	/* Return capacity of device seeds buffer. */
+	return rng->capacity;
+
+}
+
+/**
+ * Make sure the device seeds buffer can hold at least the given
+ * number of seeds, so that growing the RNG with clo_rng_resize() up to
+ * that number does not reallocate the buffer. The number of seeds is
+ * not changed.
+ *
+ * @public @memberof clo_rng
+ *
+ * @param[in] rng RNG object.
+ * @param[in] capacity Minimum capacity, in number of seeds.
+ * @param[in] cq Command queue wrapper.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE`
+ * otherwise.
+ * */
+cl_bool clo_rng_reserve(CloRng* rng, size_t capacity, CCLQueue* cq,
+	GError** err) {
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+	/* Make sure rng object is not NULL. */
+	g_return_val_if_fail(rng != NULL, CL_FALSE);
+
+	/* Round capacity to the block size of the seeds layout. */
+	capacity = CLO_DIV_CEIL(capacity, rng->block_size) * rng->block_size;
+
+	/* Only reallocate if required. */
+	if (capacity <= rng->capacity) return CL_TRUE;
+
+	/* Reallocate seeds buffer. */
+	return clo_rng_realloc(rng, capacity, cq, err);
+
+}
+
+/**
+ * Change the number of seeds of a RNG object. Existing seeds are kept,
+ * and only new seeds are initialized, using the configured hash
+ * (::CLO_RNG_SEED_DEV_GID) or by continuing the host Mersenne Twister
+ * stream (::CLO_RNG_SEED_HOST_MT). New seeds are the same as if the RNG
+ * object had been created with the new number of seeds. For the
+ * ::CLO_RNG_SEED_DEV_GID_FUSED seed type, new seeds are initialized by
+ * calling clo_rng_init_seeds() afterwards. Seeds of external seed types
+ * cannot be enlarged.
+ *
+ * If the device seeds buffer needs to grow, its capacity is at least
+ * doubled, so that growing incrementally does not reallocate every
+ * time.
+ *
+ * @public @memberof clo_rng
+ *
+ * @param[in] rng RNG object.
+ * @param[in] seeds_count New number of seeds (rounded up to a multiple
+ * of the block size of the RNG type).
+ * @param[in] cq Command queue wrapper.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if function returns successfully, `CL_FALSE`
+ * otherwise.
+ * */
+cl_bool clo_rng_resize(CloRng* rng, size_t seeds_count, CCLQueue* cq,
+	GError** err) {
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+	/* Make sure rng object is not NULL. */
+	g_return_val_if_fail(rng != NULL, CL_FALSE);
+
+	/* Function return status. */
+	cl_bool status;
+	/* Internal error handling object. */
+	GError* err_internal = NULL;
+
+	/* Round number of seeds to the block size of the seeds layout. */
+	seeds_count = CLO_DIV_CEIL(seeds_count, rng->block_size)
+		* rng->block_size;
+
+	/* Enlarge seeds buffer if required. */
+	if (seeds_count > rng->capacity) {
+		clo_rng_realloc(rng, MAX(seeds_count, 2 * rng->capacity), cq,
+			&err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+	}
+
+	/* Set new number of seeds. */
+	rng->seeds_count = seeds_count;
+	rng->size_in_device = seeds_count * rng->seed_size;
+
+	/* Initialize new seeds. */
+	clo_rng_seed_init(rng, cq, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	status = CL_TRUE;
+	goto finish;
+
+error_handler:
+
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	status = CL_FALSE;
+
+finish:
+
+	/* Return status. */
+	return status;
+
+}
+
+/**
+ * Initialize device seeds using the `clo_rng_init` kernel of a client
+ * program built with the source returned by clo_rng_get_source(). Only
+ * available for the ::CLO_RNG_SEED_DEV_GID_FUSED seed type. Only seeds
+ * not yet initialized (e.g. new seeds after a call to
+ * clo_rng_resize()) are initialized.
+ *
+ * @public @memberof clo_rng
+ *
+ * @param[in] rng RNG object.
+ * @param[in] prg Client program, built with the RNG source code.
+ * @param[in] cq Command queue wrapper.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Event wrapper associated with the seeds initialization
+ * kernel, or `NULL` if no seeds required initialization or if an error
+ * occurs.
+ * */
+CCLEvent* clo_rng_init_seeds(CloRng* rng, CCLProgram* prg,
+	CCLQueue* cq, GError** err) {
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Make sure rng object is not NULL. */
+	g_return_val_if_fail(rng != NULL, NULL);
+
+	/* Event wrapper. */
+	CCLEvent* evt = NULL;
+	/* Internal error handling object. */
+	GError* err_internal = NULL;
+
+	/* Check that the RNG source includes the initialization kernel. */
+	g_if_err_create_goto(*err, CLO_ERROR,
+		rng->seed_type != CLO_RNG_SEED_DEV_GID_FUSED, CLO_ERROR_ARGS,
+		error_handler,
+		"Seeds can only be initialized in the client program for the "\
+		"DEV_GID_FUSED seed type.");
+
+	/* Enqueue seed initialization kernel. */
+	evt = clo_rng_device_seed_init(rng, prg, cq, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	evt = NULL;
+
+finish:
+
+	/* Return event wrapper. */
+	return evt;
+
+}
+
 /** @} */
@@ -37,15 +37,21 @@
 #define CLO_RNG_SRC_TAUSLCG "@RNG_SRC_TAUSLCG@"
 #define CLO_RNG_SRC_API "@RNG_SRC_API@"
 
+/* Structure-of-arrays state layout. */
+#define CLO_RNG_SRC_SOA "@RNG_SRC_SOA@"
+
+/* Number of consecutive states in each block of the SoA layout. */
+#define CLO_RNG_SOA_BLOCK 64
+
 /* Device seed initialization kernel. */
 #define CLO_RNG_SRC_INIT "@RNG_SRC_INIT@"
 
 /* Available RNGs */
-#define CLO_RNG_IMPLS "lcg, xorshift64, xorshift128, mwc64x, parkmiller, tauslcg"
+#define CLO_RNG_IMPLS "lcg, xorshift64, xorshift128, mwc64x, parkmiller, tauslcg, xorshift128_soa, tauslcg_soa"
 
 /**
- * A RNG algorithm information: name, kernel constant and seed size in
- * bytes.
+ * A RNG algorithm information: name, kernel constant, seed size in
+ * bytes and number of seeds per block.
  * */
 struct clo_rng_info {
 
@@ -57,6 +63,12 @@ struct clo_rng_info {
 
 	/** Seed size in butes. */
 	const size_t seed_size;
+
+	/** Number of seeds per block in the seeds buffer. The number of
+	 * seeds is rounded up to a multiple of this value. It is 1 for the
+	 * default layout, and ::CLO_RNG_SOA_BLOCK for the
+	 * structure-of-arrays layout. */
+	const size_t block_size;
 };
 
 /**
@@ -87,7 +99,13 @@ typedef enum clo_rng_seed_type {
 	CLO_RNG_SEED_EXT_DEV  = 2,
 
 	/** Client initialized seeds, still in host. */
-	CLO_RNG_SEED_EXT_HOST = 3
+	CLO_RNG_SEED_EXT_HOST = 3,
+
+	/** Device initialized seeds based on workitem global ID, with the
+	 * initialization kernel fused into the RNG source code. Seeds are
+	 * initialized with clo_rng_init_seeds() using the client program,
+	 * so no additional program is built. */
+	CLO_RNG_SEED_DEV_GID_FUSED = 4
 
 } CloRngSeedType;
 
@@ -110,4 +128,20 @@ CCLBuffer* clo_rng_get_device_seeds(CloRng* rng);
 /* Get size in bytes of seeds buffer in device. */
 size_t clo_rng_get_size(CloRng* rng) ;
 
+/* Get number of seeds the device seeds buffer can hold. */
+size_t clo_rng_get_capacity(CloRng* rng);
+
+/* Make sure the device seeds buffer can hold a number of seeds. */
+cl_bool clo_rng_reserve(CloRng* rng, size_t capacity, CCLQueue* cq,
+	GError** err);
+
+/* Change the number of seeds, initializing only new seeds. */
+cl_bool clo_rng_resize(CloRng* rng, size_t seeds_count, CCLQueue* cq,
+	GError** err);
+
+/* Initialize device seeds using a client program built with the RNG
+ * source. */
+CCLEvent* clo_rng_init_seeds(CloRng* rng, CCLProgram* prg,
+	CCLQueue* cq, GError** err);
+
 #endif
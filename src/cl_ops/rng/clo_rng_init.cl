@@ -37,6 +37,12 @@
 	#define CLO_RNG_HASH(x) x=x
 #endif
 
+#ifndef clo_rng_state_store
+	/* Default is one state per array element. */
+	#define clo_rng_state_store(states, index, state) \
+		(states)[index] = (state)
+#endif
+
 /**
  * Initialize RNG seeds using each workitem's global ID and possibly
  * an externally specified hash.
@@ -55,7 +61,8 @@ __kernel void clo_rng_init(
 	CLO_RNG_HASH(seed);
 
 	/* Update seeds array. */
-	seeds[get_global_id(0)] = clo_ulong2statetype(seed);
+	clo_rng_state_store(
+		seeds, get_global_id(0), clo_ulong2statetype(seed));
 
 }
 
@@ -0,0 +1,73 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Structure-of-arrays (SoA) layout for RNG states composed of four
+ * 32-bit words.
+ *
+ * States are grouped in blocks of `CLO_RNG_SOA_BLOCK` consecutive
+ * states. Within a block, each state word lives in its own contiguous
+ * plane, so that adjacent workitems access adjacent words instead of
+ * 16-byte strided records. The `CLO_RNG_SOA_BLOCK` macro must be
+ * defined before including this source.
+ */
+
+/* Select SoA layout in RNG sources. */
+#define CLO_RNG_SOA
+
+/* Index of the given word of the given state. */
+#define CLO_RNG_SOA_IDX(index, word) \
+	(((index) / CLO_RNG_SOA_BLOCK) * CLO_RNG_SOA_BLOCK * 4 \
+	+ (word) * CLO_RNG_SOA_BLOCK + (index) % CLO_RNG_SOA_BLOCK)
+
+/**
+ * Load a state from a SoA states array.
+ *
+ * @param[in] states Array of RNG states, in SoA layout.
+ * @param[in] index Index of state to load.
+ * @return The loaded state.
+ */
+uint4 clo_rng_soa_load(__global uint *states, uint index) {
+
+	return (uint4) (states[CLO_RNG_SOA_IDX(index, 0)],
+		states[CLO_RNG_SOA_IDX(index, 1)],
+		states[CLO_RNG_SOA_IDX(index, 2)],
+		states[CLO_RNG_SOA_IDX(index, 3)]);
+}
+
+/**
+ * Store a state in a SoA states array.
+ *
+ * @param[in,out] states Array of RNG states, in SoA layout.
+ * @param[in] index Index of state to store.
+ * @param[in] state State to store.
+ */
+void clo_rng_soa_store(__global uint *states, uint index, uint4 state) {
+
+	states[CLO_RNG_SOA_IDX(index, 0)] = state.x;
+	states[CLO_RNG_SOA_IDX(index, 1)] = state.y;
+	states[CLO_RNG_SOA_IDX(index, 2)] = state.z;
+	states[CLO_RNG_SOA_IDX(index, 3)] = state.w;
+}
+
+/* State load and store macros. */
+#define clo_rng_state_load(states, index) \
+	clo_rng_soa_load(states, index)
+#define clo_rng_state_store(states, index, state) \
+	clo_rng_soa_store(states, index, state)
@@ -29,7 +29,15 @@
  */
 
 /* For the LCG RNG, the size of each seed is ulong. */
-typedef uint4 clo_statetype;
+#ifdef CLO_RNG_SOA
+	/* In SoA layout, states are accessed as arrays of integers. */
+	typedef uint clo_statetype;
+#else
+	typedef uint4 clo_statetype;
+	#define clo_rng_state_load(states, index) (states)[index]
+	#define clo_rng_state_store(states, index, state) \
+		(states)[index] = (state)
+#endif
 
 /* Convert ulong into uint4 */
 #define clo_ulong2statetype(seed) as_uint4((ulong2) (seed, seed))
@@ -79,7 +87,7 @@ uint lcg_step(uint z, uint a, uint c) {
 uint clo_rng_next(__global clo_statetype *states, uint index) {
 
 	/* Get current state */
-	clo_statetype state = states[index];
+	uint4 state = clo_rng_state_load(states, index);
 
 	/* Keep x value. */
 	uint x = state.x;
@@ -93,7 +101,7 @@ uint clo_rng_next(__global clo_statetype *states, uint index) {
 	state.w = lcg_step(x, 1664525, 1013904223U);
 
 	/* Keep state */
-	states[index] = state;
+	clo_rng_state_store(states, index, state);
 
 	/* Return value */
 	return state.x;
@@ -25,7 +25,15 @@
  */
 
 /* For the Xor-Shift128 RNG, the size of each seed is four integers. */
-typedef uint4 clo_statetype;
+#ifdef CLO_RNG_SOA
+	/* In SoA layout, states are accessed as arrays of integers. */
+	typedef uint clo_statetype;
+#else
+	typedef uint4 clo_statetype;
+	#define clo_rng_state_load(states, index) (states)[index]
+	#define clo_rng_state_store(states, index, state) \
+		(states)[index] = (state)
+#endif
 
 #define clo_ulong2statetype(seed) (uint4) (0xFFFFFFFF & seed, 0xFFFFFFFF & (seed >> 16), 0xFFFFFFFF & (seed >> 32), 0xFFFFFFFF & (seed >> 46))
 
@@ -41,7 +49,7 @@ typedef uint4 clo_statetype;
 uint clo_rng_next(__global clo_statetype *states, uint index) {
 
 	/* Get current state */
-	clo_statetype state = states[index];
+	uint4 state = clo_rng_state_load(states, index);
 
 	/* Update state */
 	uint t = state.x ^ (state.x << 11);
@@ -51,7 +59,7 @@ uint clo_rng_next(__global clo_statetype *states, uint index) {
 	state.w = state.w ^ (state.w >> 19) ^ (t ^ (t >> 8));
 
 	/* Keep state */
-	states[index] = state;
+	clo_rng_state_store(states, index, state);
 
 	/* Return value */
 	return state.w;
@@ -23,7 +23,16 @@
 
 #include "cl_ops/clo_scan_abstract.h"
 #include "cl_ops/clo_scan_blelloch.h"
+#include "cl_ops/clo_scan_rblock.h"
+#include "cl_ops/clo_scan_host.h"
 #include "common/_g_err_macros.h"
+#include <string.h>
+
+/** Default maximum number of elements which are scanned on the host
+ * instead of with the requested implementation, when the host is able
+ * to scan them (see the `host_max` option of clo_scan_new()). */
+#define CLO_SCAN_HOST_MAX_DEFAULT 256
+
 /**
  * @addtogroup CLO_SCAN
  * @{
@@ -52,8 +61,49 @@ struct clo_scan {
 	/** @private Scan implementation data. */
 	void* data;
 
+	/** @private Command batch being recorded, if any. */
+	CloBatch* batch;
+
+	/** @private Is the scan inclusive? */
+	cl_bool inclusive;
+
+	/** @private Is the scan a prefix sum, i.e. with the default
+	 * operator and identity? */
+	cl_bool default_op;
+
+	/** @private Pinned buffer for returning scan totals to the host,
+	 * created on first use. */
+	CCLBuffer* total_pinned;
+
+	/** @private Maximum number of elements which are scanned on the
+	 * host instead of with the scan implementation. */
+	size_t host_max;
+
 };
 
+/**
+ * @internal
+ * Should the given number of elements be scanned on the host instead
+ * of with the scan implementation? This is the case for few elements,
+ * which don't make up for kernel dispatch, as long as the scan is a
+ * prefix sum of types supported by the host scan and is not being
+ * recorded.
+ *
+ * @param[in] scanner Scanner object.
+ * @param[in] numel Number of elements to scan.
+ * @return `CL_TRUE` if elements should be scanned on the host,
+ * `CL_FALSE` otherwise.
+ * */
+static cl_bool clo_scan_route_host(CloScan* scanner, size_t numel) {
+
+	return (numel <= scanner->host_max) && (scanner->batch == NULL)
+		&& scanner->default_op
+		&& CLO_TYPE_IS_SCALAR(scanner->elem_type)
+		&& (scanner->elem_type != CLO_HALF)
+		&& CLO_TYPE_IS_SCALAR(scanner->sum_type)
+		&& (scanner->sum_type != CLO_HALF);
+}
+
 /**
  * Generic scan object constructor. The exact type is given in the
  * first parameter.
@@ -61,10 +111,32 @@ struct clo_scan {
  * @public @memberof clo_scan
  *
  * @param[in] type Name of scan algorithm class to create.
- * @param[in] options Algorithm options.
- * @param[in] ctx OpenCL context wrapper.
+ * @param[in] options Algorithm options. Besides the implementation
+ * specific options, the `inclusive` option is accepted by all
+ * implementations: `inclusive=1` performs an inclusive scan, while
+ * `inclusive=0` (the default) performs an exclusive scan; other values
+ * are rejected with a ::CLO_ERROR_ARGS error. The
+ * `host_max` option, also accepted by all implementations, sets the
+ * maximum number of elements which are scanned on the host instead
+ * (256 by default, 0 disables it), for prefix sums of scalar types
+ * other than `half`.
+ * @param[in] ctx OpenCL context wrapper. Can be `NULL` for the host
+ * scan, in which case no OpenCL program is built, and only host data
+ * or device data scans are available (not scans with totals).
  * @param[in] elem_type Type of elements to scan.
- * @param[in] sum_type Type of scanned elements.
+ * @param[in] sum_type Type of scanned elements. If either `elem_type`
+ * or `sum_type` is a record type, both must be the same type, since
+ * records can't be converted, and `op` and `identity` must be given.
+ * @param[in] op One-liner OpenCL C code string which combines two
+ * partial results, a and b, with an associative operator, where `a`
+ * precedes `b`; e.g. `max((a), (b))` performs a running maximum. If
+ * NULL, this defaults to `((a) + (b))`, i.e. a prefix sum.
+ * @param[in] identity One-liner OpenCL C code string with the identity
+ * element of `op`, of type `sum_type`; e.g. `0` for sums or `1` for
+ * products. If NULL, this defaults to `0`.
+ * @param[in] prelude OpenCL C code with helper functions used by `op`
+ * and `identity`, which is placed after the definitions of the scanned
+ * types and before the scan kernels. Can be `NULL`.
  * @param[in] compiler_opts OpenCL Compiler options.
  * @param[out] err Return location for a GError, or `NULL` if error
  * reporting is to be ignored.
@@ -73,19 +145,20 @@ struct clo_scan {
  * */
 CloScan* clo_scan_new(const char* type, const char* options,
 	CCLContext* ctx, CloType elem_type, CloType sum_type,
+	const char* op, const char* identity, const char* prelude,
 	const char* compiler_opts, GError** err) {
 
 	/* Make sure type is not NULL. */
 	g_return_val_if_fail(type != NULL, NULL);
-	/* Make sure context is not NULL. */
-	g_return_val_if_fail(ctx != NULL, NULL);
 	/* Make sure err is NULL or it is not set. */
 	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
 	/* The list of known scan implementations. */
 	CloScanImplDef scan_impl_defs[] = {
 		clo_scan_blelloch_def,
-		{ NULL, NULL, NULL, NULL, NULL, NULL, NULL }
+		clo_scan_rblock_def,
+		clo_scan_host_def,
+		{ NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL }
 	};
 
 	/* Scanner object. */
@@ -103,6 +176,75 @@ CloScan* clo_scan_new(const char* type, const char* options,
 	/* Scan source code. */
 	const char* src;
 
+	/* Tokenized options. */
+	gchar** opts = NULL;
+
+	/* Options passed to the scan implementation. */
+	GString* impl_opts = NULL;
+
+	/* Is the scan inclusive? */
+	cl_bool inclusive = CL_FALSE;
+
+	/* Maximum number of elements scanned on the host. */
+	guint64 host_max = CLO_SCAN_HOST_MAX_DEFAULT;
+
+	/* End of parsed number. */
+	gchar* end = NULL;
+
+	/* Scan macros builder. */
+	GString* ocl_macros = NULL;
+
+	/* Complete source (macros + common scan source + algorithm
+	 * source). */
+	const char* src_full[3];
+
+	/* Records can't be converted into other types, nor combined or
+	 * initialized with the default operator and identity. */
+	if ((elem_type >= CLO_RECORD) || (sum_type >= CLO_RECORD)) {
+		g_if_err_create_goto(*err, CLO_ERROR, elem_type != sum_type,
+			CLO_ERROR_ARGS, error_handler,
+			"Record types can only be scanned into the same record type.");
+		g_if_err_create_goto(*err, CLO_ERROR,
+			(op == NULL) || (identity == NULL),
+			CLO_ERROR_ARGS, error_handler,
+			"Scanning record types requires an operator and identity.");
+	}
+
+	/* Extract the generic inclusive option, passing the remaining
+	 * options to the scan implementation. */
+	if (options) {
+		opts = g_strsplit_set(options, ",", -1);
+		impl_opts = g_string_new("");
+		for (guint i = 0; opts[i] != NULL; i++) {
+			if (g_str_has_prefix(opts[i], "inclusive=")) {
+				g_if_err_create_goto(*err, CLO_ERROR,
+					(g_strcmp0(opts[i] + 10, "0") != 0)
+					&& (g_strcmp0(opts[i] + 10, "1") != 0),
+					CLO_ERROR_ARGS, error_handler,
+					"Invalid value for inclusive option: '%s'.",
+					opts[i] + 10);
+				inclusive = (opts[i][10] == '1') ? CL_TRUE : CL_FALSE;
+			} else if (g_str_has_prefix(opts[i], "host_max=")) {
+				host_max = g_ascii_strtoull(opts[i] + 9, &end, 10);
+				g_if_err_create_goto(*err, CLO_ERROR,
+					(opts[i][9] == '\0') || (*end != '\0'),
+					CLO_ERROR_ARGS, error_handler,
+					"Invalid value for host_max option: '%s'.",
+					opts[i] + 9);
+			} else if (opts[i][0] != '\0') {
+				g_string_append_printf(impl_opts, "%s,", opts[i]);
+			}
+		}
+		options = impl_opts->str;
+	}
+
+	/* Only the host scan is able to work without a context. */
+	g_if_err_create_goto(*err, CLO_ERROR,
+		(ctx == NULL) && (g_strcmp0(type, CLO_SCAN_HOST_NAME) != 0),
+		CLO_ERROR_ARGS, error_handler,
+		"The '%s' scan implementation requires an OpenCL context.",
+		type);
+
 	/* Search in the list of known scan classes. */
 	for (guint i = 0; scan_impl_defs[i].name != NULL; ++i) {
 		if (g_strcmp0(type, scan_impl_defs[i].name) == 0) {
@@ -113,10 +255,14 @@ CloScan* clo_scan_new(const char* type, const char* options,
 
 			/* Keep data in scanner object. */
 			scanner->impl_def = scan_impl_defs[i];
-			ccl_context_ref(ctx);
+			if (ctx) ccl_context_ref(ctx);
 			scanner->ctx = ctx;
 			scanner->elem_type = elem_type;
 			scanner->sum_type = sum_type;
+			scanner->inclusive = inclusive;
+			scanner->host_max = (size_t) host_max;
+			scanner->default_op = (op == NULL)
+				&& ((identity == NULL) || (g_strcmp0(identity, "0") == 0));
 
 			/* Determine final compiler options. */
 			compiler_opts_final = g_strconcat(
@@ -129,9 +275,60 @@ CloScan* clo_scan_new(const char* type, const char* options,
 				scanner, options, &err_internal);
 			g_if_err_propagate_goto(err, err_internal, error_handler);
 
+			/* Without a context, there is no program to build. */
+			if (ctx == NULL) continue;
+
+			/* Build scan macros which define record types, the helper
+			 * functions, the scan operator and its identity. */
+			ocl_macros = g_string_new("");
+
+			/* Definitions of record types, if any. */
+			if (clo_type_get_def(elem_type))
+				g_string_append(ocl_macros, clo_type_get_def(elem_type));
+			if ((sum_type != elem_type) && clo_type_get_def(sum_type))
+				g_string_append(ocl_macros, clo_type_get_def(sum_type));
+
+			/* Helper functions of the scan operator, if any. */
+			if (prelude) {
+				g_string_append(ocl_macros, prelude);
+				g_string_append_c(ocl_macros, '\n');
+			}
+
+			/* Scan operator. */
+			g_string_append_printf(ocl_macros,
+				"#define CLO_SCAN_OP(a, b) %s\n",
+				op != NULL ? op : "((a) + (b))");
+
+			/* Identity of the scan operator. */
+			g_string_append_printf(ocl_macros,
+				"#define CLO_SCAN_IDENTITY %s\n",
+				identity != NULL ? identity : "0");
+
+			/* Conversion of elements to scan to the sum type. Vectors
+			 * can't be cast, and records can't be cast even to their
+			 * own type. */
+			if (elem_type == sum_type) {
+				g_string_append(ocl_macros,
+					"#define CLO_SCAN_CONVERT(x) (x)\n");
+			} else if ((sum_type >= CLO_INT2) && (sum_type <= CLO_DOUBLE2)) {
+				g_string_append_printf(ocl_macros,
+					"#define CLO_SCAN_CONVERT(x) convert_%s(x)\n",
+					clo_type_get_name(sum_type));
+			} else {
+				g_string_append(ocl_macros,
+					"#define CLO_SCAN_CONVERT(x) ((CLO_SCAN_SUM_TYPE) (x))\n");
+			}
+
+			/* Inclusive scan. */
+			if (inclusive)
+				g_string_append(ocl_macros, "#define CLO_SCAN_INCLUSIVE\n");
+
 			/* Create and build scanner program. */
-			prg = ccl_program_new_from_source(
-				scanner->ctx, src, &err_internal);
+			src_full[0] = (const char*) ocl_macros->str;
+			src_full[1] = CLO_SCAN_COMMON_SRC;
+			src_full[2] = src;
+			prg = ccl_program_new_from_sources(
+				scanner->ctx, 3, src_full, NULL, &err_internal);
 			g_if_err_propagate_goto(err, err_internal, error_handler);
 
 			ccl_program_build(prg, compiler_opts_final, &err_internal);
@@ -162,6 +359,9 @@ finish:
 
 	/* Free stuff. */
 	if (compiler_opts_final) g_free(compiler_opts_final);
+	if (ocl_macros) g_string_free(ocl_macros, TRUE);
+	if (impl_opts) g_string_free(impl_opts, TRUE);
+	g_strfreev(opts);
 
 	/* Return scanner object. */
 	return scanner;
@@ -188,6 +388,9 @@ void clo_scan_destroy(CloScan* scan) {
 	/* Destroy program. */
 	if (scan->prg) ccl_program_destroy(scan->prg);
 
+	/* Destroy pinned buffer for scan totals. */
+	if (scan->total_pinned) ccl_buffer_destroy(scan->total_pinned);
+
 	/* Free scanner object memory. */
 	g_slice_free(CloScan, scan);
 
@@ -204,8 +407,13 @@ void clo_scan_destroy(CloScan* scan) {
  * @param[in] cq_comm A command queue wrapper for data transfers.
  * If `NULL`, `cq_exec` will be used for data transfers.
  * @param[in] data_in Data to be scanned.
- * @param[out] data_out Location where to place scanned data.
- * @param[in] numel Number of elements in `data_in`.
+ * @param[out] data_out Location where to place scanned data. It may be
+ * the same buffer as `data_in` if the element and sum types have the
+ * same size, in which case the data is scanned in place.
+ * @param[in] numel Number of elements in `data_in`, which need not be a
+ * power of 2 or a multiple of the local worksize; buffers need not be
+ * padded. If at most `host_max` (see clo_scan_new()), the data is mapped
+ * and scanned on the host.
  * @param[in] lws_max Max. local worksize. If 0, the local worksize
  * will be automatically determined.
  * @param[out] err Return location for a GError, or `NULL` if error
@@ -226,14 +434,281 @@ CCLEvent* clo_scan_with_device_data(CloScan* scanner,
 	/* Make sure cq_exec is not NULL. */
 	g_return_val_if_fail(cq_exec != NULL, NULL);
 
+	/* Scan few elements on the host. */
+	if (clo_scan_route_host(scanner, numel))
+		return clo_scan_host_def.scan_with_device_data(scanner, cq_exec,
+			cq_comm, data_in, data_out, numel, lws_max, NULL, err);
+
+	/* Use specific implementation. */
+	return scanner->impl_def.scan_with_device_data(scanner, cq_exec,
+		cq_comm, data_in, data_out, numel, lws_max, NULL, err);
+
+}
+
+/**
+ * Perform scan using device data and a caller-supplied workspace
+ * buffer. Pipelines which perform many scans can allocate the
+ * workspace once, with the size given by
+ * clo_scan_get_workspace_size(), instead of having each scan allocate
+ * and release its own scratch memory.
+ *
+ * @public @memberof clo_scan
+ *
+ * @param[in] scanner Scanner object.
+ * @param[in] cq_exec A valid command queue wrapper for kernel
+ * execution, cannot be `NULL`.
+ * @param[in] cq_comm A command queue wrapper for data transfers.
+ * If `NULL`, `cq_exec` will be used for data transfers.
+ * @param[in] data_in Data to be scanned.
+ * @param[out] data_out Location where to place scanned data (see
+ * clo_scan_with_device_data()).
+ * @param[in] numel Number of elements in `data_in`.
+ * @param[in] lws_max Max. local worksize. If 0, the local worksize
+ * will be automatically determined.
+ * @param[in] workspace Device workspace buffer, with at least the size
+ * returned by clo_scan_get_workspace_size() for the same queue,
+ * `numel` and `lws_max`. If `NULL`, a temporary workspace is allocated
+ * internally. If too small, the scan fails with ::CLO_ERROR_ARGS.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return An event which must terminate before scanning is considered
+ * complete.
+ * */
+CCLEvent* clo_scan_with_device_data_ws(CloScan* scanner,
+	CCLQueue* cq_exec, CCLQueue* cq_comm, CCLBuffer* data_in,
+	CCLBuffer* data_out, size_t numel, size_t lws_max,
+	CCLBuffer* workspace, GError** err) {
+
+	/* Make sure scanner object is not NULL. */
+	g_return_val_if_fail(scanner != NULL, NULL);
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Make sure cq_exec is not NULL. */
+	g_return_val_if_fail(cq_exec != NULL, NULL);
+
 	/* Use specific implementation. */
 	return scanner->impl_def.scan_with_device_data(scanner, cq_exec,
-		cq_comm, data_in, data_out, numel, lws_max, err);
+		cq_comm, data_in, data_out, numel, lws_max, workspace, err);
+
+}
+
+/**
+ * Perform scan using device data, and also obtain the scan total, i.e.
+ * the combination of all elements in `data_in`. The total is placed in
+ * the first element of `total_buf`, if given, or in a pinned buffer
+ * owned by the scanner otherwise; if `total` is not `NULL`, this
+ * function waits for the scan to finish and copies the total from the
+ * mapped buffer to `total`. This avoids a separate read of the last
+ * scanned and input elements.
+ *
+ * @public @memberof clo_scan
+ *
+ * @param[in] scanner Scanner object.
+ * @param[in] cq_exec A valid command queue wrapper for kernel
+ * execution, cannot be `NULL`.
+ * @param[in] cq_comm A command queue wrapper for data transfers.
+ * If `NULL`, `cq_exec` will be used for data transfers.
+ * @param[in] data_in Data to be scanned.
+ * @param[out] data_out Location where to place scanned data.
+ * @param[in] numel Number of elements in `data_in`.
+ * @param[in] lws_max Max. local worksize. If 0, the local worksize
+ * will be automatically determined.
+ * @param[out] total_buf Device buffer where to place the scan total
+ * (of the scan sum type), or `NULL`.
+ * @param[out] total Host location where to place the scan total (of
+ * the scan sum type), or `NULL`.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return An event which must terminate before scanning and the
+ * placement of the total in the device buffer are considered complete,
+ * or `NULL` if an error occurs.
+ * */
+CCLEvent* clo_scan_with_device_data_total(CloScan* scanner,
+	CCLQueue* cq_exec, CCLQueue* cq_comm, CCLBuffer* data_in,
+	CCLBuffer* data_out, size_t numel, size_t lws_max,
+	CCLBuffer* total_buf, void* total, GError** err) {
+
+	/* Make sure scanner object is not NULL. */
+	g_return_val_if_fail(scanner != NULL, NULL);
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Make sure cq_exec is not NULL. */
+	g_return_val_if_fail(cq_exec != NULL, NULL);
+
+	/* OpenCL wrapper objects. */
+	CCLKernel* krnl_last = NULL;
+	CCLKernel* krnl_total = NULL;
+	CCLEvent* evt = NULL;
+
+	/* Mapped scan total. */
+	void* total_map = NULL;
+
+	/* Internal error handling object. */
+	GError* err_internal = NULL;
+
+	/* Size in bytes of scan sums. */
+	size_t size_sum = clo_type_sizeof(scanner->sum_type);
+
+	/* Worksize of total kernels. */
+	size_t ws = 1;
+
+	/* Number of elements to scan. */
+	cl_uint numel_cl = numel;
+
+	/* The total kernels require the scanner program. */
+	g_if_err_create_goto(*err, CLO_ERROR, scanner->prg == NULL,
+		CLO_ERROR_ARGS, error_handler,
+		"Scan totals require a scanner with an OpenCL context.");
+
+	/* If no device buffer was given for the total, use the pinned
+	 * buffer owned by the scanner, creating it if necessary. */
+	if (total_buf == NULL) {
+		if (scanner->total_pinned == NULL) {
+			scanner->total_pinned = ccl_buffer_new(scanner->ctx,
+				CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, size_sum,
+				NULL, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+		}
+		total_buf = scanner->total_pinned;
+	}
+
+	/* Get total kernels. */
+	krnl_last = ccl_program_get_kernel(
+		scanner->prg, CLO_SCAN_KNAME_TOTAL_LAST, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	krnl_total = ccl_program_get_kernel(
+		scanner->prg, CLO_SCAN_KNAME_TOTAL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Save last element before it is (possibly) overwritten by the
+	 * scan. */
+	clo_batch_set_buffer(scanner->batch, krnl_last, 0, data_in);
+	clo_batch_set_buffer(scanner->batch, krnl_last, 1, total_buf);
+	clo_batch_set_arg_priv(scanner->batch, krnl_last, 2, numel_cl, cl_uint);
+	evt = clo_batch_enqueue_ndrange(scanner->batch, krnl_last, cq_exec,
+		1, &ws, &ws, NULL, "clo_scan_total_last", &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Perform scan. */
+	if (numel > 0) {
+		scanner->impl_def.scan_with_device_data(scanner, cq_exec,
+			cq_comm, data_in, data_out, numel, lws_max, NULL,
+			&err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+	}
+
+	/* Determine scan total. */
+	clo_batch_set_buffer(scanner->batch, krnl_total, 0, data_out);
+	clo_batch_set_buffer(scanner->batch, krnl_total, 1, total_buf);
+	clo_batch_set_arg_priv(
+		scanner->batch, krnl_total, 2, numel_cl, cl_uint);
+	evt = clo_batch_enqueue_ndrange(scanner->batch, krnl_total, cq_exec,
+		1, &ws, &ws, NULL, "clo_scan_total", &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Return total to host through the mapped buffer, if requested. */
+	if (total != NULL) {
+		total_map = ccl_buffer_enqueue_map(total_buf, cq_exec, CL_TRUE,
+			CL_MAP_READ, 0, size_sum, NULL, NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		memcpy(total, total_map, size_sum);
+		evt = ccl_memobj_enqueue_unmap((CCLMemObj*) total_buf, cq_exec,
+			total_map, NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+	}
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	evt = NULL;
+
+finish:
+
+	/* Return event. */
+	return evt;
 
 }
 
 /**
- * Perform scan using host data.
+ * Record a scan using device data in a command batch. The scan is
+ * performed once, as in clo_scan_with_device_data(), and captured in
+ * the returned batch, which can then be repeated with
+ * clo_batch_replay().
+ *
+ * @public @memberof clo_scan
+ *
+ * @param[in] scanner Scanner object.
+ * @param[in] cq_exec A valid command queue wrapper for kernel
+ * execution, cannot be `NULL`.
+ * @param[in] cq_comm A command queue wrapper for data transfers.
+ * If `NULL`, `cq_exec` will be used for data transfers.
+ * @param[in] data_in Data to be scanned.
+ * @param[out] data_out Location where to place scanned data.
+ * @param[in] numel Number of elements in `data_in`.
+ * @param[in] lws_max Max. local worksize. If 0, the local worksize
+ * will be automatically determined.
+ * @param[in] prof If `CL_TRUE`, named events will be created when the
+ * batch is replayed so that it can be profiled.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new command batch, which must be destroyed with
+ * clo_batch_destroy(), or `NULL` if an error occurs.
+ * */
+CloBatch* clo_scan_record(CloScan* scanner, CCLQueue* cq_exec,
+	CCLQueue* cq_comm, CCLBuffer* data_in, CCLBuffer* data_out,
+	size_t numel, size_t lws_max, cl_bool prof, GError** err) {
+
+	/* Make sure scanner object is not NULL. */
+	g_return_val_if_fail(scanner != NULL, NULL);
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Make sure cq_exec is not NULL. */
+	g_return_val_if_fail(cq_exec != NULL, NULL);
+
+	/* Batch to record. */
+	CloBatch* batch = clo_batch_new(prof);
+
+	/* Internal error handling object. */
+	GError* err_internal = NULL;
+
+	/* Perform scan while recording it. */
+	scanner->batch = batch;
+	scanner->impl_def.scan_with_device_data(scanner, cq_exec, cq_comm,
+		data_in, data_out, numel, lws_max, NULL, &err_internal);
+	scanner->batch = NULL;
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	clo_batch_destroy(batch);
+	batch = NULL;
+
+finish:
+
+	/* Return recorded batch. */
+	return batch;
+
+}
+
+/**
+ * Perform scan using host data. The host scan, and scans of at most
+ * `host_max` elements (see clo_scan_new()), are performed directly on
+ * the host data, without device buffers.
  *
  * @public @memberof clo_scan
  *
@@ -282,6 +757,17 @@ cl_bool clo_scan_with_host_data(CloScan* scanner,
 	size_t data_in_size = numel * clo_type_sizeof(scanner->elem_type);
 	size_t data_out_size = numel * clo_type_sizeof(scanner->sum_type);
 
+	/* The host scan, and scans of few elements, work directly on host
+	 * data, skipping device transfers altogether. */
+	if ((g_strcmp0(scanner->impl_def.name, CLO_SCAN_HOST_NAME) == 0)
+		|| clo_scan_route_host(scanner, numel)) {
+		clo_scan_host_sum(scanner->elem_type, scanner->sum_type,
+			data_in, data_out, numel, scanner->inclusive, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		status = CL_TRUE;
+		goto finish;
+	}
+
 	/* If execution queue is NULL, create own queue using first device
 	 * in context. */
 	if (cq_exec == NULL) {
@@ -322,7 +808,7 @@ cl_bool clo_scan_with_host_data(CloScan* scanner,
 
 	/* Perform scan with device data. */
 	evt = scanner->impl_def.scan_with_device_data(scanner, cq_exec,
-		cq_comm, data_in_dev, data_out_dev, numel, lws_max,
+		cq_comm, data_in_dev, data_out_dev, numel, lws_max, NULL,
 		&err_internal);
 	g_if_err_propagate_goto(err, err_internal, error_handler);
 
@@ -496,6 +982,84 @@ void clo_scan_set_data(CloScan* scanner, void* data) {
 
 }
 
+/**
+ * Is the scan inclusive?
+ *
+ * @public @memberof clo_scan
+ *
+ * @param[in] scanner Scanner object.
+ * @return `CL_TRUE` if the scan is inclusive, `CL_FALSE` if it is
+ * exclusive.
+ * */
+cl_bool clo_scan_get_inclusive(CloScan* scanner) {
+
+	/* Make sure scanner is not NULL. */
+	g_return_val_if_fail(scanner != NULL, CL_FALSE);
+
+	/* Return whether the scan is inclusive. */
+	return scanner->inclusive;
+
+}
+
+/**
+ * Is the scan a prefix sum, i.e. with the default operator and
+ * identity? Scan implementations which run on the host use this
+ * function, since they are not able to evaluate the OpenCL C operator.
+ *
+ * @public @memberof clo_scan
+ *
+ * @param[in] scanner Scanner object.
+ * @return `CL_TRUE` if the scan is a prefix sum, `CL_FALSE` otherwise.
+ * */
+cl_bool clo_scan_get_default_op(CloScan* scanner) {
+
+	/* Make sure scanner is not NULL. */
+	g_return_val_if_fail(scanner != NULL, CL_FALSE);
+
+	/* Return whether the default operator is used. */
+	return scanner->default_op;
+
+}
+
+/**
+ * Get the command batch being recorded, if any.
+ *
+ * @public @memberof clo_scan
+ *
+ * @param[in] scanner Scanner object.
+ * @return Command batch being recorded, or `NULL` if no recording is
+ * taking place.
+ * */
+CloBatch* clo_scan_get_batch(CloScan* scanner) {
+
+	/* Make sure scanner object is not NULL. */
+	g_return_val_if_fail(scanner != NULL, NULL);
+
+	/* Return batch being recorded. */
+	return scanner->batch;
+
+}
+
+/**
+ * Set the command batch in which scans are recorded. This allows
+ * algorithms which use a scanner internally (e.g. radix sort) to record
+ * the scan in their own batch.
+ *
+ * @public @memberof clo_scan
+ *
+ * @param[in] scanner Scanner object.
+ * @param[in] batch Command batch, or `NULL` to stop recording.
+ * */
+void clo_scan_set_batch(CloScan* scanner, CloBatch* batch) {
+
+	/* Make sure scanner object is not NULL. */
+	g_return_if_fail(scanner != NULL);
+
+	/* Set batch being recorded. */
+	scanner->batch = batch;
+
+}
+
 /**
  * Get the maximum number of kernels used by the scan implementation.
  *
@@ -566,4 +1130,65 @@ size_t clo_scan_get_localmem_usage(CloScan* scanner, cl_uint i,
 
 }
 
+/**
+ * Get size in bytes of the device workspace required to scan the given
+ * number of elements with the given maximum local worksize. A buffer of
+ * (at least) this size can be passed to clo_scan_with_device_data_ws()
+ * and reused across scans of up to `numel` elements in the same device.
+ *
+ * @public @memberof clo_scan
+ *
+ * @param[in] scanner Scanner object.
+ * @param[in] cq_exec Command queue wrapper which will be used for
+ * kernel execution, since worksizes depend on the device.
+ * @param[in] numel Number of elements to scan.
+ * @param[in] lws_max Max. local worksize. If 0, the local worksize
+ * is automatically determined.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Size in bytes of the required workspace, which may be 0 if
+ * no workspace is required.
+ * */
+size_t clo_scan_get_workspace_size(CloScan* scanner, CCLQueue* cq_exec,
+	size_t numel, size_t lws_max, GError** err) {
+
+	/* Make sure scanner object is not NULL. */
+	g_return_val_if_fail(scanner != NULL, 0);
+
+	/* Make sure cq_exec is not NULL. */
+	g_return_val_if_fail(cq_exec != NULL, 0);
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, 0);
+
+	/* Internal error handling object. */
+	GError* err_internal = NULL;
+
+	/* Workspace size. */
+	size_t ws_size;
+
+	/* Device where scan will take place. */
+	CCLDevice* dev = ccl_queue_get_device(cq_exec, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Get workspace size from specific implementation. */
+	ws_size = scanner->impl_def.get_workspace_size(
+		scanner, dev, numel, lws_max, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	ws_size = 0;
+
+finish:
+	/* Return workspace size. */
+	return ws_size;
+
+}
+
 /** @} */
@@ -25,6 +25,14 @@
 #define _CLO_SCAN_ABSTRACT_H_
 
 #include "cl_ops/clo_common.h"
+#include "cl_ops/clo_batch.h"
+
+/** Source of kernels common to all scan implementations. */
+#define CLO_SCAN_COMMON_SRC "@COMMON_SRC@"
+
+/* Names of kernels common to all scan implementations. */
+#define CLO_SCAN_KNAME_TOTAL_LAST "scanTotalLast"
+#define CLO_SCAN_KNAME_TOTAL "scanTotal"
 
 /**
  * @defgroup CLO_SCAN Parallel prefix sum (scan)
@@ -67,12 +75,12 @@ typedef struct clo_scan_impl_def {
 	/**
 	 * Perform scan using device data.
 	 *
-	 * @copydetails clo_scan::clo_scan_with_device_data()
+	 * @copydetails clo_scan::clo_scan_with_device_data_ws()
 	 * */
 	CCLEvent* (*scan_with_device_data)(CloScan* scanner,
 		CCLQueue* cq_exec, CCLQueue* cq_comm, CCLBuffer* data_in,
 		CCLBuffer* data_out, size_t numel, size_t lws_max,
-		GError** err);
+		CCLBuffer* workspace, GError** err);
 
 	/**
 	 * Get the maximum number of kernels used by the scan
@@ -100,6 +108,15 @@ typedef struct clo_scan_impl_def {
 	size_t (*get_localmem_usage)(CloScan* scanner, cl_uint i,
 		size_t lws_max, size_t numel, GError** err);
 
+	/**
+	 * Get size in bytes of the device workspace required by the scan
+	 * implementation.
+	 *
+	 * @copydetails clo_scan::clo_scan_get_workspace_size()
+	 * */
+	size_t (*get_workspace_size)(CloScan* scanner, CCLDevice* dev,
+		size_t numel, size_t lws_max, GError** err);
+
 } CloScanImplDef;
 
 /** @} */
@@ -108,6 +125,7 @@ typedef struct clo_scan_impl_def {
  * first parameter. */
 CloScan* clo_scan_new(const char* type, const char* options,
 	CCLContext* ctx, CloType elem_type, CloType sum_type,
+	const char* op, const char* identity, const char* prelude,
 	const char* compiler_opts, GError** err);
 
 /* Destroy scanner object. */
@@ -119,6 +137,23 @@ CCLEvent* clo_scan_with_device_data(
 	CCLBuffer* data_in, CCLBuffer* data_out, size_t numel,
 	size_t lws_max, GError** err);
 
+/* Perform scan using device data and a caller-supplied workspace. */
+CCLEvent* clo_scan_with_device_data_ws(CloScan* scanner,
+	CCLQueue* cq_exec, CCLQueue* cq_comm, CCLBuffer* data_in,
+	CCLBuffer* data_out, size_t numel, size_t lws_max,
+	CCLBuffer* workspace, GError** err);
+
+/* Perform scan using device data, and also obtain the scan total. */
+CCLEvent* clo_scan_with_device_data_total(CloScan* scanner,
+	CCLQueue* cq_exec, CCLQueue* cq_comm, CCLBuffer* data_in,
+	CCLBuffer* data_out, size_t numel, size_t lws_max,
+	CCLBuffer* total_buf, void* total, GError** err);
+
+/* Record a scan using device data in a command batch. */
+CloBatch* clo_scan_record(CloScan* scanner, CCLQueue* cq_exec,
+	CCLQueue* cq_comm, CCLBuffer* data_in, CCLBuffer* data_out,
+	size_t numel, size_t lws_max, cl_bool prof, GError** err);
+
 /* Perform scan using host data. */
 cl_bool clo_scan_with_host_data(CloScan* scanner,
 	CCLQueue* cq_exec, CCLQueue* cq_comm, void* data_in, void* data_out,
@@ -148,6 +183,19 @@ void* clo_scan_get_data(CloScan* scanner);
 /* Set scan specific data. */
 void clo_scan_set_data(CloScan* scanner, void* data);
 
+/* Is the scan inclusive? */
+cl_bool clo_scan_get_inclusive(CloScan* scanner);
+
+/* Is the scan a prefix sum, i.e. with the default operator and
+ * identity? */
+cl_bool clo_scan_get_default_op(CloScan* scanner);
+
+/* Get the command batch being recorded, if any. */
+CloBatch* clo_scan_get_batch(CloScan* scanner);
+
+/* Set the command batch in which scans are recorded. */
+void clo_scan_set_batch(CloScan* scanner, CloBatch* batch);
+
 /* Get the maximum number of kernels used by the scan implementation. */
 cl_uint clo_scan_get_num_kernels(CloScan* scanner, GError** err);
 
@@ -161,6 +209,11 @@ const char* clo_scan_get_kernel_name(
 size_t clo_scan_get_localmem_usage(CloScan* scanner, cl_uint i,
 	size_t lws_max, size_t numel, GError** err);
 
+/* Get size in bytes of the device workspace required to scan the given
+ * number of elements in the device associated with the given queue. */
+size_t clo_scan_get_workspace_size(CloScan* scanner, CCLQueue* cq_exec,
+	size_t numel, size_t lws_max, GError** err);
+
 #endif
 
 
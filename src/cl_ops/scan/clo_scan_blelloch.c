@@ -24,6 +24,43 @@
 #include "cl_ops/clo_scan_blelloch.h"
 #include "common/_g_err_macros.h"
 
+/**
+ * @internal
+ * Blelloch scan internal data.
+ * */
+typedef struct {
+
+	/**
+	 * Use a bank-conflict-free padded local memory layout?
+	 * @private
+	 * */
+	cl_bool padded;
+
+	/**
+	 * Scan source code, including the layout constants.
+	 * @private
+	 * */
+	gchar* src;
+
+} clo_scan_blelloch_data;
+
+/**
+ * @internal
+ * Number of elements of auxiliary local memory required to scan a
+ * block of `2 * lws` elements, including padding if required.
+ * */
+static size_t clo_scan_blelloch_aux_numel(
+	clo_scan_blelloch_data* data, size_t lws) {
+
+	/* Block size. */
+	size_t block_size = 2 * lws;
+
+	/* Add one padding element every 2^LOG_NUM_BANKS elements. */
+	return data->padded
+		? block_size + (block_size >> CLO_SCAN_BLELLOCH_LOG_NUM_BANKS)
+		: block_size;
+}
+
 /**
  * @internal
  * Initializes the Blelloch scan object and returns the appropriate
@@ -32,31 +69,90 @@
 static const char* clo_scan_blelloch_init(CloScan* scanner,
 	const char* options, GError** err) {
 
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
 	/* Blelloch scan source code. */
-	const char* src;
+	const char* src = NULL;
 
-	/* Avoid compiler warnings. */
-	(void)scanner;
+	/* Tokenized options. */
+	gchar** opts = NULL;
+	gchar** opt = NULL;
+
+	/* Number of tokens. */
+	int num_toks;
+
+	/* Internal data. */
+	clo_scan_blelloch_data* data = g_slice_new0(clo_scan_blelloch_data);
 
-	/* For now ignore specific blelloch scan options and throw error
-	 * if any option is given. */
-	g_if_err_create_goto(*err, CLO_ERROR,
-		(options != NULL) && (strlen(options) > 0), CLO_ERROR_ARGS,
-		error_handler, "Invalid options for blelloch scan.");
+	/* Set internal data default values. */
+	data->padded = CL_FALSE;
+
+	/* Check options. */
+	if (options) {
+		opts = g_strsplit_set(options, ",", -1);
+		for (guint i = 0; opts[i] != NULL; i++) {
+
+			/* Ignore empty tokens. */
+			if (opts[i][0] == '\0') continue;
+
+			/* Parse current option, get key and value. */
+			opt = g_strsplit_set(opts[i], "=", 2);
+
+			/* Count number of tokens. */
+			for (num_toks = 0; opt[num_toks] != NULL; num_toks++);
+
+			/* If number of tokens is not 2 (key and value), throw error. */
+			g_if_err_create_goto(*err, CLO_ERROR, num_toks != 2,
+				CLO_ERROR_ARGS, error_handler,
+				"Invalid option '%s' for blelloch scan.", opts[i]);
+
+			/* Check key/value option. */
+			if (g_strcmp0("padded", opt[0]) == 0) {
+				/* Use bank-conflict-free padded local memory layout? */
+				data->padded = atoi(opt[1]) ? CL_TRUE : CL_FALSE;
+			} else {
+				g_if_err_create_goto(*err, CLO_ERROR, TRUE,
+					CLO_ERROR_ARGS, error_handler,
+					"Invalid option key '%s' for blelloch scan.",
+					opt[0]);
+			}
+
+			/* Free token. */
+			g_strfreev(opt);
+			opt = NULL;
+
+		}
+	}
+
+	/* Prepend layout constants to scan source. */
+	if (data->padded) {
+		data->src = g_strdup_printf(
+			"#define CLO_SCAN_BLELLOCH_LOG_NUM_BANKS %d\n%s",
+			CLO_SCAN_BLELLOCH_LOG_NUM_BANKS, CLO_SCAN_BLELLOCH_SRC);
+	} else {
+		data->src = g_strdup(CLO_SCAN_BLELLOCH_SRC);
+	}
 
 	/* If we got here, everything is OK. */
 	g_assert(err == NULL || *err == NULL);
-	src = CLO_SCAN_BLELLOCH_SRC;
+	src = data->src;
 	goto finish;
 
 error_handler:
 
 	/* If we got here there was an error, verify that it is so. */
 	g_assert(err == NULL || *err != NULL);
-	src = NULL;
 
 finish:
 
+	/* Free parsed blelloch options. */
+	g_strfreev(opts);
+	g_strfreev(opt);
+
+	/* Set internal data. */
+	clo_scan_set_data(scanner, data);
+
 	/* Return Blelloch source code. */
 	return src;
 
@@ -67,7 +163,16 @@ finish:
  * Finalize blelloch scan object.
  * */
 static void clo_scan_blelloch_finalize(CloScan* scan) {
-	(void)scan;
+
+	/* Internal data. */
+	clo_scan_blelloch_data* data =
+		(clo_scan_blelloch_data*) clo_scan_get_data(scan);
+
+	/* Release internal data. */
+	if (data) {
+		g_free(data->src);
+		g_slice_free(clo_scan_blelloch_data, data);
+	}
 	return;
 }
 
@@ -78,7 +183,7 @@ static void clo_scan_blelloch_finalize(CloScan* scan) {
 static CCLEvent* clo_scan_blelloch_scan_with_device_data(
 	CloScan* scanner, CCLQueue* cq_exec, CCLQueue* cq_comm,
 	CCLBuffer* data_in, CCLBuffer* data_out, size_t numel,
-	size_t lws_max, GError** err) {
+	size_t lws_max, CCLBuffer* workspace, GError** err) {
 
 	/* Local worksize. */
 	size_t lws;
@@ -91,6 +196,7 @@ static CCLEvent* clo_scan_blelloch_scan_with_device_data(
 	CCLKernel* krnl_wgsumsscan = NULL;
 	CCLKernel* krnl_addwgsums = NULL;
 	CCLBuffer* dev_wgsums = NULL;
+	CCLBuffer* dev_wgsums_own = NULL;
 	CCLEvent* evt = NULL;
 
 	/* Internal error reporting object. */
@@ -100,9 +206,19 @@ static CCLEvent* clo_scan_blelloch_scan_with_device_data(
 	cl_uint blocks_per_wg;
 	cl_uint numel_cl;
 
+	/* Number of workgroup-wise sums. */
+	cl_uint num_wgsums;
+
 	/* Global worksizes. */
 	size_t gws_wgscan, ws_wgsumsscan, gws_addwgsums;
 
+	/* Internal data. */
+	clo_scan_blelloch_data* data =
+		(clo_scan_blelloch_data*) clo_scan_get_data(scanner);
+
+	/* Command batch being recorded, if any. */
+	CloBatch* batch = clo_scan_get_batch(scanner);
+
 	/* If data transfer queue is NULL, use exec queue for data
 	 * transfers. */
 	if (cq_comm == NULL) cq_comm = cq_exec;
@@ -126,36 +242,56 @@ static CCLEvent* clo_scan_blelloch_scan_with_device_data(
 		prg, CLO_SCAN_BLELLOCH_KNAME_WGSCAN, &err_internal);
 	g_if_err_propagate_goto(err, err_internal, error_handler);
 
-	/* Determine worksizes. */
+	/* Determine worksizes. Each work-item scans two elements per
+	 * block, and the last block may be incomplete. */
 	lws = lws_max;
-	size_t realws = numel / 2;
+	size_t realws = CLO_DIV_CEIL(numel, 2);
 	ccl_kernel_suggest_worksizes(krnl_wgscan, dev, 1, &realws,
 		&gws_wgscan, &lws, &err_internal);
 	g_if_err_propagate_goto(err, err_internal, error_handler);
 	gws_wgscan = MIN(gws_wgscan, lws * lws);
-	ws_wgsumsscan = (gws_wgscan / lws) / 2;
+	num_wgsums = gws_wgscan / lws;
+	ws_wgsumsscan = MAX(clo_nlpo2(num_wgsums) / 2, 1);
 	gws_addwgsums = CLO_GWS_MULT(numel, lws);
 
 	/* Determine number of blocks to be processed per workgroup. */
-	blocks_per_wg = CLO_DIV_CEIL(numel / 2, gws_wgscan);
+	blocks_per_wg = CLO_DIV_CEIL(realws, gws_wgscan);
 	numel_cl = numel;
 
-	/* Create temporary buffer. */
-	dev_wgsums = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
-		(gws_wgscan / lws) * size_sum, NULL, &err_internal);
-	g_if_err_propagate_goto(err, err_internal, error_handler);
+	/* Use the given workspace for the workgroup-wise sums, which
+	 * must be large enough, or create a temporary buffer if none was
+	 * given. */
+	if (workspace != NULL) {
+		size_t ws_size = ccl_memobj_get_info_scalar(
+			workspace, CL_MEM_SIZE, size_t, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		g_if_err_create_goto(*err, CLO_ERROR,
+			ws_size < num_wgsums * size_sum, CLO_ERROR_ARGS, error_handler,
+			"Scan workspace too small (%d < %d bytes).",
+			(int) ws_size, (int) (num_wgsums * size_sum));
+		dev_wgsums = workspace;
+	}
+	if (dev_wgsums == NULL) {
+		dev_wgsums_own = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+			num_wgsums * size_sum, NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		dev_wgsums = dev_wgsums_own;
+	}
 
 	/* Set wgscan kernel arguments. */
-	ccl_kernel_set_args(krnl_wgscan, data_in, data_out, dev_wgsums,
-		ccl_arg_full(NULL, size_sum * lws * 2),
-		ccl_arg_priv(numel_cl, cl_uint),
-		ccl_arg_priv(blocks_per_wg, cl_uint), NULL);
+	clo_batch_set_buffer(batch, krnl_wgscan, 0, data_in);
+	clo_batch_set_buffer(batch, krnl_wgscan, 1, data_out);
+	clo_batch_set_buffer(batch, krnl_wgscan, 2, dev_wgsums);
+	clo_batch_set_arg(batch, krnl_wgscan, 3,
+		size_sum * clo_scan_blelloch_aux_numel(data, lws), NULL);
+	clo_batch_set_arg_priv(batch, krnl_wgscan, 4, numel_cl, cl_uint);
+	clo_batch_set_arg_priv(batch, krnl_wgscan, 5, blocks_per_wg, cl_uint);
 
 	/* Perform workgroup-wise scan on complete array. */
-	evt = ccl_kernel_enqueue_ndrange(krnl_wgscan, cq_exec, 1, NULL,
-		&gws_wgscan, &lws, NULL, &err_internal);
+	evt = clo_batch_enqueue_ndrange(batch, krnl_wgscan, cq_exec, 1,
+		&gws_wgscan, &lws, NULL, "clo_scan_blelloch_wgscan",
+		&err_internal);
 	g_if_err_propagate_goto(err, err_internal, error_handler);
-	ccl_event_set_name(evt, "clo_scan_blelloch_wgscan");
 
 	g_debug("N: %d, GWS1: %d, WS2: %d, GWS3: %d | LWS: %d | BPWG=%d | Enter? %s",
 		(int) numel, (int) gws_wgscan, (int) ws_wgsumsscan,
@@ -173,24 +309,28 @@ static CCLEvent* clo_scan_blelloch_scan_with_device_data(
 		g_if_err_propagate_goto(err, err_internal, error_handler);
 
 		/* Perform scan on workgroup sums array. */
-		evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_wgsumsscan,
-			cq_exec, 1, NULL, &ws_wgsumsscan, &ws_wgsumsscan, NULL,
-			&err_internal,
-			/* Argument list. */
-			dev_wgsums, ccl_arg_full(NULL, size_sum * lws * 2),
-			NULL);
+		clo_batch_set_buffer(batch, krnl_wgsumsscan, 0, dev_wgsums);
+		clo_batch_set_arg(batch, krnl_wgsumsscan, 1,
+			size_sum * clo_scan_blelloch_aux_numel(data, lws), NULL);
+		clo_batch_set_arg_priv(
+			batch, krnl_wgsumsscan, 2, num_wgsums, cl_uint);
+		evt = clo_batch_enqueue_ndrange(batch, krnl_wgsumsscan,
+			cq_exec, 1, &ws_wgsumsscan, &ws_wgsumsscan, NULL,
+			"clo_scan_blelloch_wgsumsscan", &err_internal);
 		g_if_err_propagate_goto(err, err_internal, error_handler);
-		ccl_event_set_name(evt, "clo_scan_blelloch_wgsumsscan");
 
 		/* Add the workgroup-wise sums to the respective workgroup
 		 * elements.*/
-		evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_addwgsums,
-			cq_exec, 1, NULL, &gws_addwgsums, &lws, NULL, &err_internal,
-			/* Argument list. */
-			dev_wgsums, data_out, ccl_arg_priv(blocks_per_wg, cl_uint),
-			NULL);
+		clo_batch_set_buffer(batch, krnl_addwgsums, 0, dev_wgsums);
+		clo_batch_set_buffer(batch, krnl_addwgsums, 1, data_out);
+		clo_batch_set_arg_priv(
+			batch, krnl_addwgsums, 2, blocks_per_wg, cl_uint);
+		clo_batch_set_arg_priv(
+			batch, krnl_addwgsums, 3, numel_cl, cl_uint);
+		evt = clo_batch_enqueue_ndrange(batch, krnl_addwgsums,
+			cq_exec, 1, &gws_addwgsums, &lws, NULL,
+			"clo_scan_blelloch_addwgsums", &err_internal);
 		g_if_err_propagate_goto(err, err_internal, error_handler);
-		ccl_event_set_name(evt, "clo_scan_blelloch_addwgsums");
 
 	}
 
@@ -205,8 +345,8 @@ error_handler:
 
 finish:
 
-	/* Release temporary buffer. */
-	if (dev_wgsums) ccl_buffer_destroy(dev_wgsums);
+	/* Release temporary buffer, if one was created. */
+	if (dev_wgsums_own) ccl_buffer_destroy(dev_wgsums_own);
 
 	/* Return event wait list. */
 	return evt;
@@ -287,6 +427,9 @@ static size_t clo_scan_blelloch_get_localmem_usage(CloScan* scanner,
 	size_t realws, gws;
 	/* Device where scan will take place. */
 	CCLDevice* dev = NULL;
+	/* Internal data. */
+	clo_scan_blelloch_data* data =
+		(clo_scan_blelloch_data*) clo_scan_get_data(scanner);
 
 	/* Get device where sort will take place (it is assumed to be the
 	 * first device in the context). */
@@ -295,7 +438,7 @@ static size_t clo_scan_blelloch_get_localmem_usage(CloScan* scanner,
 	g_if_err_propagate_goto(err, err_internal, error_handler);
 
 	/* Determine worksizes. */
-	realws = numel / 2;
+	realws = CLO_DIV_CEIL(numel, 2);
 	ccl_kernel_suggest_worksizes(
 		NULL, dev, 1, &realws, &gws, &lws_max, &err_internal);
 	g_if_err_propagate_goto(err, err_internal, error_handler);
@@ -303,10 +446,10 @@ static size_t clo_scan_blelloch_get_localmem_usage(CloScan* scanner,
 	/* Determine local mem usage. */
 	switch (i) {
 		case CLO_SCAN_BLELLOCH_KIDX_WGSCAN:
-			local_mem = clo_scan_get_sum_size(scanner) * lws_max * 2;
-			break;
 		case CLO_SCAN_BLELLOCH_KIDX_WGSUMSSCAN:
-			local_mem = clo_scan_get_sum_size(scanner) * lws_max * 2;
+			/* Auxiliary memory, including padding if enabled. */
+			local_mem = clo_scan_get_sum_size(scanner)
+				* clo_scan_blelloch_aux_numel(data, lws_max);
 			break;
 		case CLO_SCAN_BLELLOCH_KIDX_ADDWGSUMS:
 			local_mem = 0;
@@ -331,6 +474,53 @@ finish:
 
 }
 
+/**
+ * @internal
+ * Get size in bytes of the device workspace required by the scan
+ * implementation, i.e. of the workgroup-wise sums buffer.
+ * */
+static size_t clo_scan_blelloch_get_workspace_size(CloScan* scanner,
+	CCLDevice* dev, size_t numel, size_t lws_max, GError** err) {
+
+	/* Internal error handling object. */
+	GError* err_internal = NULL;
+	/* Workspace size. */
+	size_t ws_size;
+	/* Worksizes. */
+	size_t realws, gws;
+	/* Kernel which determines the number of workgroup-wise sums. */
+	CCLKernel* krnl_wgscan = NULL;
+
+	/* Get the wgscan kernel wrapper. */
+	krnl_wgscan = ccl_program_get_kernel(clo_scan_get_program(scanner),
+		CLO_SCAN_BLELLOCH_KNAME_WGSCAN, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Determine worksizes, as in the scan itself. */
+	realws = CLO_DIV_CEIL(numel, 2);
+	ccl_kernel_suggest_worksizes(krnl_wgscan, dev, 1, &realws, &gws,
+		&lws_max, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	gws = MIN(gws, lws_max * lws_max);
+
+	/* One sum per workgroup. */
+	ws_size = (gws / lws_max) * clo_scan_get_sum_size(scanner);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	ws_size = 0;
+
+finish:
+	/* Return workspace size. */
+	return ws_size;
+
+}
+
 /* Definition of the Blelloch scan implementation. */
 const CloScanImplDef clo_scan_blelloch_def = {
 	"blelloch",
@@ -339,5 +529,6 @@ const CloScanImplDef clo_scan_blelloch_def = {
 	clo_scan_blelloch_scan_with_device_data,
 	clo_scan_blelloch_get_num_kernels,
 	clo_scan_blelloch_get_kernel_name,
-	clo_scan_blelloch_get_localmem_usage
+	clo_scan_blelloch_get_localmem_usage,
+	clo_scan_blelloch_get_workspace_size
 };
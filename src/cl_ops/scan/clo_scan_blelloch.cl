@@ -27,15 +27,41 @@
  *
  * A maximum of three kernels are called for problems of any size, with
  * the first kernel serializing the scan operation when the array size
- * is larger than the squared local worksize.
+ * is larger than the squared local worksize. The array size does not
+ * need to be a multiple of the block size (twice the local worksize):
+ * out-of-range elements of the last block are loaded as the identity
+ * value and are not stored.
  *
  * These kernels expect two constants to be set in the compiler options:
  *
  * * `CLO_SCAN_ELEM_TYPE` - Type of elements to sum (uint, ulong, etc.)
  * * `CLO_SCAN_SUM_TYPE` - Type of summed elements (uint, ulong, etc.)
  *
+ * And three macros to be defined before this source:
+ *
+ * * `CLO_SCAN_OP(a, b)` - Associative operator combining `a` and `b`,
+ * where `a` precedes `b` (e.g. `((a) + (b))`).
+ * * `CLO_SCAN_IDENTITY` - Identity element of `CLO_SCAN_OP`.
+ * * `CLO_SCAN_CONVERT(x)` - Converts an element to scan to the type of
+ * summed elements.
+ *
+ * If the `CLO_SCAN_INCLUSIVE` constant is defined, each scanned element
+ * also includes the respective input element (inclusive scan).
+ *
+ * If the `CLO_SCAN_BLELLOCH_LOG_NUM_BANKS` constant is defined, local
+ * memory is padded with one element every 2^CLO_SCAN_BLELLOCH_LOG_NUM_BANKS
+ * elements, which avoids most bank conflicts in the up and down sweeps.
+ *
  */
 
+/* Index of the i^th element in auxiliary local memory. */
+#ifdef CLO_SCAN_BLELLOCH_LOG_NUM_BANKS
+#define CLO_SCAN_BLELLOCH_PAD(i) \
+	((i) + ((i) >> CLO_SCAN_BLELLOCH_LOG_NUM_BANKS))
+#else
+#define CLO_SCAN_BLELLOCH_PAD(i) (i)
+#endif
+
 /**
  * Performs a workgroup-wise scan.
  *
@@ -64,10 +90,11 @@ __kernel void workgroupScan(
 	__local CLO_SCAN_SUM_TYPE in_sum[1];
 
 	if (lid == 0) {
-		in_sum[0] = 0;
+		in_sum[0] = CLO_SCAN_IDENTITY;
 	}
 
-	for (uint b = 0; (b < blocks_per_wg) && ((wgid * blocks_per_wg + b) < (numel / block_size)); b++) {
+	for (uint b = 0; (b < blocks_per_wg)
+		&& ((wgid * blocks_per_wg + b) * block_size < numel); b++) {
 
 		/* These global memory offsets improve memory coalescing. */
 		uint goffset1 = (blocks_per_wg * wgid + b) * block_size + lid;
@@ -75,17 +102,24 @@ __kernel void workgroupScan(
 
 		uint offset = 1;
 
-		/* Load input data into local memory. */
-		aux[lid] = data_in[goffset1];
-		aux[lid + lsize] = data_in[goffset2];
+		/* Load input data into local memory, using the identity value
+		 * for out-of-range elements in the last block. */
+		CLO_SCAN_SUM_TYPE x1 = (goffset1 < numel)
+			? CLO_SCAN_CONVERT(data_in[goffset1])
+			: CLO_SCAN_IDENTITY;
+		CLO_SCAN_SUM_TYPE x2 = (goffset2 < numel)
+			? CLO_SCAN_CONVERT(data_in[goffset2])
+			: CLO_SCAN_IDENTITY;
+		aux[CLO_SCAN_BLELLOCH_PAD(lid)] = x1;
+		aux[CLO_SCAN_BLELLOCH_PAD(lid + lsize)] = x2;
 
 		/* Upsweep: build sum in place up the tree. */
 		for (uint d = block_size >> 1; d > 0; d >>= 1) {
 			barrier(CLK_LOCAL_MEM_FENCE);
 			if (lid < d) {
-				uint ai = offset * (2 * lid + 1) - 1;
-				uint bi = offset * (2 * lid + 2) - 1;
-				aux[bi] += aux[ai];
+				uint ai = CLO_SCAN_BLELLOCH_PAD(offset * (2 * lid + 1) - 1);
+				uint bi = CLO_SCAN_BLELLOCH_PAD(offset * (2 * lid + 2) - 1);
+				aux[bi] = CLO_SCAN_OP(aux[ai], aux[bi]);
 			}
 			offset *= 2;
 		}
@@ -94,9 +128,10 @@ __kernel void workgroupScan(
 		barrier(CLK_LOCAL_MEM_FENCE);
 		if (lid == 0) {
 			/* Store the last element in intermediate sum. */
-			in_sum[0] += aux[block_size - 1];
+			in_sum[0] = CLO_SCAN_OP(
+				in_sum[0], aux[CLO_SCAN_BLELLOCH_PAD(block_size - 1)]);
 			/* Clear the last element. */
-			aux[block_size - 1] = 0;
+			aux[CLO_SCAN_BLELLOCH_PAD(block_size - 1)] = CLO_SCAN_IDENTITY;
 		}
 		barrier(CLK_LOCAL_MEM_FENCE);
 
@@ -105,18 +140,29 @@ __kernel void workgroupScan(
 			offset >>= 1;
 			barrier(CLK_LOCAL_MEM_FENCE);
 			if (lid < d) {
-				uint ai = offset * (2 * lid + 1) - 1;
-				uint bi = offset * (2 * lid + 2) - 1;
+				uint ai = CLO_SCAN_BLELLOCH_PAD(offset * (2 * lid + 1) - 1);
+				uint bi = CLO_SCAN_BLELLOCH_PAD(offset * (2 * lid + 2) - 1);
 				CLO_SCAN_SUM_TYPE t = aux[ai];
 				aux[ai] = aux[bi];
-				aux[bi] += t;
+				aux[bi] = CLO_SCAN_OP(aux[bi], t);
 			}
 		}
 		barrier(CLK_LOCAL_MEM_FENCE);
 
-		/* Save scan result to global memory, adding the intermediate sum. */
-		data_out[goffset1] = aux[lid] + in_sum_prev;
-		data_out[goffset2] = aux[lid + lsize] + in_sum_prev;
+		/* Get scan results, adding the intermediate sum. */
+		CLO_SCAN_SUM_TYPE y1 =
+			CLO_SCAN_OP(in_sum_prev, aux[CLO_SCAN_BLELLOCH_PAD(lid)]);
+		CLO_SCAN_SUM_TYPE y2 =
+			CLO_SCAN_OP(in_sum_prev, aux[CLO_SCAN_BLELLOCH_PAD(lid + lsize)]);
+#ifdef CLO_SCAN_INCLUSIVE
+		/* Include the respective input elements. */
+		y1 = CLO_SCAN_OP(y1, x1);
+		y2 = CLO_SCAN_OP(y2, x2);
+#endif
+
+		/* Save scan result to global memory. */
+		if (goffset1 < numel) data_out[goffset1] = y1;
+		if (goffset2 < numel) data_out[goffset2] = y2;
 	}
 
 	if (lid == 0) {
@@ -130,10 +176,13 @@ __kernel void workgroupScan(
  *
  * @param data_wgsum Workgroup-wise sums.
  * @param aux Auxiliary local memory.
+ * @param num_wgsums Number of workgroup-wise sums, which must not be
+ * larger than twice the local worksize.
  */
 __kernel void workgroupSumsScan(
 			__global CLO_SCAN_SUM_TYPE *data_wgsum,
-			__local CLO_SCAN_SUM_TYPE *aux)
+			__local CLO_SCAN_SUM_TYPE *aux,
+			uint num_wgsums)
 {
 
 	uint lid = get_local_id(0);
@@ -141,17 +190,20 @@ __kernel void workgroupSumsScan(
 	uint block_size = lsize * 2;
 	uint offset = 1;
 
-    /* Load input data into local memory. */
-	aux[lid] = data_wgsum[lid];
-	aux[lid + lsize] = data_wgsum[lid + lsize];
+	/* Load input data into local memory, using the identity value for
+	 * out-of-range elements. */
+	aux[CLO_SCAN_BLELLOCH_PAD(lid)] = (lid < num_wgsums)
+		? data_wgsum[lid] : CLO_SCAN_IDENTITY;
+	aux[CLO_SCAN_BLELLOCH_PAD(lid + lsize)] = (lid + lsize < num_wgsums)
+		? data_wgsum[lid + lsize] : CLO_SCAN_IDENTITY;
 
     /* Upsweep: build sum in place up the tree. */
 	for (uint d = block_size >> 1; d > 0; d >>= 1) {
 		barrier(CLK_LOCAL_MEM_FENCE);
 		if (lid < d) {
-			uint ai = offset * (2 * lid + 1) - 1;
-			uint bi = offset * (2 * lid + 2) - 1;
-			aux[bi] += aux[ai];
+			uint ai = CLO_SCAN_BLELLOCH_PAD(offset * (2 * lid + 1) - 1);
+			uint bi = CLO_SCAN_BLELLOCH_PAD(offset * (2 * lid + 2) - 1);
+			aux[bi] = CLO_SCAN_OP(aux[ai], aux[bi]);
 		}
 		offset *= 2;
 	}
@@ -159,7 +211,7 @@ __kernel void workgroupSumsScan(
  	barrier(CLK_LOCAL_MEM_FENCE);
 	if (lid == 0) {
 		/* Clear the last element. */
-		aux[block_size - 1] = 0;
+		aux[CLO_SCAN_BLELLOCH_PAD(block_size - 1)] = CLO_SCAN_IDENTITY;
 	}
 
  	/* Downsweep: traverse down tree and build scan. */
@@ -167,18 +219,20 @@ __kernel void workgroupSumsScan(
 		offset >>= 1;
 		barrier(CLK_LOCAL_MEM_FENCE);
 		if (lid < d) {
-			uint ai = offset * (2 * lid + 1) - 1;
-			uint bi = offset * (2 * lid + 2) - 1;
+			uint ai = CLO_SCAN_BLELLOCH_PAD(offset * (2 * lid + 1) - 1);
+			uint bi = CLO_SCAN_BLELLOCH_PAD(offset * (2 * lid + 2) - 1);
 			CLO_SCAN_SUM_TYPE t = aux[ai];
 			aux[ai] = aux[bi];
-			aux[bi] += t;
+			aux[bi] = CLO_SCAN_OP(aux[bi], t);
 		}
 	}
 	barrier(CLK_LOCAL_MEM_FENCE);
 
 	/* Save scan result to global memory. */
-	data_wgsum[lid] = aux[lid];
-	data_wgsum[lid + lsize] = aux[lid + lsize];
+	if (lid < num_wgsums)
+		data_wgsum[lid] = aux[CLO_SCAN_BLELLOCH_PAD(lid)];
+	if (lid + lsize < num_wgsums)
+		data_wgsum[lid + lsize] = aux[CLO_SCAN_BLELLOCH_PAD(lid + lsize)];
 }
 
 /**
@@ -189,11 +243,13 @@ __kernel void workgroupSumsScan(
  * @param data_out Location where to place scan results.
  * @param blocks_per_wg Number of blocks each workgroup of "workgroupScan"
  * kernel to scanned.
+ * @param numel Number of elements to scan.
  */
 __kernel void addWorkgroupSums(
 	__global CLO_SCAN_SUM_TYPE *data_wgsum,
 	__global CLO_SCAN_SUM_TYPE *data_out,
-	uint blocks_per_wg)
+	uint blocks_per_wg,
+	uint numel)
 {
 	__local CLO_SCAN_SUM_TYPE wgsum[1];
 	uint gid = get_global_id(0);
@@ -204,8 +260,9 @@ __kernel void addWorkgroupSums(
 	}
 	barrier(CLK_LOCAL_MEM_FENCE);
 
-	/* Then each workitem adds the sum to their respective array
-	 * element. */
-	data_out[gid] += wgsum[0];
+	/* Then each workitem combines the sum with their respective array
+	 * element, if within bounds. */
+	if (gid < numel)
+		data_out[gid] = CLO_SCAN_OP(wgsum[0], data_out[gid]);
 
 }
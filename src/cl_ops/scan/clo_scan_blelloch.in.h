@@ -42,6 +42,10 @@
 #define CLO_SCAN_BLELLOCH_KNAME_WGSUMSSCAN "workgroupSumsScan"
 #define CLO_SCAN_BLELLOCH_KNAME_ADDWGSUMS "addWorkgroupSums"
 
+/* Log2 of the number of local memory banks assumed by the padded
+ * (bank-conflict-free) local memory layout. */
+#define CLO_SCAN_BLELLOCH_LOG_NUM_BANKS 5
+
 /** Definition of the Blelloch scan implementation. */
 extern const CloScanImplDef clo_scan_blelloch_def;
 
@@ -0,0 +1,70 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Kernels common to all scan implementations.
+ *
+ * These kernels are compiled together with the scan implementation
+ * source, and expect the same constants and macros to be defined. If
+ * `CLO_SCAN_INCLUSIVE` is defined, scans are inclusive.
+ *
+ */
+
+/**
+ * Saves the last element to scan in the first position of the total
+ * buffer, before an exclusive scan is performed (possibly in place).
+ *
+ * @param data_in Vector to scan.
+ * @param total Buffer where the scan total will be placed.
+ * @param numel Number of elements to scan.
+ */
+__kernel void scanTotalLast(
+	__global CLO_SCAN_ELEM_TYPE *data_in,
+	__global CLO_SCAN_SUM_TYPE *total,
+	uint numel)
+{
+	if (get_global_id(0) == 0) {
+		total[0] = (numel > 0)
+			? CLO_SCAN_CONVERT(data_in[numel - 1])
+			: CLO_SCAN_IDENTITY;
+	}
+}
+
+/**
+ * Places the scan total in the first position of the total buffer,
+ * after the scan is performed.
+ *
+ * @param data_out Scan results.
+ * @param total Buffer where the scan total will be placed. For
+ * exclusive scans, it must contain the last element to scan.
+ * @param numel Number of elements scanned.
+ */
+__kernel void scanTotal(
+	__global CLO_SCAN_SUM_TYPE *data_out,
+	__global CLO_SCAN_SUM_TYPE *total,
+	uint numel)
+{
+	if ((get_global_id(0) == 0) && (numel > 0)) {
+#ifdef CLO_SCAN_INCLUSIVE
+		total[0] = data_out[numel - 1];
+#else
+		total[0] = CLO_SCAN_OP(data_out[numel - 1], total[0]);
+#endif
+	}
+}
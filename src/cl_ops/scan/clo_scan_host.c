@@ -0,0 +1,597 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Host scan definitions.
+ *
+ * Elements are scanned in host memory, so that small inputs don't pay
+ * for kernel dispatch and results can be checked against a trusted
+ * reference. Device buffers are mapped into host memory. Since OpenCL
+ * C operators can't be evaluated on the host, only prefix sums of
+ * scalar types (except `half`) are supported. The host scan doesn't
+ * require an OpenCL context, so it remains available when no OpenCL
+ * platform is.
+ * */
+
+#include "cl_ops/clo_scan_host.h"
+#include "common/_g_err_macros.h"
+#include <string.h>
+#ifdef __AVX2__
+	#include <immintrin.h>
+#endif
+
+/**
+ * @internal
+ * Generates a prefix sum function for elements and sums of the same
+ * type. Sums are accumulated in the given type, so that integer sums
+ * wrap around as they do in the device.
+ *
+ * @param[in] name Name of the function to generate.
+ * @param[in] type Type of elements and sums.
+ * @param[in] acc_type Accumulator type (unsigned for integers).
+ * */
+#define CLO_SCAN_HOST_SUM(name, type, acc_type) \
+	static void name(const type* in, type* out, size_t numel, \
+		cl_bool inclusive) { \
+		acc_type acc = 0, x; \
+		size_t i; \
+		if (inclusive) { \
+			for (i = 0; i < numel; ++i) { \
+				acc += (acc_type) in[i]; \
+				out[i] = (type) acc; \
+			} \
+		} else { \
+			for (i = 0; i < numel; ++i) { \
+				x = (acc_type) in[i]; \
+				out[i] = (type) acc; \
+				acc += x; \
+			} \
+		} \
+	}
+
+CLO_SCAN_HOST_SUM(clo_scan_host_sum_char, cl_char, cl_uchar)
+CLO_SCAN_HOST_SUM(clo_scan_host_sum_uchar, cl_uchar, cl_uchar)
+CLO_SCAN_HOST_SUM(clo_scan_host_sum_short, cl_short, cl_ushort)
+CLO_SCAN_HOST_SUM(clo_scan_host_sum_ushort, cl_ushort, cl_ushort)
+CLO_SCAN_HOST_SUM(clo_scan_host_sum_uint, cl_uint, cl_uint)
+CLO_SCAN_HOST_SUM(clo_scan_host_sum_long, cl_long, cl_ulong)
+CLO_SCAN_HOST_SUM(clo_scan_host_sum_ulong, cl_ulong, cl_ulong)
+CLO_SCAN_HOST_SUM(clo_scan_host_sum_float, cl_float, cl_float)
+CLO_SCAN_HOST_SUM(clo_scan_host_sum_double, cl_double, cl_double)
+
+#ifdef __AVX2__
+
+/**
+ * @internal
+ * Prefix sum of 32-bit integers (signed or unsigned, since sums wrap
+ * around), eight elements at a time. The eight elements are scanned in
+ * registers with AVX2 shifts and additions, first within each 128-bit
+ * lane and then across lanes, and the running total is carried in a
+ * register. Exclusive sums are obtained by subtracting the elements
+ * from the inclusive sums. Remaining elements are scanned by the
+ * scalar version.
+ * */
+static void clo_scan_host_sum_32(const cl_uint* in, cl_uint* out,
+	size_t numel, cl_bool inclusive) {
+
+	const __m256i last = _mm256_set1_epi32(7);
+	__m256i carry = _mm256_setzero_si256();
+	__m256i x, s;
+	cl_uint acc;
+	size_t i, j;
+
+	for (i = 0; i + 8 <= numel; i += 8) {
+		x = _mm256_loadu_si256((const __m256i*) (in + i));
+		s = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+		s = _mm256_add_epi32(s, _mm256_slli_si256(s, 8));
+		s = _mm256_add_epi32(s, _mm256_permute2x128_si256(
+			_mm256_shuffle_epi32(s, 0xFF), s, 0x08));
+		s = _mm256_add_epi32(s, carry);
+		carry = _mm256_permutevar8x32_epi32(s, last);
+		_mm256_storeu_si256((__m256i*) (out + i),
+			inclusive ? s : _mm256_sub_epi32(s, x));
+	}
+	acc = (cl_uint) _mm_cvtsi128_si32(_mm256_castsi256_si128(carry));
+	clo_scan_host_sum_uint(in + i, out + i, numel - i, inclusive);
+	for (j = i; j < numel; ++j) out[j] += acc;
+}
+
+#else
+
+/**
+ * @internal
+ * Prefix sum of 32-bit integers (signed or unsigned, since sums wrap
+ * around).
+ * */
+#define clo_scan_host_sum_32(in, out, numel, inclusive) \
+	clo_scan_host_sum_uint((in), (out), (numel), (inclusive))
+
+#endif
+
+/**
+ * @internal
+ * Get the i^th element of the given integer type, as an unsigned 64-bit
+ * integer (sign extended for signed types).
+ * */
+static cl_ulong clo_scan_host_get_int(
+	CloType type, const void* data, size_t i) {
+
+	switch (type) {
+		case CLO_CHAR: return (cl_ulong) ((const cl_char*) data)[i];
+		case CLO_UCHAR: return ((const cl_uchar*) data)[i];
+		case CLO_SHORT: return (cl_ulong) ((const cl_short*) data)[i];
+		case CLO_USHORT: return ((const cl_ushort*) data)[i];
+		case CLO_INT: return (cl_ulong) ((const cl_int*) data)[i];
+		case CLO_UINT: return ((const cl_uint*) data)[i];
+		case CLO_LONG: return (cl_ulong) ((const cl_long*) data)[i];
+		case CLO_ULONG: return ((const cl_ulong*) data)[i];
+		case CLO_FLOAT:
+			return (cl_ulong) (cl_long) ((const cl_float*) data)[i];
+		case CLO_DOUBLE:
+			return (cl_ulong) (cl_long) ((const cl_double*) data)[i];
+		default: g_assert_not_reached();
+	}
+	return 0;
+}
+
+/**
+ * @internal
+ * Get the i^th element of the given type as a double.
+ * */
+static cl_double clo_scan_host_get_float(
+	CloType type, const void* data, size_t i) {
+
+	switch (type) {
+		case CLO_CHAR: return ((const cl_char*) data)[i];
+		case CLO_UCHAR: return ((const cl_uchar*) data)[i];
+		case CLO_SHORT: return ((const cl_short*) data)[i];
+		case CLO_USHORT: return ((const cl_ushort*) data)[i];
+		case CLO_INT: return ((const cl_int*) data)[i];
+		case CLO_UINT: return ((const cl_uint*) data)[i];
+		case CLO_LONG: return (cl_double) ((const cl_long*) data)[i];
+		case CLO_ULONG: return (cl_double) ((const cl_ulong*) data)[i];
+		case CLO_FLOAT: return ((const cl_float*) data)[i];
+		case CLO_DOUBLE: return ((const cl_double*) data)[i];
+		default: g_assert_not_reached();
+	}
+	return 0;
+}
+
+/**
+ * @internal
+ * Set the i^th element of the given type from an unsigned 64-bit
+ * integer or, for floating point types, from a double.
+ * */
+static void clo_scan_host_set(CloType type, void* data, size_t i,
+	cl_ulong vi, cl_double vf) {
+
+	switch (type) {
+		case CLO_CHAR: ((cl_char*) data)[i] = (cl_char) vi; break;
+		case CLO_UCHAR: ((cl_uchar*) data)[i] = (cl_uchar) vi; break;
+		case CLO_SHORT: ((cl_short*) data)[i] = (cl_short) vi; break;
+		case CLO_USHORT: ((cl_ushort*) data)[i] = (cl_ushort) vi; break;
+		case CLO_INT: ((cl_int*) data)[i] = (cl_int) vi; break;
+		case CLO_UINT: ((cl_uint*) data)[i] = (cl_uint) vi; break;
+		case CLO_LONG: ((cl_long*) data)[i] = (cl_long) vi; break;
+		case CLO_ULONG: ((cl_ulong*) data)[i] = vi; break;
+		case CLO_FLOAT: ((cl_float*) data)[i] = (cl_float) vf; break;
+		case CLO_DOUBLE: ((cl_double*) data)[i] = vf; break;
+		default: g_assert_not_reached();
+	}
+}
+
+/**
+ * Perform a prefix sum of scalar elements in host memory. This
+ * function doesn't use OpenCL, and can be used as a reference for
+ * checking the results of other scan implementations. Integer sums wrap
+ * around, as in the device. Elements and sums of the same type are
+ * scanned with a tight loop for the type, vectorized with AVX2 for
+ * 32-bit integers if available at compile time; otherwise, elements
+ * are converted to the sum type one at a time.
+ *
+ * @param[in] elem_type Type of elements to scan, must be a scalar type
+ * other than `half`.
+ * @param[in] sum_type Type of scanned elements, must be a scalar type
+ * other than `half`.
+ * @param[in] data_in Elements to scan.
+ * @param[out] data_out Location where to place scanned elements. Can be
+ * the same as `data_in`.
+ * @param[in] numel Number of elements to scan.
+ * @param[in] inclusive Perform an inclusive scan?
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if scan was successfully performed, `CL_FALSE`
+ * otherwise.
+ * */
+cl_bool clo_scan_host_sum(CloType elem_type, CloType sum_type,
+	const void* data_in, void* data_out, size_t numel,
+	cl_bool inclusive, GError** err) {
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+	/* Function return status. */
+	cl_bool status;
+
+	/* Accumulators and current element. */
+	cl_ulong acc_i = 0, x_i;
+	cl_double acc_f = 0, x_f;
+
+	/* Is the sum type a floating point type? */
+	cl_bool sum_float = (sum_type == CLO_FLOAT) || (sum_type == CLO_DOUBLE);
+
+	/* Check types. */
+	g_if_err_create_goto(*err, CLO_ERROR,
+		(elem_type > CLO_DOUBLE) || (elem_type == CLO_HALF)
+			|| (sum_type > CLO_DOUBLE) || (sum_type == CLO_HALF),
+		CLO_ERROR_ARGS, error_handler,
+		"The host scan only supports scalar types other than half, "
+		"not '%s' and '%s'.",
+		clo_type_get_name(elem_type), clo_type_get_name(sum_type));
+
+	/* Elements and sums of the same type. */
+	if (elem_type == sum_type) {
+		switch (sum_type) {
+			case CLO_CHAR:
+				clo_scan_host_sum_char(
+					data_in, data_out, numel, inclusive);
+				break;
+			case CLO_UCHAR:
+				clo_scan_host_sum_uchar(
+					data_in, data_out, numel, inclusive);
+				break;
+			case CLO_SHORT:
+				clo_scan_host_sum_short(
+					data_in, data_out, numel, inclusive);
+				break;
+			case CLO_USHORT:
+				clo_scan_host_sum_ushort(
+					data_in, data_out, numel, inclusive);
+				break;
+			case CLO_INT:
+			case CLO_UINT:
+				clo_scan_host_sum_32(
+					data_in, data_out, numel, inclusive);
+				break;
+			case CLO_LONG:
+				clo_scan_host_sum_long(
+					data_in, data_out, numel, inclusive);
+				break;
+			case CLO_ULONG:
+				clo_scan_host_sum_ulong(
+					data_in, data_out, numel, inclusive);
+				break;
+			case CLO_FLOAT:
+				clo_scan_host_sum_float(
+					data_in, data_out, numel, inclusive);
+				break;
+			default:
+				clo_scan_host_sum_double(
+					data_in, data_out, numel, inclusive);
+		}
+		goto success;
+	}
+
+	/* Elements and sums of different types. Each element is read
+	 * before the respective sum is written, so data can be scanned in
+	 * place. */
+	for (size_t i = 0; i < numel; ++i) {
+		if (sum_float) {
+			x_f = clo_scan_host_get_float(elem_type, data_in, i);
+			if (inclusive) acc_f += x_f;
+			clo_scan_host_set(sum_type, data_out, i, 0, acc_f);
+			if (!inclusive) acc_f += x_f;
+		} else {
+			x_i = clo_scan_host_get_int(elem_type, data_in, i);
+			if (inclusive) acc_i += x_i;
+			clo_scan_host_set(sum_type, data_out, i, acc_i, 0);
+			if (!inclusive) acc_i += x_i;
+		}
+	}
+
+success:
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	status = CL_TRUE;
+	goto finish;
+
+error_handler:
+
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	status = CL_FALSE;
+
+finish:
+
+	/* Return function status. */
+	return status;
+
+}
+
+/**
+ * @internal
+ * Perform scan using device data, which is mapped into host memory.
+ * */
+static CCLEvent* clo_scan_host_scan_with_device_data(CloScan* scanner,
+	CCLQueue* cq_exec, CCLQueue* cq_comm, CCLBuffer* data_in,
+	CCLBuffer* data_out, size_t numel, size_t lws_max,
+	CCLBuffer* workspace, GError** err) {
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Make sure cq_exec is not NULL. */
+	g_return_val_if_fail(cq_exec != NULL, NULL);
+
+	/* OpenCL object wrappers. */
+	CCLEvent* evt = NULL;
+
+	/* Mapped data. */
+	void* map_in = NULL;
+	void* map_out = NULL;
+
+	/* Internal error reporting object. */
+	GError* err_internal = NULL;
+
+	/* Is the scan in place? */
+	cl_bool in_place = (data_out == NULL) || (data_out == data_in);
+
+	/* Avoid compiler warnings, the host scan doesn't use local memory
+	 * or device workspaces. */
+	(void)lws_max;
+	(void)workspace;
+
+	/* Scanning on the host can't be recorded in command batches. */
+	g_if_err_create_goto(*err, CLO_ERROR,
+		clo_scan_get_batch(scanner) != NULL, CLO_ERROR_ARGS,
+		error_handler,
+		"The host scan can't be recorded in command batches.");
+
+	/* Data is mapped with the execution queue, so that mapping waits
+	 * for the commands which produced the data. */
+	(void)cq_comm;
+
+	/* There is nothing to map if there is no data. */
+	if (numel == 0) {
+		evt = ccl_enqueue_marker(cq_exec, NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		goto success;
+	}
+
+	/* Map data into host memory. */
+	map_in = ccl_buffer_enqueue_map(data_in, cq_exec, CL_TRUE,
+		in_place ? CL_MAP_READ | CL_MAP_WRITE : CL_MAP_READ, 0,
+		numel * clo_scan_get_element_size(scanner), NULL, NULL,
+		&err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	if (!in_place) {
+		map_out = ccl_buffer_enqueue_map(data_out, cq_exec, CL_TRUE,
+			CL_MAP_WRITE, 0, numel * clo_scan_get_sum_size(scanner),
+			NULL, NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+	}
+
+	/* Scan. */
+	clo_scan_host_sum(clo_scan_get_elem_type(scanner),
+		clo_scan_get_sum_type(scanner), map_in,
+		in_place ? map_in : map_out, numel,
+		clo_scan_get_inclusive(scanner), &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Unmap data. */
+	evt = ccl_memobj_enqueue_unmap((CCLMemObj*) data_in, cq_exec,
+		map_in, NULL, &err_internal);
+	map_in = NULL;
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	ccl_event_set_name(evt, "clo_scan_host_unmap_in");
+	if (map_out != NULL) {
+		evt = ccl_memobj_enqueue_unmap((CCLMemObj*) data_out, cq_exec,
+			map_out, NULL, &err_internal);
+		map_out = NULL;
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "clo_scan_host_unmap_out");
+	}
+
+success:
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	evt = NULL;
+
+	/* Release mapped data, if any. */
+	if (map_in != NULL)
+		ccl_memobj_enqueue_unmap(
+			(CCLMemObj*) data_in, cq_exec, map_in, NULL, NULL);
+	if (map_out != NULL)
+		ccl_memobj_enqueue_unmap(
+			(CCLMemObj*) data_out, cq_exec, map_out, NULL, NULL);
+
+finish:
+
+	/* Return event. */
+	return evt;
+
+}
+
+/**
+ * @internal
+ * Initializes a host scanner object and returns the respective source
+ * code.
+ * */
+static const char* clo_scan_host_init(
+	CloScan* scanner, const char* options, GError** err) {
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Tokenized options. */
+	gchar** opts = NULL;
+
+	/* Element and sum types. */
+	CloType elem_type = clo_scan_get_elem_type(scanner);
+	CloType sum_type = clo_scan_get_sum_type(scanner);
+
+	/* Source to be compiled. */
+	const char* host_src = NULL;
+
+	/* The host scan has no options. */
+	if (options) {
+		opts = g_strsplit_set(options, ",", -1);
+		for (guint i = 0; opts[i] != NULL; i++) {
+			g_if_err_create_goto(*err, CLO_ERROR, opts[i][0] != '\0',
+				CLO_ERROR_ARGS, error_handler,
+				"Invalid option '%s' for host scan.", opts[i]);
+		}
+	}
+
+	/* Check that the host is able to perform the scan. */
+	g_if_err_create_goto(*err, CLO_ERROR,
+		!clo_scan_get_default_op(scanner), CLO_ERROR_ARGS,
+		error_handler,
+		"The host scan only supports the default operator and identity.");
+	g_if_err_create_goto(*err, CLO_ERROR,
+		(elem_type > CLO_DOUBLE) || (elem_type == CLO_HALF)
+			|| (sum_type > CLO_DOUBLE) || (sum_type == CLO_HALF),
+		CLO_ERROR_ARGS, error_handler,
+		"The host scan only supports scalar types other than half, "
+		"not '%s' and '%s'.",
+		clo_type_get_name(elem_type), clo_type_get_name(sum_type));
+
+	/* The host scan has no specific data. */
+	clo_scan_set_data(scanner, NULL);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	host_src = CLO_SCAN_HOST_SRC;
+	goto finish;
+
+error_handler:
+
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+
+finish:
+
+	/* Free parsed options. */
+	g_strfreev(opts);
+
+	/* Return source to be compiled. */
+	return host_src;
+
+}
+
+/**
+ * @internal
+ * Finalizes a host scanner object.
+ * */
+static void clo_scan_host_finalize(CloScan* scan) {
+
+	/* Avoid compiler warnings, there is nothing to release. */
+	(void)scan;
+	return;
+}
+
+/**
+ * @internal
+ * Get the maximum number of kernels used by the scan implementation.
+ * */
+static cl_uint clo_scan_host_get_num_kernels(
+	CloScan* scanner, GError** err) {
+
+	/* Avoid compiler warnings. */
+	(void)scanner;
+	(void)err;
+
+	/* The host scan doesn't use kernels. */
+	return 0;
+
+}
+
+/**
+ * @internal
+ * Get name of the i^th kernel used by the scan implementation.
+ * */
+static const char* clo_scan_host_get_kernel_name(
+	CloScan* scanner, cl_uint i, GError** err) {
+
+	/* Avoid compiler warnings. */
+	(void)scanner;
+	(void)i;
+	(void)err;
+
+	/* The host scan doesn't use kernels. */
+	g_return_val_if_reached(NULL);
+}
+
+/**
+ * @internal
+ * Get local memory usage of i^th kernel used by the scan implementation
+ * for the given maximum local worksize and number of elements to scan.
+ * */
+static size_t clo_scan_host_get_localmem_usage(CloScan* scanner,
+	cl_uint i, size_t lws_max, size_t numel, GError** err) {
+
+	/* Avoid compiler warnings. */
+	(void)scanner;
+	(void)i;
+	(void)lws_max;
+	(void)numel;
+	(void)err;
+
+	/* The host scan doesn't use kernels. */
+	g_return_val_if_reached(0);
+}
+
+/**
+ * @internal
+ * Get size in bytes of the device workspace required by the scan
+ * implementation.
+ * */
+static size_t clo_scan_host_get_workspace_size(CloScan* scanner,
+	CCLDevice* dev, size_t numel, size_t lws_max, GError** err) {
+
+	/* Avoid compiler warnings. */
+	(void)scanner;
+	(void)dev;
+	(void)numel;
+	(void)lws_max;
+	(void)err;
+
+	/* The host scan doesn't require a device workspace. */
+	return 0;
+}
+
+/* Definition of the host scan implementation. */
+const CloScanImplDef clo_scan_host_def = {
+	CLO_SCAN_HOST_NAME,
+	clo_scan_host_init,
+	clo_scan_host_finalize,
+	clo_scan_host_scan_with_device_data,
+	clo_scan_host_get_num_kernels,
+	clo_scan_host_get_kernel_name,
+	clo_scan_host_get_localmem_usage,
+	clo_scan_host_get_workspace_size
+};
@@ -0,0 +1,44 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Host scan declarations.
+ * */
+
+#ifndef _CLO_SCAN_HOST_H_
+#define _CLO_SCAN_HOST_H_
+
+#include "cl_ops/clo_scan_abstract.h"
+
+/** The host scan has no kernels of its own, only the common scan
+ * kernels are built, and only if the scanner has a context. */
+#define CLO_SCAN_HOST_SRC "/* Scanning is performed on the host. */\n"
+
+/** Name of the host scan implementation. */
+#define CLO_SCAN_HOST_NAME "host"
+
+/* Perform a prefix sum of scalar elements in host memory. */
+cl_bool clo_scan_host_sum(CloType elem_type, CloType sum_type,
+	const void* data_in, void* data_out, size_t numel,
+	cl_bool inclusive, GError** err);
+
+/** Definition of the host scan implementation. */
+extern const CloScanImplDef clo_scan_host_def;
+
+#endif
@@ -0,0 +1,504 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Register-blocked scan definitions.
+ * */
+
+#include "cl_ops/clo_scan_rblock.h"
+#include "common/_g_err_macros.h"
+
+/**
+ * @internal
+ * Register-blocked scan internal data.
+ * */
+typedef struct {
+
+	/**
+	 * Number of values scanned by each work-item.
+	 * @private
+	 * */
+	cl_uint vpt;
+
+	/**
+	 * Scan source code, including the register-blocking constants.
+	 * @private
+	 * */
+	gchar* src;
+
+} clo_scan_rblock_data;
+
+/**
+ * @internal
+ * Initializes the register-blocked scan object and returns the
+ * appropriate source code.
+ * */
+static const char* clo_scan_rblock_init(CloScan* scanner,
+	const char* options, GError** err) {
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Register-blocked scan source code. */
+	const char* src = NULL;
+
+	/* Tokenized options. */
+	gchar** opts = NULL;
+	gchar** opt = NULL;
+
+	/* Number of tokens. */
+	int num_toks;
+
+	/* Width of vector loads and stores (zero if not possible). */
+	cl_uint vw = 0;
+
+	/* Element and sum types. */
+	CloType elem_type = clo_scan_get_elem_type(scanner);
+	CloType sum_type = clo_scan_get_sum_type(scanner);
+
+	/* Internal data. */
+	clo_scan_rblock_data* data = g_slice_new0(clo_scan_rblock_data);
+
+	/* Set internal data default values. */
+	data->vpt = CLO_SCAN_RBLOCK_VPT_DEFAULT;
+
+	/* Check options. */
+	if (options) {
+		opts = g_strsplit_set(options, ",", -1);
+		for (guint i = 0; opts[i] != NULL; i++) {
+
+			/* Ignore empty tokens. */
+			if (opts[i][0] == '\0') continue;
+
+			/* Parse current option, get key and value. */
+			opt = g_strsplit_set(opts[i], "=", 2);
+
+			/* Count number of tokens. */
+			for (num_toks = 0; opt[num_toks] != NULL; num_toks++);
+
+			/* If number of tokens is not 2 (key and value), throw error. */
+			g_if_err_create_goto(*err, CLO_ERROR, num_toks != 2,
+				CLO_ERROR_ARGS, error_handler,
+				"Invalid option '%s' for rblock scan.", opts[i]);
+
+			/* Check key/value option. */
+			if (g_strcmp0("vpt", opt[0]) == 0) {
+				/* Number of values scanned by each work-item. */
+				data->vpt = atoi(opt[1]);
+				g_if_err_create_goto(*err, CLO_ERROR,
+					(data->vpt != 8) && (data->vpt != 16)
+						&& (data->vpt != 32),
+					CLO_ERROR_ARGS, error_handler,
+					"The 'vpt' option of rblock scan must be 8, 16 or 32.");
+			} else {
+				g_if_err_create_goto(*err, CLO_ERROR, TRUE,
+					CLO_ERROR_ARGS, error_handler,
+					"Invalid option key '%s' for rblock scan.", opt[0]);
+			}
+
+			/* Free token. */
+			g_strfreev(opt);
+			opt = NULL;
+
+		}
+	}
+
+	/* Vector loads and stores are only possible with scalar element
+	 * and sum types (half values have their own load functions). */
+	if ((elem_type <= CLO_DOUBLE) && (elem_type != CLO_HALF)
+			&& (sum_type <= CLO_DOUBLE) && (sum_type != CLO_HALF))
+		vw = MIN(data->vpt, 16);
+
+	/* Prepend register-blocking constants to scan source. */
+	if (vw > 0) {
+		data->src = g_strdup_printf(
+			"#define CLO_SCAN_RBLOCK_VPT %u\n"
+			"#define CLO_SCAN_RBLOCK_VW %u\n%s",
+			data->vpt, vw, CLO_SCAN_RBLOCK_SRC);
+	} else {
+		data->src = g_strdup_printf(
+			"#define CLO_SCAN_RBLOCK_VPT %u\n%s",
+			data->vpt, CLO_SCAN_RBLOCK_SRC);
+	}
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	src = data->src;
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+
+finish:
+
+	/* Free parsed rblock options. */
+	g_strfreev(opts);
+	g_strfreev(opt);
+
+	/* Set internal data. */
+	clo_scan_set_data(scanner, data);
+
+	/* Return source to be compiled. */
+	return src;
+
+}
+
+/**
+ * @internal
+ * Finalize register-blocked scan object.
+ * */
+static void clo_scan_rblock_finalize(CloScan* scanner) {
+
+	/* Internal data. */
+	clo_scan_rblock_data* data =
+		(clo_scan_rblock_data*) clo_scan_get_data(scanner);
+
+	/* Release internal data. */
+	if (data) {
+		g_free(data->src);
+		g_slice_free(clo_scan_rblock_data, data);
+	}
+	return;
+}
+
+/**
+ * @internal
+ * Perform scan using device data.
+ * */
+static CCLEvent* clo_scan_rblock_scan_with_device_data(
+	CloScan* scanner, CCLQueue* cq_exec, CCLQueue* cq_comm,
+	CCLBuffer* data_in, CCLBuffer* data_out, size_t numel,
+	size_t lws_max, CCLBuffer* workspace, GError** err) {
+
+	/* Local worksize. */
+	size_t lws;
+
+	/* OpenCL object wrappers. */
+	CCLContext* ctx = NULL;
+	CCLProgram* prg = NULL;
+	CCLDevice* dev = NULL;
+	CCLKernel* krnl_reduce = NULL;
+	CCLKernel* krnl_sumsscan = NULL;
+	CCLKernel* krnl_scan = NULL;
+	CCLBuffer* dev_wgsums = NULL;
+	CCLBuffer* dev_wgsums_own = NULL;
+	CCLEvent* evt = NULL;
+
+	/* Internal error reporting object. */
+	GError* err_internal = NULL;
+
+	/* Number of elements and of tiles. */
+	cl_uint numel_cl, num_tiles;
+
+	/* Worksizes. */
+	size_t realws, gws;
+
+	/* Internal data. */
+	clo_scan_rblock_data* data =
+		(clo_scan_rblock_data*) clo_scan_get_data(scanner);
+
+	/* Command batch being recorded, if any. */
+	CloBatch* batch = clo_scan_get_batch(scanner);
+
+	/* If data transfer queue is NULL, use exec queue for data
+	 * transfers. */
+	if (cq_comm == NULL) cq_comm = cq_exec;
+
+	/* Get program wrapper. */
+	prg = clo_scan_get_program(scanner);
+
+	/* Size in bytes of sum scalars. */
+	size_t size_sum = clo_scan_get_sum_size(scanner);
+
+	/* Get device where scan will occurr. */
+	dev = ccl_queue_get_device(cq_exec, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Get the context wrapper. */
+	ctx = ccl_queue_get_context(cq_exec, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Get the scan kernel wrapper. */
+	krnl_scan = ccl_program_get_kernel(
+		prg, CLO_SCAN_RBLOCK_KNAME_SCAN, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Determine worksizes: each work-item scans vpt elements, and each
+	 * workgroup scans a tile of lws * vpt elements. */
+	lws = lws_max;
+	realws = CLO_DIV_CEIL(numel, data->vpt);
+	ccl_kernel_suggest_worksizes(krnl_scan, dev, 1, &realws,
+		&gws, &lws, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	num_tiles = CLO_DIV_CEIL(numel, lws * data->vpt);
+	gws = num_tiles * lws;
+	numel_cl = numel;
+
+	/* Use the given workspace for the tile-wise reductions, which
+	 * must be large enough, or create a temporary buffer if none was
+	 * given. */
+	if (workspace != NULL) {
+		size_t ws_size = ccl_memobj_get_info_scalar(
+			workspace, CL_MEM_SIZE, size_t, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		g_if_err_create_goto(*err, CLO_ERROR,
+			ws_size < num_tiles * size_sum, CLO_ERROR_ARGS, error_handler,
+			"Scan workspace too small (%d < %d bytes).",
+			(int) ws_size, (int) (num_tiles * size_sum));
+		dev_wgsums = workspace;
+	}
+	if (dev_wgsums == NULL) {
+		dev_wgsums_own = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+			num_tiles * size_sum, NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		dev_wgsums = dev_wgsums_own;
+	}
+
+	g_debug("N: %d, GWS: %d, LWS: %d, VPT: %d, Tiles: %d",
+		(int) numel, (int) gws, (int) lws, (int) data->vpt,
+		(int) num_tiles);
+
+	if (num_tiles > 1) {
+
+		/* Get the remaining kernel wrappers. */
+		krnl_reduce = ccl_program_get_kernel(
+			prg, CLO_SCAN_RBLOCK_KNAME_REDUCE, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		krnl_sumsscan = ccl_program_get_kernel(
+			prg, CLO_SCAN_RBLOCK_KNAME_SUMSSCAN, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+
+		/* Reduce each tile to a single value. */
+		clo_batch_set_buffer(batch, krnl_reduce, 0, data_in);
+		clo_batch_set_buffer(batch, krnl_reduce, 1, dev_wgsums);
+		clo_batch_set_arg(batch, krnl_reduce, 2, size_sum * lws, NULL);
+		clo_batch_set_arg_priv(batch, krnl_reduce, 3, numel_cl, cl_uint);
+		evt = clo_batch_enqueue_ndrange(batch, krnl_reduce, cq_exec, 1,
+			&gws, &lws, NULL, "clo_scan_rblock_reduce", &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+
+		/* Scan tile-wise reductions with a single workgroup. */
+		clo_batch_set_buffer(batch, krnl_sumsscan, 0, dev_wgsums);
+		clo_batch_set_arg(batch, krnl_sumsscan, 1, size_sum * lws, NULL);
+		clo_batch_set_arg_priv(
+			batch, krnl_sumsscan, 2, num_tiles, cl_uint);
+		evt = clo_batch_enqueue_ndrange(batch, krnl_sumsscan, cq_exec,
+			1, &lws, &lws, NULL, "clo_scan_rblock_sumsscan",
+			&err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	}
+
+	/* Scan each tile, starting at the respective tile value. */
+	clo_batch_set_buffer(batch, krnl_scan, 0, data_in);
+	clo_batch_set_buffer(batch, krnl_scan, 1, data_out);
+	clo_batch_set_buffer(batch, krnl_scan, 2, dev_wgsums);
+	clo_batch_set_arg(batch, krnl_scan, 3, size_sum * lws, NULL);
+	clo_batch_set_arg_priv(batch, krnl_scan, 4, numel_cl, cl_uint);
+	evt = clo_batch_enqueue_ndrange(batch, krnl_scan, cq_exec, 1,
+		&gws, &lws, NULL, "clo_scan_rblock_scan", &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	evt = NULL;
+
+finish:
+
+	/* Release temporary buffer, if one was created. */
+	if (dev_wgsums_own) ccl_buffer_destroy(dev_wgsums_own);
+
+	/* Return event wait list. */
+	return evt;
+
+}
+
+/**
+ * @internal
+ * Get the maximum number of kernels used by the scan implementation.
+ * */
+static cl_uint clo_scan_rblock_get_num_kernels(
+	CloScan* scanner, GError** err) {
+
+	/* Avoid compiler warnings. */
+	(void)scanner;
+	(void)err;
+
+	/* Return number of kernels. */
+	return CLO_SCAN_RBLOCK_NUM_KERNELS;
+
+}
+
+/**
+ * @internal
+ * Get name of the i^th kernel used by the scan implementation.
+ * */
+static const char* clo_scan_rblock_get_kernel_name(
+	CloScan* scanner, cl_uint i, GError** err) {
+
+	/* Check that i is within bounds. */
+	g_return_val_if_fail(i < CLO_SCAN_RBLOCK_NUM_KERNELS, NULL);
+
+	/* Avoid compiler warnings. */
+	(void)scanner;
+	(void)err;
+
+	/* Kernel name. */
+	const char* kernel_name = NULL;
+
+	/* Determine kernel name. */
+	switch (i) {
+		case CLO_SCAN_RBLOCK_KIDX_REDUCE:
+			kernel_name = CLO_SCAN_RBLOCK_KNAME_REDUCE;
+			break;
+		case CLO_SCAN_RBLOCK_KIDX_SUMSSCAN:
+			kernel_name = CLO_SCAN_RBLOCK_KNAME_SUMSSCAN;
+			break;
+		case CLO_SCAN_RBLOCK_KIDX_SCAN:
+			kernel_name = CLO_SCAN_RBLOCK_KNAME_SCAN;
+			break;
+		default:
+			g_assert_not_reached();
+	}
+
+	/* Return kernel name. */
+	return kernel_name;
+
+}
+
+/**
+ * @internal
+ * Get local memory usage of i^th kernel used by the scan implementation
+ * for the given maximum local worksize and number of elements to scan.
+ * */
+static size_t clo_scan_rblock_get_localmem_usage(CloScan* scanner,
+	cl_uint i, size_t lws_max, size_t numel, GError** err) {
+
+	/* Check that i is within bounds. */
+	g_return_val_if_fail(i < CLO_SCAN_RBLOCK_NUM_KERNELS, 0);
+
+	/* Internal error handling object. */
+	GError* err_internal = NULL;
+	/* Local memory usage. */
+	size_t local_mem;
+	/* Worksizes. */
+	size_t realws, gws;
+	/* Device where scan will take place. */
+	CCLDevice* dev = NULL;
+	/* Internal data. */
+	clo_scan_rblock_data* data =
+		(clo_scan_rblock_data*) clo_scan_get_data(scanner);
+
+	/* Get device where scan will take place (it is assumed to be the
+	 * first device in the context). */
+	dev = ccl_context_get_device(
+		clo_scan_get_context(scanner), 0, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Determine worksizes. */
+	realws = CLO_DIV_CEIL(numel, data->vpt);
+	ccl_kernel_suggest_worksizes(
+		NULL, dev, 1, &realws, &gws, &lws_max, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* All kernels scan one value per work-item in local memory. */
+	local_mem = clo_scan_get_sum_size(scanner) * lws_max;
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	local_mem = 0;
+
+finish:
+	/* Return local memory usage. */
+	return local_mem;
+
+}
+
+/**
+ * @internal
+ * Get size in bytes of the device workspace required by the scan
+ * implementation, i.e. of the tile-wise reductions buffer.
+ * */
+static size_t clo_scan_rblock_get_workspace_size(CloScan* scanner,
+	CCLDevice* dev, size_t numel, size_t lws_max, GError** err) {
+
+	/* Internal error handling object. */
+	GError* err_internal = NULL;
+	/* Workspace size. */
+	size_t ws_size;
+	/* Worksizes. */
+	size_t realws, gws;
+	/* Kernel which determines the tile size. */
+	CCLKernel* krnl_scan = NULL;
+	/* Internal data. */
+	clo_scan_rblock_data* data =
+		(clo_scan_rblock_data*) clo_scan_get_data(scanner);
+
+	/* Get the scan kernel wrapper. */
+	krnl_scan = ccl_program_get_kernel(clo_scan_get_program(scanner),
+		CLO_SCAN_RBLOCK_KNAME_SCAN, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Determine worksizes, as in the scan itself. */
+	realws = CLO_DIV_CEIL(numel, data->vpt);
+	ccl_kernel_suggest_worksizes(krnl_scan, dev, 1, &realws, &gws,
+		&lws_max, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* One reduction per tile. */
+	ws_size = CLO_DIV_CEIL(numel, lws_max * data->vpt)
+		* clo_scan_get_sum_size(scanner);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	ws_size = 0;
+
+finish:
+	/* Return workspace size. */
+	return ws_size;
+
+}
+
+/* Definition of the register-blocked scan implementation. */
+const CloScanImplDef clo_scan_rblock_def = {
+	"rblock",
+	clo_scan_rblock_init,
+	clo_scan_rblock_finalize,
+	clo_scan_rblock_scan_with_device_data,
+	clo_scan_rblock_get_num_kernels,
+	clo_scan_rblock_get_kernel_name,
+	clo_scan_rblock_get_localmem_usage,
+	clo_scan_rblock_get_workspace_size
+};
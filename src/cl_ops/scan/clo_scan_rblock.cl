@@ -0,0 +1,257 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Register-blocked parallel prefix sum (scan) implementation.
+ *
+ * Each work-item loads a contiguous run of `CLO_SCAN_RBLOCK_VPT`
+ * elements into private memory (with vector loads when possible) and
+ * scans it serially, so that only the per-work-item totals are scanned
+ * across the workgroup in local memory. The array is processed in
+ * three steps (reduce-then-scan):
+ *
+ * 1. Each workgroup reduces its tile to a single value.
+ * 2. A single workgroup performs an exclusive scan of the tile values.
+ * 3. Each workgroup scans its tile, starting at the respective tile
+ * value.
+ *
+ * Besides the constants and macros required by the Blelloch scan
+ * (including the optional `CLO_SCAN_INCLUSIVE` constant), these kernels
+ * expect the following constants to be defined:
+ *
+ * * `CLO_SCAN_RBLOCK_VPT` - Number of values per work-item.
+ * * `CLO_SCAN_RBLOCK_VW` - Width of vector loads and stores (8 or 16),
+ * which must divide `CLO_SCAN_RBLOCK_VPT`. Only defined if both the
+ * elements to scan and the scanned elements are scalars, otherwise
+ * elements are loaded and stored one by one.
+ *
+ */
+
+/* Token pasting helpers. */
+#define CLO_SCAN_RBLOCK_CONCAT(a, b) a ## b
+#define CLO_SCAN_RBLOCK_XCONCAT(a, b) CLO_SCAN_RBLOCK_CONCAT(a, b)
+
+#ifdef CLO_SCAN_RBLOCK_VW
+
+/* Vector load, store and conversion functions. */
+#define CLO_SCAN_RBLOCK_VLOAD \
+	CLO_SCAN_RBLOCK_XCONCAT(vload, CLO_SCAN_RBLOCK_VW)
+#define CLO_SCAN_RBLOCK_VSTORE \
+	CLO_SCAN_RBLOCK_XCONCAT(vstore, CLO_SCAN_RBLOCK_VW)
+#define CLO_SCAN_RBLOCK_VCONVERT CLO_SCAN_RBLOCK_XCONCAT(convert_, \
+	CLO_SCAN_RBLOCK_XCONCAT(CLO_SCAN_SUM_TYPE, CLO_SCAN_RBLOCK_VW))
+
+/* Load the run of elements of the current work-item into private
+ * memory, using the identity for elements beyond the array size. */
+#define CLO_SCAN_RBLOCK_LOAD(priv, data_in, idx, numel) \
+	if ((idx) + CLO_SCAN_RBLOCK_VPT <= (numel)) { \
+		for (uint c = 0; c < CLO_SCAN_RBLOCK_VPT / CLO_SCAN_RBLOCK_VW; c++) \
+			CLO_SCAN_RBLOCK_VSTORE(CLO_SCAN_RBLOCK_VCONVERT( \
+				CLO_SCAN_RBLOCK_VLOAD(c, (data_in) + (idx))), c, priv); \
+	} else { \
+		for (uint i = 0; i < CLO_SCAN_RBLOCK_VPT; i++) \
+			priv[i] = ((idx) + i < (numel)) \
+				? CLO_SCAN_CONVERT((data_in)[(idx) + i]) \
+				: CLO_SCAN_IDENTITY; \
+	}
+
+#else
+
+/* Load the run of elements of the current work-item into private
+ * memory, using the identity for elements beyond the array size. */
+#define CLO_SCAN_RBLOCK_LOAD(priv, data_in, idx, numel) \
+	for (uint i = 0; i < CLO_SCAN_RBLOCK_VPT; i++) \
+		if ((idx) + i < (numel)) \
+			priv[i] = CLO_SCAN_CONVERT((data_in)[(idx) + i]); \
+		else priv[i] = CLO_SCAN_IDENTITY;
+
+#endif
+
+/**
+ * Performs an exclusive scan of one value per work-item across the
+ * workgroup.
+ *
+ * @param aux Auxiliary local memory with one value per work-item.
+ * @param value Value of the current work-item.
+ * @param total Location where to place the workgroup total.
+ * @return Exclusive scan of the value of the current work-item.
+ */
+CLO_SCAN_SUM_TYPE rblock_wgscan(__local CLO_SCAN_SUM_TYPE *aux,
+	CLO_SCAN_SUM_TYPE value, CLO_SCAN_SUM_TYPE *total) {
+
+	uint lid = get_local_id(0);
+	uint lsize = get_local_size(0);
+	CLO_SCAN_SUM_TYPE t;
+
+	/* Inclusive scan of the work-item values. */
+	aux[lid] = value;
+	for (uint s = 1; s < lsize; s <<= 1) {
+		barrier(CLK_LOCAL_MEM_FENCE);
+		t = (lid >= s) ? aux[lid - s] : CLO_SCAN_IDENTITY;
+		barrier(CLK_LOCAL_MEM_FENCE);
+		if (lid >= s) aux[lid] = CLO_SCAN_OP(t, aux[lid]);
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	/* Get workgroup total and exclusive value of current work-item. */
+	*total = aux[lsize - 1];
+	t = (lid > 0) ? aux[lid - 1] : CLO_SCAN_IDENTITY;
+
+	/* Make sure local memory can be reused by the caller. */
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	return t;
+}
+
+/**
+ * Reduces each tile of `get_local_size(0) * CLO_SCAN_RBLOCK_VPT`
+ * elements to a single value.
+ *
+ * @param data_in Vector to scan.
+ * @param data_wgsum Tile-wise reductions.
+ * @param aux Auxiliary local memory.
+ * @param numel Number of elements to scan.
+ */
+__kernel void rblockReduce(
+			__global CLO_SCAN_ELEM_TYPE *data_in,
+			__global CLO_SCAN_SUM_TYPE *data_wgsum,
+			__local CLO_SCAN_SUM_TYPE *aux,
+			uint numel)
+{
+
+	uint idx = get_global_id(0) * CLO_SCAN_RBLOCK_VPT;
+	CLO_SCAN_SUM_TYPE priv[CLO_SCAN_RBLOCK_VPT];
+	CLO_SCAN_SUM_TYPE acc = CLO_SCAN_IDENTITY;
+	CLO_SCAN_SUM_TYPE total;
+
+	/* Load and reduce run of current work-item. */
+	CLO_SCAN_RBLOCK_LOAD(priv, data_in, idx, numel);
+	for (uint i = 0; i < CLO_SCAN_RBLOCK_VPT; i++)
+		acc = CLO_SCAN_OP(acc, priv[i]);
+
+	/* Reduce work-item totals. */
+	rblock_wgscan(aux, acc, &total);
+
+	/* Store tile reduction. */
+	if (get_local_id(0) == 0)
+		data_wgsum[get_group_id(0)] = total;
+
+}
+
+/**
+ * Performs an exclusive scan on the tile-wise reductions, in place,
+ * using a single workgroup.
+ *
+ * @param data_wgsum Tile-wise reductions.
+ * @param aux Auxiliary local memory.
+ * @param num_wgsums Number of tile-wise reductions.
+ */
+__kernel void rblockSumsScan(
+			__global CLO_SCAN_SUM_TYPE *data_wgsum,
+			__local CLO_SCAN_SUM_TYPE *aux,
+			uint num_wgsums)
+{
+
+	uint lid = get_local_id(0);
+	uint run = (num_wgsums + get_local_size(0) - 1) / get_local_size(0);
+	uint start = min(lid * run, num_wgsums);
+	uint end = min(start + run, num_wgsums);
+	CLO_SCAN_SUM_TYPE acc = CLO_SCAN_IDENTITY;
+	CLO_SCAN_SUM_TYPE total, t;
+
+	/* Reduce run of current work-item. */
+	for (uint i = start; i < end; i++)
+		acc = CLO_SCAN_OP(acc, data_wgsum[i]);
+
+	/* Scan work-item totals. */
+	acc = rblock_wgscan(aux, acc, &total);
+
+	/* Scan run of current work-item. */
+	for (uint i = start; i < end; i++) {
+		t = data_wgsum[i];
+		data_wgsum[i] = acc;
+		acc = CLO_SCAN_OP(acc, t);
+	}
+
+}
+
+/**
+ * Performs an exclusive (or inclusive, if `CLO_SCAN_INCLUSIVE` is
+ * defined) scan of each tile of
+ * `get_local_size(0) * CLO_SCAN_RBLOCK_VPT` elements, starting at the
+ * respective tile value.
+ *
+ * @param data_in Vector to scan.
+ * @param data_out Location where to place scan results.
+ * @param data_wgsum Scanned tile-wise reductions (ignored if there is
+ * only one tile).
+ * @param aux Auxiliary local memory.
+ * @param numel Number of elements to scan.
+ */
+__kernel void rblockScan(
+			__global CLO_SCAN_ELEM_TYPE *data_in,
+			__global CLO_SCAN_SUM_TYPE *data_out,
+			__global CLO_SCAN_SUM_TYPE *data_wgsum,
+			__local CLO_SCAN_SUM_TYPE *aux,
+			uint numel)
+{
+
+	uint idx = get_global_id(0) * CLO_SCAN_RBLOCK_VPT;
+	CLO_SCAN_SUM_TYPE priv[CLO_SCAN_RBLOCK_VPT];
+	CLO_SCAN_SUM_TYPE acc = CLO_SCAN_IDENTITY;
+	CLO_SCAN_SUM_TYPE total, t;
+
+	/* Load and reduce run of current work-item. */
+	CLO_SCAN_RBLOCK_LOAD(priv, data_in, idx, numel);
+	for (uint i = 0; i < CLO_SCAN_RBLOCK_VPT; i++)
+		acc = CLO_SCAN_OP(acc, priv[i]);
+
+	/* Scan work-item totals. */
+	acc = rblock_wgscan(aux, acc, &total);
+
+	/* Start at the respective tile value. */
+	if (get_num_groups(0) > 1)
+		acc = CLO_SCAN_OP(data_wgsum[get_group_id(0)], acc);
+
+	/* Scan run of current work-item in private memory. */
+	for (uint i = 0; i < CLO_SCAN_RBLOCK_VPT; i++) {
+		t = priv[i];
+#ifdef CLO_SCAN_INCLUSIVE
+		acc = CLO_SCAN_OP(acc, t);
+		priv[i] = acc;
+#else
+		priv[i] = acc;
+		acc = CLO_SCAN_OP(acc, t);
+#endif
+	}
+
+	/* Store run of current work-item. */
+#ifdef CLO_SCAN_RBLOCK_VW
+	if (idx + CLO_SCAN_RBLOCK_VPT <= numel) {
+		for (uint c = 0; c < CLO_SCAN_RBLOCK_VPT / CLO_SCAN_RBLOCK_VW; c++)
+			CLO_SCAN_RBLOCK_VSTORE(
+				CLO_SCAN_RBLOCK_VLOAD(c, priv), c, data_out + idx);
+	} else
+#endif
+	{
+		for (uint i = 0; (i < CLO_SCAN_RBLOCK_VPT) && (idx + i < numel); i++)
+			data_out[idx + i] = priv[i];
+	}
+
+}
@@ -0,0 +1,51 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Register-blocked scan declarations.
+ * */
+
+#ifndef _CLO_SCAN_RBLOCK_H_
+#define _CLO_SCAN_RBLOCK_H_
+
+#include "cl_ops/clo_scan_abstract.h"
+
+/** The register-blocked scan kernels source. */
+#define CLO_SCAN_RBLOCK_SRC "@RBLOCK_SRC@"
+
+/* Number of kernels. */
+#define CLO_SCAN_RBLOCK_NUM_KERNELS 3
+
+/* Index of the register-blocked scan kernels. */
+#define CLO_SCAN_RBLOCK_KIDX_REDUCE 0
+#define CLO_SCAN_RBLOCK_KIDX_SUMSSCAN 1
+#define CLO_SCAN_RBLOCK_KIDX_SCAN 2
+
+/* Register-blocked scan kernel names. */
+#define CLO_SCAN_RBLOCK_KNAME_REDUCE "rblockReduce"
+#define CLO_SCAN_RBLOCK_KNAME_SUMSSCAN "rblockSumsScan"
+#define CLO_SCAN_RBLOCK_KNAME_SCAN "rblockScan"
+
+/* Default number of values scanned by each work-item. */
+#define CLO_SCAN_RBLOCK_VPT_DEFAULT 16
+
+/** Definition of the register-blocked scan implementation. */
+extern const CloScanImplDef clo_scan_rblock_def;
+
+#endif
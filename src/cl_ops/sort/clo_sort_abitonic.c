@@ -35,8 +35,22 @@ typedef struct {
 	/** Maximum in-kernel "stage finish" step. */
 	cl_uint max_inkrnl_sfs;
 
+	/** Use subgroup shuffle kernels if the device supports them? */
+	gboolean use_shfl;
+
+	/** Cache of execution plans, keyed by padded size, maximum local
+	 * worksize and device. */
+	GHashTable* plans;
+
 } clo_sort_abitonic_data;
 
+/* Key for the execution plan cache. */
+typedef struct {
+	cl_uint numel_nlpo2;
+	size_t lws_max;
+	CCLDevice* dev;
+} clo_sort_abitonic_plan_key;
+
 typedef struct {
 	CCLKernel* krnl;
 	const char* krnl_name;
@@ -51,6 +65,36 @@ typedef struct {
 static const char* clo_sort_abitnonic_knames[] =
 	CLO_SORT_ABITONIC_KERNELNAMES;
 
+/**
+ * @internal
+ * Hash function for execution plan cache keys.
+ * */
+static guint clo_sort_abitonic_plan_hash(gconstpointer key) {
+
+	const clo_sort_abitonic_plan_key* k =
+		(const clo_sort_abitonic_plan_key*) key;
+
+	return (guint) (k->numel_nlpo2 * 31u + k->lws_max * 17u)
+		^ g_direct_hash(k->dev);
+}
+
+/**
+ * @internal
+ * Equality function for execution plan cache keys.
+ * */
+static gboolean clo_sort_abitonic_plan_equal(
+	gconstpointer a, gconstpointer b) {
+
+	const clo_sort_abitonic_plan_key* ka =
+		(const clo_sort_abitonic_plan_key*) a;
+	const clo_sort_abitonic_plan_key* kb =
+		(const clo_sort_abitonic_plan_key*) b;
+
+	return (ka->numel_nlpo2 == kb->numel_nlpo2)
+		&& (ka->lws_max == kb->lws_max)
+		&& (ka->dev == kb->dev);
+}
+
 /**
  * @internal
  * Determine abitonic sort strategy for the given parameters.
@@ -63,20 +107,23 @@ static clo_sort_abitonic_step* clo_sort_abitonic_get_strategy(
 	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
 	/* Kernels applicable to each step. */
-	static const char* lookup[11][4] = {
+	static const char* lookup[11][5] = {
 		/* Step 2 */
 		{
+			CLO_SORT_ABITONIC_KNAME_SHFL_S2,
 			CLO_SORT_ABITONIC_KNAME_LOCAL_S2,
 			NULL, NULL, NULL
 		},
 		/* Step 3 */
 		{
+			CLO_SORT_ABITONIC_KNAME_SHFL_S3,
 			CLO_SORT_ABITONIC_KNAME_HYB_S3_3S8V,
 			CLO_SORT_ABITONIC_KNAME_LOCAL_S3,
 			NULL, NULL
 		},
 		/* Step 4 */
 		{
+			CLO_SORT_ABITONIC_KNAME_SHFL_S4,
 			CLO_SORT_ABITONIC_KNAME_HYB_S4_4S16V,
 			CLO_SORT_ABITONIC_KNAME_HYB_S4_2S4V,
 			CLO_SORT_ABITONIC_KNAME_LOCAL_S4,
@@ -84,11 +131,13 @@ static clo_sort_abitonic_step* clo_sort_abitonic_get_strategy(
 		},
 		/* Step 5 */
 		{
+			CLO_SORT_ABITONIC_KNAME_SHFL_S5,
 			CLO_SORT_ABITONIC_KNAME_LOCAL_S5,
 			NULL, NULL, NULL
 		},
 		/* Step 6 */
 		{
+			CLO_SORT_ABITONIC_KNAME_SHFL_S6,
 			CLO_SORT_ABITONIC_KNAME_HYB_S6_3S8V,
 			CLO_SORT_ABITONIC_KNAME_HYB_S6_2S4V,
 			CLO_SORT_ABITONIC_KNAME_LOCAL_S6,
@@ -96,11 +145,13 @@ static clo_sort_abitonic_step* clo_sort_abitonic_get_strategy(
 		},
 		/* Step 7 */
 		{
+			CLO_SORT_ABITONIC_KNAME_SHFL_S7,
 			CLO_SORT_ABITONIC_KNAME_LOCAL_S7,
 			NULL, NULL, NULL
 		},
 		/* Step 8 */
 		{
+			CLO_SORT_ABITONIC_KNAME_SHFL_S8,
 			CLO_SORT_ABITONIC_KNAME_HYB_S8_4S16V,
 			CLO_SORT_ABITONIC_KNAME_HYB_S8_2S4V,
 			CLO_SORT_ABITONIC_KNAME_LOCAL_S8,
@@ -108,18 +159,21 @@ static clo_sort_abitonic_step* clo_sort_abitonic_get_strategy(
 		},
 		/* Step 9 */
 		{
+			CLO_SORT_ABITONIC_KNAME_SHFL_S9,
 			CLO_SORT_ABITONIC_KNAME_HYB_S9_3S8V,
 			CLO_SORT_ABITONIC_KNAME_LOCAL_S9,
 			NULL, NULL
 		},
 		/* Step 10 */
 		{
+			CLO_SORT_ABITONIC_KNAME_SHFL_S10,
 			CLO_SORT_ABITONIC_KNAME_HYB_S10_2S4V,
 			CLO_SORT_ABITONIC_KNAME_LOCAL_S10,
 			NULL, NULL
 		},
 		/* Step 11 */
 		{
+			CLO_SORT_ABITONIC_KNAME_SHFL_S11,
 			CLO_SORT_ABITONIC_KNAME_LOCAL_S11,
 			NULL, NULL, NULL
 		},
@@ -128,7 +182,7 @@ static clo_sort_abitonic_step* clo_sort_abitonic_get_strategy(
 			CLO_SORT_ABITONIC_KNAME_HYB_S12_4S16V,
 			CLO_SORT_ABITONIC_KNAME_HYB_S12_3S8V,
 			CLO_SORT_ABITONIC_KNAME_HYB_S12_2S4V,
-			NULL
+			NULL, NULL
 		},
 	};
 
@@ -138,9 +192,21 @@ static clo_sort_abitonic_step* clo_sort_abitonic_get_strategy(
 	cl_uint tot_stages = (cl_uint) clo_tzc(numel_nlpo2);
 	/* Array of steps. */
 	clo_sort_abitonic_step* steps =
-		g_new(clo_sort_abitonic_step, tot_stages);
+		g_new0(clo_sort_abitonic_step, tot_stages);
 	/* Internal error handling object. */
 	GError* err_internal = NULL;
+	/* Can subgroup shuffle kernels be used in this device? */
+	gboolean has_shfl = FALSE;
+
+	/* Check if device supports subgroup shuffles. */
+	if (data.use_shfl) {
+		char* exts = ccl_device_get_info_array(
+			dev, CL_DEVICE_EXTENSIONS, char*, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		has_shfl = (g_strstr_len(exts, -1, "cl_khr_subgroup_shuffle")
+			!= NULL) || (g_strstr_len(exts, -1, "cl_intel_subgroups")
+			!= NULL);
+	}
 
 	/* Get a maximum lws for "private" kernels if step > max_inkrnl_sfs.
 	 * The 1 << 20 is just a "high enough" gws value, i.e. higher than
@@ -238,8 +304,18 @@ static clo_sort_abitonic_step* clo_sort_abitonic_get_strategy(
 				/* Get current possible kernel name. */
 				const char* krnl_name = possible_krnls[i];
 
-				/* Check if it's a hybrid or local kernel. */
-				if (g_strrstr(krnl_name, CLO_SORT_ABITONIC_KNAME_HYB_MARK)) {
+				/* Check if it's a subgroup shuffle, hybrid or local
+				 * kernel. */
+				if (g_strrstr(krnl_name, CLO_SORT_ABITONIC_KNAME_SHFL_MARK)) {
+					/* Skip subgroup shuffle kernels if the device does
+					 * not support them. */
+					if (!has_shfl) continue;
+					/* Each thread holds a single element, and local
+					 * memory is only used for strides larger than the
+					 * subgroup size. */
+					priv_steps = 0;
+					steps[step - 1].local_mem = 1;
+				} else if (g_strrstr(krnl_name, CLO_SORT_ABITONIC_KNAME_HYB_MARK)) {
 					/* It's a hybrid kernel, determine how many steps
 					 * does it perform on private memory each time. */
 					priv_steps = CLO_SORT_ABITONIC_KPARSE_S(krnl_name);
@@ -263,14 +339,24 @@ static clo_sort_abitonic_step* clo_sort_abitonic_get_strategy(
 				g_if_err_propagate_goto(
 					err, err_internal, error_handler);
 
-				if ((priv_steps <= data.max_inkrnl_stps)
-					&& (priv_steps >= data.min_inkrnl_stps)
+				/* Subgroup shuffle kernels (priv_steps == 0) are not
+				 * bound by the private memory steps interval. */
+				if (((priv_steps == 0)
+						|| ((priv_steps <= data.max_inkrnl_stps)
+						&& (priv_steps >= data.min_inkrnl_stps)))
 					&& (((int) steps[step - 1].lws)
 						>= (1 << (step - priv_steps))))
 				{
 					steps[step - 1].krnl_name = krnl_name;
 					steps[step - 1].krnl = ccl_program_get_kernel(
 						prg, krnl_name, &err_internal);
+					/* Subgroup shuffle kernels may not have been built
+					 * if some device in the context does not support
+					 * them, in which case try the next kernel. */
+					if ((priv_steps == 0) && (err_internal != NULL)) {
+						g_clear_error(&err_internal);
+						continue;
+					}
 					g_if_err_propagate_goto(
 						err, err_internal, error_handler);
 					steps[step - 1].set_step = FALSE;
@@ -306,12 +392,56 @@ static clo_sort_abitonic_step* clo_sort_abitonic_get_strategy(
 error_handler:
 	/* If we got here there was an error, verify that it is so. */
 	g_assert(err == NULL || *err != NULL);
+	g_free(steps);
+	steps = NULL;
 
 finish:
 
 	return steps;
 }
 
+/**
+ * @internal
+ * Get execution plan for the given parameters, determining and caching
+ * it if it's not already in the plan cache.
+ * */
+static const clo_sort_abitonic_step* clo_sort_abitonic_get_plan(
+	CCLProgram* prg, CCLDevice* dev, clo_sort_abitonic_data* data,
+	size_t lws_max, cl_uint numel, GError** err) {
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Plan cache key. */
+	clo_sort_abitonic_plan_key key =
+		{ (cl_uint) clo_nlpo2(numel), lws_max, dev };
+
+	/* Execution plan. */
+	clo_sort_abitonic_step* steps;
+
+	/* Check if plan is already cached. */
+	steps = g_hash_table_lookup(data->plans, &key);
+
+	if (steps == NULL) {
+
+		/* Plan not cached, determine it. */
+		steps = clo_sort_abitonic_get_strategy(
+			prg, dev, *data, lws_max, numel, err);
+
+		/* Cache it if there was no error. */
+		if (steps != NULL) {
+			g_hash_table_insert(data->plans,
+				g_memdup(&key, sizeof(clo_sort_abitonic_plan_key)),
+				steps);
+			g_debug("abitonic: cached plan for %d elements (%d plans)",
+				(int) key.numel_nlpo2,
+				(int) g_hash_table_size(data->plans));
+		}
+	}
+
+	return steps;
+}
+
 /**
  * @internal
  * Perform sort using device data.
@@ -330,11 +460,12 @@ static CCLEvent* clo_sort_abitonic_sort_with_device_data(
 	/* Number of bitonic sort stages. */
 	cl_uint tot_stages;
 
-	/* Implementation of the strategy to follow on each step. */
-	clo_sort_abitonic_step* steps = NULL;
+	/* Implementation of the strategy to follow on each step (owned by
+	 * the plan cache). */
+	const clo_sort_abitonic_step* steps = NULL;
 
-	clo_sort_abitonic_data data =
-		*((clo_sort_abitonic_data*) clo_sort_get_data(sorter));
+	clo_sort_abitonic_data* data =
+		(clo_sort_abitonic_data*) clo_sort_get_data(sorter);
 
 	/* OpenCL object wrappers. */
 	CCLDevice* dev = NULL;
@@ -344,6 +475,9 @@ static CCLEvent* clo_sort_abitonic_sort_with_device_data(
 	/* Event wait list. */
 	CCLEventWaitList ewl = NULL;
 
+	/* Command batch being recorded, if any. */
+	CloBatch* batch = clo_sort_get_batch(sorter);
+
 	/* Internal error reporting object. */
 	GError* err_internal = NULL;
 
@@ -365,32 +499,32 @@ static CCLEvent* clo_sort_abitonic_sort_with_device_data(
 	} else {
 		/* Copy data_in to data_out first, and then sort on copied
 		 * data. */
-		evt = ccl_buffer_enqueue_copy(data_in, data_out, cq_comm, 0, 0,
-			clo_sort_get_element_size(sorter) * numel, NULL,
-			&err_internal);
+		evt = clo_batch_enqueue_copy(batch, data_in, data_out, cq_comm,
+			0, 0, clo_sort_get_element_size(sorter) * numel, NULL,
+			"abit_copy", &err_internal);
 		g_if_err_propagate_goto(err, err_internal, error_handler);
 
-		ccl_event_set_name(evt, "abit_copy");
 		ccl_event_wait_list_add(&ewl, evt, NULL);
 	}
 
 	/* Determine number of bitonic sort stages. */
 	tot_stages = (cl_uint) clo_tzc(clo_nlpo2(numel));
 
-	/* Obtain sorting strategy, e.g., which kernels to use in each step. */
-	steps = clo_sort_abitonic_get_strategy(
+	/* Obtain sorting strategy, e.g., which kernels to use in each step,
+	 * from the plan cache. */
+	steps = clo_sort_abitonic_get_plan(
 		prg, dev, data, lws_max, numel, &err_internal);
 	g_if_err_propagate_goto(err, err_internal, error_handler);
 
 	/* Set kernel arguments. */
 	for (cl_uint i = 0; i < tot_stages; ++i) {
 
-		ccl_kernel_set_arg(steps[i].krnl, 0, data_in);
+		clo_batch_set_buffer(batch, steps[i].krnl, 0, data_in);
 
 		if (steps[i].local_mem > 0) {
-			ccl_kernel_set_arg(steps[i].krnl, 2,
-				ccl_arg_full(NULL, clo_sort_get_element_size(sorter)
-					* steps[i].lws * steps[i].local_mem));
+			clo_batch_set_arg(batch, steps[i].krnl, 2,
+				clo_sort_get_element_size(sorter)
+					* steps[i].lws * steps[i].local_mem, NULL);
 		}
 	}
 
@@ -410,20 +544,19 @@ static CCLEvent* clo_sort_abitonic_sort_with_device_data(
 
 			/* Set kernel arguments. */
 			/* Current stage. */
-			ccl_kernel_set_arg(
-				stp_strat.krnl, 1, ccl_arg_priv(curr_stage, cl_uint));
+			clo_batch_set_arg_priv(
+				batch, stp_strat.krnl, 1, curr_stage, cl_uint);
 
 			/* Current step (for some kernels only). */
 			if (stp_strat.set_step)
-				ccl_kernel_set_arg(stp_strat.krnl, 2,
-					ccl_arg_priv(curr_step, cl_uint));
+				clo_batch_set_arg_priv(
+					batch, stp_strat.krnl, 2, curr_step, cl_uint);
 
 			/* Execute kernel. */
-			evt = ccl_kernel_enqueue_ndrange(stp_strat.krnl, cq_exec, 1,
-				NULL, &stp_strat.gws, &stp_strat.lws, NULL,
-				&err_internal);
+			evt = clo_batch_enqueue_ndrange(batch, stp_strat.krnl,
+				cq_exec, 1, &stp_strat.gws, &stp_strat.lws, NULL,
+				stp_strat.krnl_name, &err_internal);
 			g_if_err_propagate_goto(err, err_internal, error_handler);
-			ccl_event_set_name(evt, stp_strat.krnl_name);
 
 			/* Update step. */
 			curr_step -= stp_strat.num_steps;
@@ -442,9 +575,6 @@ error_handler:
 
 finish:
 
-	/* Free the steps array. */
-	g_free(steps);
-
 	/* Return. */
 	return evt;
 
@@ -471,6 +601,11 @@ static const char* clo_sort_abitonic_init(
 	data->max_inkrnl_stps = 4;
 	data->min_inkrnl_stps = 1;
 	data->max_inkrnl_sfs = UINT_MAX;
+	data->use_shfl = TRUE;
+
+	/* Create execution plan cache. */
+	data->plans = g_hash_table_new_full(clo_sort_abitonic_plan_hash,
+		clo_sort_abitonic_plan_equal, g_free, g_free);
 
 	/* Number of tokens. */
 	int num_toks;
@@ -522,6 +657,9 @@ static const char* clo_sort_abitonic_init(
 			} else if (g_strcmp0("maxsfs", opt[0]) == 0) {
 				/* Maximum in-kernel "stage finish" step. */
 				data->max_inkrnl_sfs = value;
+			} else if (g_strcmp0("shfl", opt[0]) == 0) {
+				/* Use subgroup shuffle kernels if available. */
+				data->use_shfl = (value != 0);
 			} else {
 				g_if_err_create_goto(*err, CLO_ERROR, TRUE,
 					CLO_ERROR_ARGS, error_handler,
@@ -542,6 +680,10 @@ static const char* clo_sort_abitonic_init(
 
 	}
 
+	/* Subgroup shuffles only accept scalar types. */
+	if (!CLO_TYPE_IS_SCALAR(clo_sort_get_element_type(sorter)))
+		data->use_shfl = FALSE;
+
 	/* If we got here, everything is OK. */
 	g_assert(err == NULL || *err == NULL);
 	abitonic_src = CLO_SORT_ABITONIC_SRC;
@@ -573,8 +715,14 @@ finish:
  * */
 static void clo_sort_abitonic_finalize(CloSort* sorter) {
 
+	clo_sort_abitonic_data* data =
+		(clo_sort_abitonic_data*) clo_sort_get_data(sorter);
+
+	/* Release execution plan cache. */
+	g_hash_table_destroy(data->plans);
+
 	/* Release internal data. */
-	g_slice_free(clo_sort_abitonic_data, clo_sort_get_data(sorter));
+	g_slice_free(clo_sort_abitonic_data, data);
 
 	return;
 }
@@ -671,6 +819,14 @@ static size_t clo_sort_abitonic_get_localmem_usage(CloSort* sorter,
 		 * "any" */
 		local_mem_usage = 0;
 
+	} else if (g_strrstr(kernel_name, CLO_SORT_ABITONIC_KNAME_SHFL_MARK)) {
+
+		/* Subgroup shuffle kernels use one element of local memory
+		 * per thread, but have twice the global worksize of local
+		 * memory kernels, so the local worksize may be twice as
+		 * large. */
+		local_mem_usage = elem_size * lws * 2;
+
 	} else if (g_strrstr(kernel_name, CLO_SORT_ABITONIC_KNAME_LOCAL_MARK)) {
 
 		/* Local memory kernels use local memory. */
@@ -708,6 +864,8 @@ finish:
 const CloSortImplDef clo_sort_abitonic_def = {
 	"abitonic",
 	CL_TRUE,
+	CL_FALSE,
+	CL_FALSE,
 	clo_sort_abitonic_init,
 	clo_sort_abitonic_finalize,
 	clo_sort_abitonic_sort_with_device_data,
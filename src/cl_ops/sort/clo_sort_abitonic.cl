@@ -1065,3 +1065,95 @@ __kernel void abit_hyb_s12_4s16v(
 	ABIT_HYB_4S16V_SORT(4);
 	ABIT_HYB_4S16V_FINISH();
 }
+
+/* Subgroup shuffle kernels, only available if the device supports
+ * either the cl_khr_subgroup_shuffle or the cl_intel_subgroups
+ * extensions, and if elements are of a scalar type, since shuffles
+ * don't accept vector or record types. */
+#if !defined(CLO_SORT_ELEM_IS_SCALAR)
+	/* Elements can't be shuffled. */
+#elif defined(cl_khr_subgroup_shuffle)
+	#pragma OPENCL EXTENSION cl_khr_subgroups : enable
+	#pragma OPENCL EXTENSION cl_khr_subgroup_shuffle : enable
+	#define ABIT_SHFL_XOR(x, mask) sub_group_shuffle_xor(x, mask)
+#elif defined(cl_intel_subgroups)
+	#pragma OPENCL EXTENSION cl_intel_subgroups : enable
+	#define ABIT_SHFL_XOR(x, mask) intel_sub_group_shuffle_xor(x, mask)
+#endif
+
+#ifdef ABIT_SHFL_XOR
+
+/* Each work-item holds one element, and exchanges it with the
+ * work-item whose local id differs in the stride bit. Strides smaller
+ * than the subgroup size are performed with subgroup shuffles, without
+ * local memory or barriers; larger strides go through local memory. It
+ * is assumed that subgroups are formed by consecutive local ids, which
+ * is the case for one-dimensional work-groups with a local size which
+ * is a multiple of the subgroup size. */
+#define ABIT_SHFL_INIT() \
+	/* Global and local ids for this work-item. */ \
+	uint gid = get_global_id(0); \
+	uint lid = get_local_id(0); \
+	/* Strides smaller than this are performed with shuffles. */ \
+	uint sg_size = get_max_sub_group_size(); \
+	/* Determine if ascending or descending */ \
+	bool desc = (bool) (0x1 & (gid >> stage)); \
+	/* Element held by this work-item and element to compare with. */ \
+	CLO_SORT_ELEM_TYPE data_mine = data_global[gid]; \
+	CLO_SORT_ELEM_TYPE data_other; \
+	/* Is this work-item holding the lower index of the pair? */ \
+	bool lower; \
+	/* Swap elements? */ \
+	bool swap;
+
+#define ABIT_SHFL_SORT(stride) \
+	/* Get element to compare with. */ \
+	if ((stride) < sg_size) { \
+		data_other = ABIT_SHFL_XOR(data_mine, (stride)); \
+	} else { \
+		data_local[lid] = data_mine; \
+		barrier(CLK_LOCAL_MEM_FENCE); \
+		data_other = data_local[lid ^ (stride)]; \
+		barrier(CLK_LOCAL_MEM_FENCE); \
+	} \
+	/* Compare, both work-items in the pair reach the same decision. */ \
+	lower = !(lid & (stride)); \
+	swap = lower \
+		? CLO_SORT_COMPARE( \
+			CLO_SORT_KEY_GET(data_mine), CLO_SORT_KEY_GET(data_other)) \
+		: CLO_SORT_COMPARE( \
+			CLO_SORT_KEY_GET(data_other), CLO_SORT_KEY_GET(data_mine)); \
+	/* Keep the other element if a swap is required. */ \
+	if (swap ^ desc) data_mine = data_other;
+
+#define ABIT_SHFL_FINISH() \
+	/* Store data globally */ \
+	data_global[gid] = data_mine;
+
+/* Kernel which performs the n last steps of a stage, one element per
+ * work-item. */
+#define ABIT_SHFL_KERNEL(n) \
+	__kernel void abit_shfl_s ## n( \
+				__global CLO_SORT_ELEM_TYPE *data_global, \
+				uint stage, \
+				__local CLO_SORT_ELEM_TYPE *data_local) \
+	{ \
+		ABIT_SHFL_INIT(); \
+		for (uint stride = 1 << (n - 1); stride > 0; stride >>= 1) { \
+			ABIT_SHFL_SORT(stride); \
+		} \
+		ABIT_SHFL_FINISH(); \
+	}
+
+ABIT_SHFL_KERNEL(2)
+ABIT_SHFL_KERNEL(3)
+ABIT_SHFL_KERNEL(4)
+ABIT_SHFL_KERNEL(5)
+ABIT_SHFL_KERNEL(6)
+ABIT_SHFL_KERNEL(7)
+ABIT_SHFL_KERNEL(8)
+ABIT_SHFL_KERNEL(9)
+ABIT_SHFL_KERNEL(10)
+ABIT_SHFL_KERNEL(11)
+
+#endif
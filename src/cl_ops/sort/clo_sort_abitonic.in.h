@@ -19,6 +19,13 @@
 /**
  * @file
  * Advanced bitonic sort header file.
+ *
+ * The advanced bitonic sort has no stable mode: the exchanges of its
+ * private memory and subgroup shuffle kernels can't take the original
+ * positions of elements into account without doubling the data held
+ * by each work-item. As such, creating it with the `stable=1` option
+ * fails, while with `stable=auto` the sort is performed by the stable
+ * simple bitonic sort instead.
  */
 
 #ifndef _CLO_SORT_ABITONIC_H_
@@ -30,7 +37,7 @@
 #define CLO_SORT_ABITONIC_SRC "@ABITONIC_SRC@"
 
 /* Number of kernels. */
-#define CLO_SORT_ABITONIC_NUM_KERNELS 26
+#define CLO_SORT_ABITONIC_NUM_KERNELS 36
 
 /* Index of the advanced bitonic sort kernels. */
 #define CLO_SORT_ABITONIC_KIDX_ANY 0
@@ -59,6 +66,16 @@
 #define CLO_SORT_ABITONIC_KIDX_HYB_S4_4S16V 23
 #define CLO_SORT_ABITONIC_KIDX_HYB_S8_4S16V 24
 #define CLO_SORT_ABITONIC_KIDX_HYB_S12_4S16V 25
+#define CLO_SORT_ABITONIC_KIDX_SHFL_S2 26
+#define CLO_SORT_ABITONIC_KIDX_SHFL_S3 27
+#define CLO_SORT_ABITONIC_KIDX_SHFL_S4 28
+#define CLO_SORT_ABITONIC_KIDX_SHFL_S5 29
+#define CLO_SORT_ABITONIC_KIDX_SHFL_S6 30
+#define CLO_SORT_ABITONIC_KIDX_SHFL_S7 31
+#define CLO_SORT_ABITONIC_KIDX_SHFL_S8 32
+#define CLO_SORT_ABITONIC_KIDX_SHFL_S9 33
+#define CLO_SORT_ABITONIC_KIDX_SHFL_S10 34
+#define CLO_SORT_ABITONIC_KIDX_SHFL_S11 35
 
 /* Advanced bitonic sort kernel names. */
 #define CLO_SORT_ABITONIC_KNAME_ANY "abit_any"
@@ -87,6 +104,16 @@
 #define CLO_SORT_ABITONIC_KNAME_HYB_S4_4S16V "abit_hyb_s4_4s16v"
 #define CLO_SORT_ABITONIC_KNAME_HYB_S8_4S16V "abit_hyb_s8_4s16v"
 #define CLO_SORT_ABITONIC_KNAME_HYB_S12_4S16V "abit_hyb_s12_4s16v"
+#define CLO_SORT_ABITONIC_KNAME_SHFL_S2 "abit_shfl_s2"
+#define CLO_SORT_ABITONIC_KNAME_SHFL_S3 "abit_shfl_s3"
+#define CLO_SORT_ABITONIC_KNAME_SHFL_S4 "abit_shfl_s4"
+#define CLO_SORT_ABITONIC_KNAME_SHFL_S5 "abit_shfl_s5"
+#define CLO_SORT_ABITONIC_KNAME_SHFL_S6 "abit_shfl_s6"
+#define CLO_SORT_ABITONIC_KNAME_SHFL_S7 "abit_shfl_s7"
+#define CLO_SORT_ABITONIC_KNAME_SHFL_S8 "abit_shfl_s8"
+#define CLO_SORT_ABITONIC_KNAME_SHFL_S9 "abit_shfl_s9"
+#define CLO_SORT_ABITONIC_KNAME_SHFL_S10 "abit_shfl_s10"
+#define CLO_SORT_ABITONIC_KNAME_SHFL_S11 "abit_shfl_s11"
 
 /* Array of strings containing names of the kernels used by the advanced
  * bitonic sort strategy. */
@@ -103,11 +130,17 @@
 	CLO_SORT_ABITONIC_KNAME_HYB_S3_3S8V, CLO_SORT_ABITONIC_KNAME_HYB_S6_3S8V, \
 	CLO_SORT_ABITONIC_KNAME_HYB_S9_3S8V, CLO_SORT_ABITONIC_KNAME_HYB_S12_3S8V, \
 	CLO_SORT_ABITONIC_KNAME_HYB_S4_4S16V, CLO_SORT_ABITONIC_KNAME_HYB_S8_4S16V, \
-	CLO_SORT_ABITONIC_KNAME_HYB_S12_4S16V}
+	CLO_SORT_ABITONIC_KNAME_HYB_S12_4S16V, CLO_SORT_ABITONIC_KNAME_SHFL_S2, \
+	CLO_SORT_ABITONIC_KNAME_SHFL_S3, CLO_SORT_ABITONIC_KNAME_SHFL_S4, \
+	CLO_SORT_ABITONIC_KNAME_SHFL_S5, CLO_SORT_ABITONIC_KNAME_SHFL_S6, \
+	CLO_SORT_ABITONIC_KNAME_SHFL_S7, CLO_SORT_ABITONIC_KNAME_SHFL_S8, \
+	CLO_SORT_ABITONIC_KNAME_SHFL_S9, CLO_SORT_ABITONIC_KNAME_SHFL_S10, \
+	CLO_SORT_ABITONIC_KNAME_SHFL_S11}
 
 #define CLO_SORT_ABITONIC_KNAME_LOCAL_MARK "local"
 #define CLO_SORT_ABITONIC_KNAME_PRIV_MARK "priv"
 #define CLO_SORT_ABITONIC_KNAME_HYB_MARK "hyb"
+#define CLO_SORT_ABITONIC_KNAME_SHFL_MARK "shfl"
 
 #define CLO_SORT_ABITONIC_KPARSE_V(kname) atoi(g_strrstr(kname, "s") + 1)
 #define CLO_SORT_ABITONIC_KPARSE_S(kname) atoi(g_strrstr(kname, "_") + 1)
@@ -26,7 +26,59 @@
 #include "cl_ops/clo_sort_abitonic.h"
 #include "cl_ops/clo_sort_gselect.h"
 #include "cl_ops/clo_sort_satradix.h"
+#include "cl_ops/clo_sort_samplesort.h"
+#include "cl_ops/clo_sort_host.h"
 #include "common/_g_err_macros.h"
+#include <string.h>
+
+/** Number of samples taken per device for determining the splitters
+ * in multi-device sorting. */
+#define CLO_SORT_MULTI_OVERSAMPLE 64
+
+/** Maximum number of elements sorted in each device for measuring the
+ * device throughput in multi-device sorting. */
+#define CLO_SORT_MULTI_CALIB_NUMEL (1 << 20)
+
+/** Number of timed sorts in each device for measuring the device
+ * throughput in multi-device sorting. */
+#define CLO_SORT_MULTI_CALIB_RUNS 5
+
+/** Minimum number of elements per device for which multi-device sorting
+ * is worthwhile. */
+#define CLO_SORT_MULTI_MIN_NUMEL 1024
+
+/** Number of elements partitioned by each work-item in multi-device
+ * sorting. */
+#define CLO_SORT_MULTI_PART_PER_WI 64
+
+/** Sort implementation used when stable sorting is requested with
+ * `stable=auto` and the requested implementation is not stable. */
+#define CLO_SORT_STABLE_DEFAULT "sbitonic"
+
+/** Default maximum number of elements which are sorted on the host
+ * instead of with the requested implementation, when the host is able
+ * to sort them (see the `host_max` option of clo_sort_new()). */
+#define CLO_SORT_HOST_MAX_DEFAULT 256
+
+/** Number of buckets in each top-k / k-th element selection
+ * iteration. */
+#define CLO_SORT_SELECT_BUCKETS 256
+
+/** Number of samples per bucket for determining the splitters in
+ * top-k / k-th element selection. */
+#define CLO_SORT_SELECT_OVERSAMPLE 4
+
+/** Maximum number of work-groups for top-k / k-th element selection
+ * kernels. */
+#define CLO_SORT_SELECT_MAX_WGS 64
+
+/** Maximum number of candidates sorted in local memory in top-k / k-th
+ * element selection. */
+#define CLO_SORT_SELECT_LOCAL_MAX 2048
+
+/** Number of merge steps per work-item in sorted search with sorted
+ * query keys. */
+#define CLO_SORT_SEARCH_MERGE_STEPS 32
 
 /**
  * @addtogroup CLO_SORT
@@ -56,8 +108,51 @@ struct clo_sort {
 	/** @private Scan implementation data. */
 	void* data;
 
+	/** @private Command batch being recorded, if any. */
+	CloBatch* batch;
+
+	/** @private Was stable sorting requested? */
+	cl_bool stable;
+
+	/** @private Are elements sorted by their own value in ascending
+	 * order, i.e. with the default comparison and key? */
+	cl_bool default_order;
+
+	/** @private Command queue for each device in context, used for
+	 * multi-device sorting. */
+	CCLQueue** multi_queues;
+
+	/** @private Measured sort throughput of each device in context,
+	 * used for multi-device sorting. */
+	double* dev_tput;
+
+	/** @private Number of devices used in multi-device sorting. */
+	cl_uint num_devs_multi;
+
+	/** @private Maximum number of elements which are sorted on the
+	 * host instead of with the sort implementation. */
+	size_t host_max;
+
 };
 
+/**
+ * @internal
+ * Should the given number of elements be sorted on the host instead of
+ * with the sort implementation? This is the case for few elements,
+ * which don't make up for kernel dispatch, as long as the host is able
+ * to determine the sort order and the sort is not being recorded.
+ *
+ * @param[in] sorter Sorter object.
+ * @param[in] numel Number of elements to sort.
+ * @return `CL_TRUE` if elements should be sorted on the host,
+ * `CL_FALSE` otherwise.
+ * */
+static cl_bool clo_sort_route_host(CloSort* sorter, size_t numel) {
+
+	return (numel <= sorter->host_max) && (sorter->batch == NULL)
+		&& sorter->default_order && CLO_TYPE_IS_SCALAR(sorter->elem_type);
+}
+
 
 /**
  * Generic sort object constructor. The exact type is given in the
@@ -66,10 +161,25 @@ struct clo_sort {
  * @public @memberof clo_sort
  *
  * @param[in] type Name of sort algorithm class to create.
- * @param[in] options Algorithm options.
- * @param[in] ctx OpenCL context wrapper.
+ * @param[in] options Algorithm options. Besides the implementation
+ * specific options, the `stable` option is accepted by all
+ * implementations: `stable=1` requests a stable sort, failing if the
+ * implementation is not able to sort stably; `stable=auto` also
+ * requests a stable sort, but routes to a stable implementation if
+ * required. In this case, the implementation specific options are
+ * forwarded to the stable implementation, failing with
+ * ::CLO_ERROR_ARGS if they don't apply to it. The `host_max` option,
+ * also accepted by all implementations, sets the maximum number of
+ * elements which are sorted on the host instead (256 by default, 0
+ * disables it), when sorting elements of a scalar type with the
+ * default comparison and key.
+ * @param[in] ctx OpenCL context wrapper. Can be `NULL` for the host
+ * sort, in which case no OpenCL program is built, and only host data
+ * or device data sorts are available (no selection, search or
+ * multi-device sorting).
  * @param[in] elem_type Type of elements from which to get the keys to
- * sort.
+ * sort. Vector and record types are moved as a whole, with their
+ * keys obtained with `get_key`.
  * @param[in] key_type Type of keys to sort (if NULL, defaults to the
  * element type).
  * @param[in] compare One-liner OpenCL C code string which compares two
@@ -102,10 +212,22 @@ CloSort* clo_sort_new(const char* type, const char* options,
 	const char* src;
 	/* Sort macros builder. */
 	GString* ocl_macros = NULL;
-	/* Complete source (macros + algorithm source). */
-	const char* src_full[2];
+	/* Complete source (macros + common sort source + algorithm
+	 * source). */
+	const char* src_full[3];
 	/* Internal error handling object. */
 	GError* err_internal = NULL;
+	/* Tokenized options. */
+	gchar** opts = NULL;
+	/* Options passed to the sort implementation. */
+	GString* impl_opts = NULL;
+	/* Requested stability: 0 - not requested, 1 - required,
+	 * 2 - route to a stable implementation if required. */
+	int stable = 0;
+	/* Maximum number of elements sorted on the host. */
+	guint64 host_max = CLO_SORT_HOST_MAX_DEFAULT;
+	/* End of parsed number. */
+	gchar* end = NULL;
 
 	/* Known sort implementations. */
 	CloSortImplDef sort_impls[] = {
@@ -113,9 +235,72 @@ CloSort* clo_sort_new(const char* type, const char* options,
 		clo_sort_abitonic_def,
 		clo_sort_gselect_def,
 		clo_sort_satradix_def,
-		{ NULL, CL_FALSE, NULL, NULL, NULL, NULL, NULL, NULL }
+		clo_sort_samplesort_def,
+		clo_sort_host_def,
+		{ NULL, CL_FALSE, CL_FALSE, CL_FALSE, NULL, NULL, NULL, NULL, NULL,
+			NULL }
 	};
 
+	/* Extract the generic stable option, passing the remaining options
+	 * to the sort implementation. */
+	if (options) {
+		opts = g_strsplit_set(options, ",", -1);
+		impl_opts = g_string_new("");
+		for (guint i = 0; opts[i] != NULL; i++) {
+			if (g_str_has_prefix(opts[i], "stable=")) {
+				if (g_strcmp0(opts[i] + 7, "0") == 0) {
+					stable = 0;
+				} else if (g_strcmp0(opts[i] + 7, "1") == 0) {
+					stable = 1;
+				} else if (g_strcmp0(opts[i] + 7, "auto") == 0) {
+					stable = 2;
+				} else {
+					g_if_err_create_goto(*err, CLO_ERROR, TRUE,
+						CLO_ERROR_ARGS, error_handler,
+						"Invalid value for stable option: '%s'.",
+						opts[i] + 7);
+				}
+			} else if (g_str_has_prefix(opts[i], "host_max=")) {
+				host_max = g_ascii_strtoull(opts[i] + 9, &end, 10);
+				g_if_err_create_goto(*err, CLO_ERROR,
+					(opts[i][9] == '\0') || (*end != '\0'),
+					CLO_ERROR_ARGS, error_handler,
+					"Invalid value for host_max option: '%s'.",
+					opts[i] + 9);
+			} else if (opts[i][0] != '\0') {
+				g_string_append_printf(impl_opts, "%s,", opts[i]);
+			}
+		}
+		options = impl_opts->str;
+	}
+
+	/* If stable sorting was requested, check if the requested sort
+	 * implementation is able to sort stably. */
+	for (guint i = 0; stable && (sort_impls[i].name != NULL); ++i) {
+		if ((g_strcmp0(type, sort_impls[i].name) == 0)
+			&& (!sort_impls[i].stable)) {
+
+			g_if_err_create_goto(*err, CLO_ERROR, stable == 1,
+				CLO_ERROR_ARGS, error_handler,
+				"The '%s' sort implementation is not stable.", type);
+
+			/* Route to a stable implementation, forwarding the
+			 * remaining options. */
+			g_debug("Sort '%s' is not stable, using '%s' instead "
+				"with options '%s'.", type, CLO_SORT_STABLE_DEFAULT,
+				options != NULL ? options : "");
+			type = CLO_SORT_STABLE_DEFAULT;
+			break;
+		}
+	}
+
+	/* Only the host sort is able to work without a context. */
+	g_if_err_create_goto(*err, CLO_ERROR,
+		(ctx == NULL) && (g_strcmp0(type, CLO_SORT_HOST_NAME) != 0),
+		CLO_ERROR_ARGS, error_handler,
+		"The '%s' sort implementation requires an OpenCL context.",
+		type);
+
 	/* Search in the list of known sort classes. */
 	for (guint i = 0; sort_impls[i].name != NULL; ++i) {
 		if (g_strcmp0(type, sort_impls[i].name) == 0) {
@@ -126,8 +311,20 @@ CloSort* clo_sort_new(const char* type, const char* options,
 			/* Set implementation definition. */
 			sorter->impl_def = sort_impls[i];
 
+			/* Keep requested stability. */
+			sorter->stable = (stable != 0);
+
+			/* Keep maximum number of elements sorted on the host. */
+			sorter->host_max = (size_t) host_max;
+
+			/* Keep whether elements are sorted by their own value in
+			 * ascending order. */
+			sorter->default_order = (compare == NULL)
+				&& (get_key == NULL)
+				&& ((key_type == NULL) || (*key_type == *elem_type));
+
 			/* Keep context, program and element type. */
-			ccl_context_ref(ctx);
+			if (ctx) ccl_context_ref(ctx);
 			sorter->ctx  = ctx;
 			sorter->elem_type = *elem_type;
 			sorter->key_type =
@@ -138,11 +335,23 @@ CloSort* clo_sort_new(const char* type, const char* options,
 			src = sorter->impl_def.init(sorter, options, &err_internal);
 			g_if_err_propagate_goto(err, err_internal, error_handler);
 
+			/* Without a context, there is no program to build. */
+			if (ctx == NULL) continue;
+
 			/* Build sort macros which define element and key types,
 			 * comparison type and how to obtain a key from the
 			 * corresponding element. */
 			ocl_macros = g_string_new("");
 
+			/* Definitions of record types. */
+			if (clo_type_get_def(sorter->elem_type))
+				g_string_append(ocl_macros,
+					clo_type_get_def(sorter->elem_type));
+			if ((sorter->key_type != sorter->elem_type)
+					&& clo_type_get_def(sorter->key_type))
+				g_string_append(ocl_macros,
+					clo_type_get_def(sorter->key_type));
+
 			/* Element type. */
 			g_string_append_printf(ocl_macros,
 				"#define CLO_SORT_ELEM_TYPE %s\n",
@@ -153,6 +362,12 @@ CloSort* clo_sort_new(const char* type, const char* options,
 				"#define CLO_SORT_KEY_TYPE %s\n",
 				clo_type_get_name(sorter->key_type));
 
+			/* Scalar elements can be exchanged with subgroup
+			 * shuffles, which don't accept vector or record types. */
+			if (CLO_TYPE_IS_SCALAR(sorter->elem_type))
+				g_string_append(ocl_macros,
+					"#define CLO_SORT_ELEM_IS_SCALAR\n");
+
 			/* Comparison type. */
 			g_string_append_printf(ocl_macros,
 				"#define CLO_SORT_COMPARE(a, b) %s\n",
@@ -169,9 +384,10 @@ CloSort* clo_sort_new(const char* type, const char* options,
 
 			/* Create and build program. */
 			src_full[0] = (const char*) ocl_macros->str;
-			src_full[1] = src;
+			src_full[1] = CLO_SORT_COMMON_SRC;
+			src_full[2] = src;
 			sorter->prg = ccl_program_new_from_sources(
-				ctx, 2, src_full, NULL, &err_internal);
+				ctx, 3, src_full, NULL, &err_internal);
 			g_if_err_propagate_goto(err, err_internal, error_handler);
 
 			ccl_program_build(
@@ -201,6 +417,8 @@ finish:
 
 	/* Free stuff. */
 	if (ocl_macros) g_string_free(ocl_macros, TRUE);
+	if (impl_opts) g_string_free(impl_opts, TRUE);
+	g_strfreev(opts);
 
 	/* Return new sorter instance. */
 	return sorter;
@@ -227,6 +445,17 @@ void clo_sort_destroy(CloSort* sorter) {
 	/* Destroy program wrapper. */
 	if (sorter->prg) ccl_program_destroy(sorter->prg);
 
+	/* Destroy multi-device sorting queues. */
+	if (sorter->multi_queues) {
+		for (cl_uint d = 0; d < sorter->num_devs_multi; ++d)
+			if (sorter->multi_queues[d])
+				ccl_queue_destroy(sorter->multi_queues[d]);
+		g_free(sorter->multi_queues);
+	}
+
+	/* Free measured device throughputs. */
+	g_free(sorter->dev_tput);
+
 	/* Free sorter object. */
 	g_slice_free(CloSort, sorter);
 }
@@ -245,7 +474,9 @@ void clo_sort_destroy(CloSort* sorter) {
  * @param[out] data_out Location where to place sorted data. If
  * `NULL`, data will be sorted in-place or copied back from auxiliar
  * device buffer, depending on the sort implementation.
- * @param[in] numel Number of elements in `data_in`.
+ * @param[in] numel Number of elements in `data_in`. If at most
+ * `host_max` (see clo_sort_new()), the data is mapped and sorted on the
+ * host.
  * @param[in] lws_max Max. local worksize. If 0, the local worksize
  * will be automatically determined.
  * @param[out] err Return location for a GError, or `NULL` if error
@@ -266,15 +497,95 @@ CCLEvent* clo_sort_with_device_data(CloSort* sorter, CCLQueue* cq_exec,
 	/* Make sure cq_exec is not NULL. */
 	g_return_val_if_fail(cq_exec != NULL, NULL);
 
+	/* Sort few elements on the host. */
+	if (clo_sort_route_host(sorter, numel))
+		return clo_sort_host_def.sort_with_device_data(sorter, cq_exec,
+			cq_comm, data_in, data_out, numel, lws_max, err);
+
 	/* Use specific implementation. */
 	return sorter->impl_def.sort_with_device_data(sorter, cq_exec,
 		cq_comm, data_in, data_out, numel, lws_max, err);
 
 }
 
+/**
+ * Record a sort using device data in a command batch. The sort is
+ * performed once, as in clo_sort_with_device_data(), and the complete
+ * sequence of kernel arguments, kernel executions and buffer copies is
+ * captured in the returned batch. The sort can then be repeated with
+ * clo_batch_replay() with minimal host overhead, as long as the sorter,
+ * queues and buffers remain valid and the contents of `data_in` are to
+ * be sorted again.
+ *
+ * @public @memberof clo_sort
+ *
+ * @param[in] sorter Sorter object.
+ * @param[in] cq_exec A valid command queue wrapper for kernel
+ * execution, cannot be `NULL`.
+ * @param[in] cq_comm A command queue wrapper for data transfers.
+ * If `NULL`, `cq_exec` will be used for data transfers.
+ * @param[in] data_in Data to be sorted.
+ * @param[out] data_out Location where to place sorted data. If
+ * `NULL`, data will be sorted in-place or copied back from auxiliar
+ * device buffer, depending on the sort implementation.
+ * @param[in] numel Number of elements in `data_in`.
+ * @param[in] lws_max Max. local worksize. If 0, the local worksize
+ * will be automatically determined.
+ * @param[in] prof If `CL_TRUE`, named events will be created when the
+ * batch is replayed so that it can be profiled.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return A new command batch, which must be destroyed with
+ * clo_batch_destroy(), or `NULL` if an error occurs.
+ * */
+CloBatch* clo_sort_record(CloSort* sorter, CCLQueue* cq_exec,
+	CCLQueue* cq_comm, CCLBuffer* data_in, CCLBuffer* data_out,
+	size_t numel, size_t lws_max, cl_bool prof, GError** err) {
+
+	/* Make sure sorter object is not NULL. */
+	g_return_val_if_fail(sorter != NULL, NULL);
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Make sure cq_exec is not NULL. */
+	g_return_val_if_fail(cq_exec != NULL, NULL);
+
+	/* Batch to record. */
+	CloBatch* batch = clo_batch_new(prof);
+
+	/* Internal error handling object. */
+	GError* err_internal = NULL;
+
+	/* Perform sort while recording it. */
+	sorter->batch = batch;
+	sorter->impl_def.sort_with_device_data(sorter, cq_exec, cq_comm,
+		data_in, data_out, numel, lws_max, &err_internal);
+	sorter->batch = NULL;
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	clo_batch_destroy(batch);
+	batch = NULL;
+
+finish:
+
+	/* Return recorded batch. */
+	return batch;
+
+}
+
 /**
  * Perform sort using host data. Device buffers will be created and
- * destroyed by sort implementation.
+ * destroyed by sort implementation. The host sort, and sorts of at most
+ * `host_max` elements (see clo_sort_new()), are performed directly on
+ * the host data, without device buffers.
  *
  * @public @memberof clo_sort
  *
@@ -325,6 +636,18 @@ cl_bool clo_sort_with_host_data(CloSort* sorter, CCLQueue* cq_exec,
 	/* Determine data size. */
 	size_t data_size = numel * clo_type_sizeof(sorter->elem_type);
 
+	/* The host sort, and sorts of few elements, work directly on host
+	 * data, skipping device transfers altogether. */
+	if ((g_strcmp0(sorter->impl_def.name, CLO_SORT_HOST_NAME) == 0)
+		|| clo_sort_route_host(sorter, numel)) {
+		if (data_out != data_in) memcpy(data_out, data_in, data_size);
+		clo_sort_host_radix(
+			sorter->elem_type, data_out, numel, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		status = CL_TRUE;
+		goto finish;
+	}
+
 	/* Get context wrapper. */
 	ctx = clo_sort_get_context(sorter);
 
@@ -418,143 +741,1538 @@ finish:
 }
 
 /**
- * Get the context wrapper associated with the given sorter object.
- *
- * @public @memberof clo_sort
- *
- * @param[in] sorter Sorter object.
- * @return The context wrapper associated with the given sorter object.
+ * @internal
+ * Measure the throughput of each device in the sorter context, by
+ * sorting the first elements of the data to be sorted in each device.
+ * Only the device sort is timed, not buffer allocation nor data
+ * transfers. After a warm-up sort, several sorts are timed, and the
+ * fastest one is kept, so that sporadic delays are not measured.
  * */
-CCLContext* clo_sort_get_context(CloSort* sorter) {
+static cl_bool clo_sort_measure_tput(CloSort* sorter, void* data,
+	size_t numel, size_t lws_max, GError** err) {
 
-	/* Make sure sorter object is not NULL. */
-	g_return_val_if_fail(sorter != NULL, NULL);
+	/* Function return status. */
+	cl_bool status;
 
-	/* Return context wrapper. */
-	return sorter->ctx;
-}
+	/* Number of elements to sort in each device. */
+	size_t calib_numel = MIN(numel, CLO_SORT_MULTI_CALIB_NUMEL);
 
+	/* Size of data to sort in each device. */
+	size_t size = calib_numel * clo_sort_get_element_size(sorter);
 
-/**
- * Get the program wrapper associated with the given sorter object.
- *
- * @public @memberof clo_sort
- *
- * @param[in] sorter Sorter object.
- * @return The program wrapper associated with the given sorter object.
- * */
-CCLProgram* clo_sort_get_program(CloSort* sorter) {
+	/* Measured throughputs. */
+	double* dev_tput = g_new(double, sorter->num_devs_multi);
 
-	/* Make sure sorter object is not NULL. */
-	g_return_val_if_fail(sorter != NULL, NULL);
+	/* Fastest sort time in the current device. */
+	double best;
 
-	/* Return program wrapper. */
-	return sorter->prg;
-}
+	/* Device buffers. */
+	CCLBuffer* in_dev = NULL;
+	CCLBuffer* out_dev = NULL;
 
-/**
- * Get the element type associated with the given sorter object.
- *
- * @public @memberof clo_sort
- *
- * @param[in] sorter Sorter object.
- * @return The element type associated with the given sorter object.
- * */
-CloType clo_sort_get_element_type(CloSort* sorter) {
+	/* Timer. */
+	GTimer* timer = g_timer_new();
 
-	/* Make sure sorter object is not NULL. */
-	g_return_val_if_fail(sorter != NULL, -1);
+	/* Internal error object. */
+	GError* err_internal = NULL;
 
-	/* Return element type. */
-	return sorter->elem_type;
-}
+	for (cl_uint d = 0; d < sorter->num_devs_multi; ++d) {
 
-/**
- * Get the size in bytes of each element to be sorted.
- *
- * @public @memberof clo_sort
- *
- * @param[in] sorter Sorter object.
- * @return The size in bytes of each element to be sorted.
- * */
-size_t clo_sort_get_element_size(CloSort* sorter) {
+		CCLQueue* cq = sorter->multi_queues[d];
 
-	/* Make sure sorter object is not NULL. */
-	g_return_val_if_fail(sorter != NULL, 0);
+		in_dev = ccl_buffer_new(sorter->ctx, CL_MEM_READ_WRITE, size,
+			NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		if (!sorter->impl_def.in_place) {
+			out_dev = ccl_buffer_new(sorter->ctx, CL_MEM_READ_WRITE,
+				size, NULL, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+		}
 
-	/* Return element size. */
-	return clo_type_sizeof(sorter->elem_type);
+		/* The first sort is a warm-up, so that one-time overheads are
+		 * not measured; the remaining ones are timed. */
+		best = G_MAXDOUBLE;
+		for (guint r = 0; r <= CLO_SORT_MULTI_CALIB_RUNS; ++r) {
 
-}
+			ccl_buffer_enqueue_write(in_dev, cq, CL_TRUE, 0, size, data,
+				NULL, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+			ccl_queue_finish(cq, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
 
-/**
- * Get the key type associated with the given sorter object.
- *
- * @public @memberof clo_sort
- *
- * @param[in] sorter Sorter object.
- * @return The key type associated with the given sorter object.
- * */
-CloType clo_sort_get_key_type(CloSort* sorter) {
+			g_timer_start(timer);
+			sorter->impl_def.sort_with_device_data(sorter, cq, NULL,
+				in_dev, out_dev, calib_numel, lws_max, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+			ccl_queue_finish(cq, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+			g_timer_stop(timer);
+			if (r > 0) best = MIN(best, g_timer_elapsed(timer, NULL));
+		}
 
-	/* Make sure sorter object is not NULL. */
-	g_return_val_if_fail(sorter != NULL, -1);
+		/* Elements sorted per second. */
+		dev_tput[d] = calib_numel / MAX(best, 1e-9);
 
-	/* Return key type. */
-	return sorter->key_type;
-}
+		g_debug("Multi-device sort: device %d throughput is %g elem/s",
+			d, dev_tput[d]);
 
-/**
- * Get the size in bytes of each key to be sorted.
- *
- * @public @memberof clo_sort
- *
- * @param[in] sorter Sorter object.
- * @return The size in bytes of each key to be sorted.
- * */
-size_t clo_sort_get_key_size(CloSort* sorter) {
+		ccl_buffer_destroy(in_dev);
+		in_dev = NULL;
+		if (out_dev) ccl_buffer_destroy(out_dev);
+		out_dev = NULL;
+	}
 
-	/* Make sure sorter object is not NULL. */
-	g_return_val_if_fail(sorter != NULL, 0);
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	sorter->dev_tput = dev_tput;
+	status = CL_TRUE;
+	goto finish;
 
-	/* Return key size. */
-	return clo_type_sizeof(sorter->key_type);
+error_handler:
 
-}
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	g_free(dev_tput);
+	status = CL_FALSE;
 
-/**
- * Get sort specific data.
- *
- * @public @memberof clo_sort
- *
- * @param[in] sorter Sorter object.
- * @return Sort specific data.
- * */
-void* clo_sort_get_data(CloSort* sorter) {
+finish:
 
-	/* Make sure sorter object is not NULL. */
-	g_return_val_if_fail(sorter != NULL, NULL);
+	/* Free stuff. */
+	if (in_dev) ccl_buffer_destroy(in_dev);
+	if (out_dev) ccl_buffer_destroy(out_dev);
+	g_timer_destroy(timer);
 
-	/* Return sort specific data. */
-	return sorter->data;
+	/* Return function status. */
+	return status;
 
 }
 
 /**
- * Set sort specific data.
+ * Perform sort using host data, splitting the work among all the
+ * devices in the sorter context.
+ *
+ * A sample of the data is sorted to determine splitters, such that
+ * the number of elements between consecutive splitters is proportional
+ * to the measured throughput of each device. Each device partitions a
+ * chunk of the data into the respective buckets (using the sort
+ * comparison and key macros), the partitioned bucket ranges are
+ * gathered in the device which sorts the bucket, with device to device
+ * copies which don't go through the host, each bucket is sorted in a
+ * different device, and the sorted buckets are concatenated. The
+ * partition is stable, so stable sort implementations remain stable.
+ * Since buckets can have any size, sort implementations which only
+ * sort powers of two (sbitonic, abitonic and satradix) are not
+ * accepted, and produce a ::CLO_ERROR_ARGS error, even when there is a
+ * single device. A command queue per device is
+ * created and device throughputs are measured in the first call, and
+ * both are kept in the sorter object. If the context has a single
+ * device or there are few elements to sort, this function behaves as
+ * clo_sort_with_host_data().
  *
  * @public @memberof clo_sort
  *
  * @param[in] sorter Sorter object.
- * @param[in] data Sort specific data.
+ * @param[in] data_in Data to be sorted.
+ * @param[out] data_out Location where to place sorted data.
+ * @param[in] numel Number of elements in `data_in`.
+ * @param[in] lws_max Max. local worksize. If 0, the local worksize
+ * will be automatically determined.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if sort was successfully performed, `CL_FALSE`
+ * otherwise.
  * */
-void clo_sort_set_data(CloSort* sorter, void* data) {
+cl_bool clo_sort_with_host_data_multi(CloSort* sorter, void* data_in,
+	void* data_out, size_t numel, size_t lws_max, GError** err) {
 
 	/* Make sure sorter object is not NULL. */
-	g_return_if_fail(sorter != NULL);
+	g_return_val_if_fail(sorter != NULL, CL_FALSE);
 
-	/* Set sort specific data. */
-	sorter->data = data;
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+	/* Function return status. */
+	cl_bool status;
+
+	/* OpenCL wrapper objects. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLKernel* krnl_smpl = NULL;
+	CCLKernel* krnl_cnt = NULL;
+	CCLKernel* krnl_sctr = NULL;
+	CCLBuffer* sample_dev = NULL;
+	CCLBuffer* splitters_dev = NULL;
+	CCLEvent* evt = NULL;
+	CCLQueue** queues = NULL;
+	CCLBuffer** in_dev = NULL;
+	CCLBuffer** out_dev = NULL;
+	CCLBuffer** counts_dev = NULL;
+	CCLBuffer** bkt_in_dev = NULL;
+	CCLBuffer** bkt_out_dev = NULL;
+	CCLEvent** scatter_evts = NULL;
+
+	/* Event wait lists, for host waits and for waits of the bucket
+	 * gathering on the partitions. */
+	CCLEventWaitList ewl = NULL;
+	CCLEventWaitList ewl_part = NULL;
+
+	/* Internal error object. */
+	GError* err_internal = NULL;
+
+	/* Host buffers. */
+	char* sample = NULL;
+	char* splitters = NULL;
+	cl_uint** counts_host = NULL;
+
+	/* Chunk offsets, bucket offsets and sizes, and number of elements
+	 * of each chunk in each bucket. */
+	size_t* offsets = NULL;
+	size_t* counts = NULL;
+	size_t* parts = NULL;
+
+	/* Worksizes of the partition kernels in each device. */
+	size_t* gws_part = NULL;
+	size_t* lws_part = NULL;
+
+	/* Number of devices and of splitters. */
+	cl_uint num_devs, num_splitters;
+
+	/* Number of samples. */
+	cl_uint num_samples;
+
+	/* Total and cumulative throughput. */
+	double tot_tput, cum = 0;
+
+	/* Number of elements partitioned by each work-item. */
+	cl_uint per_wi = CLO_SORT_MULTI_PART_PER_WI;
+
+	/* Element size. */
+	size_t es = clo_sort_get_element_size(sorter);
+
+	/* Partitioning requires the sorter program. */
+	g_if_err_create_goto(*err, CLO_ERROR, sorter->prg == NULL,
+		CLO_ERROR_ARGS, error_handler,
+		"Multi-device sorting requires a sorter with an OpenCL context.");
+
+	/* Buckets can have any size. */
+	g_if_err_create_goto(*err, CLO_ERROR, !sorter->impl_def.any_size,
+		CLO_ERROR_ARGS, error_handler,
+		"Multi-device sorting requires a sort implementation which "\
+		"sorts any number of elements, which '%s' does not.",
+		sorter->impl_def.name);
+
+	/* Get context wrapper. */
+	ctx = clo_sort_get_context(sorter);
+
+	/* Get number of devices. */
+	num_devs = ccl_context_get_num_devices(ctx, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* If there's only one device or too few elements, perform a
+	 * single-device sort. */
+	if ((num_devs < 2) || (numel < num_devs * CLO_SORT_MULTI_MIN_NUMEL)) {
+		status = clo_sort_with_host_data(sorter, NULL, NULL, data_in,
+			data_out, numel, lws_max, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		goto finish;
+	}
+
+	/* Create one queue per device, if not yet created. */
+	if (sorter->multi_queues == NULL) {
+		sorter->multi_queues = g_new0(CCLQueue*, num_devs);
+		sorter->num_devs_multi = num_devs;
+	}
+	queues = sorter->multi_queues;
+	for (cl_uint d = 0; d < num_devs; ++d) {
+		if (queues[d] != NULL) continue;
+		dev = ccl_context_get_device(ctx, d, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		queues[d] = ccl_queue_new(ctx, dev, 0, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+	}
+
+	/* Measure device throughputs, if not yet measured. */
+	if (sorter->dev_tput == NULL) {
+		clo_sort_measure_tput(sorter, data_in, numel, lws_max,
+			&err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+	}
+	tot_tput = 0;
+	for (cl_uint d = 0; d < num_devs; ++d)
+		tot_tput += sorter->dev_tput[d];
+
+	/* Get kernels. */
+	krnl_smpl = ccl_program_get_kernel(clo_sort_get_program(sorter),
+		CLO_SORT_MULTI_KNAME_SAMPLE, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	krnl_cnt = ccl_program_get_kernel(clo_sort_get_program(sorter),
+		CLO_SORT_MULTI_KNAME_COUNT, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	krnl_sctr = ccl_program_get_kernel(clo_sort_get_program(sorter),
+		CLO_SORT_MULTI_KNAME_SCATTER, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Take an evenly spaced sample of the data and sort it in a single
+	 * work-group of the first device. */
+	num_samples = (cl_uint) MIN(numel,
+		num_devs * CLO_SORT_MULTI_OVERSAMPLE);
+	sample = g_malloc(num_samples * es);
+	for (size_t i = 0; i < num_samples; ++i)
+		memcpy(sample + i * es,
+			(char*) data_in + (i * (numel / num_samples)) * es, es);
+	sample_dev = ccl_buffer_new(ctx,
+		CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, num_samples * es,
+		sample, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	{
+		size_t rws = num_samples, lws = lws_max;
+		dev = ccl_queue_get_device(queues[0], &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_kernel_suggest_worksizes(
+			krnl_smpl, dev, 1, &rws, NULL, &lws, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_smpl,
+			queues[0], 1, NULL, &lws, &lws, NULL, &err_internal,
+			sample_dev, ccl_arg_priv(num_samples, cl_uint),
+			NULL);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "multi_sample");
+	}
+	evt = ccl_buffer_enqueue_read(sample_dev, queues[0], CL_FALSE, 0,
+		num_samples * es, sample, NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	ccl_event_set_name(evt, "read_multi_sample");
+	ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Pick splitters at the cumulative throughput quantiles of the
+	 * sorted sample. */
+	num_splitters = num_devs - 1;
+	splitters = g_malloc(num_splitters * es);
+	offsets = g_new0(size_t, num_devs + 1);
+	counts = g_new0(size_t, num_devs);
+	for (cl_uint d = 0; d < num_splitters; ++d) {
+		size_t idx;
+		cum += sorter->dev_tput[d];
+		idx = MIN((size_t) (cum / tot_tput * num_samples),
+			num_samples - 1);
+		memcpy(splitters + d * es, sample + idx * es, es);
+		/* Chunks to partition in each device, also weighted by the
+		 * device throughput. */
+		offsets[d + 1] = (size_t) (cum / tot_tput * numel);
+	}
+	offsets[num_devs] = numel;
+
+	splitters_dev = ccl_buffer_new(ctx,
+		CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, num_splitters * es,
+		splitters, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Count the elements of each chunk in each bucket, in the
+	 * respective device. */
+	in_dev = g_new0(CCLBuffer*, num_devs);
+	out_dev = g_new0(CCLBuffer*, num_devs);
+	counts_dev = g_new0(CCLBuffer*, num_devs);
+	counts_host = g_new0(cl_uint*, num_devs);
+	gws_part = g_new0(size_t, num_devs);
+	lws_part = g_new0(size_t, num_devs);
+	parts = g_new0(size_t, num_devs * num_devs);
+
+	for (cl_uint d = 0; d < num_devs; ++d) {
+
+		cl_uint chunk = (cl_uint) (offsets[d + 1] - offsets[d]);
+		size_t rws = CLO_DIV_CEIL(chunk, per_wi);
+
+		if (chunk == 0) continue;
+
+		dev = ccl_queue_get_device(queues[d], &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		lws_part[d] = lws_max;
+		ccl_kernel_suggest_worksizes(krnl_cnt, dev, 1, &rws,
+			&gws_part[d], &lws_part[d], &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+
+		in_dev[d] = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, chunk * es,
+			NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		out_dev[d] = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, chunk * es,
+			NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		counts_dev[d] = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+			num_devs * gws_part[d] * sizeof(cl_uint), NULL,
+			&err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		counts_host[d] = g_new(cl_uint, num_devs * gws_part[d]);
+
+		evt = ccl_buffer_enqueue_write(in_dev[d], queues[d], CL_FALSE,
+			0, chunk * es, (char*) data_in + offsets[d] * es, NULL,
+			&err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "write_multi_partition");
+
+		evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_cnt,
+			queues[d], 1, NULL, &gws_part[d], &lws_part[d], NULL,
+			&err_internal, in_dev[d], splitters_dev,
+			ccl_arg_priv(num_splitters, cl_uint),
+			ccl_arg_priv(chunk, cl_uint), ccl_arg_priv(per_wi, cl_uint),
+			counts_dev[d], NULL);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "multi_partition_count");
+
+		evt = ccl_buffer_enqueue_read(counts_dev[d], queues[d],
+			CL_FALSE, 0, num_devs * gws_part[d] * sizeof(cl_uint),
+			counts_host[d], NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "read_multi_partition_count");
+		ccl_event_wait_list_add(&ewl, evt, NULL);
+	}
+
+	/* Wait for counts in all devices. */
+	ccl_event_wait(&ewl, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Exclusive scan of the work-item counts of each chunk, in
+	 * bucket-major order, which yields the offset of each work-item in
+	 * each bucket of the partitioned chunk. */
+	for (cl_uint d = 0; d < num_devs; ++d) {
+		cl_uint sum = 0;
+		if (counts_host[d] == NULL) continue;
+		for (cl_uint b = 0; b < num_devs; ++b) {
+			cl_uint bucket_start = sum;
+			for (size_t i = 0; i < gws_part[d]; ++i) {
+				cl_uint c = counts_host[d][b * gws_part[d] + i];
+				counts_host[d][b * gws_part[d] + i] = sum;
+				sum += c;
+			}
+			parts[d * num_devs + b] = sum - bucket_start;
+			counts[b] += sum - bucket_start;
+		}
+	}
+
+	/* Determine bucket offsets. */
+	offsets[0] = 0;
+	for (cl_uint d = 0; d < num_devs; ++d)
+		offsets[d + 1] = offsets[d] + counts[d];
+
+	/* Partition each chunk in the respective device. */
+	scatter_evts = g_new0(CCLEvent*, num_devs);
+	for (cl_uint d = 0; d < num_devs; ++d) {
+
+		cl_uint chunk;
+
+		if (counts_host[d] == NULL) continue;
+		chunk = (cl_uint) (parts[d * num_devs]);
+		for (cl_uint b = 1; b < num_devs; ++b)
+			chunk += (cl_uint) parts[d * num_devs + b];
+
+		evt = ccl_buffer_enqueue_write(counts_dev[d], queues[d],
+			CL_FALSE, 0, num_devs * gws_part[d] * sizeof(cl_uint),
+			counts_host[d], NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "write_multi_partition_offsets");
+
+		evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_sctr,
+			queues[d], 1, NULL, &gws_part[d], &lws_part[d], NULL,
+			&err_internal, in_dev[d], splitters_dev,
+			ccl_arg_priv(num_splitters, cl_uint),
+			ccl_arg_priv(chunk, cl_uint), ccl_arg_priv(per_wi, cl_uint),
+			counts_dev[d], out_dev[d], NULL);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "multi_partition_scatter");
+		scatter_evts[d] = evt;
+	}
+
+	/* Gather the bucket ranges of each partitioned chunk in the device
+	 * which sorts the bucket, and sort each bucket. Since all devices
+	 * share the context, ranges are copied between devices without
+	 * going through the host, once the respective partition is done.
+	 * Within each bucket, ranges are placed in chunk order, keeping the
+	 * partition stable. */
+	bkt_in_dev = g_new0(CCLBuffer*, num_devs);
+	bkt_out_dev = g_new0(CCLBuffer*, num_devs);
+	for (cl_uint b = 0; b < num_devs; ++b) {
+
+		CCLBuffer* read_dev;
+		size_t bkt_pos = 0;
+
+		g_debug("Multi-device sort: device %d sorts %d elements",
+			b, (int) counts[b]);
+
+		if (counts[b] == 0) continue;
+
+		bkt_in_dev[b] = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+			counts[b] * es, NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+
+		/* Create output buffer if sort does not occur in place. */
+		if (!sorter->impl_def.in_place) {
+			bkt_out_dev[b] = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+				counts[b] * es, NULL, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+			read_dev = bkt_out_dev[b];
+		} else {
+			read_dev = bkt_in_dev[b];
+		}
+
+		for (cl_uint d = 0; d < num_devs; ++d) {
+
+			/* Start of the bucket range in the partitioned chunk. */
+			size_t part_start = 0;
+			size_t part = parts[d * num_devs + b];
+
+			if (part == 0) continue;
+			for (cl_uint p = 0; p < b; ++p)
+				part_start += parts[d * num_devs + p];
+
+			evt = ccl_buffer_enqueue_copy(out_dev[d], bkt_in_dev[b],
+				queues[b], part_start * es, bkt_pos * es, part * es,
+				ccl_ewl(&ewl_part, scatter_evts[d], NULL),
+				&err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+			ccl_event_set_name(evt, "copy_multi_partition");
+			bkt_pos += part;
+		}
+
+		sorter->impl_def.sort_with_device_data(sorter, queues[b], NULL,
+			bkt_in_dev[b], bkt_out_dev[b], counts[b], lws_max,
+			&err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+
+		evt = ccl_buffer_enqueue_read(read_dev, queues[b], CL_FALSE, 0,
+			counts[b] * es, (char*) data_out + offsets[b] * es, NULL,
+			&err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "read_multi");
+		ccl_event_wait_list_add(&ewl, evt, NULL);
+	}
+
+	/* Wait for sorts in all devices. */
+	ccl_event_wait(&ewl, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	status = CL_TRUE;
+	goto finish;
+
+error_handler:
+
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	status = CL_FALSE;
+
+finish:
+
+	/* Wait for any pending operations which use host buffers. */
+	if (queues) {
+		for (cl_uint d = 0; d < num_devs; ++d)
+			if (queues[d]) ccl_queue_finish(queues[d], NULL);
+	}
+
+	/* Free stuff. */
+	if (in_dev) {
+		for (cl_uint d = 0; d < num_devs; ++d) {
+			if (in_dev[d]) ccl_buffer_destroy(in_dev[d]);
+			if (out_dev[d]) ccl_buffer_destroy(out_dev[d]);
+			if (counts_dev[d]) ccl_buffer_destroy(counts_dev[d]);
+			g_free(counts_host[d]);
+		}
+	}
+	if (bkt_in_dev) {
+		for (cl_uint b = 0; b < num_devs; ++b) {
+			if (bkt_in_dev[b]) ccl_buffer_destroy(bkt_in_dev[b]);
+			if (bkt_out_dev[b]) ccl_buffer_destroy(bkt_out_dev[b]);
+		}
+	}
+	if (sample_dev) ccl_buffer_destroy(sample_dev);
+	if (splitters_dev) ccl_buffer_destroy(splitters_dev);
+	g_free(in_dev);
+	g_free(out_dev);
+	g_free(counts_dev);
+	g_free(bkt_in_dev);
+	g_free(bkt_out_dev);
+	g_free(scatter_evts);
+	g_free(counts_host);
+	g_free(gws_part);
+	g_free(lws_part);
+	g_free(sample);
+	g_free(splitters);
+	g_free(offsets);
+	g_free(counts);
+	g_free(parts);
+
+	/* Return function status. */
+	return status;
+
+}
+
+/**
+ * @internal
+ * Get the maximum number of elements which can be sorted in local
+ * memory by a single work-group, leaving room for other uses of local
+ * memory.
+ *
+ * @param[in] sorter Sorter object.
+ * @param[in] dev Device where sorting will take place.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return Maximum number of elements which can be sorted in local
+ * memory, or 0 if an error occurs.
+ * */
+static cl_uint clo_sort_select_local_max(CloSort* sorter, CCLDevice* dev,
+	GError** err) {
+
+	/* Local memory size. */
+	cl_ulong local_mem;
+
+	/* Internal error object. */
+	GError* err_internal = NULL;
+
+	local_mem = ccl_device_get_info_scalar(dev, CL_DEVICE_LOCAL_MEM_SIZE,
+		cl_ulong, &err_internal);
+	if (err_internal != NULL) {
+		g_propagate_error(err, err_internal);
+		return 0;
+	}
+
+	return (cl_uint) MIN(CLO_SORT_SELECT_LOCAL_MAX,
+		local_mem / (2 * clo_sort_get_element_size(sorter)));
+
+}
+
+/**
+ * @internal
+ * Sort the first elements of a buffer in place in a single work-group,
+ * in local memory if they fit, or in global memory otherwise. Unlike
+ * some sort implementations, any number of elements can be sorted, and
+ * no element beyond `numel` is accessed.
+ *
+ * @param[in] sorter Sorter object.
+ * @param[in] cq_exec Command queue wrapper for kernel execution.
+ * @param[in,out] data Buffer with the elements to sort.
+ * @param[in] numel Number of elements to sort.
+ * @param[in] lws_max Max. local worksize. If 0, the local worksize
+ * will be automatically determined.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return An event which must terminate before the elements are
+ * considered sorted, or `NULL` if an error occurs.
+ * */
+static CCLEvent* clo_sort_select_sort(CloSort* sorter,
+	CCLQueue* cq_exec, CCLBuffer* data, size_t numel, size_t lws_max,
+	GError** err) {
+
+	/* OpenCL wrapper objects. */
+	CCLDevice* dev = NULL;
+	CCLKernel* krnl = NULL;
+	CCLEvent* evt = NULL;
+
+	/* Internal error object. */
+	GError* err_internal = NULL;
+
+	/* Worksizes. */
+	size_t rws, gws, lws;
+
+	/* Kernel arguments. */
+	cl_uint n = (cl_uint) numel;
+	cl_uint local_max;
+
+	/* Get device and kernel. */
+	dev = ccl_queue_get_device(cq_exec, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	krnl = ccl_program_get_kernel(clo_sort_get_program(sorter),
+		CLO_SORT_SELECT_KNAME_SORT, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Number of elements which can be sorted in local memory. */
+	local_max = clo_sort_select_local_max(sorter, dev, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* A single work-group sorts all elements. */
+	rws = numel;
+	lws = lws_max;
+	ccl_kernel_suggest_worksizes(
+		krnl, dev, 1, &rws, &gws, &lws, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl, cq_exec, 1,
+		NULL, &lws, &lws, NULL, &err_internal,
+		data, ccl_arg_priv(n, cl_uint),
+		ccl_arg_priv(local_max, cl_uint),
+		ccl_arg_local(local_max * clo_sort_get_element_size(sorter),
+			cl_uchar), NULL);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	ccl_event_set_name(evt, "select_sort");
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	evt = NULL;
+
+finish:
+
+	/* Return event. */
+	return evt;
+
+}
+
+/**
+ * @internal
+ * Select the element with the given rank and, optionally, the elements
+ * which come before it in the sort order.
+ *
+ * This is a comparison based variant of radix select: in each
+ * iteration, splitters taken from a sample of the candidates define
+ * buckets (the equivalent of digits), the candidates in each bucket are
+ * counted, and only the candidates in the bucket containing the
+ * requested rank are kept for the next iteration. Candidates in lower
+ * buckets are appended to the top-k output, if requested. Repeated
+ * splitters delimit equality buckets (see `clo_sort_bucket()`), so
+ * if the requested rank falls in one, the selected element is the
+ * respective splitter and the search ends immediately, even with many
+ * repeated keys. Otherwise, when the candidates fit in local memory, or
+ * no further progress can be made, the remaining candidates are sorted
+ * in a single work-group. Candidates are compacted into two buffers,
+ * alternately, which are allocated in the first iteration.
+ *
+ * @param[in] sorter Sorter object.
+ * @param[in] cq_exec Command queue wrapper for kernel execution.
+ * @param[in] data_in Data from where to select.
+ * @param[in] numel Number of elements in `data_in`.
+ * @param[in] rank Rank of the element to select.
+ * @param[out] topk_out Buffer where to place the `rank + 1` first
+ * elements, unsorted, or `NULL` if not required.
+ * @param[out] kth Host location where to place the selected element, or
+ * `NULL` if not required.
+ * @param[in] lws_max Max. local worksize. If 0, the local worksize
+ * will be automatically determined.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if selection was successfully performed, `CL_FALSE`
+ * otherwise.
+ * */
+static cl_bool clo_sort_select(CloSort* sorter, CCLQueue* cq_exec,
+	CCLBuffer* data_in, size_t numel, size_t rank, CCLBuffer* topk_out,
+	void* kth, size_t lws_max, GError** err) {
+
+	/* Function return status. */
+	cl_bool status;
+
+	/* OpenCL wrapper objects. */
+	CCLContext* ctx = NULL;
+	CCLProgram* prg = NULL;
+	CCLDevice* dev = NULL;
+	CCLKernel* krnl_splt = NULL;
+	CCLKernel* krnl_hist = NULL;
+	CCLKernel* krnl_cmpt = NULL;
+	CCLKernel* krnl_finl = NULL;
+	CCLBuffer* cand = NULL;
+	CCLBuffer* next = NULL;
+	CCLBuffer* cand_bufs[2] = { NULL, NULL };
+	CCLBuffer* sample = NULL;
+	CCLBuffer* splitters = NULL;
+	CCLBuffer* counts = NULL;
+	CCLBuffer* pos = NULL;
+	CCLBuffer* kth_dev = NULL;
+	CCLEvent* evt = NULL;
+
+	/* Event wait list. */
+	CCLEventWaitList ewl = NULL;
+
+	/* Internal error object. */
+	GError* err_internal = NULL;
+
+	/* Host bucket counts, followed by equality bucket flags. */
+	cl_uint counts_host[2 * CLO_SORT_SELECT_BUCKETS];
+
+	/* Number of compaction iterations. */
+	guint iter = 0;
+
+	/* Is the target bucket an equality bucket? */
+	cl_bool equal = CL_FALSE;
+
+	/* Zeros for resetting device counters. */
+	cl_uint zeros[CLO_SORT_SELECT_BUCKETS] = { 0 };
+
+	/* Worksizes. */
+	size_t rws, gws, lws;
+
+	/* Kernel arguments. */
+	cl_uint ncand = (cl_uint) numel;
+	cl_uint r = (cl_uint) rank;
+	cl_uint out_base = 0;
+	cl_uint collect = (topk_out != NULL);
+	cl_uint num_out;
+	cl_uint num_buckets = CLO_SORT_SELECT_BUCKETS;
+	cl_uint num_samples = CLO_SORT_SELECT_BUCKETS
+		* CLO_SORT_SELECT_OVERSAMPLE;
+	cl_uint oversample = CLO_SORT_SELECT_OVERSAMPLE;
+	cl_uint target, cum;
+
+	/* Maximum number of elements to sort in local memory. */
+	cl_uint local_max;
+
+	/* Element size. */
+	size_t es = clo_sort_get_element_size(sorter);
+
+	/* Selection requires the sorter program. */
+	g_if_err_create_goto(*err, CLO_ERROR, sorter->prg == NULL,
+		CLO_ERROR_ARGS, error_handler,
+		"Selection requires a sorter with an OpenCL context.");
+
+	/* Get context, program and device. */
+	ctx = clo_sort_get_context(sorter);
+	prg = clo_sort_get_program(sorter);
+	dev = ccl_queue_get_device(cq_exec, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Number of elements which can be sorted in local memory. */
+	local_max = clo_sort_select_local_max(sorter, dev, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Determine worksizes. */
+	rws = numel;
+	lws = lws_max;
+	ccl_kernel_suggest_worksizes(
+		NULL, dev, 1, &rws, &gws, &lws, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	gws = MIN(gws, lws * CLO_SORT_SELECT_MAX_WGS);
+
+	/* Get kernels. */
+	krnl_splt = ccl_program_get_kernel(
+		prg, CLO_SORT_SELECT_KNAME_SPLITTERS, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	krnl_hist = ccl_program_get_kernel(
+		prg, CLO_SORT_SELECT_KNAME_HISTOGRAM, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	krnl_cmpt = ccl_program_get_kernel(
+		prg, CLO_SORT_SELECT_KNAME_COMPACT, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	krnl_finl = ccl_program_get_kernel(
+		prg, CLO_SORT_SELECT_KNAME_FINAL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Create auxiliary buffers. */
+	sample = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, num_samples * es,
+		NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	splitters = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+		(num_buckets - 1) * es, NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	counts = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+		2 * num_buckets * sizeof(cl_uint), NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	pos = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, 2 * sizeof(cl_uint),
+		NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	kth_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, es, NULL,
+		&err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Initially, all elements are candidates. */
+	cand = data_in;
+
+	/* Narrow candidates until they can be sorted in local memory. */
+	while (ncand > local_max) {
+
+		/* Pick splitters. */
+		evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_splt,
+			cq_exec, 1, NULL, &lws, &lws, NULL, &err_internal,
+			cand, ccl_arg_priv(ncand, cl_uint), sample,
+			ccl_arg_priv(num_samples, cl_uint),
+			ccl_arg_priv(oversample, cl_uint), splitters, NULL);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "select_splitters");
+
+		/* Count candidates in each bucket. */
+		evt = ccl_buffer_enqueue_write(counts, cq_exec, CL_TRUE, 0,
+			num_buckets * sizeof(cl_uint), zeros, NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "select_zero_counts");
+
+		evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_hist,
+			cq_exec, 1, NULL, &gws, &lws, NULL, &err_internal,
+			cand, ccl_arg_priv(ncand, cl_uint), splitters,
+			ccl_arg_priv(num_buckets, cl_uint), counts,
+			ccl_arg_local(num_buckets, cl_uint), NULL);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "select_histogram");
+
+		evt = ccl_buffer_enqueue_read(counts, cq_exec, CL_FALSE, 0,
+			2 * num_buckets * sizeof(cl_uint), counts_host, NULL,
+			&err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "select_read_counts");
+
+		/* Explicitly wait for transfer (some OpenCL implementations
+		 * don't respect CL_TRUE in data transfers). */
+		ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+
+		/* Find bucket containing the requested rank. */
+		cum = 0;
+		for (target = 0; target < num_buckets - 1; ++target) {
+			if (r < cum + counts_host[target]) break;
+			cum += counts_host[target];
+		}
+
+		/* All candidates in an equality bucket are equal to the
+		 * splitter which delimits it. */
+		equal = (counts_host[num_buckets + target] != 0);
+		if (equal) {
+			evt = ccl_buffer_enqueue_copy(splitters, kth_dev, cq_exec,
+				target * es, 0, es, NULL, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+			ccl_event_set_name(evt, "select_copy_kth");
+			/* If top-k elements are not required, we're done. */
+			if (!collect) break;
+		} else if (counts_host[target] == ncand) {
+			/* If no progress can be made, sort remaining
+			 * candidates. */
+			break;
+		}
+
+		g_debug("Select: %d candidates, target bucket %d has %d%s",
+			(int) ncand, (int) target, (int) counts_host[target],
+			equal ? " (equal)" : "");
+
+		/* Keep only candidates in the target bucket, compacting them
+		 * into the buffer not holding the current candidates. Since
+		 * candidates only decrease, buffers are sized in the first
+		 * iteration. */
+		if (cand_bufs[0] == NULL) {
+			for (guint i = 0; i < 2; ++i) {
+				cand_bufs[i] = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+					counts_host[target] * es, NULL, &err_internal);
+				g_if_err_propagate_goto(
+					err, err_internal, error_handler);
+			}
+		}
+		next = cand_bufs[iter % 2];
+
+		evt = ccl_buffer_enqueue_write(pos, cq_exec, CL_TRUE, 0,
+			2 * sizeof(cl_uint), zeros, NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "select_zero_pos");
+
+		evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_cmpt,
+			cq_exec, 1, NULL, &gws, &lws, NULL, &err_internal,
+			cand, ccl_arg_priv(ncand, cl_uint), splitters,
+			ccl_arg_priv(num_buckets, cl_uint),
+			ccl_arg_priv(target, cl_uint), next,
+			collect ? topk_out : next,
+			ccl_arg_priv(out_base, cl_uint),
+			ccl_arg_priv(collect, cl_uint), pos, NULL);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "select_compact");
+
+		/* Next iteration. */
+		cand = next;
+		next = NULL;
+		ncand = counts_host[target];
+		out_base += cum;
+		r -= cum;
+		iter++;
+
+		/* The remaining top-k elements are equal, take them from the
+		 * candidates. */
+		if (equal) {
+			evt = ccl_buffer_enqueue_copy(cand, topk_out, cq_exec, 0,
+				out_base * es, (r + 1) * es, NULL, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+			ccl_event_set_name(evt, "select_copy_equal");
+			break;
+		}
+
+	}
+
+	/* If the selected element is not yet known, sort the remaining
+	 * candidates. */
+	if (!equal) {
+
+		/* Remaining candidates are sorted in place if they don't fit in
+		 * local memory, so make sure the input data is not modified. */
+		if ((ncand > local_max) && (cand == data_in)) {
+			cand_bufs[0] = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+				ncand * es, NULL, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+			evt = ccl_buffer_enqueue_copy(cand, cand_bufs[0], cq_exec,
+				0, 0, ncand * es, NULL, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+			ccl_event_set_name(evt, "select_copy");
+			cand = cand_bufs[0];
+		}
+
+		/* Sort remaining candidates and get selected element. */
+		num_out = collect ? r + 1 : 0;
+		evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_finl,
+			cq_exec, 1, NULL, &lws, &lws, NULL, &err_internal,
+			cand, ccl_arg_priv(ncand, cl_uint),
+			ccl_arg_priv(r, cl_uint), ccl_arg_priv(local_max, cl_uint),
+			ccl_arg_local(local_max * es, cl_uchar),
+			collect ? topk_out : kth_dev,
+			ccl_arg_priv(out_base, cl_uint),
+			ccl_arg_priv(num_out, cl_uint), kth_dev, NULL);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "select_final");
+	}
+
+	/* Read selected element, if required. */
+	if (kth != NULL) {
+		evt = ccl_buffer_enqueue_read(kth_dev, cq_exec, CL_FALSE, 0,
+			es, kth, NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "select_read_kth");
+
+		/* Explicitly wait for transfer (some OpenCL implementations
+		 * don't respect CL_TRUE in data transfers). */
+		ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+	}
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	status = CL_TRUE;
+	goto finish;
+
+error_handler:
+
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	status = CL_FALSE;
+
+finish:
+
+	/* Free stuff. */
+	if (cand_bufs[0]) ccl_buffer_destroy(cand_bufs[0]);
+	if (cand_bufs[1]) ccl_buffer_destroy(cand_bufs[1]);
+	if (sample) ccl_buffer_destroy(sample);
+	if (splitters) ccl_buffer_destroy(splitters);
+	if (counts) ccl_buffer_destroy(counts);
+	if (pos) ccl_buffer_destroy(pos);
+	if (kth_dev) ccl_buffer_destroy(kth_dev);
+
+	/* Return function status. */
+	return status;
+
+}
+
+/**
+ * Get the first `k` elements in the sort order (e.g. the `k` smallest
+ * elements, for the default comparison), sorted.
+ *
+ * The elements are selected with a comparison based variant of radix
+ * select, with a cost proportional to `numel`, and only the selected
+ * elements are then sorted: in a single work-group bitonic sort, which
+ * accepts any number of elements, or with the sorter implementation
+ * if the selected elements don't fit in local memory and the
+ * implementation is not limited to powers of two. Either way, no
+ * element of `data_out` beyond the first `k` is accessed. The sorter
+ * comparison and key macros are respected. Unlike
+ * clo_sort_with_device_data(), this operation is not recorded in
+ * command batches, since the host waits for the selection progress.
+ *
+ * @public @memberof clo_sort
+ *
+ * @param[in] sorter Sorter object.
+ * @param[in] cq_exec Command queue wrapper for kernel execution.
+ * @param[in] cq_comm A command queue wrapper for data transfers.
+ * If `NULL`, `cq_exec` will be used for data transfers.
+ * @param[in] data_in Data from where to select (not modified).
+ * @param[out] data_out Location where to place the first `k` elements,
+ * sorted.
+ * @param[in] numel Number of elements in `data_in`.
+ * @param[in] k Number of elements to select.
+ * @param[in] lws_max Max. local worksize. If 0, the local worksize
+ * will be automatically determined.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return An event which must terminate before the selected elements
+ * are considered sorted, or `NULL` if an error occurs.
+ * */
+CCLEvent* clo_sort_topk(CloSort* sorter, CCLQueue* cq_exec,
+	CCLQueue* cq_comm, CCLBuffer* data_in, CCLBuffer* data_out,
+	size_t numel, size_t k, size_t lws_max, GError** err) {
+
+	/* Make sure sorter object is not NULL. */
+	g_return_val_if_fail(sorter != NULL, NULL);
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Make sure cq_exec is not NULL. */
+	g_return_val_if_fail(cq_exec != NULL, NULL);
+
+	/* Event to return. */
+	CCLEvent* evt = NULL;
+
+	/* Device where selection takes place. */
+	CCLDevice* dev = NULL;
+
+	/* Maximum number of elements to sort in local memory. */
+	cl_uint local_max;
+
+	/* Internal error object. */
+	GError* err_internal = NULL;
+
+	/* Check that the number of elements to select is valid. */
+	g_if_err_create_goto(*err, CLO_ERROR, (k == 0) || (k > numel),
+		CLO_ERROR_ARGS, error_handler,
+		"Number of elements to select, %d, must be between 1 and %d.",
+		(int) k, (int) numel);
+
+	/* Select first k elements, unsorted. */
+	clo_sort_select(sorter, cq_exec, data_in, numel, k - 1, data_out,
+		NULL, lws_max, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Sort them. Only the k selected elements may be touched, so the
+	 * sorter implementation is only used if it accepts any number of
+	 * elements and if they don't fit in local memory. */
+	dev = ccl_queue_get_device(cq_exec, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	local_max = clo_sort_select_local_max(sorter, dev, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	if ((k > local_max) && sorter->impl_def.any_size) {
+		evt = sorter->impl_def.sort_with_device_data(sorter, cq_exec,
+			cq_comm, data_out, NULL, k, lws_max, &err_internal);
+	} else {
+		evt = clo_sort_select_sort(sorter, cq_exec, data_out, k, lws_max,
+			&err_internal);
+	}
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	evt = NULL;
+
+finish:
+
+	/* Return event. */
+	return evt;
+
+}
+
+/**
+ * Get the element which would be at position `k` (starting at zero) if
+ * the data was sorted, e.g. the median for `k = numel / 2`.
+ *
+ * The element is selected with a comparison based variant of radix
+ * select, with a cost proportional to `numel`. The sorter comparison
+ * and key macros are respected. This function blocks until the
+ * selected element is available in host memory.
+ *
+ * @public @memberof clo_sort
+ *
+ * @param[in] sorter Sorter object.
+ * @param[in] cq_exec Command queue wrapper for kernel execution.
+ * @param[in] cq_comm A command queue wrapper for data transfers.
+ * If `NULL`, `cq_exec` will be used for data transfers.
+ * @param[in] data_in Data from where to select (not modified).
+ * @param[in] numel Number of elements in `data_in`.
+ * @param[in] k Position of the element to select.
+ * @param[out] kth Host location where to place the selected element.
+ * @param[in] lws_max Max. local worksize. If 0, the local worksize
+ * will be automatically determined.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if selection was successfully performed, `CL_FALSE`
+ * otherwise.
+ * */
+cl_bool clo_select_kth(CloSort* sorter, CCLQueue* cq_exec,
+	CCLQueue* cq_comm, CCLBuffer* data_in, size_t numel, size_t k,
+	void* kth, size_t lws_max, GError** err) {
+
+	/* Make sure sorter object is not NULL. */
+	g_return_val_if_fail(sorter != NULL, CL_FALSE);
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+	/* Make sure cq_exec and kth are not NULL. */
+	g_return_val_if_fail(cq_exec != NULL, CL_FALSE);
+	g_return_val_if_fail(kth != NULL, CL_FALSE);
+
+	/* Function return status. */
+	cl_bool status;
+
+	/* Internal error object. */
+	GError* err_internal = NULL;
+
+	/* Check that the position of the element to select is valid. */
+	g_if_err_create_goto(*err, CLO_ERROR, k >= numel,
+		CLO_ERROR_ARGS, error_handler,
+		"Position of element to select, %d, must be less than %d.",
+		(int) k, (int) numel);
+
+	/* Select element. */
+	status = clo_sort_select(sorter, cq_exec, data_in, numel, k, NULL,
+		kth, lws_max, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	status = CL_FALSE;
+
+finish:
+
+	/* Return function status. */
+	return status;
+
+}
+
+/**
+ * Find, for each query key, the lower bound (position of the first
+ * element which does not come before the key in the sort order) and
+ * the upper bound (position of the first element which comes after the
+ * key) in data sorted with the given sorter. The sorter comparison and
+ * key macros are respected, and query keys have the sorter key type.
+ *
+ * Unsorted query keys are searched independently with binary search,
+ * the top levels of which are performed in local memory. If the query
+ * keys are sorted, the data and the query keys are instead merged with
+ * the merge path method, with a cost proportional to `numel` plus
+ * `num_queries` and consecutive memory accesses.
+ *
+ * @public @memberof clo_sort
+ *
+ * @param[in] sorter Sorter object.
+ * @param[in] cq_exec Command queue wrapper for kernel execution.
+ * @param[in] data Sorted data (not modified).
+ * @param[in] numel Number of elements in `data`.
+ * @param[in] queries Query keys (not modified).
+ * @param[in] num_queries Number of query keys.
+ * @param[in] queries_sorted Are the query keys sorted with the sorter
+ * comparison?
+ * @param[out] lower Buffer of `cl_uint` where to place the lower bound
+ * of each query key.
+ * @param[out] upper Buffer of `cl_uint` where to place the upper bound
+ * of each query key.
+ * @param[in] lws_max Max. local worksize. If 0, the local worksize
+ * will be automatically determined.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return An event which must terminate before the bounds are
+ * available, or `NULL` if an error occurs or there are no queries.
+ * */
+CCLEvent* clo_sort_search(CloSort* sorter, CCLQueue* cq_exec,
+	CCLBuffer* data, size_t numel, CCLBuffer* queries,
+	size_t num_queries, cl_bool queries_sorted, CCLBuffer* lower,
+	CCLBuffer* upper, size_t lws_max, GError** err) {
+
+	/* Make sure sorter object is not NULL. */
+	g_return_val_if_fail(sorter != NULL, NULL);
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Make sure cq_exec and buffers are not NULL. */
+	g_return_val_if_fail(cq_exec != NULL, NULL);
+	g_return_val_if_fail(data != NULL, NULL);
+	g_return_val_if_fail(queries != NULL, NULL);
+	g_return_val_if_fail(lower != NULL, NULL);
+	g_return_val_if_fail(upper != NULL, NULL);
+
+	/* OpenCL wrapper objects. */
+	CCLProgram* prg = NULL;
+	CCLDevice* dev = NULL;
+	CCLKernel* krnl = NULL;
+	CCLEvent* evt = NULL;
+
+	/* Internal error object. */
+	GError* err_internal = NULL;
+
+	/* Worksizes. */
+	size_t rws, gws, lws;
+
+	/* Kernel arguments. */
+	cl_uint nel = (cl_uint) numel;
+	cl_uint nq = (cl_uint) num_queries;
+	cl_uint steps = CLO_SORT_SEARCH_MERGE_STEPS;
+
+	/* Nothing to do if there are no queries. */
+	if (num_queries == 0) goto finish;
+
+	/* Searching requires the sorter program. */
+	g_if_err_create_goto(*err, CLO_ERROR, sorter->prg == NULL,
+		CLO_ERROR_ARGS, error_handler,
+		"Searching requires a sorter with an OpenCL context.");
+
+	/* Get program and device. */
+	prg = clo_sort_get_program(sorter);
+	dev = ccl_queue_get_device(cq_exec, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Get kernel. */
+	krnl = ccl_program_get_kernel(prg, queries_sorted
+			? CLO_SORT_SEARCH_KNAME_MERGE : CLO_SORT_SEARCH_KNAME,
+		&err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Determine worksizes: one work-item per query key for binary
+	 * search, or per group of merge steps for merge path search. */
+	rws = queries_sorted
+		? CLO_DIV_CEIL((numel + num_queries), (size_t) steps)
+		: num_queries;
+	lws = lws_max;
+	ccl_kernel_suggest_worksizes(
+		krnl, dev, 1, &rws, &gws, &lws, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Search. */
+	if (queries_sorted) {
+		evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl, cq_exec, 1,
+			NULL, &gws, &lws, NULL, &err_internal,
+			data, ccl_arg_priv(nel, cl_uint),
+			queries, ccl_arg_priv(nq, cl_uint), lower, upper,
+			ccl_arg_priv(steps, cl_uint), NULL);
+	} else {
+		evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl, cq_exec, 1,
+			NULL, &gws, &lws, NULL, &err_internal,
+			data, ccl_arg_priv(nel, cl_uint),
+			queries, ccl_arg_priv(nq, cl_uint), lower, upper,
+			ccl_arg_local(lws * clo_sort_get_key_size(sorter),
+				cl_uchar), NULL);
+	}
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	ccl_event_set_name(evt, "search");
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	evt = NULL;
+
+finish:
+
+	/* Return event. */
+	return evt;
+
+}
+
+/**
+ * Get the context wrapper associated with the given sorter object.
+ *
+ * @public @memberof clo_sort
+ *
+ * @param[in] sorter Sorter object.
+ * @return The context wrapper associated with the given sorter object.
+ * */
+CCLContext* clo_sort_get_context(CloSort* sorter) {
+
+	/* Make sure sorter object is not NULL. */
+	g_return_val_if_fail(sorter != NULL, NULL);
+
+	/* Return context wrapper. */
+	return sorter->ctx;
+}
+
+
+/**
+ * Get the program wrapper associated with the given sorter object.
+ *
+ * @public @memberof clo_sort
+ *
+ * @param[in] sorter Sorter object.
+ * @return The program wrapper associated with the given sorter object.
+ * */
+CCLProgram* clo_sort_get_program(CloSort* sorter) {
+
+	/* Make sure sorter object is not NULL. */
+	g_return_val_if_fail(sorter != NULL, NULL);
+
+	/* Return program wrapper. */
+	return sorter->prg;
+}
+
+/**
+ * Get the element type associated with the given sorter object.
+ *
+ * @public @memberof clo_sort
+ *
+ * @param[in] sorter Sorter object.
+ * @return The element type associated with the given sorter object.
+ * */
+CloType clo_sort_get_element_type(CloSort* sorter) {
+
+	/* Make sure sorter object is not NULL. */
+	g_return_val_if_fail(sorter != NULL, -1);
+
+	/* Return element type. */
+	return sorter->elem_type;
+}
+
+/**
+ * Get the size in bytes of each element to be sorted.
+ *
+ * @public @memberof clo_sort
+ *
+ * @param[in] sorter Sorter object.
+ * @return The size in bytes of each element to be sorted.
+ * */
+size_t clo_sort_get_element_size(CloSort* sorter) {
+
+	/* Make sure sorter object is not NULL. */
+	g_return_val_if_fail(sorter != NULL, 0);
+
+	/* Return element size. */
+	return clo_type_sizeof(sorter->elem_type);
+
+}
+
+/**
+ * Get the key type associated with the given sorter object.
+ *
+ * @public @memberof clo_sort
+ *
+ * @param[in] sorter Sorter object.
+ * @return The key type associated with the given sorter object.
+ * */
+CloType clo_sort_get_key_type(CloSort* sorter) {
+
+	/* Make sure sorter object is not NULL. */
+	g_return_val_if_fail(sorter != NULL, -1);
+
+	/* Return key type. */
+	return sorter->key_type;
+}
+
+/**
+ * Get the size in bytes of each key to be sorted.
+ *
+ * @public @memberof clo_sort
+ *
+ * @param[in] sorter Sorter object.
+ * @return The size in bytes of each key to be sorted.
+ * */
+size_t clo_sort_get_key_size(CloSort* sorter) {
+
+	/* Make sure sorter object is not NULL. */
+	g_return_val_if_fail(sorter != NULL, 0);
+
+	/* Return key size. */
+	return clo_type_sizeof(sorter->key_type);
+
+}
+
+/**
+ * Get sort specific data.
+ *
+ * @public @memberof clo_sort
+ *
+ * @param[in] sorter Sorter object.
+ * @return Sort specific data.
+ * */
+void* clo_sort_get_data(CloSort* sorter) {
+
+	/* Make sure sorter object is not NULL. */
+	g_return_val_if_fail(sorter != NULL, NULL);
+
+	/* Return sort specific data. */
+	return sorter->data;
+
+}
+
+/**
+ * Set sort specific data.
+ *
+ * @public @memberof clo_sort
+ *
+ * @param[in] sorter Sorter object.
+ * @param[in] data Sort specific data.
+ * */
+void clo_sort_set_data(CloSort* sorter, void* data) {
+
+	/* Make sure sorter object is not NULL. */
+	g_return_if_fail(sorter != NULL);
+
+	/* Set sort specific data. */
+	sorter->data = data;
+
+}
+
+/**
+ * Was stable sorting requested for the given sorter object? Sort
+ * implementations which are not stable by construction use this
+ * function to switch to a stable mode.
+ *
+ * @public @memberof clo_sort
+ *
+ * @param[in] sorter Sorter object.
+ * @return `CL_TRUE` if stable sorting was requested, `CL_FALSE`
+ * otherwise.
+ * */
+cl_bool clo_sort_get_stable(CloSort* sorter) {
+
+	/* Make sure sorter is not NULL. */
+	g_return_val_if_fail(sorter != NULL, CL_FALSE);
+
+	/* Return requested stability. */
+	return sorter->stable;
+
+}
+
+/**
+ * Are elements sorted by their own value in ascending order, i.e. with
+ * the default comparison and key getter? Sort implementations which
+ * run on the host use this function, since they are not able to
+ * evaluate the OpenCL C comparison and key getter.
+ *
+ * @public @memberof clo_sort
+ *
+ * @param[in] sorter Sorter object.
+ * @return `CL_TRUE` if elements are sorted with the default comparison
+ * and key getter, `CL_FALSE` otherwise.
+ * */
+cl_bool clo_sort_get_default_order(CloSort* sorter) {
+
+	/* Make sure sorter is not NULL. */
+	g_return_val_if_fail(sorter != NULL, CL_FALSE);
+
+	/* Return whether the default order is used. */
+	return sorter->default_order;
+
+}
+
+/**
+ * Get the command batch being recorded, if any. Sort implementations
+ * pass this batch to the `clo_batch_set_*()` and `clo_batch_enqueue_*()`
+ * functions.
+ *
+ * @public @memberof clo_sort
+ *
+ * @param[in] sorter Sorter object.
+ * @return Command batch being recorded, or `NULL` if no recording is
+ * taking place.
+ * */
+CloBatch* clo_sort_get_batch(CloSort* sorter) {
+
+	/* Make sure sorter object is not NULL. */
+	g_return_val_if_fail(sorter != NULL, NULL);
+
+	/* Return batch being recorded. */
+	return sorter->batch;
 
 }
 
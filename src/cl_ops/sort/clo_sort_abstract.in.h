@@ -25,9 +25,30 @@
 #define _CLO_SORT_ABSTRACT_H_
 
 #include "cl_ops/clo_common.h"
+#include "cl_ops/clo_batch.h"
+
+/** Helper functions and kernels common to all sort implementations,
+ * used for multi-device sorting and top-k / k-th element selection. */
+#define CLO_SORT_COMMON_SRC "@COMMON_SRC@"
+
+/* Names of the multi-device sorting kernels. */
+#define CLO_SORT_MULTI_KNAME_SAMPLE "clo_sort_sample"
+#define CLO_SORT_MULTI_KNAME_COUNT "clo_sort_partition_count"
+#define CLO_SORT_MULTI_KNAME_SCATTER "clo_sort_partition_scatter"
+
+/* Names of the top-k / k-th element selection kernels. */
+#define CLO_SORT_SELECT_KNAME_SPLITTERS "clo_sort_select_splitters"
+#define CLO_SORT_SELECT_KNAME_HISTOGRAM "clo_sort_select_histogram"
+#define CLO_SORT_SELECT_KNAME_COMPACT "clo_sort_select_compact"
+#define CLO_SORT_SELECT_KNAME_FINAL "clo_sort_select_final"
+#define CLO_SORT_SELECT_KNAME_SORT "clo_sort_select_sort"
+
+/* Names of the sorted search kernels. */
+#define CLO_SORT_SEARCH_KNAME "clo_sort_search"
+#define CLO_SORT_SEARCH_KNAME_MERGE "clo_sort_search_merge"
 
 /* Available sort algoritms. */
-#define CLO_SORT_IMPLS "sbitonic, abitonic, gselect, satradix"
+#define CLO_SORT_IMPLS "sbitonic, abitonic, gselect, satradix, samplesort, host"
 
 /**
  * @defgroup CLO_SORT Sorting algorithms
@@ -52,6 +73,21 @@ typedef struct clo_sort_impl_def {
 	 * */
 	cl_bool in_place;
 
+	/**
+	 * Can the algorithm sort stably, i.e. keeping the relative order of
+	 * elements with equal keys? Algorithms which are not stable by
+	 * construction must switch to a stable mode when
+	 * clo_sort_get_stable() returns `CL_TRUE`.
+	 * */
+	cl_bool stable;
+
+	/**
+	 * Can the algorithm sort any number of elements? Algorithms which
+	 * can't only sort powers of two, and may access elements beyond
+	 * the number of elements to sort, up to the next power of two.
+	 * */
+	cl_bool any_size;
+
 	/**
 	 * Sort algorithm initializer function.
 	 *
@@ -126,12 +162,39 @@ CCLEvent* clo_sort_with_device_data(CloSort* sorter, CCLQueue* cq_exec,
 	CCLQueue* cq_comm, CCLBuffer* data_in, CCLBuffer* data_out,
 	size_t numel, size_t lws_max, GError** err);
 
+/* Record a sort using device data in a command batch. */
+CloBatch* clo_sort_record(CloSort* sorter, CCLQueue* cq_exec,
+	CCLQueue* cq_comm, CCLBuffer* data_in, CCLBuffer* data_out,
+	size_t numel, size_t lws_max, cl_bool prof, GError** err);
+
 /* Perform sort using host data. Device buffers will be created and
  * destroyed by sort implementation. */
 cl_bool clo_sort_with_host_data(CloSort* sorter, CCLQueue* cq_exec,
 	CCLQueue* cq_comm, void* data_in, void* data_out, size_t numel,
 	size_t lws_max, GError** err);
 
+/* Perform sort using host data, splitting the work among all the
+ * devices in the sorter context. */
+cl_bool clo_sort_with_host_data_multi(CloSort* sorter, void* data_in,
+	void* data_out, size_t numel, size_t lws_max, GError** err);
+
+/* Get the first k elements in the sort order, sorted. */
+CCLEvent* clo_sort_topk(CloSort* sorter, CCLQueue* cq_exec,
+	CCLQueue* cq_comm, CCLBuffer* data_in, CCLBuffer* data_out,
+	size_t numel, size_t k, size_t lws_max, GError** err);
+
+/* Get the element which would be at position k if the data was
+ * sorted. */
+cl_bool clo_select_kth(CloSort* sorter, CCLQueue* cq_exec,
+	CCLQueue* cq_comm, CCLBuffer* data_in, size_t numel, size_t k,
+	void* kth, size_t lws_max, GError** err);
+
+/* Find the lower and upper bounds of query keys in sorted data. */
+CCLEvent* clo_sort_search(CloSort* sorter, CCLQueue* cq_exec,
+	CCLBuffer* data, size_t numel, CCLBuffer* queries,
+	size_t num_queries, cl_bool queries_sorted, CCLBuffer* lower,
+	CCLBuffer* upper, size_t lws_max, GError** err);
+
 /* Get the context wrapper associated with the given sorter object. */
 CCLContext* clo_sort_get_context(CloSort* sorter);
 
@@ -156,6 +219,15 @@ void* clo_sort_get_data(CloSort* sorter);
 /* Set sort specific data. */
 void clo_sort_set_data(CloSort* sorter, void* data);
 
+/* Was stable sorting requested for the given sorter object? */
+cl_bool clo_sort_get_stable(CloSort* sorter);
+
+/* Are elements sorted by their own value in ascending order? */
+cl_bool clo_sort_get_default_order(CloSort* sorter);
+
+/* Get the command batch being recorded, if any. */
+CloBatch* clo_sort_get_batch(CloSort* sorter);
+
 /* Get the maximum number of kernels used by the sort implementation. */
 cl_uint clo_sort_get_num_kernels(CloSort* sorter, GError** err);
 
@@ -0,0 +1,606 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+/**
+ * @file
+ * Helper functions and kernels common to all sort implementations,
+ * used for multi-device sorting and for top-k / k-th element
+ * selection.
+ *
+ * Requires definition of:
+ *
+ * * CLO_SORT_ELEM_TYPE - Type of element to sort
+ * * CLO_SORT_COMPARE(a,b) - Compare macro or function
+ * * CLO_SORT_KEY_GET(x) - Get key macro or function
+ * * CLO_SORT_KEY_TYPE - Type of key
+ */
+
+/**
+ * Generates a work-group bitonic sort function for elements in the
+ * given address space. The bitonic network is the variant in which
+ * the first step of each stage compares mirrored elements, so that all
+ * comparisons sort in the same direction. As such, the number of
+ * elements does not need to be a power of two: comparisons with
+ * elements beyond `n` are simply skipped, as if they were larger than
+ * any other element.
+ *
+ * @param[in] name Name of the function to generate.
+ * @param[in] as Address space of the elements.
+ * @param[in] fence Memory fence for work-group barriers.
+ * */
+#define CLO_SORT_BITONIC(name, as, fence) \
+	void name(as CLO_SORT_ELEM_TYPE* d, uint n) { \
+		uint lid = get_local_id(0); \
+		uint lws = get_local_size(0); \
+		uint np2 = 1; \
+		while (np2 < n) np2 <<= 1; \
+		for (uint size = 2; size <= np2; size <<= 1) { \
+			for (uint stride = size / 2; stride > 0; stride >>= 1) { \
+				for (uint p = lid; p < np2 / 2; p += lws) { \
+					uint off = p % stride; \
+					uint i = (p / stride) * 2 * stride + off; \
+					uint j = (stride == size / 2) \
+						? i + size - 1 - 2 * off \
+						: i + stride; \
+					if (j < n) { \
+						CLO_SORT_ELEM_TYPE a = d[i]; \
+						CLO_SORT_ELEM_TYPE b = d[j]; \
+						if (CLO_SORT_COMPARE( \
+							CLO_SORT_KEY_GET(a), CLO_SORT_KEY_GET(b))) { \
+							d[i] = b; \
+							d[j] = a; \
+						} \
+					} \
+				} \
+				barrier(fence); \
+			} \
+		} \
+	}
+
+CLO_SORT_BITONIC(clo_sort_bitonic_local, __local, CLK_LOCAL_MEM_FENCE)
+CLO_SORT_BITONIC(clo_sort_bitonic_global, __global, CLK_GLOBAL_MEM_FENCE)
+
+/**
+ * Determine the bucket of the given element, i.e. the number of
+ * splitters which come before the element in the sort order. Bucket `b`
+ * contains the elements which come after splitter `b - 1` and not after
+ * splitter `b`. If splitter `b` is repeated, elements equal to it are
+ * instead placed in bucket `b + 1`, an _equality bucket_ which is
+ * otherwise empty, such that repeated keys are kept apart from the
+ * remaining elements (see clo_sort_bucket_is_equal()).
+ *
+ * @param[in] x Element.
+ * @param[in] splitters Sorted splitters.
+ * @param[in] num_splitters Number of splitters.
+ * @return Bucket of the given element.
+ * */
+uint clo_sort_bucket(CLO_SORT_ELEM_TYPE x,
+	__global const CLO_SORT_ELEM_TYPE* splitters, uint num_splitters) {
+
+	uint lo = 0, hi = num_splitters;
+	CLO_SORT_KEY_TYPE key = CLO_SORT_KEY_GET(x);
+
+	while (lo < hi) {
+		uint mid = (lo + hi) / 2;
+		if (CLO_SORT_COMPARE(key, CLO_SORT_KEY_GET(splitters[mid])))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	/* Element equal to a repeated splitter? */
+	if ((lo + 1 < num_splitters)
+		&& !CLO_SORT_COMPARE(CLO_SORT_KEY_GET(splitters[lo]), key)
+		&& !CLO_SORT_COMPARE(CLO_SORT_KEY_GET(splitters[lo + 1]),
+			CLO_SORT_KEY_GET(splitters[lo])))
+		lo++;
+
+	return lo;
+}
+
+/**
+ * Check if the given bucket is an equality bucket, i.e. if it is
+ * delimited by equal splitters, in which case all its elements are
+ * equal to the splitters (see clo_sort_bucket()). Equality buckets are
+ * sorted by definition.
+ *
+ * @param[in] splitters Sorted splitters.
+ * @param[in] num_splitters Number of splitters.
+ * @param[in] b Bucket.
+ * @return True if `b` is an equality bucket, false otherwise.
+ * */
+bool clo_sort_bucket_is_equal(
+	__global const CLO_SORT_ELEM_TYPE* splitters, uint num_splitters,
+	uint b) {
+
+	return (b > 0) && (b < num_splitters)
+		&& !CLO_SORT_COMPARE(CLO_SORT_KEY_GET(splitters[b]),
+			CLO_SORT_KEY_GET(splitters[b - 1]));
+}
+
+/**
+ * Sort a sample of elements. Must be launched with a single
+ * work-group.
+ *
+ * @param[in,out] sample Sample to sort.
+ * @param[in] num_samples Number of elements in sample.
+ * */
+__kernel void clo_sort_sample(
+	__global CLO_SORT_ELEM_TYPE* sample,
+	const uint num_samples)
+{
+	clo_sort_bitonic_global(sample, num_samples);
+}
+
+/**
+ * Count the elements in each bucket delimited by the given sorted
+ * splitters. Each work-item counts the elements in a contiguous block
+ * of `per_wi` elements, such that `clo_sort_partition_scatter` can
+ * perform a stable partition.
+ *
+ * @param[in] data Elements to partition.
+ * @param[in] splitters Sorted splitters.
+ * @param[in] num_splitters Number of splitters.
+ * @param[in] numel Number of elements to partition.
+ * @param[in] per_wi Number of elements per work-item.
+ * @param[out] counts Number of elements of each work-item in each
+ * bucket, in bucket-major order, i.e. `(num_splitters + 1) * gws`
+ * elements.
+ */
+__kernel void clo_sort_partition_count(
+	__global const CLO_SORT_ELEM_TYPE *data,
+	__global const CLO_SORT_ELEM_TYPE *splitters,
+	const uint num_splitters,
+	const uint numel,
+	const uint per_wi,
+	__global uint *counts)
+{
+
+	/* Grid position for this work-item and global worksize. */
+	uint gid = get_global_id(0);
+	uint gws = get_global_size(0);
+
+	/* Block of elements of this work-item. */
+	uint first = min(gid * per_wi, numel);
+	uint last = min(first + per_wi, numel);
+
+	for (uint b = 0; b <= num_splitters; ++b)
+		counts[b * gws + gid] = 0;
+
+	for (uint i = first; i < last; ++i)
+		counts[clo_sort_bucket(data[i], splitters, num_splitters) * gws
+			+ gid]++;
+}
+
+/**
+ * Stable partition of elements into the buckets delimited by the given
+ * sorted splitters.
+ *
+ * @param[in] data Elements to partition.
+ * @param[in] splitters Sorted splitters.
+ * @param[in] num_splitters Number of splitters.
+ * @param[in] numel Number of elements to partition.
+ * @param[in] per_wi Number of elements per work-item, as in
+ * `clo_sort_partition_count`.
+ * @param[in,out] offsets Exclusive scan of the counts determined by
+ * `clo_sort_partition_count`, modified by the kernel.
+ * @param[out] out Partitioned elements.
+ */
+__kernel void clo_sort_partition_scatter(
+	__global const CLO_SORT_ELEM_TYPE *data,
+	__global const CLO_SORT_ELEM_TYPE *splitters,
+	const uint num_splitters,
+	const uint numel,
+	const uint per_wi,
+	__global uint *offsets,
+	__global CLO_SORT_ELEM_TYPE *out)
+{
+
+	/* Grid position for this work-item and global worksize. */
+	uint gid = get_global_id(0);
+	uint gws = get_global_size(0);
+
+	/* Block of elements of this work-item. */
+	uint first = min(gid * per_wi, numel);
+	uint last = min(first + per_wi, numel);
+
+	for (uint i = first; i < last; ++i) {
+		CLO_SORT_ELEM_TYPE x = data[i];
+		uint b = clo_sort_bucket(x, splitters, num_splitters);
+		out[offsets[b * gws + gid]++] = x;
+	}
+}
+
+/**
+ * Pick splitters from an evenly spaced sample of the candidates. Must
+ * be launched with a single work-group.
+ *
+ * @param[in] cand Candidate elements.
+ * @param[in] ncand Number of candidate elements.
+ * @param[out] sample Sample buffer.
+ * @param[in] num_samples Number of elements to sample.
+ * @param[in] oversample Number of samples per bucket.
+ * @param[out] splitters Splitters, `num_samples / oversample - 1`
+ * elements.
+ * */
+__kernel void clo_sort_select_splitters(
+	__global const CLO_SORT_ELEM_TYPE* cand,
+	const uint ncand,
+	__global CLO_SORT_ELEM_TYPE* sample,
+	const uint num_samples,
+	const uint oversample,
+	__global CLO_SORT_ELEM_TYPE* splitters)
+{
+
+	uint lid = get_local_id(0);
+	uint lws = get_local_size(0);
+
+	/* Take sample. */
+	for (uint i = lid; i < num_samples; i += lws)
+		sample[i] = cand[(uint) (((ulong) i * ncand) / num_samples)];
+	barrier(CLK_GLOBAL_MEM_FENCE);
+
+	/* Sort sample. */
+	clo_sort_bitonic_global(sample, num_samples);
+
+	/* Pick splitters. */
+	for (uint i = lid; i < num_samples / oversample - 1; i += lws)
+		splitters[i] = sample[(i + 1) * oversample];
+}
+
+/**
+ * Count the number of candidates in each bucket, and flag equality
+ * buckets.
+ *
+ * @param[in] cand Candidate elements.
+ * @param[in] ncand Number of candidate elements.
+ * @param[in] splitters Sorted splitters.
+ * @param[in] num_buckets Number of buckets.
+ * @param[in,out] counts Global bucket counts, which must be zeroed
+ * before the kernel is launched, followed by the equality bucket flags,
+ * `2 * num_buckets` elements.
+ * @param[in] hist Local histogram, `num_buckets` elements.
+ * */
+__kernel void clo_sort_select_histogram(
+	__global const CLO_SORT_ELEM_TYPE* cand,
+	const uint ncand,
+	__global const CLO_SORT_ELEM_TYPE* splitters,
+	const uint num_buckets,
+	__global uint* counts,
+	__local uint* hist)
+{
+
+	uint lid = get_local_id(0);
+	uint lws = get_local_size(0);
+
+	for (uint b = lid; b < num_buckets; b += lws)
+		hist[b] = 0;
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for (uint i = get_global_id(0); i < ncand; i += get_global_size(0))
+		atomic_inc(&hist[
+			clo_sort_bucket(cand[i], splitters, num_buckets - 1)]);
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for (uint b = lid; b < num_buckets; b += lws)
+		if (hist[b] > 0) atomic_add(&counts[b], hist[b]);
+
+	if (get_group_id(0) == 0)
+		for (uint b = lid; b < num_buckets; b += lws)
+			counts[num_buckets + b] =
+				clo_sort_bucket_is_equal(splitters, num_buckets - 1, b);
+}
+
+/**
+ * Narrow the candidates to those in the target bucket. Optionally,
+ * candidates in lower buckets, which are certainly part of the top-k,
+ * are appended to the output.
+ *
+ * @param[in] cand Candidate elements.
+ * @param[in] ncand Number of candidate elements.
+ * @param[in] splitters Sorted splitters.
+ * @param[in] num_buckets Number of buckets.
+ * @param[in] target Target bucket.
+ * @param[out] next Candidates for the next iteration.
+ * @param[out] out Output (top-k) elements.
+ * @param[in] out_base Number of elements already in the output.
+ * @param[in] collect Append elements in lower buckets to the output?
+ * @param[in,out] pos Output and next candidate positions, must be
+ * zeroed before the kernel is launched.
+ * */
+__kernel void clo_sort_select_compact(
+	__global const CLO_SORT_ELEM_TYPE* cand,
+	const uint ncand,
+	__global const CLO_SORT_ELEM_TYPE* splitters,
+	const uint num_buckets,
+	const uint target,
+	__global CLO_SORT_ELEM_TYPE* next,
+	__global CLO_SORT_ELEM_TYPE* out,
+	const uint out_base,
+	const uint collect,
+	__global uint* pos)
+{
+
+	for (uint i = get_global_id(0); i < ncand; i += get_global_size(0)) {
+		CLO_SORT_ELEM_TYPE x = cand[i];
+		uint b = clo_sort_bucket(x, splitters, num_buckets - 1);
+		if (b == target)
+			next[atomic_inc(&pos[1])] = x;
+		else if ((b < target) && collect)
+			out[out_base + atomic_inc(&pos[0])] = x;
+	}
+}
+
+/**
+ * Sort the remaining candidates in a single work-group, in local
+ * memory if they fit, or in global memory otherwise (in which case
+ * the candidates are sorted in place), and get the element with the
+ * given rank.
+ *
+ * @param[in,out] cand Candidate elements.
+ * @param[in] ncand Number of candidate elements.
+ * @param[in] rank Rank of the element to select among the candidates.
+ * @param[in] local_max Maximum number of elements to sort in local
+ * memory.
+ * @param[in] data_local Local memory, `local_max` elements.
+ * @param[out] out Output (top-k) elements.
+ * @param[in] out_base Number of elements already in the output.
+ * @param[in] num_out Number of sorted candidates to append to the
+ * output.
+ * @param[out] kth Selected element.
+ * */
+__kernel void clo_sort_select_final(
+	__global CLO_SORT_ELEM_TYPE* cand,
+	const uint ncand,
+	const uint rank,
+	const uint local_max,
+	__local CLO_SORT_ELEM_TYPE* data_local,
+	__global CLO_SORT_ELEM_TYPE* out,
+	const uint out_base,
+	const uint num_out,
+	__global CLO_SORT_ELEM_TYPE* kth)
+{
+
+	uint lid = get_local_id(0);
+	uint lws = get_local_size(0);
+
+	if (ncand <= local_max) {
+
+		for (uint i = lid; i < ncand; i += lws)
+			data_local[i] = cand[i];
+		barrier(CLK_LOCAL_MEM_FENCE);
+
+		clo_sort_bitonic_local(data_local, ncand);
+
+		for (uint i = lid; i < num_out; i += lws)
+			out[out_base + i] = data_local[i];
+		if (lid == 0) kth[0] = data_local[rank];
+
+	} else {
+
+		clo_sort_bitonic_global(cand, ncand);
+
+		for (uint i = lid; i < num_out; i += lws)
+			out[out_base + i] = cand[i];
+		if (lid == 0) kth[0] = cand[rank];
+
+	}
+}
+
+/**
+ * Sort the given elements in place in a single work-group, in local
+ * memory if they fit, or in global memory otherwise. Any number of
+ * elements can be sorted, and no element beyond `numel` is accessed.
+ *
+ * @param[in,out] data Elements to sort.
+ * @param[in] numel Number of elements to sort.
+ * @param[in] local_max Maximum number of elements to sort in local
+ * memory.
+ * @param[in] data_local Local memory, `local_max` elements.
+ * */
+__kernel void clo_sort_select_sort(
+	__global CLO_SORT_ELEM_TYPE* data,
+	const uint numel,
+	const uint local_max,
+	__local CLO_SORT_ELEM_TYPE* data_local)
+{
+
+	uint lid = get_local_id(0);
+	uint lws = get_local_size(0);
+
+	if (numel <= local_max) {
+
+		for (uint i = lid; i < numel; i += lws)
+			data_local[i] = data[i];
+		barrier(CLK_LOCAL_MEM_FENCE);
+
+		clo_sort_bitonic_local(data_local, numel);
+
+		for (uint i = lid; i < numel; i += lws)
+			data[i] = data_local[i];
+
+	} else {
+
+		clo_sort_bitonic_global(data, numel);
+
+	}
+}
+
+/* Does element `x` come before key `a` in the sort order? */
+#define CLO_SORT_SEARCH_BEFORE(x, a) \
+	(CLO_SORT_COMPARE((a), CLO_SORT_KEY_GET(x)))
+
+/* Does element `x` come before or with key `a` in the sort order,
+ * i.e. not after it? */
+#define CLO_SORT_SEARCH_NOT_AFTER(x, a) \
+	(!(CLO_SORT_COMPARE(CLO_SORT_KEY_GET(x), (a))))
+
+/**
+ * Find, for each query key, the lower bound (position of the first
+ * element which does not come before the key in the sort order) and
+ * the upper bound (position of the first element which comes after
+ * the key) in sorted data. Each work-group first loads an evenly
+ * spaced sample of the data, with one element per work-item, into local
+ * memory, so that the top levels of each binary search do not touch
+ * global memory.
+ *
+ * @param[in] data Sorted data.
+ * @param[in] numel Number of elements in sorted data.
+ * @param[in] queries Query keys.
+ * @param[in] num_queries Number of query keys.
+ * @param[out] lower Lower bound of each query key.
+ * @param[out] upper Upper bound of each query key.
+ * @param[in] sample Local memory, one key per work-item.
+ */
+__kernel void clo_sort_search(
+	__global const CLO_SORT_ELEM_TYPE *data,
+	const uint numel,
+	__global const CLO_SORT_KEY_TYPE *queries,
+	const uint num_queries,
+	__global uint *lower,
+	__global uint *upper,
+	__local CLO_SORT_KEY_TYPE *sample)
+{
+
+	uint gid = get_global_id(0);
+	uint lid = get_local_id(0);
+	uint lws = get_local_size(0);
+
+	/* Sample stride and number of samples. */
+	uint stride = (numel + lws - 1) / lws;
+	uint nsample = stride ? (numel + stride - 1) / stride : 0;
+
+	CLO_SORT_KEY_TYPE key;
+	uint lo, hi, mid;
+
+	/* Load sample of sorted data: sample[j] = key of data[j * stride]. */
+	if (lid < nsample)
+		sample[lid] = CLO_SORT_KEY_GET(data[lid * stride]);
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	if (gid >= num_queries) return;
+	key = queries[gid];
+
+	/* Lower bound: first narrow to a range between two samples, then
+	 * search the range in global memory. */
+	lo = 0;
+	hi = nsample;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (CLO_SORT_COMPARE(key, sample[mid])) lo = mid + 1;
+		else hi = mid;
+	}
+	hi = min(lo * stride, numel);
+	lo = lo ? (lo - 1) * stride + 1 : 0;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (CLO_SORT_SEARCH_BEFORE(data[mid], key)) lo = mid + 1;
+		else hi = mid;
+	}
+	lower[gid] = lo;
+
+	/* Upper bound, likewise. */
+	lo = 0;
+	hi = nsample;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (!CLO_SORT_COMPARE(sample[mid], key)) lo = mid + 1;
+		else hi = mid;
+	}
+	hi = min(lo * stride, numel);
+	lo = lo ? (lo - 1) * stride + 1 : 0;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (CLO_SORT_SEARCH_NOT_AFTER(data[mid], key)) lo = mid + 1;
+		else hi = mid;
+	}
+	upper[gid] = lo;
+
+}
+
+/**
+ * Generates a merge path search function, which co-iterates over the
+ * sorted data and the sorted query keys, starting at the given diagonal
+ * of the merge matrix and consuming up to `count` elements or keys.
+ * The bound of each key is the number of data elements taken before
+ * it, with data elements taken first when `pred(x, key)` holds.
+ *
+ * @param[in] name Name of the function to generate.
+ * @param[in] pred Merge predicate.
+ * */
+#define CLO_SORT_MERGE_PATH(name, pred) \
+	void name(__global const CLO_SORT_ELEM_TYPE *data, uint numel, \
+		__global const CLO_SORT_KEY_TYPE *queries, uint num_queries, \
+		__global uint *bound, uint diag, uint count) { \
+		uint lo = diag > num_queries ? diag - num_queries : 0; \
+		uint hi = min(diag, numel); \
+		uint i, j, mid; \
+		while (lo < hi) { \
+			mid = (lo + hi) / 2; \
+			if (pred(data[mid], queries[diag - 1 - mid])) lo = mid + 1; \
+			else hi = mid; \
+		} \
+		i = lo; \
+		j = diag - lo; \
+		for (uint s = 0; (s < count) && (j < num_queries); ++s) { \
+			if ((i < numel) && pred(data[i], queries[j])) { \
+				++i; \
+			} else { \
+				bound[j] = i; \
+				++j; \
+			} \
+		} \
+	}
+
+CLO_SORT_MERGE_PATH(clo_sort_merge_path_lower, CLO_SORT_SEARCH_BEFORE)
+CLO_SORT_MERGE_PATH(clo_sort_merge_path_upper, CLO_SORT_SEARCH_NOT_AFTER)
+
+/**
+ * Find the lower and upper bounds of sorted query keys in sorted data,
+ * by merging both with the merge path method. Each work-item processes
+ * `count` consecutive steps of the merge, so that the total work is
+ * proportional to the number of elements plus the number of queries,
+ * and global memory is accessed in consecutive positions.
+ *
+ * @param[in] data Sorted data.
+ * @param[in] numel Number of elements in sorted data.
+ * @param[in] queries Sorted query keys.
+ * @param[in] num_queries Number of query keys.
+ * @param[out] lower Lower bound of each query key.
+ * @param[out] upper Upper bound of each query key.
+ * @param[in] count Number of merge steps per work-item.
+ */
+__kernel void clo_sort_search_merge(
+	__global const CLO_SORT_ELEM_TYPE *data,
+	const uint numel,
+	__global const CLO_SORT_KEY_TYPE *queries,
+	const uint num_queries,
+	__global uint *lower,
+	__global uint *upper,
+	const uint count)
+{
+
+	uint diag = get_global_id(0) * count;
+
+	if (diag >= numel + num_queries) return;
+
+	clo_sort_merge_path_lower(
+		data, numel, queries, num_queries, lower, diag, count);
+	clo_sort_merge_path_upper(
+		data, numel, queries, num_queries, upper, diag, count);
+
+}
@@ -24,6 +24,13 @@
 #include "cl_ops/clo_sort_gselect.h"
 #include "common/_g_err_macros.h"
 
+typedef struct {
+
+	/** Use tiled local memory kernel? */
+	cl_bool tiled;
+
+} clo_sort_gselect_data;
+
 /**
  * @internal
  * Perform sort using device data.
@@ -40,7 +47,7 @@ static CCLEvent* clo_sort_gselect_sort_with_device_data(
 	g_return_val_if_fail(cq_exec != NULL, NULL);
 
 	/* Worksizes. */
-	size_t lws, gws;
+	size_t lws, gws, rws;
 
 	/* OpenCL object wrappers. */
 	CCLContext* ctx = NULL;
@@ -51,6 +58,9 @@ static CCLEvent* clo_sort_gselect_sort_with_device_data(
 	/* Event wait list. */
 	CCLEventWaitList ewl = NULL;
 
+	/* Command batch being recorded, if any. */
+	CloBatch* batch = clo_sort_get_batch(sorter);
+
 	/* Internal error reporting object. */
 	GError* err_internal = NULL;
 
@@ -58,6 +68,10 @@ static CCLEvent* clo_sort_gselect_sort_with_device_data(
 	 * buffer, simulating an in-place sort. */
 	cl_bool copy_back = CL_FALSE;
 
+	/* Get gselect sort parameters. */
+	clo_sort_gselect_data* data =
+		(clo_sort_gselect_data*) clo_sort_get_data(sorter);
+
 	/* If data transfer queue is NULL, use exec queue for data
 	 * transfers. */
 	if (cq_comm == NULL) cq_comm = cq_exec;
@@ -68,14 +82,17 @@ static CCLEvent* clo_sort_gselect_sort_with_device_data(
 
 	/* Get the kernel wrapper. */
 	krnl = ccl_program_get_kernel(clo_sort_get_program(sorter),
-		"gselect", &err_internal);
+		data->tiled ? CLO_SORT_GSELECT_KNAME_TILED : CLO_SORT_GSELECT_KNAME,
+		&err_internal);
 	g_if_err_propagate_goto(err, err_internal, error_handler);
 
-	/* Determine worksizes. */
+	/* Determine worksizes. The tiled kernel handles a global worksize
+	 * larger than the number of elements. */
 	gws = numel;
+	rws = numel;
 	lws = lws_max;
-	ccl_kernel_suggest_worksizes(
-		krnl, dev, 1, &gws, NULL, &lws, &err_internal);
+	ccl_kernel_suggest_worksizes(krnl, dev, 1, &rws,
+		data->tiled ? &gws : NULL, &lws, &err_internal);
 	g_if_err_propagate_goto(err, err_internal, error_handler);
 
 	/* Check if data_out is set. */
@@ -103,24 +120,26 @@ static CCLEvent* clo_sort_gselect_sort_with_device_data(
 
 	/* Set kernel arguments. */
 	cl_ulong numel_l = numel;
-	ccl_kernel_set_args(
-		krnl, data_in, data_out, ccl_arg_priv(numel_l, cl_ulong), NULL);
-
-	/* Perform global memory selection sort. */
-	evt = ccl_kernel_enqueue_ndrange(
-		krnl, cq_exec, 1, NULL, &gws, &lws, NULL, &err_internal);
+	clo_batch_set_buffer(batch, krnl, 0, data_in);
+	clo_batch_set_buffer(batch, krnl, 1, data_out);
+	clo_batch_set_arg_priv(batch, krnl, 2, numel_l, cl_ulong);
+	if (data->tiled)
+		clo_batch_set_arg(batch, krnl, 3,
+			lws * clo_sort_get_element_size(sorter), NULL);
+
+	/* Perform selection sort. */
+	evt = clo_batch_enqueue_ndrange(batch, krnl, cq_exec, 1, &gws, &lws,
+		NULL, "gselect_ndrange", &err_internal);
 	g_if_err_propagate_goto(err, err_internal, error_handler);
-	ccl_event_set_name(evt, "gselect_ndrange");
 
 	/* If copy-back flag is set, copy sorted data back to original
 	 * buffer. */
 	if (copy_back) {
 		ccl_event_wait_list_add(&ewl, evt, NULL);
-		evt = ccl_buffer_enqueue_copy(data_out, data_in, cq_comm, 0, 0,
-			numel * clo_sort_get_element_size(sorter), &ewl,
-			&err_internal);
+		evt = clo_batch_enqueue_copy(batch, data_out, data_in, cq_comm,
+			0, 0, numel * clo_sort_get_element_size(sorter), &ewl,
+			"gselect_copy", &err_internal);
 		g_if_err_propagate_goto(err, err_internal, error_handler);
-		ccl_event_set_name(evt, "gselect_copy");
 	}
 
 	/* If we got here, everything is OK. */
@@ -144,8 +163,8 @@ finish:
 
 /**
  * @internal
- * Initializes a simple bitonic sorter object and returns the
- * respective source code.
+ * Initializes a gselect sorter object and returns the respective
+ * source code.
  * */
 static const char* clo_sort_gselect_init(
 	CloSort* sorter, const char* options, GError** err) {
@@ -153,23 +172,90 @@ static const char* clo_sort_gselect_init(
 	/* Make sure err is NULL or it is not set. */
 	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
-	/* Ignore specific gselect sort options and error handling. */
-	(void)options;
-	(void)err;
-	(void)sorter;
+	/* Source to be compiled. */
+	const char* gselect_src = NULL;
+
+	/* Tokenized options. */
+	gchar** opts = NULL;
+	gchar** opt = NULL;
+
+	/* Number of tokens. */
+	int num_toks;
+
+	/* Internal data. */
+	clo_sort_gselect_data* data = g_slice_new0(clo_sort_gselect_data);
+
+	/* Set internal data default values. */
+	data->tiled = CL_TRUE;
+
+	/* Check options. */
+	if (options) {
+		opts = g_strsplit_set(options, ",", -1);
+		for (guint i = 0; opts[i] != NULL; i++) {
+
+			/* Ignore empty tokens. */
+			if (opts[i][0] == '\0') continue;
+
+			/* Parse current option, get key and value. */
+			opt = g_strsplit_set(opts[i], "=", 2);
+
+			/* Count number of tokens. */
+			for (num_toks = 0; opt[num_toks] != NULL; num_toks++);
+
+			/* If number of tokens is not 2 (key and value), throw error. */
+			g_if_err_create_goto(*err, CLO_ERROR, num_toks != 2,
+				CLO_ERROR_ARGS, error_handler,
+				"Invalid option '%s' for gselect sort.", opts[i]);
+
+			/* Check key/value option. */
+			if (g_strcmp0("tiled", opt[0]) == 0) {
+				/* Use tiled local memory kernel? */
+				data->tiled = atoi(opt[1]) ? CL_TRUE : CL_FALSE;
+			} else {
+				g_if_err_create_goto(*err, CLO_ERROR, TRUE,
+					CLO_ERROR_ARGS, error_handler,
+					"Invalid option key '%s' for gselect sort.",
+					opt[0]);
+			}
+
+			/* Free token. */
+			g_strfreev(opt);
+			opt = NULL;
+
+		}
+	}
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	gselect_src = CLO_SORT_GSELECT_SRC;
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+
+finish:
+
+	/* Free parsed gselect options. */
+	g_strfreev(opts);
+	g_strfreev(opt);
+
+	/* Set internal data. */
+	clo_sort_set_data(sorter, data);
 
 	/* Return source to be compiled. */
-	return CLO_SORT_GSELECT_SRC;
+	return gselect_src;
 
 }
 
 /**
  * @internal
- * Finalizes a bitonic sorter object.
+ * Finalizes a gselect sorter object.
  * */
 static void clo_sort_gselect_finalize(CloSort* sorter) {
-	/* Nothing to finalize. */
-	(void)sorter;
+
+	/* Release internal data. */
+	g_slice_free(clo_sort_gselect_data, clo_sort_get_data(sorter));
 	return;
 }
 
@@ -200,11 +286,11 @@ static const char* clo_sort_gselect_get_kernel_name(
 	g_return_val_if_fail(i == 0, NULL);
 
 	/* Avoid compiler warnings. */
-	(void)sorter;
 	(void)err;
 
 	/* Return kernel name. */
-	return CLO_SORT_GSELECT_KNAME;
+	return ((clo_sort_gselect_data*) clo_sort_get_data(sorter))->tiled
+		? CLO_SORT_GSELECT_KNAME_TILED : CLO_SORT_GSELECT_KNAME;
 }
 
 /**
@@ -219,14 +305,13 @@ static size_t clo_sort_gselect_get_localmem_usage(CloSort* sorter,
 	g_return_val_if_fail(i == 0, 0);
 
 	/* Avoid compiler warnings. */
-	(void)sorter;
-	(void)lws_max;
 	(void)numel;
 	(void)err;
 
-	/* Return local memory usage, which is zero for global selection
-	 * sort. */
-	return 0;
+	/* Return local memory usage, which is one element per work-item
+	 * for the tiled kernel and zero for global selection sort. */
+	return ((clo_sort_gselect_data*) clo_sort_get_data(sorter))->tiled
+		? lws_max * clo_sort_get_element_size(sorter) : 0;
 
 }
 
@@ -234,6 +319,8 @@ static size_t clo_sort_gselect_get_localmem_usage(CloSort* sorter,
 const CloSortImplDef clo_sort_gselect_def = {
 	"gselect",
 	CL_FALSE,
+	CL_TRUE,
+	CL_TRUE,
 	clo_sort_gselect_init,
 	clo_sort_gselect_finalize,
 	clo_sort_gselect_sort_with_device_data,
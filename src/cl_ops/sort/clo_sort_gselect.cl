@@ -18,7 +18,8 @@
 
 /**
  * @file
- * Global memory selection sort implementation.
+ * Selection (rank) sort implementations, using global memory only or
+ * local memory tiles.
  *
  * Requires definition of:
  *
@@ -28,6 +29,26 @@
  * * CLO_SORT_KEY_TYPE - Type of key
  */
 
+/**
+ * Determine if an element comes after another in the sort order, using
+ * the positions of the elements to break ties, so that the rank of
+ * each element is unique and the sort is stable. Ties are determined
+ * with the comparison macro, since keys which don't come after one
+ * another need not be equal, nor comparable with `==`.
+ *
+ * @param[in] key1 Key of first element.
+ * @param[in] idx1 Position of first element.
+ * @param[in] key2 Key of second element.
+ * @param[in] idx2 Position of second element.
+ * @return True if the first element comes after the second one.
+ */
+bool gselect_after(CLO_SORT_KEY_TYPE key1, size_t idx1,
+	CLO_SORT_KEY_TYPE key2, size_t idx2) {
+
+	return CLO_SORT_COMPARE(key1, key2)
+		|| ((!CLO_SORT_COMPARE(key2, key1)) && (idx1 > idx2));
+}
+
 /**
  * A global memory selection sort kernel.
  *
@@ -42,13 +63,15 @@ __kernel void gselect(__global CLO_SORT_ELEM_TYPE *data_in,
 	size_t gid = get_global_id(0);
 
 	size_t pos = 0;
-	CLO_SORT_ELEM_TYPE data_gid = data_in[gid];
-	CLO_SORT_KEY_TYPE key_gid = CLO_SORT_KEY_GET(data_gid);
+	CLO_SORT_ELEM_TYPE data_gid;
+	CLO_SORT_KEY_TYPE key_gid;
 
 	if (gid < size) {
-		for (uint i = 0; i < size; i++) {
+		data_gid = data_in[gid];
+		key_gid = CLO_SORT_KEY_GET(data_gid);
+		for (size_t i = 0; i < size; i++) {
 			CLO_SORT_KEY_TYPE key_i = CLO_SORT_KEY_GET(data_in[i]);
-			if (CLO_SORT_COMPARE(key_gid, key_i) || ((key_i == key_gid) && (i < gid))) {
+			if (gselect_after(key_gid, gid, key_i, i)) {
 				pos++;
 			}
 		}
@@ -56,5 +79,58 @@ __kernel void gselect(__global CLO_SORT_ELEM_TYPE *data_in,
 	}
 }
 
+/**
+ * A tiled selection sort kernel. Each work-group cooperatively loads
+ * tiles of the input into local memory, and each work-item determines
+ * the rank of its element by comparing it with all the elements in
+ * each tile. Global memory reads are thus reduced by a factor of the
+ * local worksize when compared with the gselect kernel.
+ *
+ * @param[in] data_in Array of unsorted elements.
+ * @param[out] data_out Array of sorted elements.
+ * @param[in] size Number of elements to sort.
+ * @param[in] tile Local memory tile, one element per work-item.
+ */
+__kernel void gselect_tiled(__global CLO_SORT_ELEM_TYPE *data_in,
+	__global CLO_SORT_ELEM_TYPE *data_out, ulong size,
+	__local CLO_SORT_ELEM_TYPE *tile) {
+
+	/* Global and local ids for this work-item. */
+	size_t gid = get_global_id(0);
+	uint lid = get_local_id(0);
+	uint lws = get_local_size(0);
+
+	size_t pos = 0;
+	CLO_SORT_ELEM_TYPE data_gid;
+	CLO_SORT_KEY_TYPE key_gid;
+
+	/* Work-items beyond the number of elements still help loading
+	 * tiles. */
+	if (gid < size) {
+		data_gid = data_in[gid];
+		key_gid = CLO_SORT_KEY_GET(data_gid);
+	}
+
+	for (size_t t = 0; t < size; t += lws) {
 
+		/* Number of elements in current tile. */
+		uint tsize = (uint) min((size_t) lws, (size_t) (size - t));
 
+		/* Load tile. */
+		if (lid < tsize) tile[lid] = data_in[t + lid];
+		barrier(CLK_LOCAL_MEM_FENCE);
+
+		/* Rank element against tile. */
+		if (gid < size) {
+			for (uint j = 0; j < tsize; j++) {
+				CLO_SORT_KEY_TYPE key_j = CLO_SORT_KEY_GET(tile[j]);
+				if (gselect_after(key_gid, gid, key_j, t + j)) {
+					pos++;
+				}
+			}
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+
+	if (gid < size) data_out[pos] = data_gid;
+}
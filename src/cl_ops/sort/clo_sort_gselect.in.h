@@ -29,9 +29,12 @@
 /** The global selection sort kernels source. */
 #define CLO_SORT_GSELECT_SRC "@GSELECT_SRC@"
 
-/** The name of the simple bitonic sort kernel. */
+/** The name of the global memory selection sort kernel. */
 #define CLO_SORT_GSELECT_KNAME "gselect"
 
+/** The name of the tiled local memory selection sort kernel. */
+#define CLO_SORT_GSELECT_KNAME_TILED "gselect_tiled"
+
 /** Definition of the gselect sort implementation. */
 extern const CloSortImplDef clo_sort_gselect_def;
 
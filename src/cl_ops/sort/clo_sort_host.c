@@ -0,0 +1,601 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Host radix sort implementation.
+ *
+ * Elements are sorted in host memory with a least significant digit
+ * radix sort, so that small inputs don't pay for kernel dispatch and
+ * results can be checked against a trusted reference. Device buffers
+ * are mapped into host memory. Since OpenCL C comparisons and key
+ * getters can't be evaluated on the host, only scalar elements sorted
+ * by their own value in ascending order are supported. The host sort
+ * doesn't require an OpenCL context, so it remains available when no
+ * OpenCL platform is.
+ */
+
+#include "cl_ops/clo_sort_host.h"
+#include "common/_g_err_macros.h"
+#include <string.h>
+#ifdef __AVX2__
+	#include <immintrin.h>
+#endif
+
+/**
+ * @internal
+ * How radix sort keys are mapped to unsigned integers with the same
+ * order.
+ * */
+typedef enum {
+
+	/** Unsigned integers, used as they are. */
+	CLO_SORT_HOST_UNSIGNED,
+
+	/** Signed integers, with the sign bit flipped. */
+	CLO_SORT_HOST_SIGNED,
+
+	/** IEEE floating point, with the sign bit flipped for positive
+	 * numbers and all bits flipped for negative numbers. */
+	CLO_SORT_HOST_FLOAT
+
+} clo_sort_host_kind;
+
+/**
+ * @internal
+ * Generates the functions which map elements of the given unsigned
+ * integer type to radix sort keys of the requested kind, counting the
+ * digits of all keys in the same pass, and which map sorted keys back
+ * to elements.
+ *
+ * @param[in] prepare Name of the function which maps elements to keys
+ * and counts their digits.
+ * @param[in] finish Name of the function which maps keys back to
+ * elements.
+ * @param[in] utype Unsigned integer type with the element size.
+ * */
+#define CLO_SORT_HOST_KEYS(prepare, finish, utype) \
+	static void prepare(utype* data, size_t numel, \
+		clo_sort_host_kind kind, size_t hist[][CLO_SORT_HOST_RADIX]) { \
+		const utype msb = (utype) ((utype) 1 << (sizeof(utype) * 8 - 1)); \
+		size_t i; \
+		unsigned int p; \
+		for (i = 0; i < numel; ++i) { \
+			if (kind == CLO_SORT_HOST_SIGNED) \
+				data[i] ^= msb; \
+			else if (kind == CLO_SORT_HOST_FLOAT) \
+				data[i] ^= (data[i] & msb) ? (utype) ~(utype) 0 : msb; \
+			for (p = 0; p < sizeof(utype); ++p) \
+				hist[p][(data[i] >> (p * CLO_SORT_HOST_DIGIT_BITS)) \
+					& (CLO_SORT_HOST_RADIX - 1)]++; \
+		} \
+	} \
+	static void finish(utype* data, size_t numel, \
+		clo_sort_host_kind kind) { \
+		const utype msb = (utype) ((utype) 1 << (sizeof(utype) * 8 - 1)); \
+		size_t i; \
+		for (i = 0; i < numel; ++i) { \
+			if (kind == CLO_SORT_HOST_SIGNED) \
+				data[i] ^= msb; \
+			else if (kind == CLO_SORT_HOST_FLOAT) \
+				data[i] = (data[i] & msb) \
+					? (utype) (data[i] ^ msb) : (utype) ~data[i]; \
+		} \
+	}
+
+CLO_SORT_HOST_KEYS(clo_sort_host_keys8_prepare,
+	clo_sort_host_keys8_finish, cl_uchar)
+CLO_SORT_HOST_KEYS(clo_sort_host_keys16_prepare,
+	clo_sort_host_keys16_finish, cl_ushort)
+CLO_SORT_HOST_KEYS(clo_sort_host_keys32_prepare,
+	clo_sort_host_keys32_finish, cl_uint)
+CLO_SORT_HOST_KEYS(clo_sort_host_keys64_prepare,
+	clo_sort_host_keys64_finish, cl_ulong)
+
+#ifdef __AVX2__
+
+/**
+ * @internal
+ * Maps 32-bit elements to radix sort keys and counts their digits,
+ * eight elements at a time. Keys and their four digits are obtained
+ * with AVX2 instructions, and only the histogram increments are
+ * scalar. Remaining elements are handled by the scalar version.
+ * */
+static void clo_sort_host_keys32_prepare_avx2(cl_uint* data,
+	size_t numel, clo_sort_host_kind kind,
+	size_t hist[][CLO_SORT_HOST_RADIX]) {
+
+	const __m256i msb = _mm256_set1_epi32((int) 0x80000000u);
+	const __m256i mask = _mm256_set1_epi32(CLO_SORT_HOST_RADIX - 1);
+	cl_uint digits[4][8];
+	__m256i x;
+	size_t i;
+	unsigned int j;
+
+	for (i = 0; i + 8 <= numel; i += 8) {
+		x = _mm256_loadu_si256((const __m256i*) (data + i));
+		if (kind == CLO_SORT_HOST_SIGNED)
+			x = _mm256_xor_si256(x, msb);
+		else if (kind == CLO_SORT_HOST_FLOAT)
+			x = _mm256_xor_si256(x,
+				_mm256_or_si256(_mm256_srai_epi32(x, 31), msb));
+		_mm256_storeu_si256((__m256i*) (data + i), x);
+		_mm256_storeu_si256((__m256i*) digits[0],
+			_mm256_and_si256(x, mask));
+		_mm256_storeu_si256((__m256i*) digits[1], _mm256_and_si256(
+			_mm256_srli_epi32(x, CLO_SORT_HOST_DIGIT_BITS), mask));
+		_mm256_storeu_si256((__m256i*) digits[2], _mm256_and_si256(
+			_mm256_srli_epi32(x, 2 * CLO_SORT_HOST_DIGIT_BITS), mask));
+		_mm256_storeu_si256((__m256i*) digits[3],
+			_mm256_srli_epi32(x, 3 * CLO_SORT_HOST_DIGIT_BITS));
+		for (j = 0; j < 8; ++j) {
+			hist[0][digits[0][j]]++;
+			hist[1][digits[1][j]]++;
+			hist[2][digits[2][j]]++;
+			hist[3][digits[3][j]]++;
+		}
+	}
+	clo_sort_host_keys32_prepare(data + i, numel - i, kind, hist);
+}
+
+/**
+ * @internal
+ * Maps sorted 32-bit radix sort keys back to elements, eight keys at a
+ * time, with AVX2 instructions. Remaining keys are handled by the
+ * scalar version.
+ * */
+static void clo_sort_host_keys32_finish_avx2(cl_uint* data,
+	size_t numel, clo_sort_host_kind kind) {
+
+	const __m256i msb = _mm256_set1_epi32((int) 0x80000000u);
+	const __m256i ones = _mm256_set1_epi32(-1);
+	__m256i x;
+	size_t i;
+
+	if (kind == CLO_SORT_HOST_UNSIGNED) return;
+	for (i = 0; i + 8 <= numel; i += 8) {
+		x = _mm256_loadu_si256((const __m256i*) (data + i));
+		if (kind == CLO_SORT_HOST_SIGNED)
+			x = _mm256_xor_si256(x, msb);
+		else
+			x = _mm256_xor_si256(x, _mm256_or_si256(msb,
+				_mm256_andnot_si256(_mm256_srai_epi32(x, 31), ones)));
+		_mm256_storeu_si256((__m256i*) (data + i), x);
+	}
+	clo_sort_host_keys32_finish(data + i, numel - i, kind);
+}
+
+/** Maps 32-bit elements to keys and counts their digits. */
+#define CLO_SORT_HOST_KEYS32_PREPARE clo_sort_host_keys32_prepare_avx2
+
+/** Maps 32-bit keys back to elements. */
+#define CLO_SORT_HOST_KEYS32_FINISH clo_sort_host_keys32_finish_avx2
+
+#else
+
+/** Maps 32-bit elements to keys and counts their digits. */
+#define CLO_SORT_HOST_KEYS32_PREPARE clo_sort_host_keys32_prepare
+
+/** Maps 32-bit keys back to elements. */
+#define CLO_SORT_HOST_KEYS32_FINISH clo_sort_host_keys32_finish
+
+#endif
+
+/**
+ * @internal
+ * Generates a radix sort function for unsigned integers of the given
+ * type, which are mapped to and from the requested kind of keys. The
+ * histograms of all digits are obtained in a single pass over the
+ * data, together with the mapping to keys, and passes in which all
+ * elements have the same digit are skipped.
+ *
+ * @param[in] name Name of the function to generate.
+ * @param[in] utype Unsigned integer type with the element size.
+ * @param[in] prepare Function which maps elements to keys and counts
+ * their digits (see CLO_SORT_HOST_KEYS()).
+ * @param[in] finish Function which maps keys back to elements.
+ * */
+#define CLO_SORT_HOST_RADIX_SORT(name, utype, prepare, finish) \
+	static void name(utype* data, utype* aux, size_t numel, \
+		clo_sort_host_kind kind) { \
+		size_t hist[sizeof(utype)][CLO_SORT_HOST_RADIX]; \
+		utype* src = data; \
+		utype* dst = aux; \
+		utype* tmp; \
+		size_t i, sum, count; \
+		unsigned int p, d; \
+		memset(hist, 0, sizeof(hist)); \
+		prepare(data, numel, kind, hist); \
+		for (p = 0; p < sizeof(utype); ++p) { \
+			d = (src[0] >> (p * CLO_SORT_HOST_DIGIT_BITS)) \
+				& (CLO_SORT_HOST_RADIX - 1); \
+			if (hist[p][d] == numel) continue; \
+			for (d = 0, sum = 0; d < CLO_SORT_HOST_RADIX; ++d) { \
+				count = hist[p][d]; \
+				hist[p][d] = sum; \
+				sum += count; \
+			} \
+			for (i = 0; i < numel; ++i) { \
+				d = (src[i] >> (p * CLO_SORT_HOST_DIGIT_BITS)) \
+					& (CLO_SORT_HOST_RADIX - 1); \
+				dst[hist[p][d]++] = src[i]; \
+			} \
+			tmp = src; \
+			src = dst; \
+			dst = tmp; \
+		} \
+		if (src != data) memcpy(data, src, numel * sizeof(utype)); \
+		finish(data, numel, kind); \
+	}
+
+CLO_SORT_HOST_RADIX_SORT(clo_sort_host_radix8, cl_uchar,
+	clo_sort_host_keys8_prepare, clo_sort_host_keys8_finish)
+CLO_SORT_HOST_RADIX_SORT(clo_sort_host_radix16, cl_ushort,
+	clo_sort_host_keys16_prepare, clo_sort_host_keys16_finish)
+CLO_SORT_HOST_RADIX_SORT(clo_sort_host_radix32, cl_uint,
+	CLO_SORT_HOST_KEYS32_PREPARE, CLO_SORT_HOST_KEYS32_FINISH)
+CLO_SORT_HOST_RADIX_SORT(clo_sort_host_radix64, cl_ulong,
+	clo_sort_host_keys64_prepare, clo_sort_host_keys64_finish)
+
+/**
+ * Sort elements of a scalar type in host memory, in ascending order,
+ * with a stable least significant digit radix sort. This function
+ * doesn't use OpenCL, and can be used as a reference for checking the
+ * results of other sort implementations.
+ *
+ * @param[in] type Type of elements to sort, must be a scalar type.
+ * @param[in,out] data Elements to sort, sorted in place.
+ * @param[in] numel Number of elements to sort.
+ * @param[out] err Return location for a GError, or `NULL` if error
+ * reporting is to be ignored.
+ * @return `CL_TRUE` if sort was successfully performed, `CL_FALSE`
+ * otherwise.
+ * */
+cl_bool clo_sort_host_radix(CloType type, void* data, size_t numel,
+	GError** err) {
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, CL_FALSE);
+
+	/* Function return status. */
+	cl_bool status;
+
+	/* Auxiliary buffer for radix sort passes. */
+	void* aux = NULL;
+
+	/* Key kind. */
+	clo_sort_host_kind kind;
+
+	/* Determine key kind. */
+	switch (type) {
+		case CLO_UCHAR:
+		case CLO_USHORT:
+		case CLO_UINT:
+		case CLO_ULONG:
+			kind = CLO_SORT_HOST_UNSIGNED;
+			break;
+		case CLO_CHAR:
+		case CLO_SHORT:
+		case CLO_INT:
+		case CLO_LONG:
+			kind = CLO_SORT_HOST_SIGNED;
+			break;
+		case CLO_HALF:
+		case CLO_FLOAT:
+		case CLO_DOUBLE:
+			kind = CLO_SORT_HOST_FLOAT;
+			break;
+		default:
+			g_if_err_create_goto(*err, CLO_ERROR, TRUE,
+				CLO_ERROR_ARGS, error_handler,
+				"The host sort only supports scalar types, not '%s'.",
+				clo_type_get_name(type));
+	}
+
+	/* Nothing to sort. */
+	if (numel < 2) goto success;
+
+	/* Allocate auxiliary buffer. */
+	aux = g_malloc(numel * clo_type_sizeof(type));
+
+	/* Sort with the radix sort for the element size. */
+	switch (clo_type_sizeof(type)) {
+		case 1:
+			clo_sort_host_radix8(data, aux, numel, kind);
+			break;
+		case 2:
+			clo_sort_host_radix16(data, aux, numel, kind);
+			break;
+		case 4:
+			clo_sort_host_radix32(data, aux, numel, kind);
+			break;
+		default:
+			clo_sort_host_radix64(data, aux, numel, kind);
+	}
+
+success:
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	status = CL_TRUE;
+	goto finish;
+
+error_handler:
+
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	status = CL_FALSE;
+
+finish:
+
+	/* Free stuff. */
+	g_free(aux);
+
+	/* Return function status. */
+	return status;
+
+}
+
+/**
+ * @internal
+ * Perform sort using device data, which is mapped into host memory.
+ * */
+static CCLEvent* clo_sort_host_sort_with_device_data(
+	CloSort* sorter, CCLQueue* cq_exec, CCLQueue* cq_comm,
+	CCLBuffer* data_in, CCLBuffer* data_out, size_t numel,
+	size_t lws_max, GError** err) {
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Make sure cq_exec is not NULL. */
+	g_return_val_if_fail(cq_exec != NULL, NULL);
+
+	/* OpenCL object wrappers. */
+	CCLEvent* evt = NULL;
+
+	/* Mapped data. */
+	void* map_in = NULL;
+	void* map_out = NULL;
+
+	/* Internal error reporting object. */
+	GError* err_internal = NULL;
+
+	/* Size of data to sort. */
+	size_t size = numel * clo_sort_get_element_size(sorter);
+
+	/* Avoid compiler warnings. */
+	(void)lws_max;
+
+	/* Sorting on the host can't be recorded in command batches. */
+	g_if_err_create_goto(*err, CLO_ERROR,
+		clo_sort_get_batch(sorter) != NULL, CLO_ERROR_ARGS,
+		error_handler,
+		"The host sort can't be recorded in command batches.");
+
+	/* Data is mapped with the execution queue, so that mapping waits
+	 * for the commands which produced the data. */
+	(void)cq_comm;
+
+	/* There is nothing to map if there is no data. */
+	if (numel == 0) {
+		evt = ccl_enqueue_marker(cq_exec, NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		goto success;
+	}
+
+	/* Sorting into the input buffer is sorting in place. */
+	if (data_out == data_in) data_out = NULL;
+
+	/* Map data into host memory, copying it to the output buffer if
+	 * sort is not in-place. */
+	map_in = ccl_buffer_enqueue_map(data_in, cq_exec, CL_TRUE,
+		data_out == NULL ? CL_MAP_READ | CL_MAP_WRITE : CL_MAP_READ,
+		0, size, NULL, NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	if (data_out != NULL) {
+		map_out = ccl_buffer_enqueue_map(data_out, cq_exec, CL_TRUE,
+			CL_MAP_WRITE, 0, size, NULL, NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		memcpy(map_out, map_in, size);
+	}
+
+	/* Sort. */
+	clo_sort_host_radix(clo_sort_get_element_type(sorter),
+		map_out != NULL ? map_out : map_in, numel, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Unmap data. */
+	evt = ccl_memobj_enqueue_unmap((CCLMemObj*) data_in, cq_exec,
+		map_in, NULL, &err_internal);
+	map_in = NULL;
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	ccl_event_set_name(evt, "host_unmap_in");
+	if (map_out != NULL) {
+		evt = ccl_memobj_enqueue_unmap((CCLMemObj*) data_out, cq_exec,
+			map_out, NULL, &err_internal);
+		map_out = NULL;
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "host_unmap_out");
+	}
+
+success:
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	evt = NULL;
+
+	/* Release mapped data, if any. */
+	if (map_in != NULL)
+		ccl_memobj_enqueue_unmap(
+			(CCLMemObj*) data_in, cq_exec, map_in, NULL, NULL);
+	if (map_out != NULL)
+		ccl_memobj_enqueue_unmap(
+			(CCLMemObj*) data_out, cq_exec, map_out, NULL, NULL);
+
+finish:
+
+	/* Return event. */
+	return evt;
+
+}
+
+/**
+ * @internal
+ * Initializes a host sorter object and returns the respective source
+ * code.
+ * */
+static const char* clo_sort_host_init(
+	CloSort* sorter, const char* options, GError** err) {
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Tokenized options. */
+	gchar** opts = NULL;
+
+	/* Element type. */
+	CloType type = clo_sort_get_element_type(sorter);
+
+	/* Source to be compiled. */
+	const char* host_src = NULL;
+
+	/* The host sort has no options. */
+	if (options) {
+		opts = g_strsplit_set(options, ",", -1);
+		for (guint i = 0; opts[i] != NULL; i++) {
+			g_if_err_create_goto(*err, CLO_ERROR, opts[i][0] != '\0',
+				CLO_ERROR_ARGS, error_handler,
+				"Invalid option '%s' for host sort.", opts[i]);
+		}
+	}
+
+	/* Check that the host is able to determine the sort order. */
+	g_if_err_create_goto(*err, CLO_ERROR,
+		!clo_sort_get_default_order(sorter), CLO_ERROR_ARGS,
+		error_handler,
+		"The host sort only supports the default comparison and key.");
+	g_if_err_create_goto(*err, CLO_ERROR, type > CLO_DOUBLE,
+		CLO_ERROR_ARGS, error_handler,
+		"The host sort only supports scalar types, not '%s'.",
+		clo_type_get_name(type));
+
+	/* The host sort has no specific data. */
+	clo_sort_set_data(sorter, NULL);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	host_src = CLO_SORT_HOST_SRC;
+	goto finish;
+
+error_handler:
+
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+
+finish:
+
+	/* Free parsed options. */
+	g_strfreev(opts);
+
+	/* Return source to be compiled. */
+	return host_src;
+
+}
+
+/**
+ * @internal
+ * Finalizes a host sorter object.
+ * */
+static void clo_sort_host_finalize(CloSort* sorter) {
+
+	/* Avoid compiler warnings, there is nothing to release. */
+	(void)sorter;
+	return;
+}
+
+/**
+ * @internal
+ * Get the maximum number of kernels used by the sort implementation.
+ * */
+static cl_uint clo_sort_host_get_num_kernels(
+	CloSort* sorter, GError** err) {
+
+	/* Avoid compiler warnings. */
+	(void)sorter;
+	(void)err;
+
+	/* The host sort doesn't use kernels. */
+	return 0;
+
+}
+
+/**
+ * @internal
+ * Get name of the i^th kernel used by the sort implementation.
+ * */
+static const char* clo_sort_host_get_kernel_name(
+	CloSort* sorter, cl_uint i, GError** err) {
+
+	/* Avoid compiler warnings. */
+	(void)sorter;
+	(void)i;
+	(void)err;
+
+	/* The host sort doesn't use kernels. */
+	g_return_val_if_reached(NULL);
+}
+
+/**
+ * @internal
+ * Get local memory usage of i^th kernel used by the sort implementation
+ * for the given maximum local worksize and number of elements to sort.
+ * */
+static size_t clo_sort_host_get_localmem_usage(CloSort* sorter,
+	cl_uint i, size_t lws_max, size_t numel, GError** err) {
+
+	/* Avoid compiler warnings. */
+	(void)sorter;
+	(void)i;
+	(void)lws_max;
+	(void)numel;
+	(void)err;
+
+	/* The host sort doesn't use kernels. */
+	g_return_val_if_reached(0);
+}
+
+/* Definition of the host sort implementation. */
+const CloSortImplDef clo_sort_host_def = {
+	CLO_SORT_HOST_NAME,
+	CL_TRUE,
+	CL_TRUE,
+	CL_TRUE,
+	clo_sort_host_init,
+	clo_sort_host_finalize,
+	clo_sort_host_sort_with_device_data,
+	clo_sort_host_get_num_kernels,
+	clo_sort_host_get_kernel_name,
+	clo_sort_host_get_localmem_usage
+};
@@ -0,0 +1,50 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Host radix sort header file.
+ */
+
+#ifndef _CLO_SORT_HOST_H_
+#define _CLO_SORT_HOST_H_
+
+#include "cl_ops/clo_sort_abstract.h"
+
+/** The host sort has no kernels of its own, only the common sort
+ * kernels are built, and only if the sorter has a context. */
+#define CLO_SORT_HOST_SRC "/* Sorting is performed on the host. */\n"
+
+/** Name of the host sort implementation. */
+#define CLO_SORT_HOST_NAME "host"
+
+/** Number of bits in each radix sort digit. */
+#define CLO_SORT_HOST_DIGIT_BITS 8
+
+/** Number of possible values of each radix sort digit. */
+#define CLO_SORT_HOST_RADIX (1 << CLO_SORT_HOST_DIGIT_BITS)
+
+/* Sort elements of a scalar type in host memory, in ascending
+ * order. */
+cl_bool clo_sort_host_radix(CloType type, void* data, size_t numel,
+	GError** err);
+
+/** Definition of the host sort implementation. */
+extern const CloSortImplDef clo_sort_host_def;
+
+#endif
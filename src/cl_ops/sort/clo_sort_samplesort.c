@@ -0,0 +1,897 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Sample sort host implementation.
+ */
+
+#include "cl_ops/clo_sort_samplesort.h"
+#include "cl_ops/clo_scan_abstract.h"
+#include "cl_ops/clo_rng.h"
+#include "common/_g_err_macros.h"
+
+/* The default scan implementation. */
+#define CLO_SORT_SAMPLESORT_SCAN_DEFAULT "blelloch"
+
+/* The default RNG used for sampling. */
+#define CLO_SORT_SAMPLESORT_RNG_DEFAULT "xorshift128"
+
+/* Main seed and hash of the RNG used for sampling. */
+#define CLO_SORT_SAMPLESORT_RNG_SEED 0x5a17e5ULL
+#define CLO_SORT_SAMPLESORT_RNG_HASH "XS1(x)"
+
+/* Maximum recursion depth for buckets which don't fit in local memory.
+ * Beyond it, such buckets are sorted in global memory. */
+#define CLO_SORT_SAMPLESORT_MAX_DEPTH 4
+
+/* Maximum number of work-groups in the histogram and scatter kernels. */
+#define CLO_SORT_SAMPLESORT_MAX_WGS 256
+
+typedef struct {
+
+	/** Maximum number of buckets. */
+	cl_uint max_buckets;
+
+	/** Number of samples per bucket. */
+	cl_uint oversample;
+
+	/** Maximum number of elements in a bucket sorted in local memory. */
+	cl_uint local_max;
+
+	/** Source code. */
+	char* src;
+
+	/** Scanner type. */
+	char* scan_type;
+
+	/** Scanner options. */
+	char* scan_opts;
+
+	/** Scanner object. */
+	CloScan* scanner;
+
+	/** RNG type. */
+	char* rng_type;
+
+	/** RNG object, used for sampling. */
+	CloRng* rng;
+
+	/** Number of RNG seeds, one per sampling work-item. */
+	size_t num_seeds;
+
+} clo_sort_samplesort_data;
+
+/* Array of kernel names. */
+static const char* clo_sort_samplesort_knames[] =
+	CLO_SORT_SAMPLESORT_KERNELNAMES;
+
+/**
+ * @internal
+ * Get scanner object used for bucket offsets.
+ *
+ * @param[in] sorter Sorter object (sample sort).
+ * @return Scanner object used for sample sort.
+ * */
+static CloScan* clo_sort_samplesort_get_scanner(
+	CloSort* sorter, GError** err) {
+
+	/* Variables. */
+	CCLContext* ctx = NULL;
+	CCLProgram* prg = NULL;
+	CCLDevice* dev = NULL;
+	char* compiler_opts = NULL;
+	GError* err_internal = NULL;
+
+	/* Get sample sort parameters. */
+	clo_sort_samplesort_data* data =
+		(clo_sort_samplesort_data*) clo_sort_get_data(sorter);
+
+	/* Check if scanner object was already created. */
+	if (data->scanner == NULL) {
+
+		/* If not, create it. */
+
+		/* Get context, program and device. */
+		ctx = clo_sort_get_context(sorter);
+		prg = clo_sort_get_program(sorter);
+		dev = ccl_program_get_device(prg, 0, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+
+		/* Get sorter compiler options, which will also be used for
+		 * the scanner. */
+		compiler_opts = ccl_program_get_build_info_array(
+			prg, dev, CL_PROGRAM_BUILD_OPTIONS, char*, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+
+		/* Create scanner object. */
+		data->scanner = clo_scan_new(data->scan_type, data->scan_opts,
+			ctx, CLO_UINT, CLO_UINT, NULL, NULL, NULL, compiler_opts,
+			&err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+	}
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+
+finish:
+
+	/* Return. */
+	return data->scanner;
+}
+
+/**
+ * @internal
+ * Determine the local worksize, the number of buckets and the number
+ * of work-groups of the histogram and scatter kernels for the given
+ * number of elements.
+ * */
+static cl_bool clo_sort_samplesort_get_sizes(CloSort* sorter,
+	CCLDevice* dev, size_t numel, size_t lws_max, size_t* lws,
+	cl_uint* num_buckets, size_t* num_wgs, GError** err) {
+
+	/* Internal error handling object. */
+	GError* err_internal = NULL;
+
+	/* Real and global worksizes. */
+	size_t rws = numel, gws;
+
+	/* Get sample sort parameters. */
+	clo_sort_samplesort_data* data =
+		(clo_sort_samplesort_data*) clo_sort_get_data(sorter);
+
+	/* Determine local worksize. */
+	*lws = lws_max;
+	ccl_kernel_suggest_worksizes(
+		NULL, dev, 1, &rws, &gws, lws, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Aim for buckets half-filling the local memory... */
+	*num_buckets = clo_nlpo2(
+		(cl_uint) MAX(2 * numel / data->local_max, 2));
+	/* ...within the allowed maximum. */
+	*num_buckets = MIN(*num_buckets, data->max_buckets);
+
+	/* Number of work-groups for histogram and scatter. */
+	*num_wgs = MIN(gws / *lws, CLO_SORT_SAMPLESORT_MAX_WGS);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	return CL_TRUE;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	return CL_FALSE;
+
+}
+
+/**
+ * @internal
+ * Perform one sample sort pass using device data. Buckets which don't
+ * fit in local memory are sorted with further passes at increasing
+ * depth, unless the sort is being recorded in a command batch (the
+ * bucket sizes are only known at execution time) or the maximum depth
+ * is reached, in which case they are sorted in global memory.
+ * */
+static CCLEvent* clo_sort_samplesort_pass(
+	CloSort* sorter, CCLQueue* cq_exec, CCLQueue* cq_comm,
+	CCLBuffer* data_in, CCLBuffer* data_out, size_t numel,
+	size_t lws_max, guint depth, GError** err) {
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	/* Make sure cq_exec is not NULL. */
+	g_return_val_if_fail(cq_exec != NULL, NULL);
+
+	/* Required OpenCL object wrappers. */
+	CCLContext* ctx = NULL;
+	CCLProgram* prg = NULL;
+	CCLDevice* dev = NULL;
+	CCLBuffer* sample = NULL;
+	CCLBuffer* splitters = NULL;
+	CCLBuffer* counters = NULL;
+	CCLBuffer* counters_sum = NULL;
+	CCLBuffer* pending = NULL;
+	CCLBuffer* bucket_in = NULL;
+	CCLBuffer* bucket_out = NULL;
+	CCLEvent* evt = NULL;
+	CCLKernel* krnl_splt = NULL;
+	CCLKernel* krnl_hist = NULL;
+	CCLKernel* krnl_scat = NULL;
+	CCLKernel* krnl_lsrt = NULL;
+
+	/* Scanner object, used to determine bucket offsets. */
+	CloScan* scanner = NULL;
+
+	/* Local worksize. */
+	size_t lws;
+	/* Number of work-groups for histogram and scatter kernels. */
+	size_t num_wgs;
+	/* Global worksizes. */
+	size_t gws_hist, gws_lsrt;
+	/* Number of buckets. */
+	cl_uint num_buckets;
+	/* Number of samples. */
+	cl_uint num_samples;
+	/* Number of elements handled by each histogram/scatter
+	 * work-group. */
+	cl_uint chunk;
+	/* Number of elements (as a kernel argument). */
+	cl_uint numel_k = (cl_uint) numel;
+	/* Number of work-groups (as a kernel argument). */
+	cl_uint num_wgs_k;
+	/* Element size. */
+	size_t es = clo_sort_get_element_size(sorter);
+	/* Copy sorted data back to data_in? */
+	cl_bool copy_back = CL_FALSE;
+	/* Start and size of buckets left to sort in further passes. */
+	cl_uint* pending_host = NULL;
+	/* Size of largest bucket left to sort in further passes. */
+	cl_uint pending_max = 0;
+
+	/* Event wait list. */
+	CCLEventWaitList ewl = NULL;
+
+	/* Command batch being recorded, if any. */
+	CloBatch* batch = clo_sort_get_batch(sorter);
+
+	/* Leave buckets which don't fit in local memory for further
+	 * passes? */
+	cl_uint defer;
+
+	/* Internal error reporting object. */
+	GError* err_internal = NULL;
+
+	/* Get sample sort parameters. */
+	clo_sort_samplesort_data* data =
+		(clo_sort_samplesort_data*) clo_sort_get_data(sorter);
+
+	/* If data transfer queue is NULL, use exec queue for data
+	 * transfers. */
+	if (cq_comm == NULL) cq_comm = cq_exec;
+
+	/* Get device where sort will occurr. */
+	dev = ccl_queue_get_device(cq_exec, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Nothing to sort with less than two elements. */
+	if (numel < 2) {
+		if ((numel == 1) && (data_out != NULL)) {
+			evt = clo_batch_enqueue_copy(batch, data_in, data_out,
+				cq_comm, 0, 0, es, NULL, "samplesort_copy",
+				&err_internal);
+		} else {
+			evt = ccl_enqueue_marker(cq_exec, NULL, &err_internal);
+		}
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		goto finish;
+	}
+
+	/* Get context and program. */
+	ctx = clo_sort_get_context(sorter);
+	prg = clo_sort_get_program(sorter);
+
+	/* Determine work sizes and number of buckets. */
+	clo_sort_samplesort_get_sizes(sorter, dev, numel, lws_max, &lws,
+		&num_buckets, &num_wgs, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	num_wgs_k = (cl_uint) num_wgs;
+	num_samples = num_buckets * data->oversample;
+	chunk = (cl_uint) ((numel + num_wgs - 1) / num_wgs);
+	gws_hist = num_wgs * lws;
+	gws_lsrt = num_buckets * lws;
+	defer = (batch == NULL) && (depth < CLO_SORT_SAMPLESORT_MAX_DEPTH)
+		&& (numel > data->local_max);
+
+	g_debug("SAMPLESORT: numel=%d, lws=%d, buckets=%d, wgs=%d, depth=%d",
+		(int) numel, (int) lws, (int) num_buckets, (int) num_wgs,
+		(int) depth);
+
+	/* Check if data_out is set. */
+	if (data_out == NULL) {
+		/* If not create it and set a copy back flag. */
+		data_out = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, numel * es,
+			NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		copy_back = CL_TRUE;
+	}
+
+	/* Make sure there is one RNG seed per sampling work-item. */
+	if (data->num_seeds < lws) {
+		clo_rng_resize(data->rng, lws, cq_exec, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		data->num_seeds = lws;
+	}
+	clo_rng_init_seeds(data->rng, prg, cq_exec, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Get kernels. */
+	krnl_splt = ccl_program_get_kernel(
+		prg, CLO_SORT_SAMPLESORT_KNAME_SPLITTERS, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	krnl_hist = ccl_program_get_kernel(
+		prg, CLO_SORT_SAMPLESORT_KNAME_HISTOGRAM, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	krnl_scat = ccl_program_get_kernel(
+		prg, CLO_SORT_SAMPLESORT_KNAME_SCATTER, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	krnl_lsrt = ccl_program_get_kernel(
+		prg, CLO_SORT_SAMPLESORT_KNAME_LOCALSORT, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Allocate auxiliary device buffers. */
+	sample = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, num_samples * es,
+		NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	splitters = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+		(num_buckets - 1) * es, NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	counters = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+		num_buckets * num_wgs * sizeof(cl_uint), NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	counters_sum = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+		num_buckets * num_wgs * sizeof(cl_uint), NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	pending = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+		2 * num_buckets * sizeof(cl_uint), NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Get scanner object. */
+	scanner = clo_sort_samplesort_get_scanner(sorter, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Scans are recorded in the same batch as the sort. */
+	clo_scan_set_batch(scanner, batch);
+
+	/* Sample, sort sample and pick splitters, in one work-group. */
+	clo_batch_set_buffer(
+		batch, krnl_splt, 0, clo_rng_get_device_seeds(data->rng));
+	clo_batch_set_buffer(batch, krnl_splt, 1, data_in);
+	clo_batch_set_arg_priv(batch, krnl_splt, 2, numel_k, cl_uint);
+	clo_batch_set_buffer(batch, krnl_splt, 3, sample);
+	clo_batch_set_arg_priv(batch, krnl_splt, 4, num_samples, cl_uint);
+	clo_batch_set_arg_priv(
+		batch, krnl_splt, 5, data->oversample, cl_uint);
+	clo_batch_set_buffer(batch, krnl_splt, 6, splitters);
+	evt = clo_batch_enqueue_ndrange(batch, krnl_splt, cq_exec, 1,
+		&lws, &lws, NULL, "samplesort_splitters", &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Histogram. */
+	clo_batch_set_buffer(batch, krnl_hist, 0, data_in);
+	clo_batch_set_buffer(batch, krnl_hist, 1, splitters);
+	clo_batch_set_arg_priv(batch, krnl_hist, 2, num_buckets, cl_uint);
+	clo_batch_set_arg_priv(batch, krnl_hist, 3, numel_k, cl_uint);
+	clo_batch_set_arg_priv(batch, krnl_hist, 4, chunk, cl_uint);
+	clo_batch_set_buffer(batch, krnl_hist, 5, counters);
+	clo_batch_set_arg_local(batch, krnl_hist, 6, num_buckets, cl_uint);
+	evt = clo_batch_enqueue_ndrange(batch, krnl_hist, cq_exec, 1,
+		&gws_hist, &lws, NULL, "samplesort_histogram", &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Scan. */
+	clo_scan_with_device_data(scanner, cq_exec, cq_comm, counters,
+		counters_sum, num_buckets * num_wgs, lws_max, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Scatter. */
+	clo_batch_set_buffer(batch, krnl_scat, 0, data_in);
+	clo_batch_set_buffer(batch, krnl_scat, 1, data_out);
+	clo_batch_set_buffer(batch, krnl_scat, 2, splitters);
+	clo_batch_set_arg_priv(batch, krnl_scat, 3, num_buckets, cl_uint);
+	clo_batch_set_arg_priv(batch, krnl_scat, 4, numel_k, cl_uint);
+	clo_batch_set_arg_priv(batch, krnl_scat, 5, chunk, cl_uint);
+	clo_batch_set_buffer(batch, krnl_scat, 6, counters_sum);
+	clo_batch_set_arg_local(batch, krnl_scat, 7, num_buckets, cl_uint);
+	evt = clo_batch_enqueue_ndrange(batch, krnl_scat, cq_exec, 1,
+		&gws_hist, &lws, NULL, "samplesort_scatter", &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Sort each bucket. */
+	clo_batch_set_buffer(batch, krnl_lsrt, 0, data_out);
+	clo_batch_set_buffer(batch, krnl_lsrt, 1, counters_sum);
+	clo_batch_set_arg_priv(batch, krnl_lsrt, 2, num_wgs_k, cl_uint);
+	clo_batch_set_arg_priv(batch, krnl_lsrt, 3, numel_k, cl_uint);
+	clo_batch_set_arg_priv(batch, krnl_lsrt, 4, data->local_max, cl_uint);
+	clo_batch_set_buffer(batch, krnl_lsrt, 5, splitters);
+	clo_batch_set_arg_priv(batch, krnl_lsrt, 6, defer, cl_uint);
+	clo_batch_set_buffer(batch, krnl_lsrt, 7, pending);
+	clo_batch_set_arg(batch, krnl_lsrt, 8, data->local_max * es, NULL);
+	evt = clo_batch_enqueue_ndrange(batch, krnl_lsrt, cq_exec, 1,
+		&gws_lsrt, &lws, NULL, "samplesort_localsort", &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Sort buckets which don't fit in local memory with further
+	 * passes. */
+	if (defer) {
+
+		pending_host = g_new(cl_uint, 2 * num_buckets);
+		evt = ccl_buffer_enqueue_read(pending, cq_exec, CL_FALSE, 0,
+			2 * num_buckets * sizeof(cl_uint), pending_host, NULL,
+			&err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		ccl_event_set_name(evt, "samplesort_read_pending");
+		ccl_event_wait(ccl_ewl(&ewl, evt, NULL), &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+
+		for (cl_uint b = 0; b < num_buckets; ++b)
+			pending_max = MAX(pending_max, pending_host[2 * b + 1]);
+
+		if (pending_max > 0) {
+			bucket_in = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+				pending_max * es, NULL, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+			bucket_out = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+				pending_max * es, NULL, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+		}
+
+		for (cl_uint b = 0; b < num_buckets; ++b) {
+
+			size_t start = pending_host[2 * b];
+			size_t n = pending_host[2 * b + 1];
+
+			if (n == 0) continue;
+
+			evt = clo_batch_enqueue_copy(NULL, data_out, bucket_in,
+				cq_exec, start * es, 0, n * es, NULL,
+				"samplesort_copy_bucket", &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+
+			clo_sort_samplesort_pass(sorter, cq_exec, cq_exec,
+				bucket_in, bucket_out, n, lws_max, depth + 1,
+				&err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+
+			evt = clo_batch_enqueue_copy(NULL, bucket_out, data_out,
+				cq_exec, 0, start * es, n * es, NULL,
+				"samplesort_copy_bucket", &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+		}
+	}
+
+	/* If required, copy sorted data back to original data buffer. */
+	if (copy_back) {
+		evt = clo_batch_enqueue_copy(batch, data_out, data_in, cq_comm,
+			0, 0, numel * es, NULL, "samplesort_copy", &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+	}
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	evt = NULL;
+
+finish:
+
+	/* Stop recording scans in the sort batch. */
+	if (scanner) clo_scan_set_batch(scanner, NULL);
+
+	/* Free stuff. */
+	if (sample) ccl_buffer_destroy(sample);
+	if (splitters) ccl_buffer_destroy(splitters);
+	if (counters) ccl_buffer_destroy(counters);
+	if (counters_sum) ccl_buffer_destroy(counters_sum);
+	if (pending) ccl_buffer_destroy(pending);
+	if (bucket_in) ccl_buffer_destroy(bucket_in);
+	if (bucket_out) ccl_buffer_destroy(bucket_out);
+	if ((copy_back) && (data_out != NULL)) ccl_buffer_destroy(data_out);
+	g_free(pending_host);
+
+	/* Return. */
+	return evt;
+
+}
+
+/**
+ * @internal
+ * Perform sort using device data.
+ * */
+static CCLEvent* clo_sort_samplesort_sort_with_device_data(
+	CloSort* sorter, CCLQueue* cq_exec, CCLQueue* cq_comm,
+	CCLBuffer* data_in, CCLBuffer* data_out, size_t numel,
+	size_t lws_max, GError** err) {
+
+	return clo_sort_samplesort_pass(sorter, cq_exec, cq_comm, data_in,
+		data_out, numel, lws_max, 0, err);
+
+}
+
+/**
+ * @internal
+ * Initializes a sample sorter object and returns the respective source
+ * code.
+ * */
+static const char* clo_sort_samplesort_init(
+	CloSort* sorter, const char* options, GError** err) {
+
+	/* Make sure err is NULL or it is not set. */
+	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+	char* samplesort_src = NULL;
+	clo_sort_samplesort_data* data = NULL;
+	data = g_slice_new0(clo_sort_samplesort_data);
+
+	/* Set internal data default values. */
+	data->max_buckets = 1024;
+	data->oversample = 8;
+	data->local_max = 1024;
+
+	/* Number of tokens. */
+	int num_toks;
+
+	/* Tokenized options. */
+	gchar** opts = NULL;
+	gchar** opt = NULL;
+
+	/* Scan options. */
+	GString* scan_opts = g_string_new("");
+
+	/* Internal error handling object. */
+	GError* err_internal = NULL;
+
+	/* Check options. */
+	if (options) {
+		opts = g_strsplit_set(options, ",", -1);
+		for (guint i = 0; opts[i] != NULL; i++) {
+
+			/* Ignore empty tokens. */
+			if (opts[i][0] == '\0') continue;
+
+			/* Parse current option, get key and value. */
+			opt = g_strsplit_set(opts[i], "=", 2);
+
+			/* Count number of tokens. */
+			for (num_toks = 0; opt[num_toks] != NULL; num_toks++);
+
+			/* If number of tokens is not 2 (key and value), throw error. */
+			g_if_err_create_goto(*err, CLO_ERROR, num_toks != 2,
+				CLO_ERROR_ARGS, error_handler,
+				"Invalid option '%s' for samplesort sort.", opts[i]);
+
+			/* Check key/value option. */
+			if (g_strcmp0("buckets", opt[0]) == 0) {
+				/* Maximum number of buckets. */
+				data->max_buckets = atoi(opt[1]);
+				g_if_err_create_goto(*err, CLO_ERROR,
+					(clo_ones32(data->max_buckets) != 1)
+					|| (data->max_buckets < 2), CLO_ERROR_ARGS,
+					error_handler,
+					"Number of buckets must be a power of 2 larger "\
+					"than 1.");
+			} else if (g_strcmp0("oversample", opt[0]) == 0) {
+				/* Number of samples per bucket. */
+				data->oversample = atoi(opt[1]);
+				g_if_err_create_goto(*err, CLO_ERROR,
+					data->oversample < 1, CLO_ERROR_ARGS,
+					error_handler,
+					"Oversampling factor must be positive.");
+			} else if (g_strcmp0("local", opt[0]) == 0) {
+				/* Maximum bucket size sorted in local memory. */
+				data->local_max = atoi(opt[1]);
+				g_if_err_create_goto(*err, CLO_ERROR,
+					data->local_max < 2, CLO_ERROR_ARGS,
+					error_handler,
+					"Local sort size must be larger than 1.");
+			} else if (g_strcmp0("rng", opt[0]) == 0) {
+				/* RNG used for sampling. */
+				g_free(data->rng_type);
+				data->rng_type = g_strdup(opt[1]);
+			} else if (g_ascii_strncasecmp("scan", opt[0], 4) == 0) {
+				/* Its a scanner option, analyse it. */
+				if (strlen(opt[0]) == 4) {
+					/* It's the type of scan. */
+					g_free(data->scan_type);
+					data->scan_type = g_strdup(opt[1]);
+				} else {
+					/* It's some other scan option. */
+					g_string_append_printf(
+						scan_opts, "%s,", opts[i] + 4);
+				}
+			} else {
+				g_if_err_create_goto(*err, CLO_ERROR, TRUE,
+					CLO_ERROR_ARGS, error_handler,
+					"Invalid option key '%s' for samplesort sort.",
+					opt[0]);
+			}
+
+			/* Free token. */
+			g_strfreev(opt);
+			opt = NULL;
+
+		}
+
+	}
+
+	/* Create RNG object for sampling. Seeds are initialized with the
+	 * sorter program, before the first sort. */
+	data->rng = clo_rng_new(data->rng_type != NULL
+			? data->rng_type : CLO_SORT_SAMPLESORT_RNG_DEFAULT,
+		CLO_RNG_SEED_DEV_GID_FUSED, NULL, 1,
+		CLO_SORT_SAMPLESORT_RNG_SEED, CLO_SORT_SAMPLESORT_RNG_HASH,
+		clo_sort_get_context(sorter), NULL, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	data->num_seeds = 1;
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	samplesort_src = g_strconcat(
+		clo_rng_get_source(data->rng), CLO_SORT_SAMPLESORT_SRC, NULL);
+	data->src = samplesort_src;
+	if (data->scan_type == NULL)
+		data->scan_type = g_strdup(CLO_SORT_SAMPLESORT_SCAN_DEFAULT);
+	data->scan_opts = scan_opts->str;
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	samplesort_src = NULL;
+	data->src = NULL;
+	data->scan_opts = scan_opts->str;
+
+finish:
+
+	/* Free parsed sample sort options. */
+	g_strfreev(opts);
+	g_strfreev(opt);
+	g_string_free(scan_opts, FALSE);
+
+	/* Set object methods and internal data. */
+	clo_sort_set_data(sorter, data);
+
+	/* Return source to be compiled. */
+	return (const char*) samplesort_src;
+
+}
+
+/**
+ * Finalizes a sample sorter object.
+ *
+ * @copydetails ::CloSort::finalize()
+ * */
+static void clo_sort_samplesort_finalize(CloSort* sorter) {
+
+	/* Get internal data. */
+	clo_sort_samplesort_data* data =
+		(clo_sort_samplesort_data*) clo_sort_get_data(sorter);
+
+	/* Release internal data. */
+	g_free(data->src);
+	g_free(data->scan_type);
+	g_free(data->scan_opts);
+	g_free(data->rng_type);
+	if (data->scanner) clo_scan_destroy(data->scanner);
+	if (data->rng) clo_rng_destroy(data->rng);
+	g_slice_free(clo_sort_samplesort_data, data);
+
+	return;
+}
+
+/**
+ * @internal
+ * Get the maximum number of kernels used by the sort implementation.
+ * */
+static cl_uint clo_sort_samplesort_get_num_kernels(
+	CloSort* sorter, GError** err) {
+
+	/* Scanner object associated with the sample sort. */
+	CloScan* scanner = NULL;
+	/* Internal error handling object. */
+	GError* err_internal = NULL;
+	/* Number of kernels. */
+	cl_uint num_kernels = 0;
+
+	/* Get associated scan implementation. */
+	scanner = clo_sort_samplesort_get_scanner(sorter, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Determine number of kernels: sample sort kernels + scan
+	 * kernels. */
+	num_kernels = CLO_SORT_SAMPLESORT_NUM_KERNELS
+		+ clo_scan_get_num_kernels(scanner, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+
+finish:
+
+	/* Return number of kernels. */
+	return num_kernels;
+
+}
+
+/**
+ * @internal
+ * Get name of the i^th kernel used by the sort implementation.
+ * */
+static const char* clo_sort_samplesort_get_kernel_name(
+	CloSort* sorter, cl_uint i, GError** err) {
+
+	/* Scanner object associated with the sample sort. */
+	CloScan* scanner = NULL;
+	/* Number of kernels. */
+	cl_uint num_kernels = 0;
+	/* Kernel name. */
+	const char* kernel_name = NULL;
+	/* Internal error handling object. */
+	GError* err_internal = NULL;
+
+	/* Get number of kernels. */
+	num_kernels =
+		clo_sort_samplesort_get_num_kernels(sorter, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Check that it's within bounds. */
+	g_return_val_if_fail(i < num_kernels, NULL);
+
+	/* Check if the requested kernel name is from the sample sort or
+	 * from the scan implementation. */
+	if (i < CLO_SORT_SAMPLESORT_NUM_KERNELS) {
+
+		/* It's a sample sort kernel. */
+		kernel_name = clo_sort_samplesort_knames[i];
+
+	} else {
+
+		/* It's a scan kernel. */
+		scanner = clo_sort_samplesort_get_scanner(sorter, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		kernel_name = clo_scan_get_kernel_name(scanner,
+			i - CLO_SORT_SAMPLESORT_NUM_KERNELS, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	}
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	kernel_name = NULL;
+
+finish:
+	/* Return kernel name. */
+	return kernel_name;
+}
+
+/**
+ * @internal
+ * Get local memory usage of i^th kernel used by the sort implementation
+ * for the given maximum local worksize and number of elements to sort.
+ * */
+static size_t clo_sort_samplesort_get_localmem_usage(CloSort* sorter,
+	cl_uint i, size_t lws_max, size_t numel, GError** err) {
+
+	/* Scanner object associated with the sample sort. */
+	CloScan* scanner = NULL;
+	/* Number of kernels. */
+	cl_uint num_kernels = 0;
+	/* Local memory usage. */
+	size_t local_mem_usage = 0;
+	/* Internal error handling object. */
+	GError* err_internal = NULL;
+	/* Work sizes and number of buckets. */
+	size_t lws, num_wgs;
+	cl_uint num_buckets;
+	/* Device where sort will occur. */
+	CCLDevice* dev = NULL;
+
+	/* Get sample sort parameters. */
+	clo_sort_samplesort_data* data =
+		(clo_sort_samplesort_data*) clo_sort_get_data(sorter);
+
+	/* Get number of kernels. */
+	num_kernels =
+		clo_sort_samplesort_get_num_kernels(sorter, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Check that it's within bounds. */
+	g_return_val_if_fail(i < num_kernels, 0);
+
+	/* Get device where sort will occurr. */
+	dev = ccl_context_get_device(
+		clo_sort_get_context(sorter), 0, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Determine work sizes and number of buckets. */
+	clo_sort_samplesort_get_sizes(sorter, dev, numel, lws_max, &lws,
+		&num_buckets, &num_wgs, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+
+	/* Check if the local memory usage is for a sample sort kernel or
+	 * for a scan kernel. */
+	switch (i) {
+
+		case CLO_SORT_SAMPLESORT_KIDX_SPLITTERS:
+			/* The sample is sorted in global memory. */
+			local_mem_usage = 0;
+			break;
+		case CLO_SORT_SAMPLESORT_KIDX_HISTOGRAM:
+		case CLO_SORT_SAMPLESORT_KIDX_SCATTER:
+			/* One counter per bucket. */
+			local_mem_usage = num_buckets * sizeof(cl_uint);
+			break;
+		case CLO_SORT_SAMPLESORT_KIDX_LOCALSORT:
+			/* Buckets sorted in local memory. */
+			local_mem_usage =
+				data->local_max * clo_sort_get_element_size(sorter);
+			break;
+		default:
+			/* It's for a scan kernel. */
+			scanner = clo_sort_samplesort_get_scanner(
+				sorter, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+			local_mem_usage = clo_scan_get_localmem_usage(scanner,
+				i - CLO_SORT_SAMPLESORT_NUM_KERNELS, lws_max,
+				num_buckets * num_wgs, &err_internal);
+			g_if_err_propagate_goto(err, err_internal, error_handler);
+	}
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+	local_mem_usage = 0;
+
+finish:
+
+	/* Return local memory usage. */
+	return local_mem_usage;
+
+}
+
+/* Definition of the sample sort implementation. */
+const CloSortImplDef clo_sort_samplesort_def = {
+	"samplesort",
+	CL_FALSE,
+	CL_FALSE,
+	CL_TRUE,
+	clo_sort_samplesort_init,
+	clo_sort_samplesort_finalize,
+	clo_sort_samplesort_sort_with_device_data,
+	clo_sort_samplesort_get_num_kernels,
+	clo_sort_samplesort_get_kernel_name,
+	clo_sort_samplesort_get_localmem_usage
+};
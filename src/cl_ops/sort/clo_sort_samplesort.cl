@@ -0,0 +1,228 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CL_Ops.  If not, see <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Sample sort implementation.
+ *
+ * Requires definition of:
+ *
+ * * CLO_SORT_ELEM_TYPE - Type of element to sort
+ * * CLO_SORT_COMPARE(a,b) - Compare macro or function
+ * * CLO_SORT_KEY_GET(x) - Get key macro or function
+ * * CLO_SORT_KEY_TYPE - Type of key
+ *
+ * Also requires the common sort source, which defines the bitonic sort
+ * and bucket helper functions, and the CL_Ops RNG source, which defines
+ * `clo_statetype` and clo_rng_next_int().
+ */
+
+/**
+ * Draw a random sample of the elements to sort, sort it and pick the
+ * splitters. Must be launched with a single work-group.
+ *
+ * @param[in,out] seeds RNG states, one per work-item.
+ * @param[in] data Elements to sort.
+ * @param[in] numel Number of elements to sort.
+ * @param[out] sample Sample buffer.
+ * @param[in] num_samples Number of elements to sample.
+ * @param[in] oversample Number of samples per bucket.
+ * @param[out] splitters Splitters, `num_samples / oversample - 1`
+ * elements.
+ * */
+__kernel void samplesort_splitters(
+	__global clo_statetype* seeds,
+	__global const CLO_SORT_ELEM_TYPE* data,
+	const uint numel,
+	__global CLO_SORT_ELEM_TYPE* sample,
+	const uint num_samples,
+	const uint oversample,
+	__global CLO_SORT_ELEM_TYPE* splitters) {
+
+	uint lid = get_local_id(0);
+	uint lws = get_local_size(0);
+
+	/* Draw sample. */
+	for (uint i = lid; i < num_samples; i += lws)
+		sample[i] = data[clo_rng_next_int(seeds, numel)];
+	barrier(CLK_GLOBAL_MEM_FENCE);
+
+	/* Sort sample. */
+	clo_sort_bitonic_global(sample, num_samples);
+
+	/* Pick splitters. */
+	for (uint i = lid; i < num_samples / oversample - 1; i += lws)
+		splitters[i] = sample[(i + 1) * oversample];
+
+}
+
+/**
+ * Count the number of elements which fall in each bucket. Each
+ * work-group handles a contiguous chunk of elements.
+ *
+ * @param[in] data Elements to sort.
+ * @param[in] splitters Sorted splitters.
+ * @param[in] num_buckets Number of buckets.
+ * @param[in] numel Number of elements to sort.
+ * @param[in] chunk Number of elements per work-group.
+ * @param[out] counters Bucket counters, bucket-major (the counter of
+ * bucket `b` in work-group `w` is at `b * num_groups + w`).
+ * @param[in] hist Local histogram, `num_buckets` elements.
+ * */
+__kernel void samplesort_histogram(
+	__global const CLO_SORT_ELEM_TYPE* data,
+	__global const CLO_SORT_ELEM_TYPE* splitters,
+	const uint num_buckets,
+	const uint numel,
+	const uint chunk,
+	__global uint* counters,
+	__local uint* hist) {
+
+	uint lid = get_local_id(0);
+	uint lws = get_local_size(0);
+	uint wg = get_group_id(0);
+	uint num_wgs = get_num_groups(0);
+	uint start = wg * chunk;
+	uint end = min(start + chunk, numel);
+
+	for (uint b = lid; b < num_buckets; b += lws)
+		hist[b] = 0;
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for (uint i = start + lid; i < end; i += lws)
+		atomic_inc(&hist[
+			clo_sort_bucket(data[i], splitters, num_buckets - 1)]);
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for (uint b = lid; b < num_buckets; b += lws)
+		counters[b * num_wgs + wg] = hist[b];
+
+}
+
+/**
+ * Scatter elements to their buckets, using the scanned bucket
+ * counters as offsets. The order of elements within a bucket is not
+ * preserved.
+ *
+ * @param[in] data_in Elements to sort.
+ * @param[out] data_out Elements grouped by bucket.
+ * @param[in] splitters Sorted splitters.
+ * @param[in] num_buckets Number of buckets.
+ * @param[in] numel Number of elements to sort.
+ * @param[in] chunk Number of elements per work-group.
+ * @param[in] offsets Scanned bucket counters.
+ * @param[in] pos Local bucket positions, `num_buckets` elements.
+ * */
+__kernel void samplesort_scatter(
+	__global const CLO_SORT_ELEM_TYPE* data_in,
+	__global CLO_SORT_ELEM_TYPE* data_out,
+	__global const CLO_SORT_ELEM_TYPE* splitters,
+	const uint num_buckets,
+	const uint numel,
+	const uint chunk,
+	__global const uint* offsets,
+	__local uint* pos) {
+
+	uint lid = get_local_id(0);
+	uint lws = get_local_size(0);
+	uint wg = get_group_id(0);
+	uint num_wgs = get_num_groups(0);
+	uint start = wg * chunk;
+	uint end = min(start + chunk, numel);
+
+	for (uint b = lid; b < num_buckets; b += lws)
+		pos[b] = offsets[b * num_wgs + wg];
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for (uint i = start + lid; i < end; i += lws) {
+		CLO_SORT_ELEM_TYPE x = data_in[i];
+		data_out[atomic_inc(&pos[
+			clo_sort_bucket(x, splitters, num_buckets - 1)])] = x;
+	}
+
+}
+
+/**
+ * Sort each bucket with one work-group. Buckets which fit in local
+ * memory are sorted there, while equality buckets are already sorted.
+ * Larger buckets (e.g. due to an unlucky sample or to the maximum
+ * number of buckets) are either left for the host to sort in another
+ * pass, or sorted directly in global memory.
+ *
+ * @param[in,out] data Elements grouped by bucket.
+ * @param[in] offsets Scanned bucket counters.
+ * @param[in] num_wgs Number of work-groups used in the histogram and
+ * scatter kernels.
+ * @param[in] numel Number of elements to sort.
+ * @param[in] local_max Maximum number of elements which can be sorted
+ * in local memory.
+ * @param[in] splitters Sorted splitters.
+ * @param[in] defer If non-zero, buckets larger than `local_max` are
+ * not sorted, but only reported in `pending`.
+ * @param[out] pending Start and size of each bucket which remains to be
+ * sorted (size is zero for sorted buckets), two elements per bucket.
+ * @param[in] data_local Local memory, `local_max` elements.
+ * */
+__kernel void samplesort_localsort(
+	__global CLO_SORT_ELEM_TYPE* data,
+	__global const uint* offsets,
+	const uint num_wgs,
+	const uint numel,
+	const uint local_max,
+	__global const CLO_SORT_ELEM_TYPE* splitters,
+	const uint defer,
+	__global uint* pending,
+	__local CLO_SORT_ELEM_TYPE* data_local) {
+
+	uint lid = get_local_id(0);
+	uint lws = get_local_size(0);
+	uint b = get_group_id(0);
+	uint num_buckets = get_num_groups(0);
+	uint start = offsets[b * num_wgs];
+	uint end = (b + 1 < num_buckets)
+		? offsets[(b + 1) * num_wgs] : numel;
+	uint n = end - start;
+
+	/* Equality buckets are already sorted. */
+	if (clo_sort_bucket_is_equal(splitters, num_buckets - 1, b)) n = 0;
+
+	/* Report buckets left for the host. */
+	if (defer && (lid == 0)) {
+		pending[2 * b] = start;
+		pending[2 * b + 1] = (n > local_max) ? n : 0;
+	}
+
+	if (n < 2) return;
+
+	if (n <= local_max) {
+
+		for (uint i = lid; i < n; i += lws)
+			data_local[i] = data[start + i];
+		barrier(CLK_LOCAL_MEM_FENCE);
+
+		clo_sort_bitonic_local(data_local, n);
+
+		for (uint i = lid; i < n; i += lws)
+			data[start + i] = data_local[i];
+
+	} else if (!defer) {
+
+		clo_sort_bitonic_global(data + start, n);
+
+	}
+
+}
@@ -0,0 +1,60 @@
+/*
+ * This file is part of CL_Ops.
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with CL_Ops. If not, see
+ * <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Sample sort header file.
+ */
+
+#ifndef _CLO_SORT_SAMPLESORT_H_
+#define _CLO_SORT_SAMPLESORT_H_
+
+#include "cl_ops/clo_sort_abstract.h"
+#include "cl_ops/clo_scan_abstract.h"
+#include "cl_ops/clo_rng.h"
+
+/** The sample sort kernels source. */
+#define CLO_SORT_SAMPLESORT_SRC "@SAMPLESORT_SRC@"
+
+/* Number of kernels. */
+#define CLO_SORT_SAMPLESORT_NUM_KERNELS 4
+
+/* Index of the sample sort kernels. */
+#define CLO_SORT_SAMPLESORT_KIDX_SPLITTERS 0
+#define CLO_SORT_SAMPLESORT_KIDX_HISTOGRAM 1
+#define CLO_SORT_SAMPLESORT_KIDX_SCATTER 2
+#define CLO_SORT_SAMPLESORT_KIDX_LOCALSORT 3
+
+/* Sample sort kernel names. */
+#define CLO_SORT_SAMPLESORT_KNAME_SPLITTERS "samplesort_splitters"
+#define CLO_SORT_SAMPLESORT_KNAME_HISTOGRAM "samplesort_histogram"
+#define CLO_SORT_SAMPLESORT_KNAME_SCATTER "samplesort_scatter"
+#define CLO_SORT_SAMPLESORT_KNAME_LOCALSORT "samplesort_localsort"
+
+/* Array of strings containing names of the kernels used by the
+ * sample sort. */
+#define CLO_SORT_SAMPLESORT_KERNELNAMES { \
+	CLO_SORT_SAMPLESORT_KNAME_SPLITTERS, \
+	CLO_SORT_SAMPLESORT_KNAME_HISTOGRAM, \
+	CLO_SORT_SAMPLESORT_KNAME_SCATTER, \
+	CLO_SORT_SAMPLESORT_KNAME_LOCALSORT }
+
+/** Definition of the sample sort implementation. */
+extern const CloSortImplDef clo_sort_samplesort_def;
+
+#endif
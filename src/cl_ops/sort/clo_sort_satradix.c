@@ -92,7 +92,8 @@ static CloScan* clo_sort_satradix_get_scanner(
 
 		/* Create scanner object. */
 		data->scanner = clo_scan_new(data->scan_type, data->scan_opts,
-			ctx, CLO_UINT, CLO_UINT, compiler_opts, &err_internal);
+			ctx, CLO_UINT, CLO_UINT, NULL, NULL, NULL, compiler_opts,
+			&err_internal);
 		g_if_err_propagate_goto(err, err_internal, error_handler);
 	}
 
@@ -133,6 +134,7 @@ static CCLEvent* clo_sort_satradix_sort_with_device_data(
 	CCLBuffer* offsets = NULL;
 	CCLBuffer* counters = NULL;
 	CCLBuffer* counters_sum = NULL;
+	CCLBuffer* scan_ws = NULL;
 	CCLEvent* evt = NULL;
 	CCLKernel* krnl_lsrt = NULL;
 	CCLKernel* krnl_hist = NULL;
@@ -150,12 +152,17 @@ static CCLEvent* clo_sort_satradix_sort_with_device_data(
 	size_t num_wgs;
 	/* Size of aux. buffers. */
 	size_t aux_buf_size;
+	/* Size of scan workspace. */
+	size_t scan_ws_size;
 	/* Bits in digit and total digits, depend on the radix. */
 	cl_uint bits_in_digit, total_digits;
 
 	/* Event wait list. */
 	CCLEventWaitList ewl = NULL;
 
+	/* Command batch being recorded, if any. */
+	CloBatch* batch = clo_sort_get_batch(sorter);
+
 	/* Internal error reporting object. */
 	GError* err_internal = NULL;
 
@@ -207,12 +214,11 @@ static CCLEvent* clo_sort_satradix_sort_with_device_data(
 	} else {
 		/* Copy data_in to data_out first, and then sort on copied
 		 * data. */
-		evt = ccl_buffer_enqueue_copy(data_in, data_out, cq_comm, 0, 0,
-			clo_sort_get_element_size(sorter) * numel_eff, NULL,
-			&err_internal);
+		evt = clo_batch_enqueue_copy(batch, data_in, data_out, cq_comm,
+			0, 0, clo_sort_get_element_size(sorter) * numel_eff, NULL,
+			"satradix_copy", &err_internal);
 		g_if_err_propagate_goto(err, err_internal, error_handler);
 
-		ccl_event_set_name(evt, "satradix_copy");
 		ccl_event_wait_list_add(&ewl, evt, NULL);
 	}
 
@@ -260,6 +266,20 @@ static CCLEvent* clo_sort_satradix_sort_with_device_data(
 	scanner = clo_sort_satradix_get_scanner(sorter, &err_internal);
 	g_if_err_propagate_goto(err, err_internal, error_handler);
 
+	/* Scans are recorded in the same batch as the sort. */
+	clo_scan_set_batch(scanner, batch);
+
+	/* Allocate the scan workspace once, so that it is reused by the
+	 * scans performed for each digit. */
+	scan_ws_size = clo_scan_get_workspace_size(scanner, cq_exec,
+		num_wgs * data.radix, lws_max, &err_internal);
+	g_if_err_propagate_goto(err, err_internal, error_handler);
+	if (scan_ws_size > 0) {
+		scan_ws = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, scan_ws_size,
+			NULL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+	}
+
 	/* Perform sort. */
 	for (cl_uint i = 0; i < total_digits; ++i) {
 
@@ -271,45 +291,52 @@ static CCLEvent* clo_sort_satradix_sort_with_device_data(
 		/// the loop.
 
 		/* Local sort. */
-		evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_lsrt,
-			cq_exec, 1, NULL, &numel_eff, &lws_sort, NULL, &err_internal,
-			data_out, data_aux,
-			ccl_arg_full(NULL, array_len * clo_sort_get_element_size(sorter)),
-			ccl_arg_local(array_len, cl_uint),
-			ccl_arg_priv(start_bit, cl_uint),
-			NULL);
+		clo_batch_set_buffer(batch, krnl_lsrt, 0, data_out);
+		clo_batch_set_buffer(batch, krnl_lsrt, 1, data_aux);
+		clo_batch_set_arg(batch, krnl_lsrt, 2,
+			array_len * clo_sort_get_element_size(sorter), NULL);
+		clo_batch_set_arg_local(batch, krnl_lsrt, 3, array_len, cl_uint);
+		clo_batch_set_arg_priv(batch, krnl_lsrt, 4, start_bit, cl_uint);
+		evt = clo_batch_enqueue_ndrange(batch, krnl_lsrt, cq_exec, 1,
+			&numel_eff, &lws_sort, NULL, "satradix_localsort",
+			&err_internal);
 		g_if_err_propagate_goto(err, err_internal, error_handler);
-		ccl_event_set_name(evt, "satradix_localsort");
 
 		/* Histogram. */
-		evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_hist, cq_exec, 1,
-			NULL, &numel_eff, &lws_sort, NULL, &err_internal,
-			data_aux, offsets, counters,
-			ccl_arg_local(data.radix, cl_uint),
-			ccl_arg_local(data.radix, cl_uint),
-			ccl_arg_full(NULL, array_len * clo_sort_get_key_size(sorter)),
-			ccl_arg_priv(start_bit, cl_uint),
-			ccl_arg_priv(array_len, cl_uint),
-			NULL);
+		clo_batch_set_buffer(batch, krnl_hist, 0, data_aux);
+		clo_batch_set_buffer(batch, krnl_hist, 1, offsets);
+		clo_batch_set_buffer(batch, krnl_hist, 2, counters);
+		clo_batch_set_arg_local(batch, krnl_hist, 3, data.radix, cl_uint);
+		clo_batch_set_arg_local(batch, krnl_hist, 4, data.radix, cl_uint);
+		clo_batch_set_arg(batch, krnl_hist, 5,
+			array_len * clo_sort_get_key_size(sorter), NULL);
+		clo_batch_set_arg_priv(batch, krnl_hist, 6, start_bit, cl_uint);
+		clo_batch_set_arg_priv(batch, krnl_hist, 7, array_len, cl_uint);
+		evt = clo_batch_enqueue_ndrange(batch, krnl_hist, cq_exec, 1,
+			&numel_eff, &lws_sort, NULL, "satradix_histogram",
+			&err_internal);
 		g_if_err_propagate_goto(err, err_internal, error_handler);
-		ccl_event_set_name(evt, "satradix_histogram");
 
 		/* Scan. */
-		clo_scan_with_device_data(scanner, cq_exec, cq_comm, counters,
-			counters_sum, num_wgs * data.radix, lws_max, &err_internal);
+		clo_scan_with_device_data_ws(scanner, cq_exec, cq_comm,
+			counters, counters_sum, num_wgs * data.radix, lws_max,
+			scan_ws, &err_internal);
 		g_if_err_propagate_goto(err, err_internal, error_handler);
 
 		/* Scatter. */
-		evt = ccl_kernel_set_args_and_enqueue_ndrange(krnl_scat,
-			cq_exec, 1, NULL, &numel_eff, &lws_sort, NULL, &err_internal,
-			data_in, data_aux, offsets, counters_sum,
-			ccl_arg_full(NULL, array_len * clo_sort_get_element_size(sorter)),
-			ccl_arg_local(data.radix, cl_uint),
-			ccl_arg_local(data.radix, cl_uint),
-			ccl_arg_priv(start_bit, cl_uint),
-			NULL);
+		clo_batch_set_buffer(batch, krnl_scat, 0, data_in);
+		clo_batch_set_buffer(batch, krnl_scat, 1, data_aux);
+		clo_batch_set_buffer(batch, krnl_scat, 2, offsets);
+		clo_batch_set_buffer(batch, krnl_scat, 3, counters_sum);
+		clo_batch_set_arg(batch, krnl_scat, 4,
+			array_len * clo_sort_get_element_size(sorter), NULL);
+		clo_batch_set_arg_local(batch, krnl_scat, 5, data.radix, cl_uint);
+		clo_batch_set_arg_local(batch, krnl_scat, 6, data.radix, cl_uint);
+		clo_batch_set_arg_priv(batch, krnl_scat, 7, start_bit, cl_uint);
+		evt = clo_batch_enqueue_ndrange(batch, krnl_scat, cq_exec, 1,
+			&numel_eff, &lws_sort, NULL, "satradix_scatter",
+			&err_internal);
 		g_if_err_propagate_goto(err, err_internal, error_handler);
-		ccl_event_set_name(evt, "satradix_scatter");
 	}
 
 	/* If we got here, everything is OK. */
@@ -323,11 +350,15 @@ error_handler:
 
 finish:
 
+	/* Stop recording scans in the sort batch. */
+	if (scanner) clo_scan_set_batch(scanner, NULL);
+
 	/* Free stuff. */
 	ccl_buffer_destroy(data_aux);
 	ccl_buffer_destroy(offsets);
 	ccl_buffer_destroy(counters);
 	ccl_buffer_destroy(counters_sum);
+	if (scan_ws) ccl_buffer_destroy(scan_ws);
 
 	/* Return. */
 	return evt;
@@ -362,6 +393,14 @@ static const char* clo_sort_satradix_init(
 	/* Scan options. */
 	GString* scan_opts = g_string_new("");
 
+	/* Digits are extracted by shifting keys, so only integer scalar
+	 * keys can be sorted. */
+	g_if_err_create_goto(*err, CLO_ERROR,
+		clo_sort_get_key_type(sorter) > CLO_ULONG, CLO_ERROR_ARGS,
+		error_handler,
+		"The satradix sort requires integer scalar keys, got '%s'.",
+		clo_type_get_name(clo_sort_get_key_type(sorter)));
+
 	/* Check options. */
 	if (options) {
 		opts = g_strsplit_set(options, ",", -1);
@@ -678,6 +717,8 @@ finish:
 const CloSortImplDef clo_sort_satradix_def = {
 	"satradix",
 	CL_TRUE,
+	CL_TRUE,
+	CL_FALSE,
 	clo_sort_satradix_init,
 	clo_sort_satradix_finalize,
 	clo_sort_satradix_sort_with_device_data,
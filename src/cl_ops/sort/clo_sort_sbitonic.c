@@ -24,6 +24,22 @@
 #include "cl_ops/clo_sort_sbitonic.h"
 #include "common/_g_err_macros.h"
 
+typedef struct {
+
+	/** Perform steps with pair stride up to the local worksize in
+	 * local memory? */
+	cl_bool local;
+
+	/** Original positions of the elements in stable sorts, kept between
+	 * sorts and only replaced by a larger buffer when required. Command
+	 * batches keep a reference to the buffer they were recorded with. */
+	CCLBuffer* idx;
+
+	/** Number of positions in the `idx` buffer. */
+	size_t idx_numel;
+
+} clo_sort_sbitonic_data;
+
 /**
  * @internal
  * Perform sort using device data.
@@ -45,17 +61,36 @@ static CCLEvent* clo_sort_sbitonic_sort_with_device_data(
 	/* Number of bitonic sort stages. */
 	cl_uint tot_stages;
 
+	/* Last step which can be performed in local memory (zero if local
+	 * memory is not used). */
+	cl_uint max_local_step;
+
 	/* OpenCL object wrappers. */
 	CCLDevice* dev = NULL;
 	CCLKernel* krnl = NULL;
+	CCLKernel* krnl_local = NULL;
 	CCLEvent* evt = NULL;
 
+	/* Perform stable sort? */
+	cl_bool stable = clo_sort_get_stable(sorter);
+
+	/* Offset of the stage and step kernel arguments, since the stable
+	 * kernels have an additional buffer argument. */
+	cl_uint a = stable ? 1 : 0;
+
 	/* Event wait list. */
 	CCLEventWaitList ewl = NULL;
 
+	/* Command batch being recorded, if any. */
+	CloBatch* batch = clo_sort_get_batch(sorter);
+
 	/* Internal error reporting object. */
 	GError* err_internal = NULL;
 
+	/* Get sbitonic sort parameters. */
+	clo_sort_sbitonic_data* data =
+		(clo_sort_sbitonic_data*) clo_sort_get_data(sorter);
+
 	/* If data transfer queue is NULL, use exec queue for data
 	 * transfers. */
 	if (cq_comm == NULL) cq_comm = cq_exec;
@@ -66,7 +101,8 @@ static CCLEvent* clo_sort_sbitonic_sort_with_device_data(
 
 	/* Get the kernel wrapper. */
 	krnl = ccl_program_get_kernel(clo_sort_get_program(sorter),
-		"sbitonic", &err_internal);
+		stable ? CLO_SORT_SBITONIC_KNAME_STABLE : CLO_SORT_SBITONIC_KNAME,
+		&err_internal);
 	g_if_err_propagate_goto(err, err_internal, error_handler);
 
 	/* Determine worksizes. */
@@ -79,6 +115,18 @@ static CCLEvent* clo_sort_sbitonic_sort_with_device_data(
 	/* Determine number of bitonic sort stages. */
 	tot_stages = (cl_uint) clo_tzc(gws * 2);
 
+	/* If required, get the local memory kernel wrapper, which can
+	 * perform all steps with a pair stride up to the local worksize. */
+	if (data->local) {
+		krnl_local = ccl_program_get_kernel(clo_sort_get_program(sorter),
+			stable ? CLO_SORT_SBITONIC_KNAME_STABLE_LOCAL
+				: CLO_SORT_SBITONIC_KNAME_LOCAL, &err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		max_local_step = (cl_uint) clo_tzc(lws * 2);
+	} else {
+		max_local_step = 0;
+	}
+
 	/* Determine which buffer to use. */
 	if (data_out == NULL) {
 		/* Sort directly in original data. */
@@ -86,33 +134,72 @@ static CCLEvent* clo_sort_sbitonic_sort_with_device_data(
 	} else {
 		/* Copy data_in to data_out first, and then sort on copied
 		 * data. */
-		evt = ccl_buffer_enqueue_copy(data_in, data_out, cq_comm, 0, 0,
-			clo_sort_get_element_size(sorter) * numel, NULL,
-			&err_internal);
+		evt = clo_batch_enqueue_copy(batch, data_in, data_out, cq_comm,
+			0, 0, clo_sort_get_element_size(sorter) * numel, NULL,
+			"sbitonic_copy", &err_internal);
 
 		g_if_err_propagate_goto(err, err_internal, error_handler);
-		ccl_event_set_name(evt, "sbitonic_copy");
 		ccl_event_wait_list_add(&ewl, evt, NULL);
 	}
 
-	/* Set first kernel argument. */
-	ccl_kernel_set_arg(krnl, 0, data_out);
+	/* For stable sort, get buffer for the original positions of the
+	 * elements, which are initialized by the first stage. The buffer
+	 * is only created if there is none large enough. */
+	if (stable && (data->idx_numel < gws * 2)) {
+		if (data->idx) ccl_buffer_destroy(data->idx);
+		data->idx = NULL;
+		data->idx_numel = 0;
+		data->idx = ccl_buffer_new(clo_sort_get_context(sorter),
+			CL_MEM_READ_WRITE, gws * 2 * sizeof(cl_uint), NULL,
+			&err_internal);
+		g_if_err_propagate_goto(err, err_internal, error_handler);
+		data->idx_numel = gws * 2;
+	}
+
+	/* Set first kernel argument(s). */
+	clo_batch_set_buffer(batch, krnl, 0, data_out);
+	if (stable) clo_batch_set_buffer(batch, krnl, 1, data->idx);
+	if (krnl_local) {
+		clo_batch_set_buffer(batch, krnl_local, 0, data_out);
+		if (stable)
+			clo_batch_set_buffer(batch, krnl_local, 1, data->idx);
+		clo_batch_set_arg(batch, krnl_local, a + 3,
+			2 * lws * clo_sort_get_element_size(sorter), NULL);
+		if (stable)
+			clo_batch_set_arg_local(batch, krnl_local, 5, 2 * lws, cl_uint);
+	}
 
 	/* Perform simple bitonic sort. */
 	for (cl_uint curr_stage = 1; curr_stage <= tot_stages; curr_stage++) {
 
-		ccl_kernel_set_arg(krnl, 1, ccl_arg_priv(curr_stage, cl_uint));
+		clo_batch_set_arg_priv(batch, krnl, a + 1, curr_stage, cl_uint);
 
 		cl_uint step = curr_stage;
 
 		for (cl_uint curr_step = step; curr_step > 0; curr_step--) {
 
-			ccl_kernel_set_arg(krnl, 2, ccl_arg_priv(curr_step, cl_uint));
+			/* If the remaining steps can be performed in local memory,
+			 * do it with a single kernel. */
+			if (curr_step <= max_local_step) {
+
+				clo_batch_set_arg_priv(
+					batch, krnl_local, a + 1, curr_stage, cl_uint);
+				clo_batch_set_arg_priv(
+					batch, krnl_local, a + 2, curr_step, cl_uint);
+
+				evt = clo_batch_enqueue_ndrange(batch, krnl_local,
+					cq_exec, 1, &gws, &lws, &ewl, "sbitonic_local",
+					&err_internal);
+				g_if_err_propagate_goto(err, err_internal, error_handler);
 
-			evt = ccl_kernel_enqueue_ndrange(krnl, cq_exec, 1, NULL,
-				&gws, &lws, &ewl, &err_internal);
+				break;
+			}
+
+			clo_batch_set_arg_priv(batch, krnl, a + 2, curr_step, cl_uint);
+
+			evt = clo_batch_enqueue_ndrange(batch, krnl, cq_exec, 1,
+				&gws, &lws, &ewl, "sbitonic_ndrange", &err_internal);
 			g_if_err_propagate_goto(err, err_internal, error_handler);
-			ccl_event_set_name(evt, "sbitonic_ndrange");
 
 		}
 	}
@@ -144,13 +231,79 @@ static const char* clo_sort_sbitonic_init(
 	/* Make sure err is NULL or it is not set. */
 	g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
-	/* Ignore specific sbitonic sort options and error handling. */
-	(void)options;
-	(void)err;
-	(void)sorter;
+	/* Source to be compiled. */
+	const char* sbitonic_src = NULL;
+
+	/* Tokenized options. */
+	gchar** opts = NULL;
+	gchar** opt = NULL;
+
+	/* Number of tokens. */
+	int num_toks;
+
+	/* Internal data. */
+	clo_sort_sbitonic_data* data = g_slice_new0(clo_sort_sbitonic_data);
+
+	/* Set internal data default values. */
+	data->local = CL_TRUE;
+
+	/* Check options. */
+	if (options) {
+		opts = g_strsplit_set(options, ",", -1);
+		for (guint i = 0; opts[i] != NULL; i++) {
+
+			/* Ignore empty tokens. */
+			if (opts[i][0] == '\0') continue;
+
+			/* Parse current option, get key and value. */
+			opt = g_strsplit_set(opts[i], "=", 2);
+
+			/* Count number of tokens. */
+			for (num_toks = 0; opt[num_toks] != NULL; num_toks++);
+
+			/* If number of tokens is not 2 (key and value), throw error. */
+			g_if_err_create_goto(*err, CLO_ERROR, num_toks != 2,
+				CLO_ERROR_ARGS, error_handler,
+				"Invalid option '%s' for sbitonic sort.", opts[i]);
+
+			/* Check key/value option. */
+			if (g_strcmp0("local", opt[0]) == 0) {
+				/* Perform steps in local memory when possible? */
+				data->local = atoi(opt[1]) ? CL_TRUE : CL_FALSE;
+			} else {
+				g_if_err_create_goto(*err, CLO_ERROR, TRUE,
+					CLO_ERROR_ARGS, error_handler,
+					"Invalid option key '%s' for sbitonic sort.",
+					opt[0]);
+			}
+
+			/* Free token. */
+			g_strfreev(opt);
+			opt = NULL;
+
+		}
+	}
+
+	/* If we got here, everything is OK. */
+	g_assert(err == NULL || *err == NULL);
+	sbitonic_src = CLO_SORT_SBITONIC_SRC;
+	goto finish;
+
+error_handler:
+	/* If we got here there was an error, verify that it is so. */
+	g_assert(err == NULL || *err != NULL);
+
+finish:
+
+	/* Free parsed sbitonic options. */
+	g_strfreev(opts);
+	g_strfreev(opt);
+
+	/* Set internal data. */
+	clo_sort_set_data(sorter, data);
 
 	/* Return source to be compiled. */
-	return CLO_SORT_SBITONIC_SRC;
+	return sbitonic_src;
 
 }
 
@@ -159,8 +312,14 @@ static const char* clo_sort_sbitonic_init(
  * Finalizes a bitonic sorter object.
  * */
 static void clo_sort_sbitonic_finalize(CloSort* sorter) {
-	/* Nothing to finalize. */
-	(void)sorter;
+
+	/* Get internal data. */
+	clo_sort_sbitonic_data* data =
+		(clo_sort_sbitonic_data*) clo_sort_get_data(sorter);
+
+	/* Release internal data. */
+	if (data->idx) ccl_buffer_destroy(data->idx);
+	g_slice_free(clo_sort_sbitonic_data, data);
 	return;
 }
 
@@ -172,11 +331,11 @@ static cl_uint clo_sort_sbitonic_get_num_kernels(
 	CloSort* sorter, GError** err) {
 
 	/* Avoid compiler warnings. */
-	(void)sorter;
 	(void)err;
 
 	/* Return number of kernels. */
-	return 1;
+	return ((clo_sort_sbitonic_data*) clo_sort_get_data(sorter))->local
+		? 2 : 1;
 
 }
 
@@ -187,15 +346,17 @@ static cl_uint clo_sort_sbitonic_get_num_kernels(
 static const char* clo_sort_sbitonic_get_kernel_name(
 	CloSort* sorter, cl_uint i, GError** err) {
 
-	/* i must be zero because there is only one kernel. */
-	g_return_val_if_fail(i == 0, NULL);
-
-	/* Avoid compiler warnings. */
-	(void)sorter;
-	(void)err;
+	/* Check that i is within bounds. */
+	g_return_val_if_fail(
+		i < clo_sort_sbitonic_get_num_kernels(sorter, err), NULL);
 
 	/* Return kernel name. */
-	return CLO_SORT_SBITONIC_KNAME;
+	if (clo_sort_get_stable(sorter))
+		return i == 0 ? CLO_SORT_SBITONIC_KNAME_STABLE
+			: CLO_SORT_SBITONIC_KNAME_STABLE_LOCAL;
+	else
+		return i == 0 ? CLO_SORT_SBITONIC_KNAME
+			: CLO_SORT_SBITONIC_KNAME_LOCAL;
 }
 
 /**
@@ -206,17 +367,18 @@ static const char* clo_sort_sbitonic_get_kernel_name(
 static size_t clo_sort_sbitonic_get_localmem_usage(CloSort* sorter,
 	cl_uint i, size_t lws_max, size_t numel, GError** err) {
 
-	/* i must be zero because there is only one kernel. */
-	g_return_val_if_fail(i == 0, 0);
+	/* Check that i is within bounds. */
+	g_return_val_if_fail(
+		i < clo_sort_sbitonic_get_num_kernels(sorter, err), 0);
 
 	/* Avoid compiler warnings. */
-	(void)sorter;
-	(void)lws_max;
 	(void)numel;
-	(void)err;
 
-	/* Simple bitonic sort doesn't use local memory. */
-	return 0;
+	/* The global memory kernel doesn't use local memory, while the
+	 * local memory kernel uses two elements (and, if stable, two
+	 * positions) per work-item. */
+	return i == 0 ? 0 : 2 * lws_max * (clo_sort_get_element_size(sorter)
+		+ (clo_sort_get_stable(sorter) ? sizeof(cl_uint) : 0));
 
 }
 
@@ -224,6 +386,8 @@ static size_t clo_sort_sbitonic_get_localmem_usage(CloSort* sorter,
 const CloSortImplDef clo_sort_sbitonic_def = {
 	"sbitonic",
 	CL_TRUE,
+	CL_TRUE,
+	CL_FALSE,
 	clo_sort_sbitonic_init,
 	clo_sort_sbitonic_finalize,
 	clo_sort_sbitonic_sort_with_device_data,
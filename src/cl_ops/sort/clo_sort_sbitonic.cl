@@ -68,3 +68,200 @@ __kernel void sbitonic(__global CLO_SORT_ELEM_TYPE *data,
 
 }
 
+/**
+ * A simple bitonic sort kernel which performs, in local memory, all
+ * the steps of a stage starting at the given step, as long as the
+ * pair stride of the given step is not larger than the local
+ * worksize. Each work-group handles `2 * lws` contiguous elements.
+ *
+ * @param[in,out] data Array of elements to sort.
+ * @param[in] stage Current bitonic sort stage.
+ * @param[in] step First bitonic sort step to perform.
+ * @param[in] data_local Local memory, two elements per work-item.
+ */
+__kernel void sbitonic_local(__global CLO_SORT_ELEM_TYPE *data,
+	const uint stage, const uint step,
+	__local CLO_SORT_ELEM_TYPE *data_local) {
+
+	/* Global and local ids for this work-item. */
+	uint gid = get_global_id(0);
+	uint lid = get_local_id(0);
+	uint lws = get_local_size(0);
+
+	/* Start of the block of elements handled by this work-group. */
+	uint start = get_group_id(0) * lws * 2;
+
+	/* Determine if ascending or descending. */
+	bool desc = (bool) (0x1 & (gid >> (stage - 1)));
+
+	/* Load elements into local memory. */
+	data_local[lid] = data[start + lid];
+	data_local[lid + lws] = data[start + lid + lws];
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for (uint curr_step = step; curr_step > 0; curr_step--) {
+
+		/* Determine what to compare and possibly swap. */
+		uint pair_stride = (uint) (1 << (curr_step - 1));
+		uint index1 = lid + (lid / pair_stride) * pair_stride;
+		uint index2 = index1 + pair_stride;
+
+		/* Get values from local memory. */
+		CLO_SORT_ELEM_TYPE data1 = data_local[index1];
+		CLO_SORT_ELEM_TYPE data2 = data_local[index2];
+
+		/* Determine keys. */
+		CLO_SORT_KEY_TYPE key1 = CLO_SORT_KEY_GET(data1);
+		CLO_SORT_KEY_TYPE key2 = CLO_SORT_KEY_GET(data2);
+
+		/* Perform swap if needed. */
+		if (CLO_SORT_COMPARE(key1, key2) ^ desc) {
+			data_local[index1] = data2;
+			data_local[index2] = data1;
+		}
+
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+
+	/* Store elements back in global memory. */
+	data[start + lid] = data_local[lid];
+	data[start + lid + lws] = data_local[lid + lws];
+
+}
+
+/**
+ * Determine if an element comes after another in a stable sort, i.e.
+ * using the original positions of the elements to break ties.
+ *
+ * @param[in] key1 Key of first element.
+ * @param[in] idx1 Original position of first element.
+ * @param[in] key2 Key of second element.
+ * @param[in] idx2 Original position of second element.
+ * @return True if the first element comes after the second one.
+ */
+bool sbitonic_stable_after(CLO_SORT_KEY_TYPE key1, uint idx1,
+	CLO_SORT_KEY_TYPE key2, uint idx2) {
+
+	return CLO_SORT_COMPARE(key1, key2)
+		|| ((!CLO_SORT_COMPARE(key2, key1)) && (idx1 > idx2));
+}
+
+/**
+ * A simple bitonic sort kernel, stable version. The original position
+ * of each element is kept in a separate buffer, and is used to break
+ * ties. In the first stage, positions are implicit, i.e. they are not
+ * read from the buffer.
+ *
+ * @param[in,out] data Array of elements to sort.
+ * @param[in,out] idx Original positions of elements.
+ * @param[in] stage Current bitonic sort stage.
+ * @param[in] step Current bitonic sort step.
+ */
+__kernel void sbitonic_stable(__global CLO_SORT_ELEM_TYPE *data,
+	__global uint *idx, const uint stage, const uint step) {
+
+	/* Global id for this work-item. */
+	uint gid = get_global_id(0);
+
+	/* Determine what to compare and possibly swap. */
+	uint pair_stride = (uint) (1 << (step - 1));
+	uint index1 = gid + (gid / pair_stride) * pair_stride;
+	uint index2 = index1 + pair_stride;
+
+	/* Get values from global memory. */
+	CLO_SORT_ELEM_TYPE data1 = data[index1];
+	CLO_SORT_ELEM_TYPE data2 = data[index2];
+
+	/* Get original positions. */
+	uint idx1 = (stage == 1) ? index1 : idx[index1];
+	uint idx2 = (stage == 1) ? index2 : idx[index2];
+
+	/* Determine keys. */
+	CLO_SORT_KEY_TYPE key1 = CLO_SORT_KEY_GET(data1);
+	CLO_SORT_KEY_TYPE key2 = CLO_SORT_KEY_GET(data2);
+
+	/* Determine if ascending or descending */
+	bool desc = (bool) (0x1 & (gid >> (stage - 1)));
+
+	/* Perform swap if needed. */
+	if (sbitonic_stable_after(key1, idx1, key2, idx2) ^ desc) {
+		data[index1] = data2;
+		data[index2] = data1;
+		idx[index1] = idx2;
+		idx[index2] = idx1;
+	} else if (stage == 1) {
+		idx[index1] = idx1;
+		idx[index2] = idx2;
+	}
+
+}
+
+/**
+ * Stable version of the sbitonic_local kernel.
+ *
+ * @param[in,out] data Array of elements to sort.
+ * @param[in,out] idx Original positions of elements.
+ * @param[in] stage Current bitonic sort stage.
+ * @param[in] step First bitonic sort step to perform.
+ * @param[in] data_local Local memory, two elements per work-item.
+ * @param[in] idx_local Local memory, two positions per work-item.
+ */
+__kernel void sbitonic_stable_local(__global CLO_SORT_ELEM_TYPE *data,
+	__global uint *idx, const uint stage, const uint step,
+	__local CLO_SORT_ELEM_TYPE *data_local, __local uint *idx_local) {
+
+	/* Global and local ids for this work-item. */
+	uint gid = get_global_id(0);
+	uint lid = get_local_id(0);
+	uint lws = get_local_size(0);
+
+	/* Start of the block of elements handled by this work-group. */
+	uint start = get_group_id(0) * lws * 2;
+
+	/* Determine if ascending or descending. */
+	bool desc = (bool) (0x1 & (gid >> (stage - 1)));
+
+	/* Load elements and their original positions into local
+	 * memory. */
+	data_local[lid] = data[start + lid];
+	data_local[lid + lws] = data[start + lid + lws];
+	idx_local[lid] = (stage == 1) ? start + lid : idx[start + lid];
+	idx_local[lid + lws] =
+		(stage == 1) ? start + lid + lws : idx[start + lid + lws];
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for (uint curr_step = step; curr_step > 0; curr_step--) {
+
+		/* Determine what to compare and possibly swap. */
+		uint pair_stride = (uint) (1 << (curr_step - 1));
+		uint index1 = lid + (lid / pair_stride) * pair_stride;
+		uint index2 = index1 + pair_stride;
+
+		/* Get values from local memory. */
+		CLO_SORT_ELEM_TYPE data1 = data_local[index1];
+		CLO_SORT_ELEM_TYPE data2 = data_local[index2];
+		uint idx1 = idx_local[index1];
+		uint idx2 = idx_local[index2];
+
+		/* Determine keys. */
+		CLO_SORT_KEY_TYPE key1 = CLO_SORT_KEY_GET(data1);
+		CLO_SORT_KEY_TYPE key2 = CLO_SORT_KEY_GET(data2);
+
+		/* Perform swap if needed. */
+		if (sbitonic_stable_after(key1, idx1, key2, idx2) ^ desc) {
+			data_local[index1] = data2;
+			data_local[index2] = data1;
+			idx_local[index1] = idx2;
+			idx_local[index2] = idx1;
+		}
+
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+
+	/* Store elements and positions back in global memory. */
+	data[start + lid] = data_local[lid];
+	data[start + lid + lws] = data_local[lid + lws];
+	idx[start + lid] = idx_local[lid];
+	idx[start + lid + lws] = idx_local[lid + lws];
+
+}
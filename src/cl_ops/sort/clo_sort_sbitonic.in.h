@@ -32,6 +32,17 @@
 /** The name of the simple bitonic sort kernel. */
 #define CLO_SORT_SBITONIC_KNAME "sbitonic"
 
+/** The name of the simple bitonic sort kernel which performs several
+ * steps in local memory. */
+#define CLO_SORT_SBITONIC_KNAME_LOCAL "sbitonic_local"
+
+/** The name of the stable simple bitonic sort kernel. */
+#define CLO_SORT_SBITONIC_KNAME_STABLE "sbitonic_stable"
+
+/** The name of the stable simple bitonic sort kernel which performs
+ * several steps in local memory. */
+#define CLO_SORT_SBITONIC_KNAME_STABLE_LOCAL "sbitonic_stable_local"
+
 /** Definition of the sbitonic sort implementation. */
 extern const CloSortImplDef clo_sort_sbitonic_def;
 
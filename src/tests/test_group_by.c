@@ -0,0 +1,242 @@
+/*
+ * This file is part of CL_Ops (C Framework for OpenCL).
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CL_Ops. If not, see <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Test the group-by class. Device results are checked against runs
+ * found in the host.
+ *
+ * @author Nuno Fachada
+ * @date 2016
+ * @copyright [GNU General Public License version 3 (GPLv3)](http://www.gnu.org/licenses/gpl.html)
+ * */
+
+#include <cl_ops.h>
+#include <string.h>
+
+#define CLO_GROUP_BY_TEST_SEED 1234
+
+/* Number of keys: empty, single key and non-power of two sizes. */
+static const size_t clo_group_by_test_sizes[] =
+	{ 0, 1, 3, 1000, 4099, 65537 };
+
+/* Probability (in percentage) of a key starting a new run: all keys
+ * equal, duplicate-heavy, short runs and all keys distinct. */
+static const gint32 clo_group_by_test_new_run[] = { 0, 2, 50, 100 };
+
+/* Reduction operators and their identities, with the equivalent host
+ * operator. */
+static const struct {
+	const char* op;
+	const char* identity;
+	cl_bool max;
+} clo_group_by_test_ops[] = {
+	{ NULL, NULL, CL_FALSE },
+	{ "max((a), (b))", "0", CL_TRUE }
+};
+
+/**
+ * Read the number of runs from the device and check it.
+ * */
+static void clo_group_by_test_count(CCLQueue* cq, CCLBuffer* count_dev,
+	size_t expected) {
+
+	GError* err = NULL;
+	cl_uint count;
+
+	ccl_buffer_enqueue_read(count_dev, cq, CL_TRUE, 0, sizeof(cl_uint),
+		&count, NULL, &err);
+	g_assert_no_error(err);
+	g_assert_cmpuint(count, ==, expected);
+}
+
+/**
+ * Read the given number of elements from the device and compare them
+ * with the expected elements.
+ * */
+static void clo_group_by_test_read(CCLQueue* cq, CCLBuffer* buf,
+	cl_uint* expected, size_t num) {
+
+	GError* err = NULL;
+	cl_uint* result = g_new(cl_uint, MAX(num, 1));
+
+	if (num > 0) {
+		ccl_buffer_enqueue_read(buf, cq, CL_TRUE, 0,
+			num * sizeof(cl_uint), result, NULL, &err);
+		g_assert_no_error(err);
+		g_assert(memcmp(result, expected, num * sizeof(cl_uint)) == 0);
+	}
+
+	g_free(result);
+}
+
+/**
+ * Test unique, run-length encoding and reduce-by-key of sorted keys,
+ * with several run lengths and reduction operators.
+ * */
+static void group_by_test() {
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq = NULL;
+	CCLBuffer* keys_dev = NULL;
+	CCLBuffer* vals_dev = NULL;
+	CCLBuffer* out1_dev = NULL;
+	CCLBuffer* out2_dev = NULL;
+	CCLBuffer* count_dev = NULL;
+	CloGroupBy* grp = NULL;
+	CloType val_type = CLO_UINT;
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_GROUP_BY_TEST_SEED);
+
+	/* Get context, device and command queue. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+	cq = ccl_queue_new(ctx, dev, 0, &err);
+	g_assert_no_error(err);
+
+	count_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, sizeof(cl_uint),
+		NULL, &err);
+	g_assert_no_error(err);
+
+	for (guint o = 0; o < G_N_ELEMENTS(clo_group_by_test_ops); ++o) {
+
+		grp = clo_group_by_new(ctx, CLO_UINT, &val_type, NULL,
+			clo_group_by_test_ops[o].op,
+			clo_group_by_test_ops[o].identity, NULL, NULL, &err);
+		g_assert_no_error(err);
+
+		for (guint s = 0; s < G_N_ELEMENTS(clo_group_by_test_sizes);
+			++s) {
+
+			size_t numel = clo_group_by_test_sizes[s];
+			size_t size = MAX(numel, 1) * sizeof(cl_uint);
+			cl_uint* keys = g_malloc(size);
+			cl_uint* vals = g_malloc(size);
+			cl_uint* ukeys = g_malloc(size);
+			cl_uint* lengths = g_malloc(size);
+			cl_uint* reds = g_malloc(size);
+
+			keys_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, size, NULL,
+				&err);
+			g_assert_no_error(err);
+			vals_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, size, NULL,
+				&err);
+			g_assert_no_error(err);
+			out1_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, size, NULL,
+				&err);
+			g_assert_no_error(err);
+			out2_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, size, NULL,
+				&err);
+			g_assert_no_error(err);
+
+			for (guint r = 0; r < G_N_ELEMENTS(clo_group_by_test_new_run);
+				++r) {
+
+				size_t num_runs = 0;
+
+				/* Sorted keys and their runs. */
+				for (size_t i = 0; i < numel; ++i) {
+					cl_bool head = (i == 0) || (g_rand_int_range(rng, 0, 100)
+						< clo_group_by_test_new_run[r]);
+					keys[i] = (i == 0) ? 0 : keys[i - 1] + (head ? 1 : 0);
+					vals[i] = g_rand_int_range(rng, 0, 1000);
+					if (head) {
+						ukeys[num_runs] = keys[i];
+						lengths[num_runs] = 0;
+						reds[num_runs] = 0;
+						num_runs++;
+					}
+					lengths[num_runs - 1]++;
+					reds[num_runs - 1] = clo_group_by_test_ops[o].max
+						? MAX(reds[num_runs - 1], vals[i])
+						: reds[num_runs - 1] + vals[i];
+				}
+
+				if (numel > 0) {
+					ccl_buffer_enqueue_write(keys_dev, cq, CL_TRUE, 0,
+						numel * sizeof(cl_uint), keys, NULL, &err);
+					g_assert_no_error(err);
+					ccl_buffer_enqueue_write(vals_dev, cq, CL_TRUE, 0,
+						numel * sizeof(cl_uint), vals, NULL, &err);
+					g_assert_no_error(err);
+				}
+
+				/* Unique. */
+				clo_unique(grp, cq, NULL, keys_dev, out1_dev, count_dev,
+					numel, 0, &err);
+				g_assert_no_error(err);
+				clo_group_by_test_count(cq, count_dev, num_runs);
+				clo_group_by_test_read(cq, out1_dev, ukeys, num_runs);
+
+				/* Run-length encoding. */
+				clo_run_length_encode(grp, cq, NULL, keys_dev, out1_dev,
+					out2_dev, count_dev, numel, 0, &err);
+				g_assert_no_error(err);
+				clo_group_by_test_count(cq, count_dev, num_runs);
+				clo_group_by_test_read(cq, out1_dev, ukeys, num_runs);
+				clo_group_by_test_read(cq, out2_dev, lengths, num_runs);
+
+				/* Reduce-by-key. */
+				clo_reduce_by_key(grp, cq, NULL, keys_dev, vals_dev,
+					out1_dev, out2_dev, count_dev, numel, 0, &err);
+				g_assert_no_error(err);
+				clo_group_by_test_count(cq, count_dev, num_runs);
+				clo_group_by_test_read(cq, out1_dev, ukeys, num_runs);
+				clo_group_by_test_read(cq, out2_dev, reds, num_runs);
+			}
+
+			ccl_buffer_destroy(keys_dev);
+			ccl_buffer_destroy(vals_dev);
+			ccl_buffer_destroy(out1_dev);
+			ccl_buffer_destroy(out2_dev);
+			g_free(keys);
+			g_free(vals);
+			g_free(ukeys);
+			g_free(lengths);
+			g_free(reds);
+		}
+
+		clo_group_by_destroy(grp);
+	}
+
+	/* Free stuff. */
+	ccl_buffer_destroy(count_dev);
+	g_rand_free(rng);
+	ccl_queue_destroy(cq);
+	ccl_context_destroy(ctx);
+}
+
+/**
+ * Main function.
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Command line arguments.
+ * @return Result of test run.
+ * */
+int main(int argc, char** argv) {
+
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func(
+		"/group-by/sorted",
+		group_by_test);
+
+	return g_test_run();
+}
@@ -0,0 +1,220 @@
+/*
+ * This file is part of CL_Ops (C Framework for OpenCL).
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CL_Ops. If not, see <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Test the histogram class. Device results are checked against
+ * histograms computed in the host.
+ *
+ * @author Nuno Fachada
+ * @date 2016
+ * @copyright [GNU General Public License version 3 (GPLv3)](http://www.gnu.org/licenses/gpl.html)
+ * */
+
+#include <cl_ops.h>
+#include <string.h>
+
+#define CLO_HISTOGRAM_TEST_SEED 1234
+
+/* Number of elements to bin: empty, single element and non-power of
+ * two sizes. */
+static const size_t clo_histogram_test_sizes[] =
+	{ 0, 1, 3, 1000, 4099, 65537 };
+
+/* Histogram options: both paths, with one bin count which fits in
+ * local memory and one which requires the sort-based path, and the
+ * sort-based path with sort algorithms which only sort powers of two,
+ * for which the sorted bins are padded. */
+static const struct {
+	const char* options;
+	cl_uint num_bins;
+} clo_histogram_test_cfgs[] = {
+	{ "path=local", 37 },
+	{ "path=sort", 37 },
+	{ "path=sort", 100003 },
+	{ "path=sort,sort=sbitonic", 37 },
+	{ "path=sort,sort=abitonic", 100003 },
+	{ NULL, 100003 }
+};
+
+/**
+ * Compute the histogram in the device and check it against the given
+ * expected histogram.
+ * */
+static void clo_histogram_test_check(CloHistogram* hist, CCLQueue* cq,
+	void* data, cl_uint* expected, size_t numel) {
+
+	GError* err = NULL;
+	cl_uint num_bins = clo_histogram_get_num_bins(hist);
+	cl_uint* counts = g_new0(cl_uint, num_bins);
+
+	clo_histogram_with_host_data(hist, cq, NULL, data, counts, numel, 0,
+		&err);
+	g_assert_no_error(err);
+	g_assert(memcmp(counts, expected, num_bins * sizeof(cl_uint)) == 0);
+
+	g_free(counts);
+}
+
+/**
+ * Test histograms of unsigned integers, with random and duplicate-heavy
+ * data, and with elements which fall outside the bins.
+ * */
+static void uint_test() {
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq = NULL;
+	CloHistogram* hist = NULL;
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_HISTOGRAM_TEST_SEED);
+
+	/* Get context, device and command queue. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+	cq = ccl_queue_new(ctx, dev, 0, &err);
+	g_assert_no_error(err);
+
+	for (guint c = 0; c < G_N_ELEMENTS(clo_histogram_test_cfgs); ++c) {
+
+		cl_uint num_bins = clo_histogram_test_cfgs[c].num_bins;
+		cl_uint* expected = g_new(cl_uint, num_bins);
+
+		/* Elements in the last tenth of the range are not counted. */
+		hist = clo_histogram_new(ctx, CLO_UINT, num_bins,
+			"((x) % (CLO_HISTOGRAM_NUM_BINS + CLO_HISTOGRAM_NUM_BINS / 10))",
+			clo_histogram_test_cfgs[c].options, NULL, &err);
+		g_assert_no_error(err);
+
+		for (guint s = 0; s < G_N_ELEMENTS(clo_histogram_test_sizes);
+			++s) {
+
+			size_t numel = clo_histogram_test_sizes[s];
+			cl_uint* data = g_new(cl_uint, MAX(numel, 1));
+
+			/* Random and duplicate-heavy data. */
+			for (guint dups = 0; dups < 2; ++dups) {
+				memset(expected, 0, num_bins * sizeof(cl_uint));
+				for (size_t i = 0; i < numel; ++i) {
+					cl_uint bin;
+					data[i] = dups
+						? (cl_uint) g_rand_int_range(rng, 0, 4) * 7
+						: g_rand_int(rng);
+					bin = data[i] % (num_bins + num_bins / 10);
+					if (bin < num_bins) expected[bin]++;
+				}
+				clo_histogram_test_check(
+					hist, cq, data, expected, numel);
+			}
+
+			g_free(data);
+		}
+
+		clo_histogram_destroy(hist);
+		g_free(expected);
+	}
+
+	/* Free stuff. */
+	g_rand_free(rng);
+	ccl_queue_destroy(cq);
+	ccl_context_destroy(ctx);
+}
+
+/**
+ * Test histograms of floats with negative bins, which must not be
+ * counted.
+ * */
+static void float_test() {
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq = NULL;
+	CloHistogram* hist = NULL;
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_HISTOGRAM_TEST_SEED);
+	const cl_uint num_bins = 8;
+	cl_uint expected[8];
+	const char* options[] = { "path=local", "path=sort" };
+
+	/* Get context, device and command queue. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+	cq = ccl_queue_new(ctx, dev, 0, &err);
+	g_assert_no_error(err);
+
+	for (guint o = 0; o < G_N_ELEMENTS(options); ++o) {
+
+		/* Bins floats in [0, 1), values in [-1, 0) and [1, 1.5) are not
+		 * counted. */
+		hist = clo_histogram_new(ctx, CLO_FLOAT, num_bins,
+			"((x) * 8.0f)", options[o], NULL, &err);
+		g_assert_no_error(err);
+
+		for (guint s = 0; s < G_N_ELEMENTS(clo_histogram_test_sizes);
+			++s) {
+
+			size_t numel = clo_histogram_test_sizes[s];
+			cl_float* data = g_new(cl_float, MAX(numel, 1));
+
+			memset(expected, 0, sizeof(expected));
+			for (size_t i = 0; i < numel; ++i) {
+				cl_float bin;
+				data[i] = (cl_float) g_rand_double_range(rng, -1.0, 1.5);
+				bin = data[i] * 8.0f;
+				if ((bin >= 0) && (bin < num_bins))
+					expected[(cl_uint) bin]++;
+			}
+			clo_histogram_test_check(hist, cq, data, expected, numel);
+
+			g_free(data);
+		}
+
+		clo_histogram_destroy(hist);
+	}
+
+	/* Free stuff. */
+	g_rand_free(rng);
+	ccl_queue_destroy(cq);
+	ccl_context_destroy(ctx);
+}
+
+/**
+ * Main function.
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Command line arguments.
+ * @return Result of test run.
+ * */
+int main(int argc, char** argv) {
+
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func(
+		"/histogram/uint",
+		uint_test);
+
+	g_test_add_func(
+		"/histogram/float",
+		float_test);
+
+	return g_test_run();
+}
@@ -133,6 +133,156 @@ static void seed_dev_gid_test() {
 
 }
 
+/**
+ * Test RNG with GID-based device generated seeds, initialized from the
+ * client program.
+ * */
+static void seed_dev_gid_fused_test() {
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq = NULL;
+	CCLProgram* prg = NULL;
+	CCLKernel* krnl = NULL;
+	CCLBuffer* seeds_dev = NULL;
+	CCLBuffer* output_dev = NULL;
+	GError* err = NULL;
+	CloRng* rng = NULL;
+	CloRng* rng_ref = NULL;
+	size_t lws = 0;
+	size_t ws = CLO_RNG_TEST_NUM_SEEDS;
+	size_t seeds_size;
+	cl_uchar* seeds_host = NULL;
+	cl_uchar* seeds_ref = NULL;
+	cl_ulong* output_host = NULL;
+	cl_ulong* output_ref = NULL;
+	gchar* src;
+
+	/* Get context and device. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+
+	/* Create command queue. */
+	cq = ccl_queue_new(ctx, dev, 0, &err);
+	g_assert_no_error(err);
+
+	/* Host buffers for outputs. */
+	output_host = g_new(cl_ulong, CLO_RNG_TEST_NUM_SEEDS);
+	output_ref = g_new(cl_ulong, CLO_RNG_TEST_NUM_SEEDS);
+
+	/* Test all RNGs. */
+	for (cl_uint i = 0; clo_rng_infos[i].name != NULL; ++i) {
+
+		/* Create RNG object. */
+		rng = clo_rng_new(clo_rng_infos[i].name, CLO_RNG_SEED_DEV_GID_FUSED,
+			NULL, CLO_RNG_TEST_NUM_SEEDS, CLO_RNG_TEST_INIT_SEED,
+			CLO_RNG_TEST_HASH, ctx, cq, &err);
+		g_assert_no_error(err);
+
+		/* Create reference RNG object, with seeds initialized by a
+		 * separate program, which must yield the same seeds. */
+		rng_ref = clo_rng_new(clo_rng_infos[i].name, CLO_RNG_SEED_DEV_GID,
+			NULL, CLO_RNG_TEST_NUM_SEEDS, CLO_RNG_TEST_INIT_SEED,
+			CLO_RNG_TEST_HASH, ctx, cq, &err);
+		g_assert_no_error(err);
+
+		/* Get RNG seeds device buffer. */
+		seeds_dev = clo_rng_get_device_seeds(rng);
+
+		/* Get RNG kernels source. */
+		src = g_strconcat(
+			clo_rng_get_source(rng), CLO_RNG_TEST_SRC, NULL);
+
+		/* Create and build program. */
+		prg = ccl_program_new_from_source(ctx, src, &err);
+		g_assert_no_error(err);
+
+		ccl_program_build(prg, NULL, &err);
+		g_assert_no_error(err);
+
+		/* Initialize seeds using the client program. */
+		clo_rng_init_seeds(rng, prg, cq, &err);
+		g_assert_no_error(err);
+
+		/* Check that seeds are the same as the reference seeds. */
+		seeds_size = clo_rng_get_size(rng);
+		g_assert_cmpuint(seeds_size, ==, clo_rng_get_size(rng_ref));
+		seeds_host = g_malloc(seeds_size);
+		seeds_ref = g_malloc(seeds_size);
+		ccl_buffer_enqueue_read(seeds_dev, cq, CL_TRUE, 0, seeds_size,
+			seeds_host, NULL, &err);
+		g_assert_no_error(err);
+		ccl_buffer_enqueue_read(clo_rng_get_device_seeds(rng_ref), cq,
+			CL_TRUE, 0, seeds_size, seeds_ref, NULL, &err);
+		g_assert_no_error(err);
+		g_assert(memcmp(seeds_host, seeds_ref, seeds_size) == 0);
+
+		/* Create output buffer. */
+		output_dev = ccl_buffer_new(ctx, CL_MEM_WRITE_ONLY,
+			CLO_RNG_TEST_NUM_SEEDS * sizeof(cl_ulong), NULL, &err);
+		g_assert_no_error(err);
+
+		/* Get kernel from program. */
+		krnl = ccl_program_get_kernel(prg, CLO_RNG_TEST_KERNEL, &err);
+		g_assert_no_error(err);
+
+		/* Get a "nice" local worksize. */
+		ccl_kernel_suggest_worksizes(
+			krnl, dev, 1, &ws, NULL, &lws, &err);
+		g_assert_no_error(err);
+
+		/* Execute kernel with fused seeds and with reference seeds,
+		 * which must produce the same first outputs. */
+		ccl_kernel_set_args_and_enqueue_ndrange(
+			krnl, cq, 1, NULL, &ws, &lws, NULL, &err,
+			seeds_dev, output_dev, NULL);
+		g_assert_no_error(err);
+		ccl_buffer_enqueue_read(output_dev, cq, CL_TRUE, 0,
+			CLO_RNG_TEST_NUM_SEEDS * sizeof(cl_ulong), output_host,
+			NULL, &err);
+		g_assert_no_error(err);
+
+		ccl_kernel_set_args_and_enqueue_ndrange(
+			krnl, cq, 1, NULL, &ws, &lws, NULL, &err,
+			clo_rng_get_device_seeds(rng_ref), output_dev, NULL);
+		g_assert_no_error(err);
+		ccl_buffer_enqueue_read(output_dev, cq, CL_TRUE, 0,
+			CLO_RNG_TEST_NUM_SEEDS * sizeof(cl_ulong), output_ref,
+			NULL, &err);
+		g_assert_no_error(err);
+
+		g_assert(memcmp(output_host, output_ref,
+			CLO_RNG_TEST_NUM_SEEDS * sizeof(cl_ulong)) == 0);
+
+		/* Release this iteration stuff. */
+		g_free(src);
+		g_free(seeds_host);
+		g_free(seeds_ref);
+		ccl_buffer_destroy(output_dev);
+		ccl_program_destroy(prg);
+		clo_rng_destroy(rng);
+		clo_rng_destroy(rng_ref);
+
+	}
+
+	/* Free host buffers. */
+	g_free(output_host);
+	g_free(output_ref);
+
+	/* Destroy queue and context. */
+	ccl_queue_destroy(cq);
+	ccl_context_destroy(ctx);
+
+	/* Confirm that memory allocated by wrappers has been properly
+	 * freed. */
+	g_assert(ccl_wrapper_memcheck());
+
+}
+
 /**
  * Test RNG with Mersenne Twister host generated seeds.
  * */
@@ -258,9 +408,11 @@ static void seed_ext_dev_test() {
 	/* Test all RNGs. */
 	for (cl_uint i = 0; clo_rng_infos[i].name != NULL; ++i) {
 
-		/* Host seeds must account for the seed size of current RNG. */
-		size_t seed_size =
-			clo_rng_infos[i].seed_size * CLO_RNG_TEST_NUM_SEEDS;
+		/* Host seeds must account for the seed size and block size of
+		 * current RNG. */
+		size_t seed_size = clo_rng_infos[i].seed_size
+			* CLO_DIV_CEIL(CLO_RNG_TEST_NUM_SEEDS, clo_rng_infos[i].block_size)
+			* clo_rng_infos[i].block_size;
 		host_seeds = g_slice_alloc(seed_size);
 
 		/* Initialize host seeds with any value. */
@@ -364,9 +516,11 @@ static void seed_ext_host_test() {
 	/* Test all RNGs. */
 	for (cl_uint i = 0; clo_rng_infos[i].name != NULL; ++i) {
 
-		/* Host seeds must account for the seed size of current RNG. */
-		size_t seed_size =
-			clo_rng_infos[i].seed_size * CLO_RNG_TEST_NUM_SEEDS;
+		/* Host seeds must account for the seed size and block size of
+		 * current RNG. */
+		size_t seed_size = clo_rng_infos[i].seed_size
+			* CLO_DIV_CEIL(CLO_RNG_TEST_NUM_SEEDS, clo_rng_infos[i].block_size)
+			* clo_rng_infos[i].block_size;
 		host_seeds = g_slice_alloc(seed_size);
 
 		/* Initialize host seeds with any value. */
@@ -432,6 +586,112 @@ static void seed_ext_host_test() {
 
 }
 
+/**
+ * Test resizing of RNG seeds, which should keep existing seeds and
+ * initialize new seeds as if the RNG had been created with the final
+ * number of seeds.
+ * */
+static void resize_test() {
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq = NULL;
+	GError* err = NULL;
+	CloRng* rng_full = NULL;
+	CloRng* rng_grown = NULL;
+	CloRngSeedType seed_types[] =
+		{ CLO_RNG_SEED_DEV_GID, CLO_RNG_SEED_HOST_MT };
+	size_t seeds_size;
+	size_t capacity;
+	cl_uchar* seeds_full;
+	cl_uchar* seeds_grown;
+
+	/* Get context and device. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+
+	/* Create command queue. */
+	cq = ccl_queue_new(ctx, dev, 0, &err);
+	g_assert_no_error(err);
+
+	/* Test all RNGs with both internally initialized seed types. */
+	for (cl_uint i = 0; clo_rng_infos[i].name != NULL; ++i) {
+		for (cl_uint j = 0; j < 2; ++j) {
+
+			/* Create RNG object with the final number of seeds. */
+			rng_full = clo_rng_new(clo_rng_infos[i].name, seed_types[j],
+				NULL, CLO_RNG_TEST_NUM_SEEDS, CLO_RNG_TEST_INIT_SEED,
+				CLO_RNG_TEST_HASH, ctx, cq, &err);
+			g_assert_no_error(err);
+
+			/* Create RNG object with less seeds, shrink it, then
+			 * grow it to the final number of seeds. */
+			rng_grown = clo_rng_new(clo_rng_infos[i].name,
+				seed_types[j], NULL, CLO_RNG_TEST_NUM_SEEDS / 4,
+				CLO_RNG_TEST_INIT_SEED, CLO_RNG_TEST_HASH, ctx, cq,
+				&err);
+			g_assert_no_error(err);
+			capacity = clo_rng_get_capacity(rng_grown);
+
+			clo_rng_resize(rng_grown, CLO_RNG_TEST_NUM_SEEDS / 8, cq,
+				&err);
+			g_assert_no_error(err);
+			g_assert_cmpuint(clo_rng_get_capacity(rng_grown), ==,
+				capacity);
+
+			clo_rng_resize(rng_grown, CLO_RNG_TEST_NUM_SEEDS / 3, cq,
+				&err);
+			g_assert_no_error(err);
+			g_assert_cmpuint(clo_rng_get_capacity(rng_grown), ==,
+				2 * capacity);
+
+			clo_rng_resize(rng_grown, CLO_RNG_TEST_NUM_SEEDS, cq,
+				&err);
+			g_assert_no_error(err);
+
+			/* Check sizes. */
+			seeds_size = clo_rng_get_size(rng_full);
+			g_assert_cmpuint(seeds_size, ==,
+				clo_rng_get_size(rng_grown));
+
+			/* Read seeds from both RNG objects. */
+			seeds_full = g_slice_alloc(seeds_size);
+			seeds_grown = g_slice_alloc(seeds_size);
+
+			ccl_buffer_enqueue_read(clo_rng_get_device_seeds(rng_full),
+				cq, CL_TRUE, 0, seeds_size, seeds_full, NULL, &err);
+			g_assert_no_error(err);
+
+			ccl_buffer_enqueue_read(clo_rng_get_device_seeds(rng_grown),
+				cq, CL_TRUE, 0, seeds_size, seeds_grown, NULL, &err);
+			g_assert_no_error(err);
+
+			/* Seeds must be the same. */
+			g_assert(memcmp(seeds_full, seeds_grown, seeds_size) == 0);
+
+			/* Release this iteration stuff. */
+			g_slice_free1(seeds_size, seeds_full);
+			g_slice_free1(seeds_size, seeds_grown);
+			clo_rng_destroy(rng_full);
+			clo_rng_destroy(rng_grown);
+
+		}
+	}
+
+	/* Destroy queue and context. */
+	ccl_queue_destroy(cq);
+	ccl_context_destroy(ctx);
+
+	/* Confirm that memory allocated by wrappers has been properly
+	 * freed. */
+	g_assert(ccl_wrapper_memcheck());
+
+}
+
 
 /**
  * Main function.
@@ -447,6 +707,10 @@ int main(int argc, char** argv) {
 		"/rng/seed-dev-gid",
 		seed_dev_gid_test);
 
+	g_test_add_func(
+		"/rng/seed-dev-gid-fused",
+		seed_dev_gid_fused_test);
+
 	g_test_add_func(
 		"/rng/seed-host-mt",
 		seed_host_mt_test);
@@ -459,6 +723,10 @@ int main(int argc, char** argv) {
 		"/rng/seed-ext-host",
 		seed_ext_host_test);
 
+	g_test_add_func(
+		"/rng/resize",
+		resize_test);
+
 	return g_test_run();
 }
 
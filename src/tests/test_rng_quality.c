@@ -0,0 +1,571 @@
+/*
+ * This file is part of CL_Ops (C Framework for OpenCL).
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CL_Ops. If not, see <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Test the statistical quality and throughput of the RNGs. Numbers are
+ * read directly from device buffers and submitted to a chi-square test,
+ * a serial correlation test, a birthday spacings test and a gap test.
+ * Each generator/seed combination is registered as a separate test
+ * path, `/rng-quality/<rng>/<seed>`. Throughput in GB/s is reported
+ * with g_test_maximized_result() (visible with `-m perf` or
+ * `--verbose`).
+ *
+ * Each workitem produces a stream of numbers, and streams are
+ * concatenated before being tested. The first numbers of each stream
+ * are discarded, since seeds are obtained with simple hashes.
+ *
+ * @author Nuno Fachada
+ * @date 2016
+ * @copyright [GNU General Public License version 3 (GPLv3)](http://www.gnu.org/licenses/gpl.html)
+ * */
+
+#include <cl_ops.h>
+#include <math.h>
+
+#define CLO_RNG_QUALITY_KERNEL "clo_rng_quality"
+#define CLO_RNG_THROUGHPUT_KERNEL "clo_rng_throughput"
+#define CLO_RNG_QUALITY_SRC \
+	"__kernel void " CLO_RNG_QUALITY_KERNEL "(" \
+	"		__global clo_statetype* seeds, __global uint* output," \
+	"		const uint warmup, const uint count) {" \
+	"	uint gid = get_global_id(0);" \
+	"	for (uint i = 0; i < warmup; ++i) clo_rng_next(seeds, gid);" \
+	"	for (uint i = 0; i < count; ++i)" \
+	"		output[gid * count + i] = clo_rng_next(seeds, gid);" \
+	"}" \
+	"__kernel void " CLO_RNG_THROUGHPUT_KERNEL "(" \
+	"		__global clo_statetype* seeds, __global uint* output," \
+	"		const uint count) {" \
+	"	uint gid = get_global_id(0);" \
+	"	uint gsize = get_global_size(0);" \
+	"	for (uint i = 0; i < count; ++i)" \
+	"		output[i * gsize + gid] = clo_rng_next(seeds, gid);" \
+	"}"
+
+/* Number of workitems (streams) for quality tests. */
+#define CLO_RNG_QUALITY_WORKITEMS 4096
+/* Numbers discarded at the start of each stream. */
+#define CLO_RNG_QUALITY_WARMUP 16
+/* Numbers tested per stream. */
+#define CLO_RNG_QUALITY_PER_WORKITEM 64
+/* Total numbers tested. */
+#define CLO_RNG_QUALITY_NUMEL \
+	(CLO_RNG_QUALITY_WORKITEMS * CLO_RNG_QUALITY_PER_WORKITEM)
+
+/* Number of workitems for throughput measurement. */
+#define CLO_RNG_THROUGHPUT_WORKITEMS 65536
+/* Numbers generated per workitem in each throughput run. */
+#define CLO_RNG_THROUGHPUT_PER_WORKITEM 64
+/* Number of throughput runs. */
+#define CLO_RNG_THROUGHPUT_RUNS 10
+
+/* Base seed. */
+#define CLO_RNG_QUALITY_INIT_SEED 1234
+
+/* A test fails if its p-value is smaller than this value. Suspiciously
+ * good fits are not rejected, since GID-based seeds of some generators
+ * yield overly regular, but otherwise correct, frequencies. */
+#define CLO_RNG_QUALITY_ALPHA 1e-6
+
+/* Chi-square test: number of bins, using the most significant bits. */
+#define CLO_RNG_CHISQ_BITS 8
+
+/* Birthday spacings test: number of days (2^24), birthdays per sample
+ * and resulting lambda parameter of the Poisson distribution. */
+#define CLO_RNG_BDAY_BITS 24
+#define CLO_RNG_BDAY_N 512
+#define CLO_RNG_BDAY_LAMBDA 2.0
+/* Birthday spacings test: number of Poisson bins (last is for 5 or
+ * more duplicate spacings). */
+#define CLO_RNG_BDAY_BINS 6
+
+/* Gap test: values in [0, 0.5) are marked, gaps of length 10 or more
+ * are counted together. */
+#define CLO_RNG_GAP_BETA 0.5
+#define CLO_RNG_GAP_T 10
+
+/**
+ * Seed configuration under test.
+ * */
+struct clo_rng_quality_seed {
+
+	/** Name used in test path. */
+	const char* name;
+
+	/** Type of seed. */
+	CloRngSeedType seed_type;
+
+	/** Seed hash, if any. */
+	const char* hash;
+};
+
+/**
+ * Seed configurations under test.
+ * */
+static const struct clo_rng_quality_seed clo_rng_quality_seeds[] = {
+	{"host-mt", CLO_RNG_SEED_HOST_MT, NULL},
+	{"gid-knuth", CLO_RNG_SEED_DEV_GID, "KNUTH(x)"},
+	{"gid-xs1", CLO_RNG_SEED_DEV_GID, "XS1(x)"},
+	{"gid-fused", CLO_RNG_SEED_DEV_GID_FUSED, "KNUTH(x)"},
+	{NULL, 0, NULL}
+};
+
+/**
+ * Generator/seed combination under test.
+ * */
+struct clo_rng_quality_case {
+
+	/** Generator. */
+	const struct clo_rng_info* rng;
+
+	/** Seed configuration. */
+	const struct clo_rng_quality_seed* seed;
+};
+
+/**
+ * Regularized upper incomplete gamma function, Q(a, x), using a series
+ * expansion for x < a + 1 and a continued fraction otherwise.
+ *
+ * @param[in] a Parameter a > 0.
+ * @param[in] x Parameter x >= 0.
+ * @return The value of Q(a, x).
+ * */
+static double clo_rng_quality_igamc(double a, double x) {
+
+	double gln = lgamma(a);
+
+	if (x <= 0) return 1.0;
+
+	if (x < a + 1) {
+
+		/* Series expansion of P(a, x). */
+		double ap = a, del = 1.0 / a, sum = del;
+		for (int n = 0; n < 1000; ++n) {
+			ap += 1;
+			del *= x / ap;
+			sum += del;
+			if (fabs(del) < fabs(sum) * 1e-15) break;
+		}
+		return 1.0 - sum * exp(-x + a * log(x) - gln);
+
+	} else {
+
+		/* Continued fraction for Q(a, x) (modified Lentz). */
+		double b = x + 1 - a, c = 1.0 / 1e-300, d = 1.0 / b, h = d;
+		for (int i = 1; i < 1000; ++i) {
+			double an = -i * (i - a);
+			b += 2;
+			d = an * d + b;
+			if (fabs(d) < 1e-300) d = 1e-300;
+			c = b + an / c;
+			if (fabs(c) < 1e-300) c = 1e-300;
+			d = 1.0 / d;
+			h *= d * c;
+			if (fabs(d * c - 1) < 1e-15) break;
+		}
+		return exp(-x + a * log(x) - gln) * h;
+	}
+}
+
+/**
+ * Perform a chi-square goodness-of-fit test.
+ *
+ * @param[in] observed Observed counts.
+ * @param[in] expected Expected counts.
+ * @param[in] bins Number of bins.
+ * @return The p-value of the test.
+ * */
+static double clo_rng_quality_chisq(const double* observed,
+	const double* expected, guint bins) {
+
+	double chisq = 0;
+
+	for (guint i = 0; i < bins; ++i) {
+		double d = observed[i] - expected[i];
+		chisq += d * d / expected[i];
+	}
+
+	return clo_rng_quality_igamc((bins - 1) / 2.0, chisq / 2.0);
+}
+
+/**
+ * Chi-square test on the frequency of the most significant bits.
+ *
+ * @param[in] x Numbers to test.
+ * @param[in] n Number of numbers to test.
+ * @return The p-value of the test.
+ * */
+static double clo_rng_quality_test_freq(const cl_uint* x, size_t n) {
+
+	guint bins = 1 << CLO_RNG_CHISQ_BITS;
+	double* observed = g_new0(double, bins);
+	double* expected = g_new(double, bins);
+	double p;
+
+	for (size_t i = 0; i < n; ++i)
+		observed[x[i] >> (32 - CLO_RNG_CHISQ_BITS)] += 1;
+	for (guint i = 0; i < bins; ++i)
+		expected[i] = ((double) n) / bins;
+
+	p = clo_rng_quality_chisq(observed, expected, bins);
+
+	g_free(observed);
+	g_free(expected);
+	return p;
+}
+
+/**
+ * Serial correlation test (Knuth, TAOCP vol. 2, 3.3.2.K). The serial
+ * correlation coefficient is approximately normal with mean
+ * -1/(n - 1) and standard deviation sqrt(n(n - 3)/(n + 1))/(n - 1).
+ *
+ * @param[in] x Numbers to test.
+ * @param[in] n Number of numbers to test.
+ * @return The p-value of the test.
+ * */
+static double clo_rng_quality_test_serial(const cl_uint* x, size_t n) {
+
+	double sum = 0, sum_sq = 0, sum_uv = 0;
+	double c, mu, sigma;
+
+	for (size_t i = 0; i < n; ++i) {
+		double u = x[i] / 4294967296.0;
+		double v = x[(i + 1) % n] / 4294967296.0;
+		sum += u;
+		sum_sq += u * u;
+		sum_uv += u * v;
+	}
+
+	c = (n * sum_uv - sum * sum) / (n * sum_sq - sum * sum);
+	mu = -1.0 / (n - 1);
+	sigma = sqrt(n * (n - 3.0) / (n + 1.0)) / (n - 1.0);
+
+	return erfc(fabs(c - mu) / sigma / sqrt(2.0));
+}
+
+/**
+ * Compare two unsigned integers, for qsort().
+ *
+ * @param[in] a First integer.
+ * @param[in] b Second integer.
+ * @return Negative, zero or positive if a is smaller, equal or larger
+ * than b, respectively.
+ * */
+static int clo_rng_quality_cmp(const void* a, const void* b) {
+
+	cl_uint ua = *((const cl_uint*) a), ub = *((const cl_uint*) b);
+	return (ua > ub) - (ua < ub);
+}
+
+/**
+ * Birthday spacings test (Marsaglia). In each sample, birthdays are
+ * the most significant bits of each number. The number of duplicate
+ * spacings between sorted birthdays follows a Poisson distribution.
+ *
+ * @param[in] x Numbers to test.
+ * @param[in] n Number of numbers to test.
+ * @return The p-value of the test.
+ * */
+static double clo_rng_quality_test_bday(const cl_uint* x, size_t n) {
+
+	double observed[CLO_RNG_BDAY_BINS] = { 0 };
+	double expected[CLO_RNG_BDAY_BINS];
+	cl_uint bdays[CLO_RNG_BDAY_N];
+	cl_uint spacings[CLO_RNG_BDAY_N];
+	size_t samples = n / CLO_RNG_BDAY_N;
+	double prob = exp(-CLO_RNG_BDAY_LAMBDA), prob_acc = 0;
+
+	for (size_t s = 0; s < samples; ++s) {
+
+		guint dups = 0;
+
+		/* Get and sort birthdays. */
+		for (guint i = 0; i < CLO_RNG_BDAY_N; ++i)
+			bdays[i] = x[s * CLO_RNG_BDAY_N + i] >> (32 - CLO_RNG_BDAY_BITS);
+		qsort(bdays, CLO_RNG_BDAY_N, sizeof(cl_uint), clo_rng_quality_cmp);
+
+		/* Get and sort spacings. */
+		spacings[0] = bdays[0];
+		for (guint i = 1; i < CLO_RNG_BDAY_N; ++i)
+			spacings[i] = bdays[i] - bdays[i - 1];
+		qsort(spacings, CLO_RNG_BDAY_N, sizeof(cl_uint),
+			clo_rng_quality_cmp);
+
+		/* Count duplicate spacings. */
+		for (guint i = 1; i < CLO_RNG_BDAY_N; ++i)
+			if (spacings[i] == spacings[i - 1]) dups++;
+
+		observed[MIN(dups, CLO_RNG_BDAY_BINS - 1)] += 1;
+	}
+
+	/* Expected Poisson frequencies. */
+	for (guint i = 0; i < CLO_RNG_BDAY_BINS - 1; ++i) {
+		expected[i] = samples * prob;
+		prob_acc += prob;
+		prob *= CLO_RNG_BDAY_LAMBDA / (i + 1);
+	}
+	expected[CLO_RNG_BDAY_BINS - 1] = samples * (1 - prob_acc);
+
+	return clo_rng_quality_chisq(observed, expected, CLO_RNG_BDAY_BINS);
+}
+
+/**
+ * Gap test (Knuth, TAOCP vol. 2, 3.3.2.D). Gap lengths between numbers
+ * falling in [0, beta) follow a geometric distribution.
+ *
+ * @param[in] x Numbers to test.
+ * @param[in] n Number of numbers to test.
+ * @return The p-value of the test.
+ * */
+static double clo_rng_quality_test_gap(const cl_uint* x, size_t n) {
+
+	double observed[CLO_RNG_GAP_T + 1] = { 0 };
+	double expected[CLO_RNG_GAP_T + 1];
+	double gaps = 0, prob = CLO_RNG_GAP_BETA;
+	guint r = 0;
+
+	for (size_t i = 0; i < n; ++i) {
+		if (x[i] / 4294967296.0 < CLO_RNG_GAP_BETA) {
+			observed[MIN(r, CLO_RNG_GAP_T)] += 1;
+			gaps += 1;
+			r = 0;
+		} else {
+			r++;
+		}
+	}
+
+	for (guint i = 0; i < CLO_RNG_GAP_T; ++i) {
+		expected[i] = gaps * prob;
+		prob *= 1 - CLO_RNG_GAP_BETA;
+	}
+	expected[CLO_RNG_GAP_T] = gaps * pow(1 - CLO_RNG_GAP_BETA, CLO_RNG_GAP_T);
+
+	return clo_rng_quality_chisq(observed, expected, CLO_RNG_GAP_T + 1);
+}
+
+/**
+ * Check a p-value, failing the current test if it is too small.
+ *
+ * @param[in] name Name of statistical test.
+ * @param[in] p The p-value.
+ * */
+static void clo_rng_quality_check(const char* name, double p) {
+
+	g_test_message("%s: p = %g", name, p);
+	if (p < CLO_RNG_QUALITY_ALPHA) {
+		g_test_message("%s: FAILED", name);
+		g_test_fail();
+	}
+}
+
+/**
+ * Test the quality and measure the throughput of a generator/seed
+ * combination.
+ *
+ * @param[in] data A ::clo_rng_quality_case object.
+ * */
+static void quality_test(gconstpointer data) {
+
+	/* Test case. */
+	const struct clo_rng_quality_case* qcase = data;
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq = NULL;
+	CCLProgram* prg = NULL;
+	CCLKernel* krnl = NULL;
+	CCLBuffer* seeds_dev = NULL;
+	CCLBuffer* output_dev = NULL;
+	CCLEvent* evt = NULL;
+	CCLProf* prof = NULL;
+	const CCLProfAgg* agg;
+	GError* err = NULL;
+	CloRng* rng = NULL;
+	gchar* src;
+	cl_uint* output_host;
+	size_t ws;
+	size_t output_size;
+	cl_uint warmup = CLO_RNG_QUALITY_WARMUP;
+	cl_uint count = CLO_RNG_QUALITY_PER_WORKITEM;
+	double gbps;
+
+	/* Get context and device. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+
+	/* Create command queue with profiling enabled. */
+	cq = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err);
+	g_assert_no_error(err);
+
+	/* Create RNG object with enough seeds for throughput. */
+	rng = clo_rng_new(qcase->rng->name, qcase->seed->seed_type, NULL,
+		CLO_RNG_THROUGHPUT_WORKITEMS, CLO_RNG_QUALITY_INIT_SEED,
+		qcase->seed->hash, ctx, cq, &err);
+	g_assert_no_error(err);
+
+	seeds_dev = clo_rng_get_device_seeds(rng);
+
+	/* Create and build program. */
+	src = g_strconcat(
+		clo_rng_get_source(rng), CLO_RNG_QUALITY_SRC, NULL);
+
+	prg = ccl_program_new_from_source(ctx, src, &err);
+	g_assert_no_error(err);
+
+	ccl_program_build(prg, NULL, &err);
+	g_assert_no_error(err);
+
+	/* Fused seeds are initialized with the program just built. */
+	if (qcase->seed->seed_type == CLO_RNG_SEED_DEV_GID_FUSED) {
+		clo_rng_init_seeds(rng, prg, cq, &err);
+		g_assert_no_error(err);
+	}
+
+	/* Create output buffers, large enough for both kernels. */
+	output_size = sizeof(cl_uint) * MAX(CLO_RNG_QUALITY_NUMEL,
+		CLO_RNG_THROUGHPUT_WORKITEMS * CLO_RNG_THROUGHPUT_PER_WORKITEM);
+	output_dev = ccl_buffer_new(
+		ctx, CL_MEM_WRITE_ONLY, output_size, NULL, &err);
+	g_assert_no_error(err);
+
+	output_host = g_slice_alloc(sizeof(cl_uint) * CLO_RNG_QUALITY_NUMEL);
+
+	/* Generate numbers for quality tests. */
+	krnl = ccl_program_get_kernel(prg, CLO_RNG_QUALITY_KERNEL, &err);
+	g_assert_no_error(err);
+
+	ws = CLO_RNG_QUALITY_WORKITEMS;
+	ccl_kernel_set_args_and_enqueue_ndrange(
+		krnl, cq, 1, NULL, &ws, NULL, NULL, &err,
+		seeds_dev, output_dev, ccl_arg_priv(warmup, cl_uint),
+		ccl_arg_priv(count, cl_uint), NULL);
+	g_assert_no_error(err);
+
+	/* Read numbers directly into host memory. */
+	ccl_buffer_enqueue_read(output_dev, cq, CL_TRUE, 0,
+		sizeof(cl_uint) * CLO_RNG_QUALITY_NUMEL, output_host, NULL,
+		&err);
+	g_assert_no_error(err);
+
+	/* Perform statistical tests. */
+	clo_rng_quality_check("chi-square",
+		clo_rng_quality_test_freq(output_host, CLO_RNG_QUALITY_NUMEL));
+	clo_rng_quality_check("serial-correlation",
+		clo_rng_quality_test_serial(output_host, CLO_RNG_QUALITY_NUMEL));
+	clo_rng_quality_check("birthday-spacings",
+		clo_rng_quality_test_bday(output_host, CLO_RNG_QUALITY_NUMEL));
+	clo_rng_quality_check("gap",
+		clo_rng_quality_test_gap(output_host, CLO_RNG_QUALITY_NUMEL));
+
+	/* Measure throughput. */
+	krnl = ccl_program_get_kernel(prg, CLO_RNG_THROUGHPUT_KERNEL, &err);
+	g_assert_no_error(err);
+
+	ws = CLO_RNG_THROUGHPUT_WORKITEMS;
+	count = CLO_RNG_THROUGHPUT_PER_WORKITEM;
+	ccl_kernel_set_args(krnl, seeds_dev, output_dev,
+		ccl_arg_priv(count, cl_uint), NULL);
+
+	for (cl_uint i = 0; i < CLO_RNG_THROUGHPUT_RUNS; ++i) {
+		evt = ccl_kernel_enqueue_ndrange(
+			krnl, cq, 1, NULL, &ws, NULL, NULL, &err);
+		g_assert_no_error(err);
+		ccl_event_set_name(evt, "THROUGHPUT");
+	}
+
+	ccl_queue_finish(cq, &err);
+	g_assert_no_error(err);
+
+	prof = ccl_prof_new();
+	ccl_prof_add_queue(prof, "q", cq);
+	ccl_prof_calc(prof, &err);
+	g_assert_no_error(err);
+
+	agg = ccl_prof_get_agg(prof, "THROUGHPUT");
+	g_assert(agg != NULL);
+
+	/* Bytes per nanosecond is GB/s. */
+	gbps = ((double) CLO_RNG_THROUGHPUT_RUNS)
+		* CLO_RNG_THROUGHPUT_WORKITEMS * CLO_RNG_THROUGHPUT_PER_WORKITEM
+		* sizeof(cl_uint) / agg->absolute_time;
+	g_test_maximized_result(gbps, "%s (%s): %.3f GB/s",
+		qcase->rng->name, qcase->seed->name, gbps);
+
+	/* Release stuff. */
+	ccl_prof_destroy(prof);
+	g_slice_free1(sizeof(cl_uint) * CLO_RNG_QUALITY_NUMEL, output_host);
+	g_free(src);
+	ccl_buffer_destroy(output_dev);
+	ccl_program_destroy(prg);
+	clo_rng_destroy(rng);
+	ccl_queue_destroy(cq);
+	ccl_context_destroy(ctx);
+
+	/* Confirm that memory allocated by wrappers has been properly
+	 * freed. */
+	g_assert(ccl_wrapper_memcheck());
+
+}
+
+
+/**
+ * Main function.
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Command line arguments.
+ * @return Result of test run.
+ * */
+int main(int argc, char** argv) {
+
+	/* Test cases and respective paths. */
+	struct clo_rng_quality_case* qcases;
+	gchar** paths;
+	guint num_rngs = 0, num_seeds = 0, k = 0;
+	int status;
+
+	g_test_init(&argc, &argv, NULL);
+
+	/* Count generators and seed configurations. */
+	while (clo_rng_infos[num_rngs].name != NULL) num_rngs++;
+	while (clo_rng_quality_seeds[num_seeds].name != NULL) num_seeds++;
+
+	qcases = g_new(struct clo_rng_quality_case, num_rngs * num_seeds);
+	paths = g_new0(gchar*, num_rngs * num_seeds + 1);
+
+	/* Add a test for each generator/seed combination. */
+	for (guint i = 0; i < num_rngs; ++i) {
+		for (guint j = 0; j < num_seeds; ++j) {
+			qcases[k].rng = &clo_rng_infos[i];
+			qcases[k].seed = &clo_rng_quality_seeds[j];
+			paths[k] = g_strdup_printf("/rng-quality/%s/%s",
+				clo_rng_infos[i].name, clo_rng_quality_seeds[j].name);
+			g_test_add_data_func(paths[k], &qcases[k], quality_test);
+			k++;
+		}
+	}
+
+	status = g_test_run();
+
+	g_strfreev(paths);
+	g_free(qcases);
+
+	return status;
+}
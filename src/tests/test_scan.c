@@ -0,0 +1,904 @@
+/*
+ * This file is part of CL_Ops (C Framework for OpenCL).
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CL_Ops. If not, see <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Test the scan classes. Results of the host scan implementation and
+ * of the device scan implementations are checked against the host
+ * prefix sum.
+ *
+ * @author Nuno Fachada
+ * @date 2016
+ * @copyright [GNU General Public License version 3 (GPLv3)](http://www.gnu.org/licenses/gpl.html)
+ * */
+
+#include <cl_ops.h>
+#include <string.h>
+
+#define CLO_SCAN_TEST_SEED 1234
+
+/* Number of elements to scan: single element and non-power of two
+ * sizes, the larger of which span several workgroups. Device buffers
+ * can't be empty. */
+static const size_t clo_scan_test_sizes[] = { 1, 3, 1000, 4099, 65537 };
+
+/* Scan implementations, the first of which runs on the host. */
+static const char* clo_scan_test_types[] = {
+	CLO_SCAN_HOST_NAME, "blelloch", "blelloch", "rblock", "rblock" };
+
+/* Options of each scan implementation. Routing to the host is disabled
+ * so that the device implementations scan the smaller sizes, except
+ * in the last configuration. */
+static const char* clo_scan_test_opts[] = {
+	"", "host_max=0", "host_max=0,padded=1", "host_max=0", "" };
+
+/* Element and sum types: same type, wider sum type and signed
+ * elements with wrap-around. */
+static const CloType clo_scan_test_elem_types[] =
+	{ CLO_UINT, CLO_UINT, CLO_INT };
+static const CloType clo_scan_test_sum_types[] =
+	{ CLO_UINT, CLO_ULONG, CLO_INT };
+
+/**
+ * Test exclusive and inclusive prefix sums with each scan
+ * implementation.
+ * */
+static void sum_test() {
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq = NULL;
+	CCLBuffer* data_in_dev = NULL;
+	CCLBuffer* data_out_dev = NULL;
+	CloScan* scanner = NULL;
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_SCAN_TEST_SEED);
+
+	/* Get context, device and command queue. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+	cq = ccl_queue_new(ctx, dev, 0, &err);
+	g_assert_no_error(err);
+
+	for (guint t = 0; t < G_N_ELEMENTS(clo_scan_test_elem_types); ++t) {
+
+		CloType elem_type = clo_scan_test_elem_types[t];
+		CloType sum_type = clo_scan_test_sum_types[t];
+		size_t elem_size = clo_type_sizeof(elem_type);
+		size_t sum_size = clo_type_sizeof(sum_type);
+
+		for (guint a = 0; a < G_N_ELEMENTS(clo_scan_test_types); ++a) {
+
+			for (guint incl = 0; incl < 2; ++incl) {
+
+				gchar* options = g_strdup_printf("%s,inclusive=%u",
+					clo_scan_test_opts[a], incl);
+
+				scanner = clo_scan_new(clo_scan_test_types[a], options,
+					ctx, elem_type, sum_type, NULL, NULL, NULL, NULL,
+					&err);
+				g_assert_no_error(err);
+				g_free(options);
+
+				for (guint s = 0; s < G_N_ELEMENTS(clo_scan_test_sizes);
+					++s) {
+
+					size_t numel = clo_scan_test_sizes[s];
+					cl_uint* data = g_new(cl_uint, numel);
+					void* expected = g_malloc(numel * sum_size);
+					void* result = g_malloc(numel * sum_size);
+
+					/* Large values, so that sums wrap around. */
+					for (size_t i = 0; i < numel; ++i)
+						data[i] = g_rand_int(rng);
+					clo_scan_host_sum(elem_type, sum_type, data,
+						expected, numel, incl, &err);
+					g_assert_no_error(err);
+
+					data_in_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+						numel * elem_size, NULL, &err);
+					g_assert_no_error(err);
+					data_out_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+						numel * sum_size, NULL, &err);
+					g_assert_no_error(err);
+					ccl_buffer_enqueue_write(data_in_dev, cq, CL_TRUE, 0,
+						numel * elem_size, data, NULL, &err);
+					g_assert_no_error(err);
+
+					/* Scan device data. */
+					clo_scan_with_device_data(scanner, cq, NULL,
+						data_in_dev, data_out_dev, numel, 0, &err);
+					g_assert_no_error(err);
+					ccl_buffer_enqueue_read(data_out_dev, cq, CL_TRUE, 0,
+						numel * sum_size, result, NULL, &err);
+					g_assert_no_error(err);
+					g_assert(memcmp(result, expected, numel * sum_size)
+						== 0);
+
+					/* Scan host data. */
+					memset(result, 0, numel * sum_size);
+					clo_scan_with_host_data(scanner, cq, NULL, data,
+						result, numel, 0, &err);
+					g_assert_no_error(err);
+					g_assert(memcmp(result, expected, numel * sum_size)
+						== 0);
+
+					ccl_buffer_destroy(data_in_dev);
+					ccl_buffer_destroy(data_out_dev);
+					g_free(data);
+					g_free(expected);
+					g_free(result);
+				}
+
+				clo_scan_destroy(scanner);
+			}
+		}
+	}
+
+	/* Free stuff. */
+	g_rand_free(rng);
+	ccl_queue_destroy(cq);
+	ccl_context_destroy(ctx);
+}
+
+/* Device scan implementations, with routing to the host disabled. */
+static const char* clo_scan_test_dev_types[] = {
+	"blelloch", "blelloch", "rblock" };
+static const char* clo_scan_test_dev_opts[] = {
+	"host_max=0", "host_max=0,padded=1", "host_max=0" };
+
+/* Operators, identities and helper code of user-defined scans, the
+ * last of which is given by a helper function in the prelude. */
+static const struct {
+	const char* op;
+	const char* identity;
+	const char* prelude;
+} clo_scan_test_ops[] = {
+	{ "max((a), (b))", "0", NULL },
+	{ "min((a), (b))", "UINT_MAX", NULL },
+	{ "((a) * (b))", "1", NULL },
+	{ "clo_scan_test_xor((a), (b))", "0",
+		"uint clo_scan_test_xor(uint a, uint b) { return a ^ b; }" }
+};
+
+/**
+ * Host version of the user-defined scan operators.
+ * */
+static cl_uint clo_scan_test_op(guint o, cl_uint a, cl_uint b) {
+
+	switch (o) {
+		case 0: return MAX(a, b);
+		case 1: return MIN(a, b);
+		case 2: return a * b;
+		default: return a ^ b;
+	}
+}
+
+/**
+ * Scan the given host data with the given scanner and compare the
+ * result with the expected result.
+ * */
+static void clo_scan_test_check(CloScan* scanner, CCLQueue* cq,
+	void* data, void* expected, size_t numel) {
+
+	GError* err = NULL;
+	size_t size = numel * clo_scan_get_sum_size(scanner);
+	void* result = g_malloc0(size);
+
+	clo_scan_with_host_data(scanner, cq, NULL, data, result, numel, 0,
+		&err);
+	g_assert_no_error(err);
+	g_assert(memcmp(result, expected, size) == 0);
+
+	g_free(result);
+}
+
+/**
+ * Test scans with user-defined operators: maximum, minimum, product
+ * (with wrap-around) and an operator defined in the prelude.
+ * */
+static void op_test() {
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq = NULL;
+	CloScan* scanner = NULL;
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_SCAN_TEST_SEED);
+
+	/* Get context, device and command queue. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+	cq = ccl_queue_new(ctx, dev, 0, &err);
+	g_assert_no_error(err);
+
+	for (guint o = 0; o < G_N_ELEMENTS(clo_scan_test_ops); ++o) {
+
+		/* Host identity of the current operator. */
+		cl_uint identity = (o == 1) ? G_MAXUINT32 : (o == 2) ? 1 : 0;
+
+		for (guint a = 0; a < G_N_ELEMENTS(clo_scan_test_dev_types); ++a) {
+
+			for (guint incl = 0; incl < 2; ++incl) {
+
+				gchar* options = g_strdup_printf("%s,inclusive=%u",
+					clo_scan_test_dev_opts[a], incl);
+
+				scanner = clo_scan_new(clo_scan_test_dev_types[a],
+					options, ctx, CLO_UINT, CLO_UINT,
+					clo_scan_test_ops[o].op, clo_scan_test_ops[o].identity,
+					clo_scan_test_ops[o].prelude, NULL, &err);
+				g_assert_no_error(err);
+				g_free(options);
+
+				for (guint s = 0; s < G_N_ELEMENTS(clo_scan_test_sizes);
+					++s) {
+
+					size_t numel = clo_scan_test_sizes[s];
+					cl_uint* data = g_new(cl_uint, numel);
+					cl_uint* expected = g_new(cl_uint, numel);
+					cl_uint acc = identity;
+
+					/* Odd factors for products, so that they don't
+					 * quickly become zero. */
+					for (size_t i = 0; i < numel; ++i) {
+						data[i] = g_rand_int(rng);
+						if (o == 2) data[i] |= 1;
+					}
+					for (size_t i = 0; i < numel; ++i) {
+						if (incl) acc = clo_scan_test_op(o, acc, data[i]);
+						expected[i] = acc;
+						if (!incl) acc = clo_scan_test_op(o, acc, data[i]);
+					}
+
+					clo_scan_test_check(scanner, cq, data, expected,
+						numel);
+
+					g_free(data);
+					g_free(expected);
+				}
+
+				clo_scan_destroy(scanner);
+			}
+		}
+	}
+
+	/* Free stuff. */
+	g_rand_free(rng);
+	ccl_queue_destroy(cq);
+	ccl_context_destroy(ctx);
+}
+
+/* Affine map record, x -> m * x + c (with wrap-around). */
+typedef struct {
+	cl_uint m;
+	cl_uint c;
+} clo_scan_test_affine;
+
+/**
+ * Test scans of a record monoid: the composition of affine maps, which
+ * is associative but not commutative, so that the order of the
+ * operands is also checked.
+ * */
+static void record_test() {
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq = NULL;
+	CloScan* scanner = NULL;
+	CloType type;
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_SCAN_TEST_SEED);
+
+	/* Composition of affine maps, `a` being applied first. */
+	const char* prelude =
+		"clo_scan_test_affine clo_scan_test_compose(\n"
+		"	clo_scan_test_affine a, clo_scan_test_affine b) {\n"
+		"	clo_scan_test_affine r;\n"
+		"	r.m = a.m * b.m;\n"
+		"	r.c = a.c * b.m + b.c;\n"
+		"	return r;\n"
+		"}\n"
+		"clo_scan_test_affine clo_scan_test_identity() {\n"
+		"	clo_scan_test_affine r;\n"
+		"	r.m = 1;\n"
+		"	r.c = 0;\n"
+		"	return r;\n"
+		"}\n";
+
+	/* Get context, device and command queue. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+	cq = ccl_queue_new(ctx, dev, 0, &err);
+	g_assert_no_error(err);
+
+	type = clo_type_new_record("clo_scan_test_affine", "uint m; uint c;",
+		sizeof(clo_scan_test_affine), sizeof(clo_scan_test_affine),
+		&err);
+	g_assert_no_error(err);
+
+	for (guint a = 0; a < G_N_ELEMENTS(clo_scan_test_dev_types); ++a) {
+
+		for (guint incl = 0; incl < 2; ++incl) {
+
+			gchar* options = g_strdup_printf("%s,inclusive=%u",
+				clo_scan_test_dev_opts[a], incl);
+
+			scanner = clo_scan_new(clo_scan_test_dev_types[a], options,
+				ctx, type, type, "clo_scan_test_compose((a), (b))",
+				"clo_scan_test_identity()", prelude, NULL, &err);
+			g_assert_no_error(err);
+			g_free(options);
+
+			for (guint s = 0; s < G_N_ELEMENTS(clo_scan_test_sizes);
+				++s) {
+
+				size_t numel = clo_scan_test_sizes[s];
+				clo_scan_test_affine* data =
+					g_new(clo_scan_test_affine, numel);
+				clo_scan_test_affine* expected =
+					g_new(clo_scan_test_affine, numel);
+				clo_scan_test_affine acc = { 1, 0 };
+
+				for (size_t i = 0; i < numel; ++i) {
+					data[i].m = g_rand_int(rng) | 1;
+					data[i].c = g_rand_int(rng);
+				}
+				for (size_t i = 0; i < numel; ++i) {
+					clo_scan_test_affine next;
+					next.m = acc.m * data[i].m;
+					next.c = acc.c * data[i].m + data[i].c;
+					if (incl) acc = next;
+					expected[i] = acc;
+					if (!incl) acc = next;
+				}
+
+				clo_scan_test_check(scanner, cq, data, expected, numel);
+
+				g_free(data);
+				g_free(expected);
+			}
+
+			clo_scan_destroy(scanner);
+		}
+	}
+
+	/* Free stuff. */
+	g_rand_free(rng);
+	ccl_queue_destroy(cq);
+	ccl_context_destroy(ctx);
+}
+
+/* Vector element and sum types, the second pair of which converts
+ * elements to a wider vector type. */
+static const CloType clo_scan_test_vec_elem_types[] =
+	{ CLO_UINT2, CLO_UINT2, CLO_FLOAT4 };
+static const CloType clo_scan_test_vec_sum_types[] =
+	{ CLO_UINT2, CLO_ULONG2, CLO_FLOAT4 };
+
+/* Record of 16 bytes, with a different operator for each member. */
+typedef struct {
+	cl_uint sum;
+	cl_uint top;
+	cl_uint bits;
+	cl_uint count;
+} clo_scan_test_rec;
+
+/**
+ * Test prefix sums of vectors, with the default operator and
+ * identity, and scans of a 16 byte record.
+ * */
+static void record_vector_test() {
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq = NULL;
+	CloScan* scanner = NULL;
+	CloType rec_type;
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_SCAN_TEST_SEED);
+
+	/* Operator and identity of the record scan. */
+	const char* prelude =
+		"clo_scan_test_rec clo_scan_test_rec_op(\n"
+		"	clo_scan_test_rec a, clo_scan_test_rec b) {\n"
+		"	clo_scan_test_rec r;\n"
+		"	r.sum = a.sum + b.sum;\n"
+		"	r.top = max(a.top, b.top);\n"
+		"	r.bits = a.bits ^ b.bits;\n"
+		"	r.count = a.count + b.count;\n"
+		"	return r;\n"
+		"}\n"
+		"clo_scan_test_rec clo_scan_test_rec_identity() {\n"
+		"	clo_scan_test_rec r;\n"
+		"	r.sum = 0;\n"
+		"	r.top = 0;\n"
+		"	r.bits = 0;\n"
+		"	r.count = 0;\n"
+		"	return r;\n"
+		"}\n";
+
+	/* Get context, device and command queue. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+	cq = ccl_queue_new(ctx, dev, 0, &err);
+	g_assert_no_error(err);
+
+	rec_type = clo_type_new_record("clo_scan_test_rec",
+		"uint sum; uint top; uint bits; uint count;",
+		sizeof(clo_scan_test_rec), 16, &err);
+	g_assert_no_error(err);
+
+	for (guint a = 0; a < G_N_ELEMENTS(clo_scan_test_dev_types); ++a) {
+
+		for (guint incl = 0; incl < 2; ++incl) {
+
+			gchar* options = g_strdup_printf("%s,inclusive=%u",
+				clo_scan_test_dev_opts[a], incl);
+
+			/* Vectors. */
+			for (guint t = 0;
+				t < G_N_ELEMENTS(clo_scan_test_vec_elem_types); ++t) {
+
+				CloType elem_type = clo_scan_test_vec_elem_types[t];
+				CloType sum_type = clo_scan_test_vec_sum_types[t];
+				guint comps = (elem_type == CLO_FLOAT4) ? 4 : 2;
+
+				scanner = clo_scan_new(clo_scan_test_dev_types[a],
+					options, ctx, elem_type, sum_type, NULL, NULL, NULL,
+					NULL, &err);
+				g_assert_no_error(err);
+
+				for (guint s = 0; s < G_N_ELEMENTS(clo_scan_test_sizes);
+					++s) {
+
+					size_t numel = clo_scan_test_sizes[s];
+					void* data = g_malloc(numel * clo_type_sizeof(elem_type));
+					void* expected =
+						g_malloc(numel * clo_type_sizeof(sum_type));
+					cl_ulong acc[4] = { 0, 0, 0, 0 };
+
+					for (size_t i = 0; i < numel; ++i) {
+						for (guint c = 0; c < comps; ++c) {
+
+							size_t j = i * comps + c;
+							cl_ulong next;
+
+							/* Small integer floats, whose sums are exact,
+							 * and large integers, whose sums wrap around
+							 * unless a wider type is used. */
+							if (elem_type == CLO_FLOAT4) {
+								((cl_float*) data)[j] =
+									(cl_float) g_rand_int_range(rng, 0, 16);
+								next = acc[c]
+									+ (cl_ulong) ((cl_float*) data)[j];
+							} else {
+								((cl_uint*) data)[j] = g_rand_int(rng);
+								next = acc[c] + ((cl_uint*) data)[j];
+							}
+							if (incl) acc[c] = next;
+
+							if (sum_type == CLO_FLOAT4)
+								((cl_float*) expected)[j] = (cl_float) acc[c];
+							else if (sum_type == CLO_ULONG2)
+								((cl_ulong*) expected)[j] = acc[c];
+							else
+								((cl_uint*) expected)[j] = (cl_uint) acc[c];
+
+							if (!incl) acc[c] = next;
+						}
+					}
+
+					clo_scan_test_check(scanner, cq, data, expected,
+						numel);
+
+					g_free(data);
+					g_free(expected);
+				}
+
+				clo_scan_destroy(scanner);
+			}
+
+			/* Records. */
+			scanner = clo_scan_new(clo_scan_test_dev_types[a], options,
+				ctx, rec_type, rec_type, "clo_scan_test_rec_op((a), (b))",
+				"clo_scan_test_rec_identity()", prelude, NULL, &err);
+			g_assert_no_error(err);
+
+			for (guint s = 0; s < G_N_ELEMENTS(clo_scan_test_sizes); ++s) {
+
+				size_t numel = clo_scan_test_sizes[s];
+				clo_scan_test_rec* data = g_new(clo_scan_test_rec, numel);
+				clo_scan_test_rec* expected =
+					g_new(clo_scan_test_rec, numel);
+				clo_scan_test_rec acc = { 0, 0, 0, 0 };
+
+				for (size_t i = 0; i < numel; ++i) {
+					clo_scan_test_rec next;
+					data[i].sum = g_rand_int(rng);
+					data[i].top = g_rand_int(rng);
+					data[i].bits = g_rand_int(rng);
+					data[i].count = 1;
+					next.sum = acc.sum + data[i].sum;
+					next.top = MAX(acc.top, data[i].top);
+					next.bits = acc.bits ^ data[i].bits;
+					next.count = acc.count + data[i].count;
+					if (incl) acc = next;
+					expected[i] = acc;
+					if (!incl) acc = next;
+				}
+
+				clo_scan_test_check(scanner, cq, data, expected, numel);
+
+				g_free(data);
+				g_free(expected);
+			}
+
+			clo_scan_destroy(scanner);
+			g_free(options);
+		}
+	}
+
+	/* Free stuff. */
+	g_rand_free(rng);
+	ccl_queue_destroy(cq);
+	ccl_context_destroy(ctx);
+}
+
+/**
+ * Test scans which also obtain the scan total, placed in a given device
+ * buffer or in the pinned buffer owned by the scanner.
+ * */
+static void total_test() {
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq = NULL;
+	CCLBuffer* data_in_dev = NULL;
+	CCLBuffer* data_out_dev = NULL;
+	CCLBuffer* total_dev = NULL;
+	CloScan* scanner = NULL;
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_SCAN_TEST_SEED);
+
+	/* Get context, device and command queue. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+	cq = ccl_queue_new(ctx, dev, 0, &err);
+	g_assert_no_error(err);
+
+	total_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, sizeof(cl_ulong),
+		NULL, &err);
+	g_assert_no_error(err);
+
+	for (guint a = 0; a < G_N_ELEMENTS(clo_scan_test_dev_types); ++a) {
+
+		for (guint incl = 0; incl < 2; ++incl) {
+
+			gchar* options = g_strdup_printf("%s,inclusive=%u",
+				clo_scan_test_dev_opts[a], incl);
+
+			scanner = clo_scan_new(clo_scan_test_dev_types[a], options,
+				ctx, CLO_UINT, CLO_ULONG, NULL, NULL, NULL, NULL, &err);
+			g_assert_no_error(err);
+			g_free(options);
+
+			for (guint s = 0; s < G_N_ELEMENTS(clo_scan_test_sizes);
+				++s) {
+
+				size_t numel = clo_scan_test_sizes[s];
+				cl_uint* data = g_new(cl_uint, numel);
+				cl_ulong* expected = g_new(cl_ulong, numel);
+				cl_ulong* result = g_new(cl_ulong, numel);
+				cl_ulong sum = 0, total = 0;
+
+				for (size_t i = 0; i < numel; ++i) {
+					data[i] = g_rand_int(rng);
+					if (incl) sum += data[i];
+					expected[i] = sum;
+					if (!incl) sum += data[i];
+				}
+
+				data_in_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+					numel * sizeof(cl_uint), NULL, &err);
+				g_assert_no_error(err);
+				data_out_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+					numel * sizeof(cl_ulong), NULL, &err);
+				g_assert_no_error(err);
+				ccl_buffer_enqueue_write(data_in_dev, cq, CL_TRUE, 0,
+					numel * sizeof(cl_uint), data, NULL, &err);
+				g_assert_no_error(err);
+
+				/* Total in the given device buffer. */
+				clo_scan_with_device_data_total(scanner, cq, NULL,
+					data_in_dev, data_out_dev, numel, 0, total_dev, NULL,
+					&err);
+				g_assert_no_error(err);
+				ccl_buffer_enqueue_read(total_dev, cq, CL_TRUE, 0,
+					sizeof(cl_ulong), &total, NULL, &err);
+				g_assert_no_error(err);
+				g_assert_cmpuint(total, ==, sum);
+				ccl_buffer_enqueue_read(data_out_dev, cq, CL_TRUE, 0,
+					numel * sizeof(cl_ulong), result, NULL, &err);
+				g_assert_no_error(err);
+				g_assert(memcmp(result, expected,
+					numel * sizeof(cl_ulong)) == 0);
+
+				/* Total in the pinned buffer, returned to the host. */
+				total = 0;
+				clo_scan_with_device_data_total(scanner, cq, NULL,
+					data_in_dev, data_out_dev, numel, 0, NULL, &total,
+					&err);
+				g_assert_no_error(err);
+				g_assert_cmpuint(total, ==, sum);
+
+				ccl_buffer_destroy(data_in_dev);
+				ccl_buffer_destroy(data_out_dev);
+				g_free(data);
+				g_free(expected);
+				g_free(result);
+			}
+
+			clo_scan_destroy(scanner);
+		}
+	}
+
+	/* Free stuff. */
+	ccl_buffer_destroy(total_dev);
+	g_rand_free(rng);
+	ccl_queue_destroy(cq);
+	ccl_context_destroy(ctx);
+}
+
+/**
+ * Test scans with a caller-supplied workspace, sized for the largest
+ * scan and reused for all scans, and with a workspace which is too
+ * small.
+ * */
+static void ws_test() {
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq = NULL;
+	CCLBuffer* data_in_dev = NULL;
+	CCLBuffer* data_out_dev = NULL;
+	CCLBuffer* ws = NULL;
+	CloScan* scanner = NULL;
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_SCAN_TEST_SEED);
+	size_t numel_max = clo_scan_test_sizes[
+		G_N_ELEMENTS(clo_scan_test_sizes) - 1];
+	size_t ws_size;
+
+	/* Get context, device and command queue. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+	cq = ccl_queue_new(ctx, dev, 0, &err);
+	g_assert_no_error(err);
+
+	data_in_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+		numel_max * sizeof(cl_uint), NULL, &err);
+	g_assert_no_error(err);
+	data_out_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+		numel_max * sizeof(cl_uint), NULL, &err);
+	g_assert_no_error(err);
+
+	for (guint a = 0; a < G_N_ELEMENTS(clo_scan_test_dev_types); ++a) {
+
+		scanner = clo_scan_new(clo_scan_test_dev_types[a],
+			clo_scan_test_dev_opts[a], ctx, CLO_UINT, CLO_UINT, NULL,
+			NULL, NULL, NULL, &err);
+		g_assert_no_error(err);
+
+		/* Several workgroups are required for the largest scan, and
+		 * thus a workspace. */
+		ws_size = clo_scan_get_workspace_size(scanner, cq, numel_max, 0,
+			&err);
+		g_assert_no_error(err);
+		g_assert_cmpuint(ws_size, >, 1);
+		ws = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, ws_size, NULL, &err);
+		g_assert_no_error(err);
+
+		for (guint s = 0; s < G_N_ELEMENTS(clo_scan_test_sizes); ++s) {
+
+			size_t numel = clo_scan_test_sizes[s];
+			cl_uint* data = g_new(cl_uint, numel);
+			cl_uint* expected = g_new(cl_uint, numel);
+			cl_uint* result = g_new(cl_uint, numel);
+
+			for (size_t i = 0; i < numel; ++i)
+				data[i] = g_rand_int(rng);
+			clo_scan_host_sum(CLO_UINT, CLO_UINT, data, expected, numel,
+				CL_FALSE, &err);
+			g_assert_no_error(err);
+
+			ccl_buffer_enqueue_write(data_in_dev, cq, CL_TRUE, 0,
+				numel * sizeof(cl_uint), data, NULL, &err);
+			g_assert_no_error(err);
+			clo_scan_with_device_data_ws(scanner, cq, NULL, data_in_dev,
+				data_out_dev, numel, 0, ws, &err);
+			g_assert_no_error(err);
+			ccl_buffer_enqueue_read(data_out_dev, cq, CL_TRUE, 0,
+				numel * sizeof(cl_uint), result, NULL, &err);
+			g_assert_no_error(err);
+			g_assert(memcmp(result, expected, numel * sizeof(cl_uint))
+				== 0);
+
+			g_free(data);
+			g_free(expected);
+			g_free(result);
+		}
+		ccl_buffer_destroy(ws);
+
+		/* A workspace which is too small is rejected. */
+		ws = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, ws_size / 2, NULL,
+			&err);
+		g_assert_no_error(err);
+		clo_scan_with_device_data_ws(scanner, cq, NULL, data_in_dev,
+			data_out_dev, numel_max, 0, ws, &err);
+		g_assert_error(err, CLO_ERROR, CLO_ERROR_ARGS);
+		g_clear_error(&err);
+		ccl_buffer_destroy(ws);
+
+		clo_scan_destroy(scanner);
+	}
+
+	/* Free stuff. */
+	ccl_buffer_destroy(data_in_dev);
+	ccl_buffer_destroy(data_out_dev);
+	g_rand_free(rng);
+	ccl_queue_destroy(cq);
+	ccl_context_destroy(ctx);
+}
+
+/**
+ * Test that invalid values of the generic options are rejected.
+ * */
+static void options_test() {
+
+	CloScan* scanner = NULL;
+	GError* err = NULL;
+	const char* options[] = { "inclusive=2", "inclusive=yes",
+		"inclusive=", "host_max=-", "host_max=1k" };
+
+	for (guint o = 0; o < G_N_ELEMENTS(options); ++o) {
+		scanner = clo_scan_new(CLO_SCAN_HOST_NAME, options[o], NULL,
+			CLO_UINT, CLO_UINT, NULL, NULL, NULL, NULL, &err);
+		g_assert_error(err, CLO_ERROR, CLO_ERROR_ARGS);
+		g_assert(scanner == NULL);
+		g_clear_error(&err);
+	}
+}
+
+/**
+ * Test the host scan without an OpenCL context, which is only possible
+ * for the host scan.
+ * */
+static void host_no_context_test() {
+
+	/* Test variables. */
+	CloScan* scanner = NULL;
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_SCAN_TEST_SEED);
+
+	/* Device scan implementations require a context. */
+	scanner = clo_scan_new("blelloch", NULL, NULL, CLO_UINT, CLO_UINT,
+		NULL, NULL, NULL, NULL, &err);
+	g_assert_error(err, CLO_ERROR, CLO_ERROR_ARGS);
+	g_assert(scanner == NULL);
+	g_clear_error(&err);
+
+	for (guint incl = 0; incl < 2; ++incl) {
+
+		scanner = clo_scan_new(CLO_SCAN_HOST_NAME,
+			incl ? "inclusive=1" : NULL, NULL, CLO_UINT, CLO_ULONG,
+			NULL, NULL, NULL, NULL, &err);
+		g_assert_no_error(err);
+
+		for (guint s = 0; s < G_N_ELEMENTS(clo_scan_test_sizes); ++s) {
+
+			size_t numel = clo_scan_test_sizes[s];
+			cl_uint* data = g_new(cl_uint, numel);
+			cl_ulong* result = g_new(cl_ulong, numel);
+			cl_ulong sum = 0;
+
+			for (size_t i = 0; i < numel; ++i)
+				data[i] = g_rand_int(rng);
+
+			clo_scan_with_host_data(scanner, NULL, NULL, data, result,
+				numel, 0, &err);
+			g_assert_no_error(err);
+
+			for (size_t i = 0; i < numel; ++i) {
+				if (incl) sum += data[i];
+				g_assert_cmpuint(result[i], ==, sum);
+				if (!incl) sum += data[i];
+			}
+
+			g_free(data);
+			g_free(result);
+		}
+
+		clo_scan_destroy(scanner);
+	}
+
+	/* Free stuff. */
+	g_rand_free(rng);
+}
+
+/**
+ * Main function.
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Command line arguments.
+ * @return Result of test run.
+ * */
+int main(int argc, char** argv) {
+
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func(
+		"/scan/sum",
+		sum_test);
+
+	g_test_add_func(
+		"/scan/ops",
+		op_test);
+
+	g_test_add_func(
+		"/scan/record",
+		record_test);
+
+	g_test_add_func(
+		"/scan/record-vector",
+		record_vector_test);
+
+	g_test_add_func(
+		"/scan/total",
+		total_test);
+
+	g_test_add_func(
+		"/scan/workspace",
+		ws_test);
+
+	g_test_add_func(
+		"/scan/options",
+		options_test);
+
+	g_test_add_func(
+		"/scan/host-no-context",
+		host_no_context_test);
+
+	return g_test_run();
+}
@@ -0,0 +1,1245 @@
+/*
+ * This file is part of CL_Ops (C Framework for OpenCL).
+ *
+ * CL_Ops is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CL_Ops is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CL_Ops. If not, see <http://www.gnu.org/licenses/>.
+ * */
+
+/**
+ * @file
+ * Test the sort classes and the algorithms built on top of them. Device
+ * results are checked against the host sort.
+ *
+ * @author Nuno Fachada
+ * @date 2016
+ * @copyright [GNU General Public License version 3 (GPLv3)](http://www.gnu.org/licenses/gpl.html)
+ * */
+
+#include <cl_ops.h>
+#include <string.h>
+
+#define CLO_SORT_TEST_SEED 1234
+
+/* Number of elements to sort: empty, single element and non-power of
+ * two sizes, the larger of which don't fit in local memory. */
+static const size_t clo_sort_test_sizes[] = { 0, 1, 3, 1000, 4099, 65537 };
+
+/* Number of elements to sort with the implementations which only sort
+ * power of two sized arrays, the smallest of which is the satradix
+ * radix. */
+static const size_t clo_sort_test_sizes_pow2[] = { 16, 1024, 4096, 65536 };
+
+/* Number of elements which are sorted on the host by default, whatever
+ * the sort implementation. */
+static const size_t clo_sort_test_sizes_tiny[] = { 0, 1, 3, 100 };
+
+/* Distributions of the elements to sort. */
+typedef enum {
+	/* Random values. */
+	CLO_SORT_TEST_RANDOM,
+	/* Few distinct values. */
+	CLO_SORT_TEST_DUPLICATES,
+	/* All values equal. */
+	CLO_SORT_TEST_EQUAL,
+	/* Number of distributions. */
+	CLO_SORT_TEST_NUM_DISTS
+} clo_sort_test_dist;
+
+/**
+ * Fill the given array with values of the given distribution.
+ * */
+static void clo_sort_test_fill(cl_uint* data, size_t numel,
+	clo_sort_test_dist dist, GRand* rng) {
+
+	for (size_t i = 0; i < numel; ++i) {
+		switch (dist) {
+			case CLO_SORT_TEST_RANDOM:
+				data[i] = g_rand_int(rng);
+				break;
+			case CLO_SORT_TEST_DUPLICATES:
+				data[i] = g_rand_int_range(rng, 0, 4);
+				break;
+			default:
+				data[i] = 42;
+		}
+	}
+}
+
+/**
+ * Sort the given data in the device, optionally recording the sort in a
+ * command batch, and check the result against the host sort. If the
+ * sort is recorded, the input is then rewritten in reverse order and
+ * the batch is replayed, and the result is checked again.
+ * */
+static void clo_sort_test_check(CloSort* sorter, CCLQueue* cq,
+	cl_uint* data, size_t numel, cl_bool record) {
+
+	/* Test variables. */
+	CCLContext* ctx = clo_sort_get_context(sorter);
+	CCLBuffer* data_dev = NULL;
+	CloBatch* batch = NULL;
+	GError* err = NULL;
+	size_t size = numel * sizeof(cl_uint);
+	cl_uint* expected = g_memdup(data, size);
+	cl_uint* result = g_new0(cl_uint, MAX(numel, 1));
+
+	/* Expected result. */
+	clo_sort_host_radix(CLO_UINT, expected, numel, &err);
+	g_assert_no_error(err);
+
+	/* Device buffers can't be empty. */
+	data_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+		MAX(size, sizeof(cl_uint)), NULL, &err);
+	g_assert_no_error(err);
+	if (numel > 0) {
+		ccl_buffer_enqueue_write(data_dev, cq, CL_TRUE, 0, size, data,
+			NULL, &err);
+		g_assert_no_error(err);
+	}
+
+	/* Sort data. */
+	if (record) {
+		batch = clo_sort_record(sorter, cq, NULL, data_dev, NULL, numel,
+			0, CL_FALSE, &err);
+		g_assert_no_error(err);
+	} else {
+		clo_sort_with_device_data(sorter, cq, NULL, data_dev, NULL,
+			numel, 0, &err);
+		g_assert_no_error(err);
+	}
+	ccl_queue_finish(cq, &err);
+	g_assert_no_error(err);
+
+	/* Check result. */
+	if (numel > 0) {
+		ccl_buffer_enqueue_read(data_dev, cq, CL_TRUE, 0, size, result,
+			NULL, &err);
+		g_assert_no_error(err);
+		g_assert(memcmp(result, expected, size) == 0);
+	}
+
+	/* Replay the recorded sort on the reversed input. */
+	if (batch) {
+		for (size_t i = 0; i < numel; ++i)
+			result[i] = data[numel - 1 - i];
+		if (numel > 0) {
+			ccl_buffer_enqueue_write(data_dev, cq, CL_TRUE, 0, size,
+				result, NULL, &err);
+			g_assert_no_error(err);
+		}
+		clo_batch_replay(batch, &err);
+		g_assert_no_error(err);
+		ccl_queue_finish(cq, &err);
+		g_assert_no_error(err);
+		if (numel > 0) {
+			ccl_buffer_enqueue_read(data_dev, cq, CL_TRUE, 0, size,
+				result, NULL, &err);
+			g_assert_no_error(err);
+			g_assert(memcmp(result, expected, size) == 0);
+		}
+		clo_batch_destroy(batch);
+	}
+
+	/* Free stuff. */
+	ccl_buffer_destroy(data_dev);
+	g_free(expected);
+	g_free(result);
+}
+
+/**
+ * Test sample sort, with buckets which fit and which don't fit in local
+ * memory, with and without command batches.
+ * */
+static void samplesort_test() {
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq = NULL;
+	CloSort* sorter = NULL;
+	CloType type = CLO_UINT;
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_SORT_TEST_SEED);
+	cl_uint* data = NULL;
+	const char* options[] = {
+		NULL, "local=64", "local=64,buckets=4", "local=64,buckets=2" };
+
+	/* Get context, device and command queue. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+	cq = ccl_queue_new(ctx, dev, 0, &err);
+	g_assert_no_error(err);
+
+	for (guint o = 0; o < G_N_ELEMENTS(options); ++o) {
+
+		sorter = clo_sort_new("samplesort", options[o], ctx, &type,
+			NULL, NULL, NULL, NULL, &err);
+		g_assert_no_error(err);
+
+		for (guint s = 0; s < G_N_ELEMENTS(clo_sort_test_sizes); ++s) {
+			size_t numel = clo_sort_test_sizes[s];
+			data = g_new(cl_uint, MAX(numel, 1));
+			for (guint d = 0; d < CLO_SORT_TEST_NUM_DISTS; ++d) {
+				clo_sort_test_fill(data, numel, d, rng);
+				clo_sort_test_check(sorter, cq, data, numel, CL_FALSE);
+				clo_sort_test_check(sorter, cq, data, numel, CL_TRUE);
+			}
+			g_free(data);
+		}
+
+		clo_sort_destroy(sorter);
+	}
+
+	/* Free stuff. */
+	g_rand_free(rng);
+	ccl_queue_destroy(cq);
+	ccl_context_destroy(ctx);
+}
+
+/**
+ * Test the host sort implementation and device sort implementations
+ * through the same sort interface, checking both against the host radix
+ * sort. The bitonic and radix sorts are only tested with power of two
+ * sizes, the only ones they support, and with tiny sizes, which are
+ * sorted on the host.
+ * */
+static void host_device_test() {
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq = NULL;
+	CloSort* sorter = NULL;
+	CloType type = CLO_UINT;
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_SORT_TEST_SEED);
+	cl_uint* data = NULL;
+	/* Only the host implementation sorts arrays of any size; tiny
+	 * arrays are routed to the host by the other implementations. */
+	const struct {
+		const char* type;
+		const char* options;
+		const size_t* sizes;
+		guint num_sizes;
+	} impls[] = {
+		{ CLO_SORT_HOST_NAME, NULL, clo_sort_test_sizes,
+			G_N_ELEMENTS(clo_sort_test_sizes) },
+		{ "sbitonic", "host_max=0", clo_sort_test_sizes_pow2,
+			G_N_ELEMENTS(clo_sort_test_sizes_pow2) },
+		{ "sbitonic", NULL, clo_sort_test_sizes_tiny,
+			G_N_ELEMENTS(clo_sort_test_sizes_tiny) },
+		{ "abitonic", "host_max=0", clo_sort_test_sizes_pow2,
+			G_N_ELEMENTS(clo_sort_test_sizes_pow2) },
+		{ "abitonic", NULL, clo_sort_test_sizes_tiny,
+			G_N_ELEMENTS(clo_sort_test_sizes_tiny) },
+		{ "satradix", "host_max=0", clo_sort_test_sizes_pow2,
+			G_N_ELEMENTS(clo_sort_test_sizes_pow2) },
+		{ "satradix", NULL, clo_sort_test_sizes_tiny,
+			G_N_ELEMENTS(clo_sort_test_sizes_tiny) }
+	};
+
+	/* Get context, device and command queue. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+	cq = ccl_queue_new(ctx, dev, 0, &err);
+	g_assert_no_error(err);
+
+	for (guint t = 0; t < G_N_ELEMENTS(impls); ++t) {
+
+		sorter = clo_sort_new(impls[t].type, impls[t].options, ctx,
+			&type, NULL, NULL, NULL, NULL, &err);
+		g_assert_no_error(err);
+
+		for (guint s = 0; s < impls[t].num_sizes; ++s) {
+			size_t numel = impls[t].sizes[s];
+			data = g_new(cl_uint, MAX(numel, 1));
+			for (guint d = 0; d < CLO_SORT_TEST_NUM_DISTS; ++d) {
+				clo_sort_test_fill(data, numel, d, rng);
+				clo_sort_test_check(sorter, cq, data, numel, CL_FALSE);
+			}
+			g_free(data);
+		}
+
+		clo_sort_destroy(sorter);
+	}
+
+	/* Free stuff. */
+	g_rand_free(rng);
+	ccl_queue_destroy(cq);
+	ccl_context_destroy(ctx);
+}
+
+/**
+ * Test replaying recorded sorts, with and without profiling, with
+ * separate queues for kernel execution and data transfers, and sorting
+ * in place or to another buffer. Before each replay, the input is
+ * rewritten with new data.
+ * */
+static void replay_test() {
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq_exec = NULL;
+	CCLQueue* cq_comm = NULL;
+	CCLBuffer* data_dev = NULL;
+	CCLBuffer* out_dev = NULL;
+	CloSort* sorter = NULL;
+	CloBatch* batch = NULL;
+	CloType type = CLO_UINT;
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_SORT_TEST_SEED);
+	const size_t sizes_any[] = { 1000, 4099 };
+	const struct {
+		const char* type;
+		const size_t* sizes;
+		guint num_sizes;
+	} impls[] = {
+		{ "sbitonic", clo_sort_test_sizes_pow2,
+			G_N_ELEMENTS(clo_sort_test_sizes_pow2) },
+		{ "abitonic", clo_sort_test_sizes_pow2,
+			G_N_ELEMENTS(clo_sort_test_sizes_pow2) },
+		{ "satradix", clo_sort_test_sizes_pow2,
+			G_N_ELEMENTS(clo_sort_test_sizes_pow2) },
+		{ "gselect", sizes_any, G_N_ELEMENTS(sizes_any) },
+		{ "samplesort", sizes_any, G_N_ELEMENTS(sizes_any) }
+	};
+
+	/* Get context, device and command queues. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+	cq_exec = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err);
+	g_assert_no_error(err);
+	cq_comm = ccl_queue_new(ctx, dev, CL_QUEUE_PROFILING_ENABLE, &err);
+	g_assert_no_error(err);
+
+	for (guint t = 0; t < G_N_ELEMENTS(impls); ++t) {
+
+		sorter = clo_sort_new(impls[t].type, "host_max=0", ctx, &type,
+			NULL, NULL, NULL, NULL, &err);
+		g_assert_no_error(err);
+
+		for (guint s = 0; s < impls[t].num_sizes; ++s) {
+
+			size_t numel = impls[t].sizes[s];
+			size_t size = numel * sizeof(cl_uint);
+			cl_uint* data = g_new(cl_uint, numel);
+			cl_uint* result = g_new(cl_uint, numel);
+
+			data_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, size, NULL,
+				&err);
+			g_assert_no_error(err);
+			out_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, size, NULL,
+				&err);
+			g_assert_no_error(err);
+
+			for (guint m = 0; m < 4; ++m) {
+
+				/* Profiling on or off, in place or to another buffer. */
+				cl_bool prof = (m & 1) ? CL_TRUE : CL_FALSE;
+				CCLBuffer* sorted_dev = (m & 2) ? out_dev : data_dev;
+
+				/* Replays 1 and 2 sort new data. */
+				for (guint r = 0; r < 3; ++r) {
+
+					clo_sort_test_fill(data, numel, CLO_SORT_TEST_RANDOM,
+						rng);
+					ccl_buffer_enqueue_write(data_dev, cq_comm, CL_TRUE,
+						0, size, data, NULL, &err);
+					g_assert_no_error(err);
+
+					if (r == 0) {
+						batch = clo_sort_record(sorter, cq_exec, cq_comm,
+							data_dev, (m & 2) ? out_dev : NULL, numel, 0,
+							prof, &err);
+						g_assert_no_error(err);
+					} else {
+						clo_batch_replay(batch, &err);
+						g_assert_no_error(err);
+					}
+					ccl_queue_finish(cq_exec, &err);
+					g_assert_no_error(err);
+					ccl_queue_finish(cq_comm, &err);
+					g_assert_no_error(err);
+
+					clo_sort_host_radix(CLO_UINT, data, numel, &err);
+					g_assert_no_error(err);
+					ccl_buffer_enqueue_read(sorted_dev, cq_comm, CL_TRUE,
+						0, size, result, NULL, &err);
+					g_assert_no_error(err);
+					g_assert(memcmp(result, data, size) == 0);
+				}
+
+				clo_batch_destroy(batch);
+			}
+
+			ccl_buffer_destroy(data_dev);
+			ccl_buffer_destroy(out_dev);
+			g_free(data);
+			g_free(result);
+		}
+
+		clo_sort_destroy(sorter);
+	}
+
+	/* Free stuff. */
+	g_rand_free(rng);
+	ccl_queue_destroy(cq_exec);
+	ccl_queue_destroy(cq_comm);
+	ccl_context_destroy(ctx);
+}
+
+/**
+ * Test the host sort without an OpenCL context, which is only possible
+ * for the host sort, with signed and floating point elements.
+ * */
+static void host_no_context_test() {
+
+	/* Test variables. */
+	CloSort* sorter = NULL;
+	CloType types[] = { CLO_INT, CLO_FLOAT };
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_SORT_TEST_SEED);
+
+	/* Device sort implementations require a context. */
+	sorter = clo_sort_new("sbitonic", NULL, NULL, &types[0], NULL,
+		NULL, NULL, NULL, &err);
+	g_assert_error(err, CLO_ERROR, CLO_ERROR_ARGS);
+	g_assert(sorter == NULL);
+	g_clear_error(&err);
+
+	for (guint t = 0; t < G_N_ELEMENTS(types); ++t) {
+
+		sorter = clo_sort_new(CLO_SORT_HOST_NAME, NULL, NULL, &types[t],
+			NULL, NULL, NULL, NULL, &err);
+		g_assert_no_error(err);
+
+		for (guint s = 0; s < G_N_ELEMENTS(clo_sort_test_sizes); ++s) {
+
+			size_t numel = clo_sort_test_sizes[s];
+			cl_int* data_i = g_new(cl_int, MAX(numel, 1));
+			cl_float* data_f = (cl_float*) data_i;
+
+			for (size_t i = 0; i < numel; ++i) {
+				if (types[t] == CLO_INT)
+					data_i[i] = (cl_int) g_rand_int(rng);
+				else
+					data_f[i] = (cl_float) g_rand_double_range(
+						rng, -1000.0, 1000.0);
+			}
+
+			/* Sort in place. */
+			clo_sort_with_host_data(sorter, NULL, NULL, data_i, data_i,
+				numel, 0, &err);
+			g_assert_no_error(err);
+
+			for (size_t i = 1; i < numel; ++i) {
+				if (types[t] == CLO_INT)
+					g_assert_cmpint(data_i[i - 1], <=, data_i[i]);
+				else
+					g_assert_cmpfloat(data_f[i - 1], <=, data_f[i]);
+			}
+
+			g_free(data_i);
+		}
+
+		clo_sort_destroy(sorter);
+	}
+
+	/* Free stuff. */
+	g_rand_free(rng);
+}
+
+/**
+ * Test top-k and k-th element selection, including inputs with many
+ * repeated keys, which are handled by equality buckets. Selection is
+ * tested with a sorter which only sorts powers of two and with one
+ * which sorts any number of elements, and output elements beyond the
+ * first k must not be touched.
+ * */
+static void select_test() {
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq = NULL;
+	CCLBuffer* data_dev = NULL;
+	CCLBuffer* topk_dev = NULL;
+	CloSort* sorter = NULL;
+	CloType type = CLO_UINT;
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_SORT_TEST_SEED);
+	cl_uint* data = NULL;
+	cl_uint* expected = NULL;
+	cl_uint* topk = NULL;
+	cl_uint kth;
+	const char* types[] = { "sbitonic", "samplesort" };
+
+	/* Get context, device and command queue. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+	cq = ccl_queue_new(ctx, dev, 0, &err);
+	g_assert_no_error(err);
+
+	for (guint t = 0; t < G_N_ELEMENTS(types); ++t) {
+
+		sorter = clo_sort_new(types[t], NULL, ctx, &type, NULL, NULL, NULL,
+			NULL, &err);
+		g_assert_no_error(err);
+
+		for (guint s = 0; s < G_N_ELEMENTS(clo_sort_test_sizes); ++s) {
+
+			size_t numel = clo_sort_test_sizes[s];
+			size_t size = MAX(numel, 1) * sizeof(cl_uint);
+			data = g_malloc(size);
+			topk = g_malloc(size);
+			data_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, size, NULL,
+				&err);
+			g_assert_no_error(err);
+			topk_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, size, NULL,
+				&err);
+			g_assert_no_error(err);
+
+			/* Nothing can be selected from empty data. */
+			if (numel == 0) {
+				clo_sort_topk(sorter, cq, NULL, data_dev, topk_dev, numel, 1,
+					0, &err);
+				g_assert_error(err, CLO_ERROR, CLO_ERROR_ARGS);
+				g_clear_error(&err);
+				clo_select_kth(sorter, cq, NULL, data_dev, numel, 0, &kth, 0,
+					&err);
+				g_assert_error(err, CLO_ERROR, CLO_ERROR_ARGS);
+				g_clear_error(&err);
+			}
+
+			for (guint d = 0; (numel > 0) && (d < CLO_SORT_TEST_NUM_DISTS);
+				++d) {
+
+				/* First, middle and last positions. */
+				size_t ks[] = { 0, numel / 2, numel - 1 };
+
+				clo_sort_test_fill(data, numel, d, rng);
+				expected = g_memdup(data, numel * sizeof(cl_uint));
+				clo_sort_host_radix(CLO_UINT, expected, numel, &err);
+				g_assert_no_error(err);
+				ccl_buffer_enqueue_write(data_dev, cq, CL_TRUE, 0,
+					numel * sizeof(cl_uint), data, NULL, &err);
+				g_assert_no_error(err);
+
+				for (guint i = 0; i < G_N_ELEMENTS(ks); ++i) {
+
+					/* k-th element. */
+					clo_select_kth(sorter, cq, NULL, data_dev, numel, ks[i],
+						&kth, 0, &err);
+					g_assert_no_error(err);
+					g_assert_cmpuint(kth, ==, expected[ks[i]]);
+
+					/* Top k + 1 elements, the remaining output elements
+					 * being set to a canary value. */
+					memset(topk, 0xA5, numel * sizeof(cl_uint));
+					ccl_buffer_enqueue_write(topk_dev, cq, CL_TRUE, 0,
+						numel * sizeof(cl_uint), topk, NULL, &err);
+					g_assert_no_error(err);
+					clo_sort_topk(sorter, cq, NULL, data_dev, topk_dev,
+						numel, ks[i] + 1, 0, &err);
+					g_assert_no_error(err);
+					ccl_buffer_enqueue_read(topk_dev, cq, CL_TRUE, 0,
+						numel * sizeof(cl_uint), topk, NULL, &err);
+					g_assert_no_error(err);
+					g_assert(memcmp(topk, expected,
+						(ks[i] + 1) * sizeof(cl_uint)) == 0);
+					for (size_t j = ks[i] + 1; j < numel; ++j)
+						g_assert_cmphex(topk[j], ==, 0xA5A5A5A5);
+				}
+
+				/* Input data must not be modified. */
+				ccl_buffer_enqueue_read(data_dev, cq, CL_TRUE, 0,
+					numel * sizeof(cl_uint), topk, NULL, &err);
+				g_assert_no_error(err);
+				g_assert(memcmp(topk, data, numel * sizeof(cl_uint)) == 0);
+
+				g_free(expected);
+			}
+
+			ccl_buffer_destroy(data_dev);
+			ccl_buffer_destroy(topk_dev);
+			g_free(data);
+			g_free(topk);
+		}
+
+		clo_sort_destroy(sorter);
+	}
+
+	/* Free stuff. */
+	g_rand_free(rng);
+	ccl_queue_destroy(cq);
+	ccl_context_destroy(ctx);
+}
+
+/**
+ * Test stable sorting of (key, original position) pairs with many
+ * repeated keys, requesting stability explicitly and with `stable=auto`
+ * for an implementation which is not stable. Sizes are not sorted in
+ * increasing order, so that buffers kept between sorts are both reused
+ * and replaced.
+ * */
+static void stable_test() {
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq = NULL;
+	CloSort* sorter = NULL;
+	CloType elem_type = CLO_UINT2;
+	CloType key_type = CLO_UINT;
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_SORT_TEST_SEED);
+	const size_t sizes[] = { 1024, 16, 65536, 4096 };
+	const char* types[] = { "sbitonic", "sbitonic", "samplesort" };
+	const char* options[] = { "stable=1", "stable=1,local=0",
+		"stable=auto" };
+
+	/* Get context, device and command queue. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+	cq = ccl_queue_new(ctx, dev, 0, &err);
+	g_assert_no_error(err);
+
+	for (guint t = 0; t < G_N_ELEMENTS(types); ++t) {
+
+		sorter = clo_sort_new(types[t], options[t], ctx, &elem_type,
+			&key_type, NULL, "((x).s0)", NULL, &err);
+		g_assert_no_error(err);
+		g_assert(clo_sort_get_stable(sorter));
+
+		for (guint s = 0; s < G_N_ELEMENTS(sizes); ++s) {
+
+			size_t numel = sizes[s];
+			cl_uint* data = g_new(cl_uint, 2 * numel);
+			cl_uint* result = g_new(cl_uint, 2 * numel);
+
+			/* Few distinct keys, each paired with its position. */
+			for (size_t i = 0; i < numel; ++i) {
+				data[2 * i] = g_rand_int_range(rng, 0, 4);
+				data[2 * i + 1] = (cl_uint) i;
+			}
+
+			clo_sort_with_host_data(sorter, cq, NULL, data, result,
+				numel, 0, &err);
+			g_assert_no_error(err);
+
+			/* Keys are sorted, and positions of equal keys are kept
+			 * in order. */
+			for (size_t i = 1; i < numel; ++i) {
+				g_assert_cmpuint(result[2 * (i - 1)], <=, result[2 * i]);
+				if (result[2 * (i - 1)] == result[2 * i])
+					g_assert_cmpuint(
+						result[2 * (i - 1) + 1], <, result[2 * i + 1]);
+			}
+
+			g_free(data);
+			g_free(result);
+		}
+
+		clo_sort_destroy(sorter);
+	}
+
+	/* Free stuff. */
+	g_rand_free(rng);
+	ccl_queue_destroy(cq);
+	ccl_context_destroy(ctx);
+}
+
+/**
+ * Test the global memory and tiled gselect kernels with a comparison
+ * for which distinct keys can tie (only the upper bits of the keys are
+ * compared), checking that ties keep the original order and that no
+ * element is lost.
+ * */
+static void gselect_test() {
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq = NULL;
+	CloSort* sorter = NULL;
+	CloType elem_type = CLO_UINT2;
+	CloType key_type = CLO_UINT;
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_SORT_TEST_SEED);
+	const size_t sizes[] = { 1, 3, 1000, 4099 };
+	const char* options[] = { "tiled=0", "tiled=1" };
+
+	/* Get context, device and command queue. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+	cq = ccl_queue_new(ctx, dev, 0, &err);
+	g_assert_no_error(err);
+
+	for (guint o = 0; o < G_N_ELEMENTS(options); ++o) {
+
+		sorter = clo_sort_new("gselect", options[o], ctx, &elem_type,
+			&key_type, "(((a) >> 4) > ((b) >> 4))", "((x).s0)", NULL,
+			&err);
+		g_assert_no_error(err);
+
+		for (guint s = 0; s < G_N_ELEMENTS(sizes); ++s) {
+
+			size_t numel = sizes[s];
+			cl_uint* data = g_new(cl_uint, 2 * numel);
+			cl_uint* result = g_new(cl_uint, 2 * numel);
+			gboolean* seen = g_new0(gboolean, numel);
+
+			/* Keys with few distinct upper bits, each paired with its
+			 * position. */
+			for (size_t i = 0; i < numel; ++i) {
+				data[2 * i] = g_rand_int_range(rng, 0, 64);
+				data[2 * i + 1] = (cl_uint) i;
+			}
+
+			clo_sort_with_host_data(sorter, cq, NULL, data, result,
+				numel, 0, &err);
+			g_assert_no_error(err);
+
+			for (size_t i = 0; i < numel; ++i) {
+				cl_uint p = result[2 * i + 1];
+				g_assert_cmpuint(p, <, numel);
+				g_assert(!seen[p]);
+				seen[p] = TRUE;
+				g_assert_cmpuint(result[2 * i], ==, data[2 * p]);
+				if (i == 0) continue;
+				g_assert_cmpuint(
+					result[2 * (i - 1)] >> 4, <=, result[2 * i] >> 4);
+				if ((result[2 * (i - 1)] >> 4) == (result[2 * i] >> 4))
+					g_assert_cmpuint(result[2 * (i - 1) + 1], <, p);
+			}
+
+			g_free(data);
+			g_free(result);
+			g_free(seen);
+		}
+
+		clo_sort_destroy(sorter);
+	}
+
+	/* Free stuff. */
+	g_rand_free(rng);
+	ccl_queue_destroy(cq);
+	ccl_context_destroy(ctx);
+}
+
+/**
+ * Record of 16 bytes sorted by its first member.
+ * */
+typedef struct {
+	cl_uint key;
+	cl_uint a;
+	cl_uint b;
+	cl_uint c;
+} clo_sort_test_rec;
+
+/**
+ * Test sorting of 16 byte records and of `float4` vectors by one of
+ * their members, checking that the remaining members are moved along
+ * with the keys, and that implementations which can't sort such keys
+ * are rejected when the sorter is created.
+ * */
+static void record_vector_test() {
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq = NULL;
+	CloSort* sorter = NULL;
+	CloType rec_type;
+	CloType f4_type = CLO_FLOAT4;
+	CloType uint_type = CLO_UINT;
+	CloType float_type = CLO_FLOAT;
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_SORT_TEST_SEED);
+	const char* types[] = { "sbitonic", "abitonic", "samplesort",
+		"gselect" };
+
+	/* Get context, device and command queue. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+	cq = ccl_queue_new(ctx, dev, 0, &err);
+	g_assert_no_error(err);
+
+	rec_type = clo_type_new_record("clo_sort_test_rec",
+		"uint key; uint a; uint b; uint c;", sizeof(clo_sort_test_rec),
+		16, &err);
+	g_assert_no_error(err);
+
+	for (guint t = 0; t < G_N_ELEMENTS(types); ++t) {
+
+		/* The gselect sort is quadratic, keep it to few elements. */
+		const size_t* sizes = (t == 3)
+			? clo_sort_test_sizes_tiny : clo_sort_test_sizes_pow2;
+		guint num_sizes = (t == 3)
+			? G_N_ELEMENTS(clo_sort_test_sizes_tiny)
+			: G_N_ELEMENTS(clo_sort_test_sizes_pow2);
+
+		/* Records. */
+		sorter = clo_sort_new(types[t], "host_max=0", ctx, &rec_type,
+			&uint_type, NULL, "((x).key)", NULL, &err);
+		g_assert_no_error(err);
+
+		for (guint s = 0; s < num_sizes; ++s) {
+
+			size_t numel = sizes[s];
+			clo_sort_test_rec* data =
+				g_new(clo_sort_test_rec, MAX(numel, 1));
+			clo_sort_test_rec* result =
+				g_new(clo_sort_test_rec, MAX(numel, 1));
+			gboolean* seen = g_new0(gboolean, MAX(numel, 1));
+
+			/* Keys with duplicates, members derived from the position
+			 * of each record. */
+			for (size_t i = 0; i < numel; ++i) {
+				data[i].key = g_rand_int_range(rng, 0, 1000);
+				data[i].a = (cl_uint) i;
+				data[i].b = ~((cl_uint) i);
+				data[i].c = data[i].key ^ (cl_uint) i;
+			}
+
+			clo_sort_with_host_data(sorter, cq, NULL, data, result,
+				numel, 0, &err);
+			g_assert_no_error(err);
+
+			for (size_t i = 0; i < numel; ++i) {
+				cl_uint p = result[i].a;
+				g_assert_cmpuint(p, <, numel);
+				g_assert(!seen[p]);
+				seen[p] = TRUE;
+				g_assert(memcmp(&result[i], &data[p],
+					sizeof(clo_sort_test_rec)) == 0);
+				if (i > 0)
+					g_assert_cmpuint(result[i - 1].key, <=, result[i].key);
+			}
+
+			g_free(data);
+			g_free(result);
+			g_free(seen);
+		}
+
+		clo_sort_destroy(sorter);
+
+		/* Vectors. */
+		sorter = clo_sort_new(types[t], "host_max=0", ctx, &f4_type,
+			&float_type, NULL, "((x).s0)", NULL, &err);
+		g_assert_no_error(err);
+
+		for (guint s = 0; s < num_sizes; ++s) {
+
+			size_t numel = sizes[s];
+			cl_float* data = g_new(cl_float, 4 * MAX(numel, 1));
+			cl_float* result = g_new(cl_float, 4 * MAX(numel, 1));
+			gboolean* seen = g_new0(gboolean, MAX(numel, 1));
+
+			/* Keys in the first component, the position of each
+			 * vector in the second one. */
+			for (size_t i = 0; i < numel; ++i) {
+				data[4 * i] = (cl_float) g_rand_double_range(rng, -1, 1);
+				data[4 * i + 1] = (cl_float) i;
+				data[4 * i + 2] = -data[4 * i];
+				data[4 * i + 3] = (cl_float) (2 * i);
+			}
+
+			clo_sort_with_host_data(sorter, cq, NULL, data, result,
+				numel, 0, &err);
+			g_assert_no_error(err);
+
+			for (size_t i = 0; i < numel; ++i) {
+				size_t p = (size_t) result[4 * i + 1];
+				g_assert_cmpuint(p, <, numel);
+				g_assert(!seen[p]);
+				seen[p] = TRUE;
+				g_assert(memcmp(&result[4 * i], &data[4 * p],
+					4 * sizeof(cl_float)) == 0);
+				if (i > 0)
+					g_assert_cmpfloat(
+						result[4 * (i - 1)], <=, result[4 * i]);
+			}
+
+			g_free(data);
+			g_free(result);
+			g_free(seen);
+		}
+
+		clo_sort_destroy(sorter);
+	}
+
+	/* The satradix sort shifts keys, so it can't sort by float or
+	 * record keys. */
+	sorter = clo_sort_new("satradix", NULL, ctx, &f4_type, &float_type,
+		NULL, "((x).s0)", NULL, &err);
+	g_assert_error(err, CLO_ERROR, CLO_ERROR_ARGS);
+	g_assert(sorter == NULL);
+	g_clear_error(&err);
+
+	sorter = clo_sort_new("satradix", NULL, ctx, &rec_type, NULL,
+		"((a).key > (b).key)", NULL, NULL, &err);
+	g_assert_error(err, CLO_ERROR, CLO_ERROR_ARGS);
+	g_assert(sorter == NULL);
+	g_clear_error(&err);
+
+	/* The host can't evaluate key getters. */
+	sorter = clo_sort_new("host", NULL, ctx, &rec_type, &uint_type,
+		NULL, "((x).key)", NULL, &err);
+	g_assert_error(err, CLO_ERROR, CLO_ERROR_ARGS);
+	g_assert(sorter == NULL);
+	g_clear_error(&err);
+
+	/* Free stuff. */
+	g_rand_free(rng);
+	ccl_queue_destroy(cq);
+	ccl_context_destroy(ctx);
+}
+
+/**
+ * Get a context with at least two devices for multi-device sorting:
+ * either the context of any device, if it has several devices, or a
+ * context with two sub-devices of its first device. The context of any
+ * device is placed in `parent`, since it owns the sub-devices.
+ * Returns `NULL` if no such context can be obtained.
+ * */
+static CCLContext* clo_sort_test_multi_context(CCLContext** parent) {
+
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLDevice* const* subdevs = NULL;
+	GError* err = NULL;
+	cl_uint num_subdevs, max_subdevs, cus;
+
+	*parent = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+	if (ccl_context_get_num_devices(*parent, &err) > 1)
+		return *parent;
+	g_assert_no_error(err);
+
+	/* Partition the first device in two sub-devices, if possible. */
+	dev = ccl_context_get_device(*parent, 0, &err);
+	g_assert_no_error(err);
+	max_subdevs = ccl_device_get_info_scalar(dev,
+		CL_DEVICE_PARTITION_MAX_SUB_DEVICES, cl_uint, &err);
+	if (err != NULL) goto finish;
+	cus = ccl_device_get_info_scalar(dev, CL_DEVICE_MAX_COMPUTE_UNITS,
+		cl_uint, &err);
+	if ((err != NULL) || (max_subdevs < 2) || (cus < 2)) goto finish;
+	{
+		const cl_device_partition_property props[] =
+			{ CL_DEVICE_PARTITION_EQUALLY, cus / 2, 0 };
+		subdevs = ccl_device_create_subdevices(
+			dev, props, &num_subdevs, &err);
+	}
+	if ((err != NULL) || (num_subdevs < 2)) goto finish;
+	ctx = ccl_context_new_from_devices(2, subdevs, &err);
+
+finish:
+
+	g_clear_error(&err);
+	return ctx;
+}
+
+/**
+ * Test multi-device sorting, with sort implementations which sort any
+ * number of elements, and check that implementations which only sort
+ * powers of two are rejected. The test is skipped if no context with
+ * several devices or sub-devices is available.
+ * */
+static void multi_test() {
+
+	/* Test variables. */
+	CCLContext* parent = NULL;
+	CCLContext* ctx = NULL;
+	CloSort* sorter = NULL;
+	CloType type = CLO_UINT;
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_SORT_TEST_SEED);
+	const char* types[] = { "samplesort", CLO_SORT_HOST_NAME };
+
+	/* Sizes which are and which are not split among the devices. */
+	const size_t sizes[] = { 1000, 65537 };
+
+	ctx = clo_sort_test_multi_context(&parent);
+	if (ctx == NULL) {
+		g_test_skip("No context with several devices or sub-devices.");
+		goto finish;
+	}
+
+	for (guint t = 0; t < G_N_ELEMENTS(types); ++t) {
+
+		sorter = clo_sort_new(types[t], NULL, ctx, &type, NULL, NULL,
+			NULL, NULL, &err);
+		g_assert_no_error(err);
+
+		for (guint s = 0; s < G_N_ELEMENTS(sizes); ++s) {
+
+			size_t numel = sizes[s];
+			cl_uint* data = g_new(cl_uint, numel);
+			cl_uint* result = g_new(cl_uint, numel);
+			cl_uint* expected = NULL;
+
+			for (guint d = 0; d < CLO_SORT_TEST_NUM_DISTS; ++d) {
+
+				clo_sort_test_fill(data, numel, d, rng);
+				expected = g_memdup(data, numel * sizeof(cl_uint));
+				clo_sort_host_radix(CLO_UINT, expected, numel, &err);
+				g_assert_no_error(err);
+
+				clo_sort_with_host_data_multi(sorter, data, result, numel,
+					0, &err);
+				g_assert_no_error(err);
+				g_assert(memcmp(result, expected, numel * sizeof(cl_uint))
+					== 0);
+
+				g_free(expected);
+			}
+
+			g_free(data);
+			g_free(result);
+		}
+
+		clo_sort_destroy(sorter);
+	}
+
+	/* Buckets have any size, so implementations which only sort powers
+	 * of two are rejected. */
+	sorter = clo_sort_new("sbitonic", NULL, ctx, &type, NULL, NULL, NULL,
+		NULL, &err);
+	g_assert_no_error(err);
+	{
+		cl_uint data[1024] = { 0 };
+		clo_sort_with_host_data_multi(sorter, data, data, 1024, 0, &err);
+		g_assert_error(err, CLO_ERROR, CLO_ERROR_ARGS);
+		g_clear_error(&err);
+	}
+	clo_sort_destroy(sorter);
+
+finish:
+
+	/* Free stuff. */
+	g_rand_free(rng);
+	if (ctx && (ctx != parent)) ccl_context_destroy(ctx);
+	ccl_context_destroy(parent);
+}
+
+/**
+ * Position of the first element of sorted data which is not smaller
+ * (if `upper` is false) or which is larger (if `upper` is true) than
+ * the given key.
+ * */
+static size_t clo_sort_test_bound(cl_uint* data, size_t numel,
+	cl_uint key, cl_bool upper) {
+
+	size_t lo = 0, hi = numel, mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if ((data[mid] < key) || (upper && (data[mid] == key)))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/**
+ * Test searching of sorted and unsorted query keys in sorted data,
+ * with keys which are and which are not present in the data.
+ * */
+static void search_test() {
+
+	/* Test variables. */
+	CCLContext* ctx = NULL;
+	CCLDevice* dev = NULL;
+	CCLQueue* cq = NULL;
+	CCLBuffer* data_dev = NULL;
+	CCLBuffer* queries_dev = NULL;
+	CCLBuffer* lower_dev = NULL;
+	CCLBuffer* upper_dev = NULL;
+	CloSort* sorter = NULL;
+	CloType type = CLO_UINT;
+	GError* err = NULL;
+	GRand* rng = g_rand_new_with_seed(CLO_SORT_TEST_SEED);
+	const size_t num_queries = 1001;
+	cl_uint* queries = g_new(cl_uint, num_queries);
+	cl_uint* lower = g_new(cl_uint, num_queries);
+	cl_uint* upper = g_new(cl_uint, num_queries);
+	cl_uint* data = NULL;
+
+	/* Get context, device and command queue. */
+	ctx = ccl_context_new_any(&err);
+	g_assert_no_error(err);
+	dev = ccl_context_get_device(ctx, 0, &err);
+	g_assert_no_error(err);
+	cq = ccl_queue_new(ctx, dev, 0, &err);
+	g_assert_no_error(err);
+
+	sorter = clo_sort_new("sbitonic", NULL, ctx, &type, NULL, NULL, NULL,
+		NULL, &err);
+	g_assert_no_error(err);
+
+	queries_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+		num_queries * sizeof(cl_uint), NULL, &err);
+	g_assert_no_error(err);
+	lower_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+		num_queries * sizeof(cl_uint), NULL, &err);
+	g_assert_no_error(err);
+	upper_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE,
+		num_queries * sizeof(cl_uint), NULL, &err);
+	g_assert_no_error(err);
+
+	for (guint s = 0; s < G_N_ELEMENTS(clo_sort_test_sizes); ++s) {
+
+		size_t numel = clo_sort_test_sizes[s];
+		size_t size = MAX(numel, 1) * sizeof(cl_uint);
+		data = g_malloc(size);
+		data_dev = ccl_buffer_new(ctx, CL_MEM_READ_WRITE, size, NULL,
+			&err);
+		g_assert_no_error(err);
+
+		for (guint d = 0; d < CLO_SORT_TEST_NUM_DISTS; ++d) {
+
+			/* Sorted data. */
+			clo_sort_test_fill(data, numel, d, rng);
+			clo_sort_host_radix(CLO_UINT, data, numel, &err);
+			g_assert_no_error(err);
+			if (numel > 0) {
+				ccl_buffer_enqueue_write(data_dev, cq, CL_TRUE, 0,
+					numel * sizeof(cl_uint), data, NULL, &err);
+				g_assert_no_error(err);
+			}
+
+			/* Queries with the same distribution as the data, half of
+			 * which are data elements or their successors. */
+			clo_sort_test_fill(queries, num_queries, d, rng);
+			for (size_t i = 1; (numel > 0) && (i < num_queries); i += 2)
+				queries[i] = data[g_rand_int_range(rng, 0, numel)]
+					+ ((i % 4 == 1) ? 0 : 1);
+
+			/* Unsorted, then sorted queries. */
+			for (guint sorted = 0; sorted < 2; ++sorted) {
+
+				if (sorted) {
+					clo_sort_host_radix(
+						CLO_UINT, queries, num_queries, &err);
+					g_assert_no_error(err);
+				}
+				ccl_buffer_enqueue_write(queries_dev, cq, CL_TRUE, 0,
+					num_queries * sizeof(cl_uint), queries, NULL, &err);
+				g_assert_no_error(err);
+
+				clo_sort_search(sorter, cq, data_dev, numel, queries_dev,
+					num_queries, sorted, lower_dev, upper_dev, 0, &err);
+				g_assert_no_error(err);
+				ccl_buffer_enqueue_read(lower_dev, cq, CL_TRUE, 0,
+					num_queries * sizeof(cl_uint), lower, NULL, &err);
+				g_assert_no_error(err);
+				ccl_buffer_enqueue_read(upper_dev, cq, CL_TRUE, 0,
+					num_queries * sizeof(cl_uint), upper, NULL, &err);
+				g_assert_no_error(err);
+
+				for (size_t i = 0; i < num_queries; ++i) {
+					g_assert_cmpuint(lower[i], ==, clo_sort_test_bound(
+						data, numel, queries[i], CL_FALSE));
+					g_assert_cmpuint(upper[i], ==, clo_sort_test_bound(
+						data, numel, queries[i], CL_TRUE));
+				}
+			}
+		}
+
+		ccl_buffer_destroy(data_dev);
+		g_free(data);
+	}
+
+	/* Free stuff. */
+	ccl_buffer_destroy(queries_dev);
+	ccl_buffer_destroy(lower_dev);
+	ccl_buffer_destroy(upper_dev);
+	g_free(queries);
+	g_free(lower);
+	g_free(upper);
+	clo_sort_destroy(sorter);
+	g_rand_free(rng);
+	ccl_queue_destroy(cq);
+	ccl_context_destroy(ctx);
+}
+
+/**
+ * Main function.
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Command line arguments.
+ * @return Result of test run.
+ * */
+int main(int argc, char** argv) {
+
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func(
+		"/sort/samplesort",
+		samplesort_test);
+
+	g_test_add_func(
+		"/sort/host-device",
+		host_device_test);
+
+	g_test_add_func(
+		"/sort/replay",
+		replay_test);
+
+	g_test_add_func(
+		"/sort/host-no-context",
+		host_no_context_test);
+
+	g_test_add_func(
+		"/sort/gselect",
+		gselect_test);
+
+	g_test_add_func(
+		"/sort/record-vector",
+		record_vector_test);
+
+	g_test_add_func(
+		"/sort/stable",
+		stable_test);
+
+	g_test_add_func(
+		"/sort/multi",
+		multi_test);
+
+	g_test_add_func(
+		"/sort/select",
+		select_test);
+
+	g_test_add_func(
+		"/sort/search",
+		search_test);
+
+	return g_test_run();
+}